@@ -0,0 +1,190 @@
+#include <gn/gn.h>
+#include <array>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include "../../example_lib.h"
+
+// --- Pipeline startup benchmark ---
+// Compiles a few hundred graphics pipeline variants, one by one with GnCreateGraphicsPipeline and all at once with
+// GnCreateGraphicsPipelines. Every measurement runs on a fresh device so neither variant benefits from modules or
+// driver caches warmed up by the other, and the order alternates across iterations. To compare against a software
+// rasterizer, point VK_ICD_FILENAMES at a software Vulkan ICD (e.g. lavapipe) before running.
+
+const std::array<GnFormat, 4> color_formats = {
+    GnFormat_RGBA8Unorm, GnFormat_BGRA8Unorm, GnFormat_RGBA16Float, GnFormat_R32Float,
+};
+
+const std::array<GnPrimitiveTopology, 3> topologies = {
+    GnPrimitiveTopology_TriangleList, GnPrimitiveTopology_TriangleStrip, GnPrimitiveTopology_LineList,
+};
+
+const std::array<GnCullMode, 3> cull_modes = {
+    GnCullMode_None, GnCullMode_Front, GnCullMode_Back,
+};
+
+constexpr uint32_t num_iterations = 4;
+constexpr uint32_t num_blend_variants = 2;
+constexpr uint32_t num_frontface_variants = 2;
+constexpr uint32_t num_variants =
+    (uint32_t)(color_formats.size() * topologies.size() * cull_modes.size()) * num_blend_variants * num_frontface_variants;
+
+struct PipelineVariant
+{
+    GnFormat                        color_format;
+    GnInputAssemblyStateDesc        input_assembly;
+    GnRasterizationStateDesc        rasterization;
+    GnFragmentInterfaceStateDesc    fragment_interface;
+    GnColorTargetBlendStateDesc     color_blend_state;
+    GnBlendStateDesc                blend;
+};
+
+double MeasureMs(GnAdapter adapter, std::vector<GnPipeline>& pipelines, const std::function<void(GnDevice)>& create_pipelines)
+{
+    GnDevice device;
+    EX_THROW_IF_FAILED(GnCreateDevice(adapter, nullptr, &device));
+
+    auto start = std::chrono::high_resolution_clock::now();
+    create_pipelines(device);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+    for (GnPipeline& pipeline : pipelines) {
+        if (pipeline != nullptr)
+            GnDestroyPipeline(device, pipeline);
+
+        pipeline = nullptr;
+    }
+
+    GnDestroyDevice(device);
+
+    return elapsed.count();
+}
+
+int main(int argc, char** argv)
+{
+    auto vertex_shader = GnLoadSPIRV("shader.vert.spv");
+    auto fragment_shader = GnLoadSPIRV("shader.frag.spv");
+    EX_THROW_IF(!vertex_shader.has_value() || !fragment_shader.has_value());
+
+    std::cout << "Pipeline startup benchmark" << std::endl;
+
+    // Validation adds a lot of overhead to pipeline creation, keep it off for measurement.
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = GnBackend_Vulkan;
+    instance_desc.enable_debugging = false;
+    instance_desc.enable_validation = false;
+    instance_desc.enable_backend_validation = false;
+
+    GnInstance instance;
+    EX_THROW_IF_FAILED(GnCreateInstance(&instance_desc, &instance));
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnAdapterProperties adapter_properties;
+    GnGetAdapterProperties(adapter, &adapter_properties);
+    std::cout << "Adapter: " << adapter_properties.name << std::endl;
+
+    GnShaderBytecode vs_bytecode{};
+    vs_bytecode.size = vertex_shader->size();
+    vs_bytecode.bytecode = vertex_shader->data();
+    vs_bytecode.entry_point = "main";
+
+    GnShaderBytecode fs_bytecode{};
+    fs_bytecode.size = fragment_shader->size();
+    fs_bytecode.bytecode = fragment_shader->data();
+    fs_bytecode.entry_point = "main";
+
+    GnVertexInputStateDesc vertex_input{};
+
+    // --- Build pipeline variants ---
+    std::vector<PipelineVariant> variants(num_variants);
+    std::vector<GnGraphicsPipelineDesc> descs(num_variants);
+    uint32_t variant_index = 0;
+
+    for (GnFormat format : color_formats) {
+        for (GnPrimitiveTopology topology : topologies) {
+            for (GnCullMode cull_mode : cull_modes) {
+                for (uint32_t blend_variant = 0; blend_variant < num_blend_variants; blend_variant++) {
+                    for (uint32_t frontface_variant = 0; frontface_variant < num_frontface_variants; frontface_variant++) {
+                        PipelineVariant& variant = variants[variant_index];
+                        variant.input_assembly = {};
+                        variant.input_assembly.topology = topology;
+
+                        variant.rasterization = {};
+                        variant.rasterization.polygon_mode = GnPolygonMode_Fill;
+                        variant.rasterization.cull_mode = cull_mode;
+                        variant.rasterization.frontface_ccw = frontface_variant == 1;
+
+                        variant.color_format = format;
+
+                        variant.fragment_interface = {};
+                        variant.fragment_interface.num_color_targets = 1;
+                        variant.fragment_interface.color_target_formats = &variant.color_format;
+
+                        variant.color_blend_state.blend_enable = blend_variant == 1;
+                        variant.color_blend_state.src_color_blend_factor = GnBlendFactor_SrcAlpha;
+                        variant.color_blend_state.dst_color_blend_factor = GnBlendFactor_InvSrcAlpha;
+                        variant.color_blend_state.color_blend_op = GnBlendOp_Add;
+                        variant.color_blend_state.src_alpha_blend_factor = GnBlendFactor_One;
+                        variant.color_blend_state.dst_alpha_blend_factor = GnBlendFactor_Zero;
+                        variant.color_blend_state.alpha_blend_op = GnBlendOp_Add;
+                        variant.color_blend_state.color_write_mask = GnColorComponent_All;
+
+                        variant.blend.independent_blend = GN_FALSE;
+                        variant.blend.num_blend_states = 1;
+                        variant.blend.blend_states = &variant.color_blend_state;
+
+                        GnGraphicsPipelineDesc& desc = descs[variant_index];
+                        desc = {};
+                        desc.vs = &vs_bytecode;
+                        desc.fs = &fs_bytecode;
+                        desc.vertex_input = &vertex_input;
+                        desc.input_assembly = &variant.input_assembly;
+                        desc.rasterization = &variant.rasterization;
+                        desc.fragment_interface = &variant.fragment_interface;
+                        desc.blend = &variant.blend;
+                        desc.num_viewports = 1;
+
+                        variant_index++;
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<GnPipeline> pipelines(num_variants);
+    std::vector<GnResult> results(num_variants);
+
+    auto create_serial = [&](GnDevice device) {
+        for (uint32_t i = 0; i < num_variants; i++)
+            EX_THROW_IF_FAILED(GnCreateGraphicsPipeline(device, &descs[i], &pipelines[i]));
+    };
+
+    auto create_batched = [&](GnDevice device) {
+        EX_THROW_IF_FAILED(GnCreateGraphicsPipelines(device, num_variants, descs.data(), pipelines.data(), results.data()));
+    };
+
+    // --- Compile ---
+    double serial_ms = 0.0;
+    double batched_ms = 0.0;
+
+    for (uint32_t i = 0; i < num_iterations; i++) {
+        if (i % 2 == 0) {
+            serial_ms += MeasureMs(adapter, pipelines, create_serial);
+            batched_ms += MeasureMs(adapter, pipelines, create_batched);
+        }
+        else {
+            batched_ms += MeasureMs(adapter, pipelines, create_batched);
+            serial_ms += MeasureMs(adapter, pipelines, create_serial);
+        }
+    }
+
+    std::cout << "Pipelines: " << num_variants << std::endl;
+    std::cout << "Iterations: " << num_iterations << std::endl;
+    std::cout << "One by one: " << serial_ms / num_iterations << " ms" << std::endl;
+    std::cout << "Batched: " << batched_ms / num_iterations << " ms" << std::endl;
+
+    GnDestroyInstance(instance);
+
+    return 0;
+}
@@ -1,6 +1,8 @@
 #include <gn/gn.h>
 #include <array>
 #include <vector>
+#include <chrono>
+#include <cstring>
 #include "../../example_lib.h"
 
 const std::array<float, 8> buffer_data = {
@@ -30,7 +32,174 @@ void CreateBuffer(GnAdapter adapter, GnDevice device, GnDeviceSize size, GnMemor
     GnBindBufferMemory(device, *buffer, *memory, 0);
 }
 
-int main()
+// --- Async compute overlap benchmark ---
+// Runs two independent chains of the hello_compute kernel, first back to back on the direct queue, then with the
+// second chain moved to a compute queue through GnEnqueueSubmissions so both chains can execute concurrently.
+
+constexpr uint32_t bench_num_elements = 65535;
+constexpr uint32_t bench_dispatches_per_chain = 64;
+constexpr uint32_t bench_warmup_iterations = 4;
+constexpr uint32_t bench_iterations = 64;
+
+struct BenchChain
+{
+    GnBuffer src_buffer;
+    GnMemory src_buffer_memory;
+    GnBuffer dst_buffer;
+    GnMemory dst_buffer_memory;
+};
+
+void RecordBenchChain(GnCommandList command_list, GnPipelineLayout pipeline_layout, GnPipeline compute_pipeline, const BenchChain& chain)
+{
+    GnCommandListBeginDesc begin_desc;
+    begin_desc.flags = 0; // Submitted many times
+    begin_desc.inheritance = nullptr;
+
+    GnBeginCommandList(command_list, &begin_desc);
+
+    GnBufferBarrier buffer_barrier{};
+    buffer_barrier.buffer = chain.dst_buffer;
+    buffer_barrier.offset = 0;
+    buffer_barrier.size = GN_WHOLE_SIZE;
+    buffer_barrier.prev_access = GnResourceAccess_CSWrite;
+    buffer_barrier.next_access = GnResourceAccess_CSWrite;
+
+    GnCmdSetComputePipeline(command_list, compute_pipeline);
+    GnCmdSetComputePipelineLayout(command_list, pipeline_layout);
+    GnCmdSetComputeStorageBuffer(command_list, 0, chain.src_buffer, 0);
+    GnCmdSetComputeStorageBuffer(command_list, 1, chain.dst_buffer, 0);
+
+    for (uint32_t i = 0; i < bench_dispatches_per_chain; i++) {
+        GnCmdDispatch(command_list, bench_num_elements, 1, 1);
+        GnCmdBufferBarrier(command_list, 1, &buffer_barrier);
+    }
+
+    GnEndCommandList(command_list);
+}
+
+template<typename Fn>
+double MeasureAverageMs(Fn&& run_iteration)
+{
+    for (uint32_t i = 0; i < bench_warmup_iterations; i++)
+        run_iteration();
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (uint32_t i = 0; i < bench_iterations; i++)
+        run_iteration();
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count() / (double)bench_iterations;
+}
+
+void RunOverlapBenchmark(GnAdapter adapter, GnDevice device, GnPipelineLayout pipeline_layout, GnPipeline compute_pipeline, uint32_t direct_queue_group)
+{
+    std::cout << "Async compute overlap benchmark" << std::endl;
+
+    bool has_compute_queue = false;
+    uint32_t compute_queue_group = 0;
+
+    GnEnumerateAdapterQueueGroupProperties(adapter,
+                                           [&](const GnQueueGroupProperties& properties) {
+                                               if (properties.type == GnQueueType_Compute && properties.num_queues > 0) {
+                                                   compute_queue_group = properties.index;
+                                                   has_compute_queue = true;
+                                               }
+                                           });
+
+    if (!has_compute_queue || !GnIsAdapterFeaturePresent(adapter, GnFeature_TimelineFence)) {
+        std::cout << "Skipped: no dedicated compute queue or timeline fence support" << std::endl;
+        return;
+    }
+
+    GnQueue direct_queue = GnGetDeviceQueue(device, direct_queue_group, 0);
+    GnQueue compute_queue = GnGetDeviceQueue(device, compute_queue_group, 0);
+
+    // The compute queue gets its own copy of the second chain's buffers. Buffers are created with exclusive sharing,
+    // so using the same ones from both queue groups would require ownership transfers.
+    BenchChain chains[3];
+
+    for (BenchChain& chain : chains) {
+        CreateBuffer(adapter, device, bench_num_elements * sizeof(float), 0, &chain.src_buffer_memory, &chain.src_buffer);
+        CreateBuffer(adapter, device, bench_num_elements * sizeof(float), 0, &chain.dst_buffer_memory, &chain.dst_buffer);
+    }
+
+    GnCommandPoolDesc command_pool_desc{};
+    command_pool_desc.usage = GnCommandPoolUsage_Transient;
+    command_pool_desc.command_list_usage = GnCommandListUsage_Primary;
+    command_pool_desc.max_allocated_cmd_list = 2;
+
+    GnCommandPool direct_command_pool;
+    command_pool_desc.queue_group_index = direct_queue_group;
+    EX_THROW_IF_FAILED(GnCreateCommandPool(device, &command_pool_desc, &direct_command_pool));
+
+    GnCommandPool compute_command_pool;
+    command_pool_desc.queue_group_index = compute_queue_group;
+    EX_THROW_IF_FAILED(GnCreateCommandPool(device, &command_pool_desc, &compute_command_pool));
+
+    GnCommandListDesc command_list_desc{};
+    command_list_desc.usage = GnCommandListUsage_Primary;
+
+    // Both chains on the direct queue
+    GnCommandList direct_command_lists[2];
+    command_list_desc.command_pool = direct_command_pool;
+    command_list_desc.queue_group_index = direct_queue_group;
+    command_list_desc.num_cmd_lists = 2;
+    EX_THROW_IF_FAILED(GnCreateCommandLists(device, &command_list_desc, direct_command_lists));
+
+    // The second chain again, recorded for the compute queue
+    GnCommandList compute_command_list;
+    command_list_desc.command_pool = compute_command_pool;
+    command_list_desc.queue_group_index = compute_queue_group;
+    command_list_desc.num_cmd_lists = 1;
+    EX_THROW_IF_FAILED(GnCreateCommandLists(device, &command_list_desc, &compute_command_list));
+
+    RecordBenchChain(direct_command_lists[0], pipeline_layout, compute_pipeline, chains[0]);
+    RecordBenchChain(direct_command_lists[1], pipeline_layout, compute_pipeline, chains[1]);
+    RecordBenchChain(compute_command_list, pipeline_layout, compute_pipeline, chains[2]);
+
+    double serial_ms = MeasureAverageMs([&]() {
+        GnEnqueueCommandLists(direct_queue, 2, direct_command_lists);
+        GnFlushQueueAndWait(direct_queue);
+    });
+
+    // The last submission joins the compute chain back into the direct queue.
+    const uint32_t join_dependencies[] = { 1 };
+    GnQueueSubmission submissions[3]{};
+    submissions[0].queue = direct_queue;
+    submissions[0].num_command_lists = 1;
+    submissions[0].command_lists = &direct_command_lists[0];
+    submissions[1].queue = compute_queue;
+    submissions[1].num_command_lists = 1;
+    submissions[1].command_lists = &compute_command_list;
+    submissions[2].queue = direct_queue;
+    submissions[2].num_dependencies = 1;
+    submissions[2].dependencies = join_dependencies;
+    submissions[2].wait_stages = GnPipelineStage_AllCommands;
+
+    double overlapped_ms = MeasureAverageMs([&]() {
+        EX_THROW_IF_FAILED(GnEnqueueSubmissions(3, submissions));
+        GnFlushQueueAndWait(direct_queue);
+    });
+
+    std::cout << "Serial (direct queue only): " << serial_ms << " ms" << std::endl;
+    std::cout << "Overlapped (direct + compute queue): " << overlapped_ms << " ms" << std::endl;
+    std::cout << "Speedup: " << serial_ms / overlapped_ms << "x" << std::endl;
+
+    GnDestroyCommandLists(device, compute_command_pool, 1, &compute_command_list);
+    GnDestroyCommandLists(device, direct_command_pool, 2, direct_command_lists);
+    GnDestroyCommandPool(device, compute_command_pool);
+    GnDestroyCommandPool(device, direct_command_pool);
+
+    for (BenchChain& chain : chains) {
+        GnDestroyBuffer(device, chain.dst_buffer);
+        GnDestroyBuffer(device, chain.src_buffer);
+        GnDestroyMemory(device, chain.dst_buffer_memory);
+        GnDestroyMemory(device, chain.src_buffer_memory);
+    }
+}
+
+int main(int argc, char** argv)
 {
     // Load shader
     auto compute_shader = GnLoadSPIRV("hello_compute.comp.spv");
@@ -187,6 +356,11 @@ int main()
         std::cout << mapped_buffer[i] << " ";
 
     GnUnmapBuffer(device, dst_buffer, nullptr);
+    std::cout << std::endl;
+
+    // Pass --overlap-benchmark to compare direct-only and direct + compute queue execution.
+    if (argc > 1 && std::strcmp(argv[1], "--overlap-benchmark") == 0)
+        RunOverlapBenchmark(adapter, device, pipeline_layout, compute_pipeline, direct_queue_group);
 
     // Cleanup
     GnDestroyCommandLists(device, command_pool, 1, &command_list);
@@ -1,4 +1,5 @@
 #include "example_lib.h"
+#include <cstring>
 
 GnExampleApp* GnExampleApp::g_app = nullptr;
 
@@ -7,6 +8,10 @@ int main(int argc, const char* argv[])
     if (GnExampleApp::g_app == nullptr)
         return -1;
 
+    for (int i = 1; i < argc; i++)
+        if (std::strcmp(argv[i], "--direct-present") == 0)
+            GnExampleApp::g_app->direct_present = true;
+
     if (!GnExampleApp::g_app->Init())
         return -1;
 
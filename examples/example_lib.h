@@ -4,6 +4,7 @@
 #include <vector>
 #include <fstream>
 #include <optional>
+#include <chrono>
 #include "example_def.h"
 
 struct GnExampleWindow
@@ -138,6 +139,7 @@ struct GnExampleApp : private GnExampleWindowWin32
     uint32_t num_swapchain_buffers = 2;
     int32_t direct_queue_group = -1;
     int32_t present_queue_group = -1;
+    bool direct_present = false;
 
     GnExampleApp()
     {
@@ -246,6 +248,8 @@ struct GnExampleApp : private GnExampleWindowWin32
         swapchain_desc.height = window_height;
         swapchain_desc.num_buffers = num_swapchain_buffers;
         swapchain_desc.vsync = false;
+        swapchain_desc.direct_present = direct_present;
+        swapchain_desc.present_queue = direct_present ? queue : nullptr;
 
         if (GN_FAILED(GnCreateSwapchain(device, &swapchain_desc, &swapchain))) {
             EX_ERROR("Cannot create swapchain");
@@ -260,15 +264,41 @@ struct GnExampleApp : private GnExampleWindowWin32
 
     int Run()
     {
+        uint64_t num_frames = 0;
+        auto start_time = std::chrono::steady_clock::now();
+
         while (open) {
             ProcessEvent();
+
+            if (direct_present) {
+                uint32_t back_buffer_index;
+                GnAcquireNextBackBuffer(swapchain, &back_buffer_index);
+            }
+
             OnRender();
             GnPresentSwapchain(queue, swapchain);
+            num_frames++;
         }
 
+        ReportPresentStats(num_frames, std::chrono::steady_clock::now() - start_time);
         return 0;
     }
 
+    void ReportPresentStats(uint64_t num_frames, std::chrono::steady_clock::duration elapsed) const
+    {
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        if (num_frames == 0 || seconds <= 0.0)
+            return;
+
+        // Without direct_present, every frame reads the intermediate back buffer and writes the presentable image
+        double blit_bytes_per_frame = direct_present ? 0.0 : (double)window_width * (double)window_height * 4.0 * 2.0;
+        double fps = (double)num_frames / seconds;
+
+        std::cout << "Present mode: " << (direct_present ? "direct" : "blit") << "\n";
+        std::cout << "Average frame time: " << (seconds * 1000.0 / (double)num_frames) << " ms (" << fps << " fps)\n";
+        std::cout << "Present copy traffic: " << (blit_bytes_per_frame * fps / (1024.0 * 1024.0)) << " MiB/s\n";
+    }
+
     virtual void OnStart() { }
 
     virtual void OnRender() { }
@@ -21,6 +21,9 @@
 #define GN_MAX_MEMORY_TYPES         32
 #define GN_MAX_SWAPCHAIN_BUFFERS    16
 #define GN_MAX_COLOR_TARGETS        8
+#define GN_MAX_SUBPASSES            8
+#define GN_MAX_QUEUED_PIPELINES     256
+#define GN_DEPTH_STENCIL_TARGET     GN_MAX_COLOR_TARGETS
 
 #if defined(_WIN32)
 #define GN_FPTR __stdcall
@@ -68,6 +71,8 @@ typedef enum
 {
     GnSuccess,
     GnTimeout,
+    GnNotReady,
+    GnOutOfDate,
     GnError_Unknown             = -1,
     GnError_Unimplemented       = -2,
     GnError_InvalidArgs         = -3,
@@ -108,6 +113,21 @@ uint32_t GnGetAdapters(GnInstance instance, uint32_t num_adapters, GnAdapter* ad
 uint32_t GnEnumerateAdapters(GnInstance instance, void* userdata, GnGetAdapterCallbackFn callback_fn);
 GnBackend GnGetBackend(GnInstance instance);
 
+typedef struct
+{
+    uint64_t    load_backend_ns;        // Loading the backend library and its entry points
+    uint64_t    create_instance_ns;     // Creating the backend instance
+    uint64_t    enumerate_adapters_ns;  // Listing the adapters, without querying them
+    uint64_t    query_adapters_ns;      // Adapter property, feature and format queries made so far
+    uint64_t    create_devices_ns;      // Every GnCreateDevice call made on the instance's adapters so far
+    uint32_t    num_queried_adapters;
+} GnInstanceStartupTimings;
+
+// Adapters are only queried the first time they are used (GnGetAdapterProperties, GnGetTextureFormatFeatureSupport,
+// GnCreateDevice and the other adapter getters), so adapters the application never looks at cost nothing past
+// enumeration. The timings break down where instance and device creation time went.
+void GnGetInstanceStartupTimings(GnInstance instance, GnInstanceStartupTimings* timings);
+
 typedef enum
 {
     GnAdapterType_Unknown,
@@ -130,6 +150,8 @@ typedef enum
     GnFeature_PointPolygonMode,
     GnFeature_ColorTargetLogicOp,
     GnFeature_UnclippedDepth,
+    GnFeature_TimelineFence,
+    GnFeature_Bindless,
     GnFeature_Count,
 } GnFeature;
 
@@ -275,6 +297,7 @@ typedef enum
     GnMemoryAttribute_HostVisible        = 1 << 1,
     GnMemoryAttribute_HostCoherent       = 1 << 2,
     GnMemoryAttribute_HostCached         = 1 << 3,
+    GnMemoryAttribute_LazilyAllocated    = 1 << 4, // Only backed as needed, only usable by transient textures
 } GnMemoryAttribute;
 typedef uint32_t GnMemoryAttributeFlags;
 
@@ -358,6 +381,8 @@ void GnGetAdapterQueueGroupProperties(GnAdapter adapter, uint32_t num_queues, Gn
 void GnEnumerateAdapterQueueGroupProperties(GnAdapter adapter, void* userdata, GnGetAdapterQueueGroupPropertiesCallbackFn callback_fn);
 void GnGetAdapterMemoryProperties(GnAdapter adapter, GnMemoryProperties* memory_properties);
 uint32_t GnFindMemoryType(GnAdapter adapter, GnMemoryAttributeFlags memory_attribute, uint32_t start_index);
+// Memory types that are lazily allocated are picked first when memory_type_bits allows them, which is only the case
+// for textures created with GnTextureUsage_Transient. Among those, a type with preferred_flags is picked first.
 uint32_t GnFindSupportedMemoryType(GnAdapter adapter, uint32_t memory_type_bits, GnMemoryAttributeFlags preferred_flags, GnMemoryAttributeFlags required_flags, uint32_t start_index);
 
 typedef enum
@@ -366,6 +391,7 @@ typedef enum
     GnSurfaceType_UWP,
     GnSurfaceType_Android,
     GnSurfaceType_SDL,
+    GnSurfaceType_Headless, // Presents to nothing, for benchmarking and testing
 } GnSurfaceType;
 
 typedef enum
@@ -378,6 +404,8 @@ typedef enum
     GnTextureUsage_Storage = 1 << 5,
     GnTextureUsage_ColorTarget = 1 << 6,
     GnTextureUsage_DepthStencilTarget = 1 << 7,
+    GnTextureUsage_InputAttachment = 1 << 8,
+    GnTextureUsage_Transient = 1 << 9, // Contents never outlive a render pass, may be combined with target usages only
 } GnTextureUsage;
 typedef uint32_t GnTextureUsageFlags;
 
@@ -445,6 +473,7 @@ typedef struct
     uint32_t    max_buffers;
     uint32_t    min_buffers;
     GnBool      immediate_presentable;
+    GnBool      mailbox_presentable;
 } GnSurfaceProperties;
 
 typedef void (*GnGetSurfaceFormatCallbackFn)(void* userdata, GnFormat format);
@@ -470,13 +499,54 @@ typedef struct
     const GnFeature*        enabled_features;
     uint32_t                num_enabled_queue_groups;
     const GnQueueGroupDesc* queue_group_descs;
+    uint32_t                max_bindless_textures; // 0 means default. Clamped to the adapter limits.
+    uint32_t                max_bindless_buffers; // 0 means default. Clamped to the adapter limits.
 } GnDeviceDesc;
 
 GnResult GnCreateDevice(GnAdapter adapter, const GnDeviceDesc* desc, GnDevice* device);
 void GnDestroyDevice(GnDevice device);
 GnQueue GnGetDeviceQueue(GnDevice device, uint32_t queue_group_index, uint32_t queue_index);
 GnResult GnDeviceWaitIdle(GnDevice device);
+
+// With deferred destruction enabled, GnDestroyMemory, GnDestroyBuffer, GnDestroyTexture, GnDestroyTextureView and
+// GnDestroyPipeline only queue the object. GnRetireDeviceFrame closes the list of objects queued since the previous
+// call and ties it to a fence: a binary fence once it is signaled (it must not be reset before that), or a timeline
+// fence once it reaches value. It then releases completed lists in order, at most max_destroys_per_frame objects per
+// call (0 means no limit); the rest carries over to the next call. GnFlushDeferredDestruction waits for the device to
+// become idle and releases everything. GnDestroyDevice flushes implicitly. The queue is internally synchronized.
+void GnSetDeviceDeferredDestruction(GnDevice device, GnBool enable, uint32_t max_destroys_per_frame);
+GnResult GnRetireDeviceFrame(GnDevice device, GnFence fence, uint64_t value);
+GnResult GnFlushDeferredDestruction(GnDevice device);
+
+typedef struct
+{
+    uint32_t num_pending_objects;   // Objects queued and not released yet
+    uint32_t num_pending_frames;    // Retired frames with objects left to release
+} GnDeferredDestructionStats;
+
+void GnGetDeferredDestructionStats(GnDevice device, GnDeferredDestructionStats* stats);
+
+typedef enum
+{
+    GnPipelineStage_DrawIndirect        = 1 << 0,
+    GnPipelineStage_VertexInput         = 1 << 1,
+    GnPipelineStage_VertexShader        = 1 << 2,
+    GnPipelineStage_FragmentShader      = 1 << 3,
+    GnPipelineStage_DepthStencilTarget  = 1 << 4,
+    GnPipelineStage_ColorTarget         = 1 << 5,
+    GnPipelineStage_ComputeShader       = 1 << 6,
+    GnPipelineStage_Transfer            = 1 << 7,
+
+    GnPipelineStage_AllGraphics         = GnPipelineStage_DrawIndirect | GnPipelineStage_VertexInput | GnPipelineStage_VertexShader | GnPipelineStage_FragmentShader | GnPipelineStage_DepthStencilTarget | GnPipelineStage_ColorTarget,
+    GnPipelineStage_AllCommands         = GnPipelineStage_AllGraphics | GnPipelineStage_ComputeShader | GnPipelineStage_Transfer
+} GnPipelineStage;
+typedef uint32_t GnPipelineStageFlags;
+
+// Waits issued with GnEnqueueWaitSemaphore and GnEnqueueWaitFence block every stage of the following command lists.
+// The *Stages variants only block the given stages, letting earlier stages of the following work start before the
+// dependency is satisfied. Stages not supported by the queue are ignored.
 GnResult GnEnqueueWaitSemaphore(GnQueue queue, uint32_t num_wait_semaphores, const GnSemaphore* wait_semaphores);
+GnResult GnEnqueueWaitSemaphoreStages(GnQueue queue, uint32_t num_wait_semaphores, const GnSemaphore* wait_semaphores, const GnPipelineStageFlags* wait_stages);
 GnResult GnEnqueueCommandLists(GnQueue queue, uint32_t num_command_lists, const GnCommandList* command_lists);
 GnResult GnEnqueueSignalSemaphore(GnQueue queue, uint32_t num_signal_semaphores, const GnSemaphore* signal_semaphores);
 GnResult GnFlushQueue(GnQueue queue, GnFence fence);
@@ -484,6 +554,20 @@ GnResult GnFlushQueueAndWait(GnQueue queue);
 GnResult GnWaitQueue(GnQueue queue);
 GnResult GnPresentSwapchain(GnQueue queue, GnSwapchain swapchain);
 
+// In deferred submission mode, GnFlushQueue without a fence only closes a submission packet. Packets accumulate until
+// GnCommitQueue, a flush that signals a fence or waits, or GnPresentSwapchain, and are submitted with a single call.
+// If that submission fails, every accumulated packet is discarded and none of its command lists execute.
+void GnSetQueueDeferredSubmission(GnQueue queue, GnBool enable);
+GnResult GnCommitQueue(GnQueue queue, GnFence fence);
+
+typedef enum
+{
+    GnPresentMode_Auto,         // FIFO with vsync, immediate otherwise
+    GnPresentMode_Fifo,
+    GnPresentMode_Mailbox,      // Falls back to FIFO if the surface does not support it
+    GnPresentMode_Immediate,    // Falls back to FIFO if the surface does not support it
+} GnPresentMode;
+
 typedef struct
 {
     GnSurface           surface;
@@ -493,13 +577,33 @@ typedef struct
     uint32_t            height;
     uint32_t            num_buffers;
     GnBool              vsync;
+    GnBool              direct_present; // Render directly into the presentable images instead of an intermediate copy
+    GnQueue             present_queue;  // Required with direct_present, the queue that renders into and presents the back buffers
+    GnPresentMode       present_mode;
+    uint32_t            max_frames_in_flight; // 0 means num_buffers
 } GnSwapchainDesc;
 
+// By default, back buffers are intermediate textures that are copied to the presentable image by
+// GnPresentSwapchain. With direct_present, back buffers are the presentable images themselves:
+// - The back buffer index is only known after acquiring the next image with GnAcquireNextBackBuffer, which makes the
+//   next submission on present_queue wait for the image. GnGetCurrentBackBufferIndex returns the index of the last
+//   acquired image and never acquires.
+// - The back buffer must be transitioned to GnResourceAccess_Present before GnPresentSwapchain, which signals the
+//   presentation engine after all work submitted to present_queue so far.
+// - GnAcquireNextBackBuffer returns GnOutOfDate when the swapchain had to be recreated. Back buffer textures keep
+//   their handles, but texture views created from them must be recreated.
+//
+// At most max_frames_in_flight presents can be queued before the CPU blocks. GnWaitForPresentSlot blocks until the next
+// frame can be submitted without stalling; calling it before sampling input keeps input-to-display latency low. It
+// returns GnTimeout if no slot became available within the timeout (in nanoseconds).
+
 GnResult GnCreateSwapchain(GnDevice device, const GnSwapchainDesc* desc, GnSwapchain* swapchain);
 void GnDestroySwapchain(GnDevice device, GnSwapchain swapchain);
 uint32_t GnGetSwapchainBackBufferCount(GnSwapchain swapchain);
 uint32_t GnGetCurrentBackBufferIndex(GnSwapchain swapchain);
 GnTexture GnGetSwapchainBackBuffer(GnSwapchain swapchain, uint32_t index);
+GnResult GnAcquireNextBackBuffer(GnSwapchain swapchain, uint32_t* index);
+GnResult GnWaitForPresentSlot(GnSwapchain swapchain, uint64_t timeout);
 GnResult GnUpdateSwapchain(GnSwapchain swapchain, GnFormat format, uint32_t width, uint32_t height, uint32_t num_buffers, GnBool vsync);
 
 typedef enum
@@ -517,6 +621,33 @@ GnResult GnGetFenceStatus(GnFence fence);
 GnResult GnWaitFence(GnFence fence, uint64_t timeout);
 GnResult GnResetFence(GnFence fence);
 
+// Timeline fences hold a monotonically increasing 64-bit value and never need to be reset. They are signaled and
+// waited on by queues through GnEnqueueSignalFence/GnEnqueueWaitFence, and can be waited on from the host.
+// GnWaitFence on a timeline fence waits for the highest value enqueued for signaling so far.
+GnResult GnCreateTimelineFence(GnDevice device, uint64_t initial_value, GnFence* fence);
+GnResult GnGetFenceValue(GnFence fence, uint64_t* value);
+GnResult GnWaitFenceValue(GnFence fence, uint64_t value, uint64_t timeout);
+GnResult GnEnqueueWaitFence(GnQueue queue, GnFence fence, uint64_t value);
+GnResult GnEnqueueWaitFenceStages(GnQueue queue, GnFence fence, uint64_t value, GnPipelineStageFlags wait_stages);
+GnResult GnEnqueueSignalFence(GnQueue queue, GnFence fence, uint64_t value);
+
+typedef struct
+{
+    GnQueue                 queue;
+    uint32_t                num_command_lists;
+    const GnCommandList*    command_lists;
+    uint32_t                num_dependencies;
+    const uint32_t*         dependencies;       // Indices of earlier submissions in the same call
+    GnPipelineStageFlags    wait_stages;        // Stages that wait for dependencies on other queues
+} GnQueueSubmission;
+
+// Enqueues command lists to one or more queues and inserts the cross-queue synchronization implied by the
+// dependencies. Only submissions that another queue depends on signal, and each submission waits at most once per
+// other queue, skipping the wait if an earlier wait already covers both the value and the stages. Dependencies on
+// the same queue add no synchronization; command lists on one queue are ordered with barriers as usual. Every queue
+// involved is flushed before returning. Requires GnFeature_TimelineFence.
+GnResult GnEnqueueSubmissions(uint32_t num_submissions, const GnQueueSubmission* submissions);
+
 typedef enum
 {
     GnMemoryUsage_AlwaysMapped                  = 1 << 0,
@@ -672,6 +803,16 @@ typedef struct
 GnResult GnCreateTextureView(GnDevice device, const GnTextureViewDesc* desc, GnTextureView* texture_view);
 void GnDestroyTextureView(GnDevice device, GnTextureView texture);
 
+// With GnFeature_Bindless enabled, every buffer with uniform or storage usage and every texture view of a texture
+// with sampled or storage usage gets a stable index into the device's bindless heap, valid until the object is
+// destroyed. Buffers are written to the heap once memory is bound; texture views on creation, sampled textures in the
+// shader read-only layout and storage textures in the general layout. The heap is bound to pipeline layouts created
+// with use_bindless_resources, right after the descriptor tables and the global resources, and has one binding per
+// resource type: 0 for sampled textures, 1 for storage textures, 2 for storage buffers and 3 for uniform buffers (if
+// the adapter supports updating them after bind). Returns GN_INVALID if the object has no index or the heap is full.
+uint32_t GnGetTextureViewBindlessIndex(GnTextureView texture_view);
+uint32_t GnGetBufferBindlessIndex(GnBuffer buffer);
+
 typedef enum
 {
     GnRenderPassOp_Load,
@@ -709,6 +850,7 @@ typedef enum
     GnResourceAccess_Present                    = 1 << 23,
     GnResourceAccess_HostRead                   = 1 << 24,
     GnResourceAccess_HostWrite                  = 1 << 25,
+    GnResourceAccess_Discard                    = 1 << 26, // Only valid as prev_access, the previous contents are not preserved
 
     GnResourceAccess_UniformRead                = GnResourceAccess_VSUniformBuffer | GnResourceAccess_FSUniformBuffer | GnResourceAccess_CSUniformBuffer,
     GnResourceAccess_ShaderRead                 = GnResourceAccess_VSRead | GnResourceAccess_FSRead | GnResourceAccess_CSRead,
@@ -767,6 +909,7 @@ typedef struct
     const GnSubpassDependency*  dependencies;
 } GnRenderGraphDesc;
 
+// Passing a NULL desc creates an empty frame graph, which is built with the functions below instead.
 GnResult GnCreateRenderGraph(GnDevice device, const GnRenderGraphDesc* desc, GnRenderGraph* render_graph);
 void GnDestroyRenderGraph(GnDevice device, GnRenderGraph render_graph);
 
@@ -786,6 +929,7 @@ typedef enum
     GnResourceType_StorageBuffer,
     GnResourceType_SampledTexture,
     GnResourceType_StorageTexture,
+    GnResourceType_InputAttachment,
 } GnResourceType;
 
 typedef struct
@@ -829,6 +973,7 @@ typedef struct
     const GnDescriptorTableLayout*  descriptor_tables;
     uint32_t                        num_constant_ranges;
     const GnShaderConstantRange*    constant_ranges;
+    GnBool                          use_bindless_resources; // Requires GnFeature_Bindless
 } GnPipelineLayoutDesc;
 
 GnResult GnCreatePipelineLayout(GnDevice device, const GnPipelineLayoutDesc* desc, GnPipelineLayout* pipeline_layout);
@@ -948,6 +1093,9 @@ typedef enum
     GnPipelineStreamTokenType_AttachmentBlendState,
     GnPipelineStreamTokenType_EnableIndependentBlend,
     GnPipelineStreamTokenType_Layout,
+    GnPipelineStreamTokenType_VertexInputSlot,
+    GnPipelineStreamTokenType_FragmentInterface,
+    GnPipelineStreamTokenType_NumViewports,
 } GnPipelineStreamTokenType;
 
 typedef enum
@@ -1018,6 +1166,18 @@ typedef struct
     GnFormat    depth_stencil_target_format;
 } GnFragmentInterfaceStateDesc;
 
+// Targets used by one subpass. Color target indices refer to the color targets of the render pass. Input
+// attachment index i reads input_targets[i], which may also be GN_DEPTH_STENCIL_TARGET. Resolve targets are only
+// supported in render passes with a single subpass.
+typedef struct
+{
+    uint32_t        num_color_targets;
+    const uint32_t* color_targets;              // Color target written by each fragment shader output
+    uint32_t        num_input_targets;
+    const uint32_t* input_targets;
+    GnBool          use_depth_stencil_target;
+} GnRenderPassSubpassDesc;
+
 typedef struct
 {
     GnStencilOp fail_op;
@@ -1070,12 +1230,20 @@ typedef struct
     const GnBlendStateDesc*             blend;
     uint32_t                            num_viewports;
     GnPipelineLayout                    layout;
+    GnPipelineCache                     cache;  // Optional
+
+    // Only needed for pipelines used in a render pass with subpasses, which must match the subpasses of that
+    // render pass. fragment_interface then describes every target of the render pass.
+    uint32_t                            num_subpasses;
+    const GnRenderPassSubpassDesc*      subpasses;
+    uint32_t                            subpass;
 } GnGraphicsPipelineDesc;
 
 typedef struct
 {
     GnShaderBytecode cs;
     GnPipelineLayout layout;
+    GnPipelineCache  cache;  // Optional
 } GnComputePipelineDesc;
 
 typedef struct
@@ -1083,31 +1251,117 @@ typedef struct
     GnPipelineStreamTokenType type;
     union
     {
-        GnShaderBytecode            shader;
-        GnVertexInputAttributeDesc       vertex_attribute;
-        GnInputAssemblyStateDesc    input_assembly;
-        GnRasterizationStateDesc    rasterization;
-        GnDepthStencilStateDesc     depth_stencil;
-        GnMultisampleStateDesc      multisample;
-        GnColorTargetBlendStateDesc color_target_blend;
-        GnPipelineLayout            layout;
+        GnShaderBytecode                shader;
+        GnVertexInputAttributeDesc      vertex_attribute;
+        GnInputAssemblyStateDesc        input_assembly;
+        GnRasterizationStateDesc        rasterization;
+        GnDepthStencilStateDesc         depth_stencil;
+        GnMultisampleStateDesc          multisample;
+        GnColorTargetBlendStateDesc     color_target_blend;
+        GnPipelineLayout                layout;
+        GnVertexInputSlotDesc           vertex_input_slot;
+        GnFragmentInterfaceStateDesc    fragment_interface;
+        uint32_t                        num_viewports;
     } token;
 } GnPipelineStreamToken;
 
+// Header of a token in a tight stream, followed by payload_size bytes of payload padded to a multiple of 4 bytes.
+typedef struct
+{
+    uint32_t type;          // GnPipelineStreamTokenType
+    uint32_t payload_size;
+} GnPipelineStreamTokenHeader;
+
+// A pipeline stream is a sequence of tokens. Missing state tokens take default values: no vertex input, triangle
+// list, solid fill without culling, single sample, no depth/stencil, blending disabled and a single viewport.
+//
+// When tight_stream is false, stream_data is an array of GnPipelineStreamToken.
+//
+// When tight_stream is true, the stream contains no pointers and can be stored on disk or memory-mapped. It must be
+// 4-byte aligned and in native byte order. The payload of each token is:
+//   VS, FS, CS:                uint32_t bytecode_size, uint32_t entry_point_size, the bytecode (bytecode_size must be
+//                              a multiple of 4), then the NUL-terminated entry point (entry_point_size includes NUL)
+//   FragmentInterface:         uint32_t num_color_targets, uint32_t resolve_target_mask,
+//                              GnFormat depth_stencil_target_format, then GnFormat color_target_formats[num_color_targets]
+//   Layout:                    uint32_t index into layouts
+//   NumViewports:              uint32_t
+//   EnableIndependentBlend:    no payload
+//   Others:                    the matching struct of GnPipelineStreamToken::token
+//
+// Pointers in the parsed tokens refer to stream_data, which is not accessed after the pipeline is created.
+typedef struct
+{
+    size_t                  stream_size;
+    const void*             stream_data;
+    GnBool                  tight_stream;
+    uint32_t                num_layouts;    // Tight streams only
+    const GnPipelineLayout* layouts;        // Tight streams only
+    GnPipelineCache         cache;          // Optional
+} GnPipelineStreamDesc;
+
 typedef struct
 {
-    size_t      stream_size;
-    const void* stream_data;
-    GnBool      tight_stream;
-} GnPipelineStreamDesc;
+    size_t      initial_data_size;
+    const void* initial_data;       // Optional, data previously returned by GnGetPipelineCacheData
+} GnPipelineCacheDesc;
+
+// Pipeline cache data starts with a header identifying the vendor, device and driver that produced it. Initial data
+// produced by a different adapter or driver version is ignored and the cache starts empty.
+// GnGetPipelineCacheData returns the required size in data_size when data is NULL, and GnError_InvalidArgs when
+// data_size is too small.
+GnResult GnCreatePipelineCache(GnDevice device, const GnPipelineCacheDesc* desc, GnPipelineCache* pipeline_cache);
+void GnDestroyPipelineCache(GnDevice device, GnPipelineCache pipeline_cache);
+GnResult GnGetPipelineCacheData(GnDevice device, GnPipelineCache pipeline_cache, size_t* data_size, void* data);
+GnResult GnMergePipelineCaches(GnDevice device, GnPipelineCache dst_cache, uint32_t num_src_caches, const GnPipelineCache* src_caches);
 
 GnResult GnCreateGraphicsPipeline(GnDevice device, const GnGraphicsPipelineDesc* desc, GnPipeline* graphics_pipeline);
+
+// Creates several graphics pipelines at once, letting the backend compile them together. results is optional and
+// receives the result of each pipeline; pipelines that fail are set to NULL. Returns the first error, if any.
+GnResult GnCreateGraphicsPipelines(GnDevice device, uint32_t num_pipelines, const GnGraphicsPipelineDesc* descs, GnPipeline* graphics_pipelines, GnResult* results);
+
+// Creates a graphics pipeline that is compiled on a background thread owned by the device and returns it right away.
+// Until it is ready, GnCmdSetGraphicsPipeline binds fallback_pipeline in its place, or skips the draws recorded with
+// it when fallback_pipeline is NULL. The description and the data it points to are copied; the layout and the
+// pipeline cache must stay alive until compilation finishes. At most GN_MAX_QUEUED_PIPELINES pipelines can wait for
+// compilation per device; beyond that, GnError_OutOfHostMemory is returned and no pipeline is created.
+GnResult GnCreateGraphicsPipelineAsync(GnDevice device, const GnGraphicsPipelineDesc* desc, GnPipeline fallback_pipeline, GnPipeline* graphics_pipeline);
+
+// Returns GnNotReady while the pipeline is compiling, then GnSuccess or the error compilation failed with. Pipelines
+// still queued when the device is destroyed are never compiled and fail with GnError_Unknown.
+GnResult GnGetPipelineStatus(GnPipeline pipeline);
+
 GnResult GnCreateComputePipeline(GnDevice device, const GnComputePipelineDesc* desc, GnPipeline* compute_pipeline);
 GnResult GnCreateGraphicsPipelineFromStream(GnDevice device, const GnPipelineStreamDesc* desc, GnPipeline* graphics_pipeline);
 GnResult GnCreateComputePipelineFromStream(GnDevice device, const GnPipelineStreamDesc* desc, GnPipeline* compute_pipeline);
 void GnDestroyPipeline(GnDevice device, GnPipeline pipeline);
 GnPipelineType GnGetPipelineType(GnPipeline pipeline);
 
+typedef struct
+{
+    uint64_t num_hits;      // Create calls that returned an existing pipeline
+    uint64_t num_misses;    // Create calls that compiled a new pipeline
+    uint32_t num_pipelines; // Pipelines currently shared through the table
+} GnPipelineDeduplicationStats;
+
+// With pipeline deduplication enabled, GnCreateGraphicsPipeline and GnCreateGraphicsPipelines hash the whole
+// description (shader bytecode, every state and the layout) and return the existing pipeline when an identical one is
+// still alive. Shared pipelines are reference-counted: every successful create must be matched by GnDestroyPipeline,
+// and the pipeline is destroyed along with its last reference.
+void GnSetDevicePipelineDeduplication(GnDevice device, GnBool enable);
+void GnGetPipelineDeduplicationStats(GnDevice device, GnPipelineDeduplicationStats* stats);
+
+typedef struct
+{
+    uint64_t num_hits;      // Pipeline shader stages that reused a cached shader module
+    uint64_t num_misses;    // Pipeline shader stages that created a new shader module
+    uint32_t num_modules;   // Shader modules currently referenced by a pipeline
+} GnShaderModuleCacheStats;
+
+// Pipelines created from the same shader bytecode share one shader module, which is released along with the last
+// pipeline referencing it. Backends that pass the bytecode straight to pipeline creation report no activity.
+void GnGetShaderModuleCacheStats(GnDevice device, GnShaderModuleCacheStats* stats);
+
 typedef enum
 {
     GnDescriptorTableType_Resource,
@@ -1121,17 +1375,66 @@ typedef struct
     uint32_t max_sampled_textures;
     uint32_t max_storage_textures;
     uint32_t max_samplers;
+    uint32_t max_input_attachments;
 } GnDescriptorTablePoolLimits;
 
+typedef enum
+{
+    GnDescriptorPoolMode_Persistent,    // Tables are freed individually with GnFreeDescriptorTables
+    GnDescriptorPoolMode_Linear,        // Tables are only released all at once with GnResetDescriptorPool
+} GnDescriptorPoolMode;
+
 typedef struct
 {
     GnDescriptorTableType       type;
+    GnDescriptorPoolMode        mode;
     uint32_t                    max_descriptor_tables;
     GnDescriptorTablePoolLimits pool_limits;
 } GnDescriptorPoolDesc;
 
+typedef struct
+{
+    GnBuffer        buffer;
+    GnDeviceSize    offset;
+    GnDeviceSize    size; // GN_WHOLE_SIZE to use the rest of the buffer
+} GnDescriptorBufferInfo;
+
+// Writes num_descriptors consecutive array elements of a table binding. Buffer descriptors are taken from buffers,
+// texture descriptors from texture_views: sampled textures in the shader read-only layout, storage textures and input
+// attachments in the general layout.
+typedef struct
+{
+    GnDescriptorTable               descriptor_table;
+    uint32_t                        binding;
+    uint32_t                        first_array_element;
+    uint32_t                        num_descriptors;
+    GnResourceType                  resource_type;
+    const GnDescriptorBufferInfo*   buffers;
+    const GnTextureView*            texture_views;
+} GnDescriptorTableWrite;
+
+// A linear pool hands out tables with a bump allocator. GnFreeDescriptorTables is ignored for it, and
+// GnResetDescriptorPool releases every table in constant time, which suits tables rebuilt every frame. The tables of a
+// pool must not be in use by the device when the pool is reset or destroyed. GnUpdateDescriptorTables applies every
+// write with a single backend call; it must not race with other updates of the same tables. A table keeps referring to
+// the layout it was allocated with, so the layout must not be destroyed while any of its tables is still allocated.
 GnResult GnCreateDescriptorPool(GnDevice device, const GnDescriptorPoolDesc* desc, GnDescriptorPool* descriptor_pool);
 void GnDestroyDescriptorPool(GnDevice device, GnDescriptorPool descriptor_pool);
+GnResult GnResetDescriptorPool(GnDevice device, GnDescriptorPool descriptor_pool);
+GnResult GnAllocateDescriptorTables(GnDevice device, GnDescriptorPool descriptor_pool, uint32_t num_descriptor_tables, const GnDescriptorTableLayout* layouts, GnDescriptorTable* descriptor_tables);
+void GnFreeDescriptorTables(GnDevice device, GnDescriptorPool descriptor_pool, uint32_t num_descriptor_tables, const GnDescriptorTable* descriptor_tables);
+GnResult GnUpdateDescriptorTables(GnDevice device, uint32_t num_writes, const GnDescriptorTableWrite* writes);
+
+typedef struct
+{
+    GnDescriptorBufferInfo  buffer;         // For uniform and storage buffer bindings
+    GnTextureView           texture_view;   // For texture and input attachment bindings
+} GnDescriptorInfo;
+
+// Rewrites every descriptor of a table from one packed array: the bindings of the table layout in the order they were
+// declared, each taking num_resources consecutive entries. Goes through a descriptor update template built with the
+// layout where the backend supports it, which is cheaper than the equivalent GnUpdateDescriptorTables call.
+GnResult GnWriteDescriptorTable(GnDevice device, GnDescriptorTable descriptor_table, const GnDescriptorInfo* descriptors);
 
 typedef enum
 {
@@ -1167,6 +1470,7 @@ typedef enum
     GnCommandListBegin_OneTimeSubmit = 1 << 0,
     GnCommandListBegin_RenderPassContinue = 1 << 1,
     GnCommandListBegin_SimultaneousUse = 1 << 2,
+    GnCommandListBegin_TrackResourceState = 1 << 3, // Track resource access and insert barriers automatically.
 } GnCommandListBegin;
 typedef uint32_t GnCommandListBeginFlags;
 
@@ -1274,6 +1578,8 @@ typedef struct
     uint32_t                                    num_color_targets;
     const GnRenderPassColorTargetDesc*          color_targets;
     const GnRenderPassDepthStencilTargetDesc*   depth_stencil_target;
+    uint32_t                                    num_subpasses;  // Optional, a single subpass using every target when 0
+    const GnRenderPassSubpassDesc*              subpasses;
 } GnRenderPassBeginDesc;
 
 typedef struct
@@ -1366,6 +1672,7 @@ void GnCmdSetBlendConstants(GnCommandList command_list, const float blend_consta
 void GnCmdSetBlendConstants2(GnCommandList command_list, float r, float g, float b, float a);
 void GnCmdSetStencilRef(GnCommandList command_list, uint32_t stencil_ref);
 void GnCmdBeginRenderPass(GnCommandList command_list, const GnRenderPassBeginDesc* desc);
+void GnCmdNextSubpass(GnCommandList command_list);
 void GnCmdEndRenderPass(GnCommandList command_list);
 void GnCmdDraw(GnCommandList command_list, uint32_t num_vertices, uint32_t first_vertex);
 void GnCmdDrawInstanced(GnCommandList command_list, uint32_t num_vertices, uint32_t num_instances, uint32_t first_vertex, uint32_t first_instance);
@@ -1396,8 +1703,136 @@ void GnCmdGenerateMipmap(GnCommandList command_list, GnTexture src_texture, GnTe
 void GnCmdBarrier(GnCommandList command_list, uint32_t num_buffer_barriers, const GnBufferBarrier* buffer_barriers, uint32_t num_texture_barriers, const GnTextureBarrier* texture_barriers);
 void GnCmdBufferBarrier(GnCommandList command_list, uint32_t num_barriers, const GnBufferBarrier* barriers);
 void GnCmdTextureBarrier(GnCommandList command_list, uint32_t num_barriers, const GnTextureBarrier* barriers);
+
+// Declares the next access of a resource in a command list that was begun with GnCommandListBegin_TrackResourceState.
+// The command list inserts a barrier from the last known access when required. Must be called outside of a render pass.
+// GnCmdCopyBuffer, GnCmdCopyTexture, GnCmdCopyTextureToBuffer and dispatches transition their resources automatically,
+// dispatches including the buffers bound to the global resources. Draws track their vertex, index and global buffers, but cannot record barriers: a buffer
+// must either be first used by the draw or already be declared with a compatible access before the render pass,
+// otherwise the command list fails with GnError_InvalidArgs. Textures sampled by draws and dispatches and the
+// resources of blit commands must be declared with these functions before the command (before the render pass for
+// draws). Explicit barriers recorded into a tracked list update the tracked state as well.
+void GnCmdTransitionBuffer(GnCommandList command_list, GnBuffer buffer, GnResourceAccessFlags next_access);
+void GnCmdTransitionTexture(GnCommandList command_list, GnTexture texture, const GnTextureSubresourceRange* subresource_range, GnResourceAccessFlags next_access);
 void GnCmdExecuteBundles(GnCommandList command_list, uint32_t num_bundles, const GnCommandList* bundles);
 
+typedef uint32_t GnRenderGraphResource;
+typedef void (*GnRenderGraphExecuteFn)(void* userdata, GnCommandList command_list, GnRenderGraph render_graph);
+
+typedef struct
+{
+    GnRenderGraphResource   resource;
+    GnResourceAccessFlags   access;
+} GnRenderGraphResourceAccess;
+
+typedef struct
+{
+    GnRenderGraphResource   resource;
+    GnRenderPassOp          load_op;
+    GnRenderPassOp          store_op;
+    GnColorValue            clear_value;
+} GnRenderGraphColorTargetDesc;
+
+typedef struct
+{
+    GnRenderGraphResource   resource;
+    GnRenderPassOp          depth_load_op;
+    GnRenderPassOp          depth_store_op;
+    GnRenderPassOp          stencil_load_op;
+    GnRenderPassOp          stencil_store_op;
+    GnDepthStencilValue     clear_value;
+} GnRenderGraphDepthStencilTargetDesc;
+
+// Targets of a pass that renders inside a render pass begun by the graph. Their accesses are added to the pass
+// automatically. Input attachment index i reads input_targets[i].
+typedef struct
+{
+    uint32_t                                    num_color_targets;
+    const GnRenderGraphColorTargetDesc*         color_targets;
+    const GnRenderGraphDepthStencilTargetDesc*  depth_stencil_target;   // Optional
+    uint32_t                                    num_input_targets;
+    const GnRenderGraphResource*                input_targets;
+} GnRenderGraphRenderPassDesc;
+
+typedef struct
+{
+    uint32_t                            num_accesses;
+    const GnRenderGraphResourceAccess*  accesses;
+    GnBool                              has_side_effects;   // Never culled, even if nothing reads what it writes
+    GnRenderGraphExecuteFn              execute_fn;
+    void*                               userdata;
+    const GnRenderGraphRenderPassDesc*  render_pass;        // Optional
+} GnRenderGraphPassDesc;
+
+// Imported resources are owned by the application. They are expected in initial_access when the graph starts
+// executing and are left in final_access once it is done.
+GnResult GnRenderGraphImportTexture(GnRenderGraph render_graph, GnTexture texture, GnResourceAccessFlags initial_access, GnResourceAccessFlags final_access, GnRenderGraphResource* resource);
+GnResult GnRenderGraphImportBuffer(GnRenderGraph render_graph, GnBuffer buffer, GnResourceAccessFlags initial_access, GnResourceAccessFlags final_access, GnRenderGraphResource* resource);
+
+// Transient resources only live while the graph is executing. They are created by GnCompileRenderGraph, and
+// resources whose lifetimes do not overlap may share the same memory.
+GnResult GnRenderGraphCreateTexture(GnRenderGraph render_graph, const GnTextureDesc* desc, GnRenderGraphResource* resource);
+GnResult GnRenderGraphCreateBuffer(GnRenderGraph render_graph, const GnBufferDesc* desc, GnRenderGraphResource* resource);
+
+// Passes run in an order consistent with the order they were added in. Accesses listed more than once for the same
+// resource are merged.
+GnResult GnRenderGraphAddPass(GnRenderGraph render_graph, const GnRenderGraphPassDesc* desc);
+
+// Sorts the passes, culls the ones that contribute to neither an imported resource nor a pass with side effects,
+// computes the barriers needed before every pass, and creates the transient resources. Transient resources are
+// placed into one memory per memory type, aliased where their lifetimes do not overlap.
+GnResult GnCompileRenderGraph(GnDevice device, GnRenderGraph render_graph);
+
+// Records the compiled graph into command_list. Each pass is preceded by one batch of barriers. The first use of a
+// transient resource also waits for the accesses made to its memory by the previous execution, so a compiled graph
+// can be recorded again every frame.
+void GnExecuteRenderGraph(GnCommandList command_list, GnRenderGraph render_graph);
+
+// Consecutive passes with render passes are merged into subpasses of one render pass when they have the same size
+// and sample count, share at most one depth-stencil target and only depend on each other through their targets.
+// Enabled by default.
+void GnSetRenderGraphSubpassMerging(GnRenderGraph render_graph, GnBool enable);
+
+typedef struct
+{
+    uint32_t                        num_color_targets;
+    GnFormat                        color_target_formats[GN_MAX_COLOR_TARGETS];
+    GnFormat                        depth_stencil_target_format;
+    GnSampleCount                   sample_count;
+    uint32_t                        num_subpasses;
+    const GnRenderPassSubpassDesc*  subpasses;
+    uint32_t                        subpass;
+} GnRenderGraphPassLayout;
+
+// Describes the render pass a pass runs in once the graph is compiled. Graphics pipelines used by the pass have to
+// be created with the same targets and subpasses. pass_index is the order in which the pass was added.
+GnResult GnGetRenderGraphPassLayout(GnRenderGraph render_graph, uint32_t pass_index, GnRenderGraphPassLayout* layout);
+
+typedef struct
+{
+    uint32_t                    execution_position; // GN_INVALID if the pass was culled
+    uint32_t                    num_buffer_barriers;
+    const GnBufferBarrier*      buffer_barriers;
+    uint32_t                    num_texture_barriers;
+    const GnTextureBarrier*     texture_barriers;
+} GnRenderGraphPassInfo;
+
+// Describes where a pass runs once the graph is compiled and the barriers recorded right before it. Passes merged
+// into the render pass of an earlier pass have no barriers of their own. The barriers stay valid until the graph is
+// compiled again or reset.
+GnResult GnGetRenderGraphPassInfo(GnRenderGraph render_graph, uint32_t pass_index, GnRenderGraphPassInfo* info);
+
+// Only valid after the graph has been compiled. Returns the imported or transient resource.
+GnTexture GnGetRenderGraphTexture(GnRenderGraph render_graph, GnRenderGraphResource resource);
+GnBuffer GnGetRenderGraphBuffer(GnRenderGraph render_graph, GnRenderGraphResource resource);
+
+// Only valid after the graph has been compiled. Returns the memory a transient resource is placed in and its offset
+// in that memory, or NULL for imported and unused resources.
+GnMemory GnGetRenderGraphResourceMemory(GnRenderGraph render_graph, GnRenderGraphResource resource, GnDeviceSize* offset);
+
+// Removes every pass and resource, and destroys the transient resources. The graph can be built again afterwards.
+void GnResetRenderGraph(GnDevice device, GnRenderGraph render_graph);
+
 // [HELPERS]
 
 typedef struct
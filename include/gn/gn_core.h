@@ -8,10 +8,15 @@
 #include <bitset>
 #include <optional>
 #include <algorithm>
+#include <chrono>
 #include <new>
 #include <mutex>
 #include <shared_mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
 #include <functional>
+#include <unordered_map>
 
 #if defined(_MSC_VER)
 #define GN_COMPILER_MSVC
@@ -112,6 +117,11 @@ inline static void GnFree(T ptr, std::size_t align = alignof(std::remove_pointer
     ::operator delete[](ptr, std::align_val_t{ align }, std::nothrow);
 }
 
+inline static uint64_t GnGetTimeNs() noexcept
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 template<typename T>
 inline static size_t GnCalcHash(const T& data)
 {
@@ -136,6 +146,44 @@ inline static void GnCombineHash(size_t& hash, const T& data, const Args&... arg
     (GnCombineHash(hash, args), ...);
 }
 
+// 64-bit MurmurHash2 (64A variant). Consumes 8 bytes per step, fast enough to hash whole shader binaries.
+inline static uint64_t GnHashBytes64(const void* data, size_t size, uint64_t seed = 0) noexcept
+{
+    static constexpr uint64_t m = 0xc6a4a7935bd1e995ULL;
+    static constexpr int r = 47;
+
+    const uint8_t* bytes = (const uint8_t*)data;
+    const uint8_t* end = bytes + (size & ~(size_t)7);
+    uint64_t hash = seed ^ (size * m);
+
+    for (; bytes != end; bytes += 8) {
+        uint64_t k;
+        std::memcpy(&k, bytes, sizeof(k));
+
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+
+        hash ^= k;
+        hash *= m;
+    }
+
+    size_t remaining = size & 7;
+
+    if (remaining > 0) {
+        for (size_t i = remaining; i > 0; i--)
+            hash ^= (uint64_t)bytes[i - 1] << (8 * (i - 1));
+
+        hash *= m;
+    }
+
+    hash ^= hash >> r;
+    hash *= m;
+    hash ^= hash >> r;
+
+    return hash;
+}
+
 struct GnPoolHeader
 {
     GnPoolHeader* next_pool;
@@ -247,6 +295,85 @@ struct GnPool
     }
 };
 
+// Lock-free allocator for integer indices in [0, capacity). Freed indices are kept in a Treiber stack, the head is
+// tagged with a counter in its upper 32 bits to avoid ABA.
+struct GnIndexAllocator
+{
+    static constexpr uint32_t invalid_index = UINT32_MAX;
+
+    std::atomic<uint32_t>*  next_free = nullptr;
+    uint32_t                capacity = 0;
+    std::atomic<uint32_t>   num_used{ 0 };
+    std::atomic<uint64_t>   free_head{ invalid_index };
+
+    bool Init(uint32_t new_capacity) noexcept
+    {
+        next_free = GnAllocate<std::atomic<uint32_t>>(new_capacity);
+
+        if (next_free == nullptr)
+            return false;
+
+        for (uint32_t i = 0; i < new_capacity; i++)
+            new(next_free + i) std::atomic<uint32_t>(invalid_index);
+
+        capacity = new_capacity;
+        Reset();
+
+        return true;
+    }
+
+    void Destroy() noexcept
+    {
+        if (next_free != nullptr)
+            GnFree(next_free);
+
+        next_free = nullptr;
+        capacity = 0;
+    }
+
+    // Not thread-safe, no other operation may run concurrently.
+    void Reset() noexcept
+    {
+        num_used.store(0, std::memory_order_relaxed);
+        free_head.store(invalid_index, std::memory_order_relaxed);
+    }
+
+    uint32_t Allocate() noexcept
+    {
+        uint64_t head = free_head.load(std::memory_order_acquire);
+
+        while ((uint32_t)head != invalid_index) {
+            uint32_t index = (uint32_t)head;
+            uint64_t new_head = ((head >> 32) + 1) << 32 | next_free[index].load(std::memory_order_relaxed);
+
+            if (free_head.compare_exchange_weak(head, new_head, std::memory_order_acquire, std::memory_order_acquire))
+                return index;
+        }
+
+        uint32_t index = num_used.load(std::memory_order_relaxed);
+
+        while (index < capacity) {
+            if (num_used.compare_exchange_weak(index, index + 1, std::memory_order_relaxed))
+                return index;
+        }
+
+        return invalid_index;
+    }
+
+    void Free(uint32_t index) noexcept
+    {
+        assert(index < capacity);
+
+        uint64_t head = free_head.load(std::memory_order_relaxed);
+        uint64_t new_head;
+
+        do {
+            next_free[index].store((uint32_t)head, std::memory_order_relaxed);
+            new_head = ((head >> 32) + 1) << 32 | index;
+        } while (!free_head.compare_exchange_weak(head, new_head, std::memory_order_release, std::memory_order_relaxed));
+    }
+};
+
 template<typename T>
 struct GnStackHandle
 {
@@ -335,6 +462,24 @@ struct GnVector
             ::operator delete[](first_ptr, std::align_val_t{ alignof(T) }, std::nothrow);
     }
 
+    GnVector& operator=(GnVector&& other) noexcept
+    {
+        if (this == &other)
+            return *this;
+
+        if (first_ptr)
+            ::operator delete[](first_ptr, std::align_val_t{ alignof(T) }, std::nothrow);
+
+        first_ptr = other.first_ptr;
+        last_ptr = other.last_ptr;
+        end_ptr = other.end_ptr;
+        other.first_ptr = nullptr;
+        other.last_ptr = nullptr;
+        other.end_ptr = nullptr;
+
+        return *this;
+    }
+
     inline T& operator[](size_t n) noexcept
     {
         return first_ptr[n];
@@ -517,8 +662,11 @@ struct GnSmallVector
 
     inline bool resize(size_t n) noexcept
     {
+        if (!reserve(n))
+            return false;
+
         size = n;
-        return reserve(n);
+        return true;
     }
 
     bool reserve(size_t n) noexcept
@@ -695,11 +843,18 @@ struct GnCacheTable<K, V, CacheKeyTrait<K>>
         return {};
     }
 
-    inline bool Insert(const K& key, const V& value)
+    // Returns the value stored for key, which is not value if another thread inserted the key first. Returns an
+    // empty optional if the value could not be inserted.
+    inline std::optional<V> Insert(const K& key, const V& value) noexcept
     {
         std::unique_lock<std::shared_mutex> lock(mutex);
-        cache_table.emplace(key, value);
-        return true; // TODO: Return false when fail
+
+        try {
+            return { cache_table.emplace(key, value).first->second };
+        }
+        catch (...) {
+            return {};
+        }
     }
 
     template<typename Fn>
@@ -805,6 +960,7 @@ struct GnObjectPool
     std::optional<GnPool<typename ObjectTypes::PipelineLayout>>         pipeline_layout;
     std::optional<GnPool<typename ObjectTypes::DescriptorPool>>         descriptor_pool;
     std::optional<GnPool<typename ObjectTypes::Pipeline>>               pipeline;
+    std::optional<GnPool<typename ObjectTypes::PipelineCache>>          pipeline_cache;
     std::optional<GnPool<typename ObjectTypes::CommandPool>>            command_pool;
 };
 
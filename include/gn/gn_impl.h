@@ -20,6 +20,9 @@ struct GnInstance_t
     GnBackend               backend = GnBackend_Auto;
     uint32_t                num_adapters = 0;
     GnAdapter               adapters = nullptr; // Linked-list
+    uint64_t                load_backend_ns = 0;
+    uint64_t                create_instance_ns = 0;
+    uint64_t                enumerate_adapters_ns = 0;
 
     virtual ~GnInstance_t() {}
     virtual GnResult CreateSurface(const GnSurfaceDesc* desc, GnSurface* surface) noexcept = 0;
@@ -34,8 +37,26 @@ struct GnAdapter_t
     uint32_t                        num_queue_groups = 0;
     GnQueueGroupProperties          queue_group_properties[4]{}; // is 4 enough?
     GnMemoryProperties              memory_properties{};
+    std::once_flag                  query_once;
+    std::atomic_bool                queried{ false };
+    mutable std::atomic<uint64_t>   query_ns{ 0 };
+    std::atomic<uint64_t>           create_device_ns{ 0 };
 
     virtual ~GnAdapter_t() { }
+
+    // Fills everything above but next_adapter. Backends that query their adapters up front leave it empty.
+    virtual void Query() noexcept { }
+
+    void EnsureQueried() noexcept
+    {
+        std::call_once(query_once, [this]() {
+            uint64_t start = GnGetTimeNs();
+            Query();
+            query_ns += GnGetTimeNs() - start;
+            queried = true;
+        });
+    }
+
     virtual GnTextureFormatFeatureFlags GetTextureFormatFeatureSupport(GnFormat format) const noexcept = 0;
     virtual GnSampleCountFlags GetTextureFormatMultisampleSupport(GnFormat format) const noexcept = 0;
     virtual GnBool IsVertexFormatSupported(GnFormat format) const noexcept = 0;
@@ -51,16 +72,113 @@ struct GnSurface_t
     virtual ~GnSurface_t() { }
 };
 
+enum GnDeferredObjectType
+{
+    GnDeferredObjectType_Memory,
+    GnDeferredObjectType_Buffer,
+    GnDeferredObjectType_Texture,
+    GnDeferredObjectType_TextureView,
+    GnDeferredObjectType_Pipeline,
+};
+
+struct GnDeferredObject
+{
+    GnDeferredObjectType    type;
+    void*                   object;
+};
+
+struct GnDeferredDestructionFrame
+{
+    GnFence     fence;
+    uint64_t    value;
+    size_t      end_object; // One past the last object of this frame
+};
+
+// FIFO of objects waiting for the GPU to finish using them, grouped into retired frames.
+struct GnDeferredDestructionQueue
+{
+    std::mutex                              mutex;
+    GnVector<GnDeferredObject>              objects;
+    size_t                                  first_object = 0;
+    GnVector<GnDeferredDestructionFrame>    frames;
+    size_t                                  first_frame = 0;
+
+    bool Push(GnDeferredObjectType type, void* object) noexcept;
+    bool Retire(GnFence fence, uint64_t value) noexcept;
+    void Release(GnDevice device, uint32_t max_objects) noexcept;
+    void ReleaseAll(GnDevice device) noexcept;
+    void GetStats(GnDeferredDestructionStats* stats) noexcept;
+    void Compact() noexcept;
+};
+
+struct GnPipelineDedupEntry
+{
+    GnPipeline          pipeline;
+    uint32_t            ref_count;
+    GnVector<uint8_t>   key_data;
+};
+
+// Reference-counted graphics pipelines, keyed by the hash of their canonical description.
+struct GnPipelineDedupTable
+{
+    std::mutex                                          mutex;
+    std::unordered_map<uint64_t, GnPipelineDedupEntry>  entries;
+    std::unordered_map<GnPipeline, uint64_t>            pipeline_hashes;
+    uint64_t                                            num_hits = 0;
+    uint64_t                                            num_misses = 0;
+
+    static bool WriteKey(const GnGraphicsPipelineDesc* desc, GnVector<uint8_t>& key_data) noexcept;
+    GnPipeline Acquire(uint64_t hash, const uint8_t* key_data, size_t key_size) noexcept;
+    GnPipeline Insert(uint64_t hash, const uint8_t* key_data, size_t key_size, GnPipeline pipeline) noexcept;
+    bool Release(GnPipeline pipeline) noexcept;
+};
+
+struct GnPipelineCompileJob
+{
+    GnPipeline              pipeline;
+    GnGraphicsPipelineDesc  desc;       // Points into storage
+    GnVector<uint8_t>       storage;
+};
+
+// Compiles pipelines created with GnCreateGraphicsPipelineAsync in order, on a thread started on first use. Queued jobs
+// live in a fixed ring buffer so that enqueueing never allocates.
+struct GnPipelineCompiler
+{
+    static constexpr uint32_t max_queued_jobs = GN_MAX_QUEUED_PIPELINES;
+
+    std::mutex                          mutex;
+    std::condition_variable             job_available;
+    std::condition_variable             job_finished;
+    GnPipelineCompileJob                jobs[max_queued_jobs];
+    uint32_t                            first_job = 0;
+    uint32_t                            num_jobs = 0;
+    std::thread                         thread;
+    GnPipeline                          compiling_pipeline = nullptr;
+    bool                                stop = false;
+
+    GnResult Enqueue(GnDevice device, GnPipelineCompileJob&& job) noexcept;
+    void Cancel(GnPipeline pipeline) noexcept;
+    void Shutdown() noexcept;
+    void Run(GnDevice device) noexcept;
+};
+
 struct GnDevice_t
 {
-    GnAdapter   parent_adapter = nullptr;
-    uint32_t    num_enabled_queue_groups = 0;
-    uint32_t    num_enabled_queues[4]{}; // Number of enabled queues for each queue group.
-    uint32_t    total_enabled_queues = 0;
+    GnAdapter                   parent_adapter = nullptr;
+    uint32_t                    num_enabled_queue_groups = 0;
+    uint32_t                    num_enabled_queues[4]{}; // Number of enabled queues for each queue group.
+    uint32_t                    total_enabled_queues = 0;
+    bool                        deferred_destruction = false;
+    uint32_t                    max_destroys_per_frame = 0;
+    GnDeferredDestructionQueue  deferred_destruction_queue;
+    bool                        pipeline_deduplication = false;
+    GnPipelineDedupTable        pipeline_dedup_table;
+    GnPipelineCompiler          pipeline_compiler;
 
     virtual ~GnDevice_t() { }
     virtual GnResult CreateSwapchain(const GnSwapchainDesc* desc, GnSwapchain* swapchain) noexcept = 0;
     virtual GnResult CreateFence(GnBool signaled, GnFence* fence) noexcept = 0;
+    virtual GnResult CreateTimelineFence(uint64_t initial_value, GnFence* fence) noexcept { return GnError_Unimplemented; }
     virtual GnResult CreateMemory(const GnMemoryDesc* desc, GnMemory* buffer) noexcept = 0;
     virtual GnResult CreateBuffer(const GnBufferDesc* desc, GnBuffer* buffer) noexcept = 0;
     virtual GnResult CreateTexture(const GnTextureDesc* desc, GnTexture* texture) noexcept = 0;
@@ -69,8 +187,21 @@ struct GnDevice_t
     virtual GnResult CreateDescriptorTableLayout(const GnDescriptorTableLayoutDesc* desc, GnDescriptorTableLayout* descriptor_table_layout) noexcept = 0;
     virtual GnResult CreatePipelineLayout(const GnPipelineLayoutDesc* desc, GnPipelineLayout* pipeline_layout) noexcept = 0;
     virtual GnResult CreateGraphicsPipeline(const GnGraphicsPipelineDesc* desc, GnPipeline* pipeline) noexcept = 0;
+    virtual GnResult CreateGraphicsPipelines(uint32_t num_pipelines, const GnGraphicsPipelineDesc* descs, GnPipeline* pipelines, GnResult* results) noexcept { return GnError_Unimplemented; }
     virtual GnResult CreateComputePipeline(const GnComputePipelineDesc* desc, GnPipeline* pipeline) noexcept = 0;
+    virtual GnResult CreatePendingPipeline(GnPipelineType type, GnPipeline* pipeline) noexcept { return GnError_Unimplemented; }
+    virtual GnResult CompilePendingGraphicsPipeline(GnPipeline pipeline, const GnGraphicsPipelineDesc* desc) noexcept { return GnError_Unimplemented; }
+    virtual GnResult CreateGraphicsPipelineFromStream(const GnPipelineStreamDesc* desc, GnPipeline* pipeline) noexcept { return GnError_Unimplemented; }
+    virtual GnResult CreateComputePipelineFromStream(const GnPipelineStreamDesc* desc, GnPipeline* pipeline) noexcept { return GnError_Unimplemented; }
+    virtual GnResult CreatePipelineCache(const GnPipelineCacheDesc* desc, GnPipelineCache* pipeline_cache) noexcept { return GnError_Unimplemented; }
+    virtual GnResult GetPipelineCacheData(GnPipelineCache pipeline_cache, size_t* data_size, void* data) noexcept { return GnError_Unimplemented; }
+    virtual GnResult MergePipelineCaches(GnPipelineCache dst_cache, uint32_t num_src_caches, const GnPipelineCache* src_caches) noexcept { return GnError_Unimplemented; }
     virtual GnResult CreateDescriptorPool(const GnDescriptorPoolDesc* desc, GnDescriptorPool* descriptor_pool) noexcept = 0;
+    virtual GnResult ResetDescriptorPool(GnDescriptorPool descriptor_pool) noexcept { return GnError_Unimplemented; }
+    virtual GnResult AllocateDescriptorTables(GnDescriptorPool descriptor_pool, uint32_t num_descriptor_tables, const GnDescriptorTableLayout* layouts, GnDescriptorTable* descriptor_tables) noexcept { return GnError_Unimplemented; }
+    virtual void FreeDescriptorTables(GnDescriptorPool descriptor_pool, uint32_t num_descriptor_tables, const GnDescriptorTable* descriptor_tables) noexcept { }
+    virtual GnResult UpdateDescriptorTables(uint32_t num_writes, const GnDescriptorTableWrite* writes) noexcept { return GnError_Unimplemented; }
+    virtual GnResult WriteDescriptorTable(GnDescriptorTable descriptor_table, const GnDescriptorInfo* descriptors) noexcept { return GnError_Unimplemented; }
     virtual GnResult CreateCommandPool(const GnCommandPoolDesc* desc, GnCommandPool* command_pool) noexcept = 0;
     virtual GnResult CreateCommandLists(const GnCommandListDesc* desc, GnCommandList* command_lists) noexcept = 0;
     virtual void DestroySwapchain(GnSwapchain swapchain) noexcept = 0;
@@ -83,11 +214,14 @@ struct GnDevice_t
     virtual void DestroyDescriptorTableLayout(GnDescriptorTableLayout descriptor_table_layout) noexcept = 0;
     virtual void DestroyPipelineLayout(GnPipelineLayout pipeline_layout) noexcept = 0;
     virtual void DestroyPipeline(GnPipeline pipeline) noexcept = 0;
+    virtual void DestroyPipelineCache(GnPipelineCache pipeline_cache) noexcept { }
+    virtual void GetShaderModuleCacheStats(GnShaderModuleCacheStats* stats) noexcept { *stats = {}; }
     virtual void DestroyDescriptorPool(GnDescriptorPool descriptor_pool) noexcept = 0;
     virtual void DestroyCommandPool(GnCommandPool command_pool) noexcept = 0;
     virtual void DestroyCommandLists(GnCommandPool command_pool, uint32_t num_command_lists, const GnCommandList* command_lists) noexcept = 0;
     virtual void GetBufferMemoryRequirements(GnBuffer buffer, GnMemoryRequirements* memory_requirements) noexcept = 0;
     virtual GnResult BindBufferMemory(GnBuffer buffer, GnMemory memory, GnDeviceSize aligned_offset) noexcept = 0;
+    virtual GnResult BindTextureMemory(GnTexture texture, GnMemory memory, GnDeviceSize aligned_offset) noexcept = 0;
     virtual GnResult MapBuffer(GnBuffer buffer, const GnMemoryRange* memory_range, void** mapped_memory) noexcept = 0;
     virtual void UnmapBuffer(GnBuffer buffer, const GnMemoryRange* memory_range) noexcept = 0;
     virtual GnResult WriteBufferRange(GnBuffer buffer, const GnMemoryRange* memory_range, const void* data) noexcept = 0;
@@ -103,15 +237,77 @@ struct GnSwapchain_t
 
     virtual ~GnSwapchain_t() { }
     virtual GnTexture GetBackBuffer(uint32_t index) noexcept = 0;
+
+    virtual uint32_t GetBackBufferCount() noexcept
+    {
+        return swapchain_desc.num_buffers;
+    }
+
+    virtual uint32_t GetCurrentBackBufferIndex() noexcept
+    {
+        return current_frame;
+    }
+
+    virtual GnResult AcquireNextBackBuffer(uint32_t* index) noexcept
+    {
+        *index = current_frame;
+        return GnSuccess;
+    }
+
+    virtual GnResult WaitForPresentSlot(uint64_t timeout) noexcept
+    {
+        return GnSuccess;
+    }
+
     virtual GnResult Update(GnFormat format, uint32_t width, uint32_t height, uint32_t num_buffers, GnBool vsync) noexcept = 0;
 };
 
+struct GnQueueProgressWait
+{
+    GnQueue_t*              queue;
+    uint64_t                value;
+    GnPipelineStageFlags    wait_stages; // Stages that waited for value
+};
+
 struct GnQueue_t
 {
-    virtual GnResult EnqueueWaitSemaphore(uint32_t num_wait_semaphores, const GnSemaphore* wait_semaphores) noexcept = 0;
+    bool                            deferred_submission = false;
+    uint64_t                        progress_value = 0;     // Last value signaled on the progress fence by GnEnqueueSubmissions
+    GnVector<GnQueueProgressWait>   progress_waits;         // Highest progress value of other queues waited on so far
+    GnVector<GnBufferBarrier>       tracked_buffer_barriers;    // Scratch storage reused when resolving tracked command lists
+    GnVector<GnTextureBarrier>      tracked_texture_barriers;   // Scratch storage reused when resolving tracked command lists
+
+    // Records barriers that bring resources into the state expected by the next tracked command list.
+    virtual GnResult EnqueueStateFixup(uint32_t num_buffer_barriers, const GnBufferBarrier* buffer_barriers, uint32_t num_texture_barriers, const GnTextureBarrier* texture_barriers) noexcept
+    {
+        return GnError_Unimplemented;
+    }
+
+    // Timeline fence signaled by this queue when other queues depend on its work.
+    virtual GnResult GetProgressFence(GnFence* fence) noexcept
+    {
+        return GnError_Unimplemented;
+    }
+
+    // Makes room for the given number of enqueued waits, command lists and signals so that enqueueing them afterwards
+    // cannot run out of host memory.
+    virtual GnResult Reserve(uint32_t num_waits, uint32_t num_command_lists, uint32_t num_signals) noexcept
+    {
+        return GnSuccess;
+    }
+
+    virtual GnResult EnqueueWaitSemaphore(uint32_t num_wait_semaphores, const GnSemaphore* wait_semaphores, const GnPipelineStageFlags* wait_stages) noexcept = 0;
     virtual GnResult EnqueueCommandLists(uint32_t num_command_lists, const GnCommandList* command_lists) noexcept = 0;
     virtual GnResult EnqueueSignalSemaphore(uint32_t num_wait_semaphores, const GnSemaphore* wait_semaphores) noexcept = 0;
+    virtual GnResult EnqueueWaitFence(GnFence fence, uint64_t value, GnPipelineStageFlags wait_stages) noexcept { return GnError_Unimplemented; }
+    virtual GnResult EnqueueSignalFence(GnFence fence, uint64_t value) noexcept { return GnError_Unimplemented; }
     virtual GnResult Flush(GnFence fence, bool wait) noexcept = 0;
+
+    virtual GnResult Commit(GnFence fence) noexcept
+    {
+        return Flush(fence, false);
+    }
+
     virtual GnResult PresentSwapchain(GnSwapchain swapchain) noexcept = 0;
 };
 
@@ -121,8 +317,13 @@ struct GnSemaphore_t
 
 struct GnFence_t
 {
+    bool timeline = false;
+
+    virtual GnResult GetStatus() { return GnError_Unimplemented; }
     virtual GnResult Wait(uint64_t timeout) = 0;
     virtual GnResult Reset() = 0;
+    virtual GnResult GetValue(uint64_t* value) { return GnError_Unimplemented; }
+    virtual GnResult WaitValue(uint64_t value, uint64_t timeout) { return GnError_Unimplemented; }
 };
 
 struct GnMemory_t
@@ -145,6 +346,8 @@ struct GnBuffer_t
 {
     GnBufferDesc            desc;
     GnMemoryRequirements    memory_requirements;
+    GnResourceAccessFlags   tracked_access; // Last access of the buffer as seen by the queue, used by tracked command lists.
+    uint32_t                bindless_index; // GN_INVALID if the buffer is not in the bindless heap.
 };
 
 struct GnTexture_t
@@ -152,20 +355,138 @@ struct GnTexture_t
     GnTextureDesc           desc;
     GnMemoryRequirements    memory_requirements;
     bool                    swapchain_owned;
+    bool                    direct_present;             // Presented directly, GnResourceAccess_Present is the presentation layout.
+    GnResourceAccessFlags   tracked_access;             // Used when the texture only has one subresource.
+    GnResourceAccessFlags*  tracked_subresource_access; // Allocated on first tracked use, indexed by (mip_level * array_layers + array_layer).
+
+    inline uint32_t GetNumSubresources() const noexcept
+    {
+        return desc.mip_levels * desc.array_layers;
+    }
+
+    inline GnResourceAccessFlags* GetTrackedAccess() noexcept
+    {
+        const uint32_t num_subresources = GetNumSubresources();
+
+        if (num_subresources <= 1)
+            return &tracked_access;
+
+        if (tracked_subresource_access == nullptr) {
+            tracked_subresource_access = GnAllocate<GnResourceAccessFlags>(num_subresources);
+
+            if (tracked_subresource_access == nullptr)
+                return nullptr;
+
+            for (uint32_t i = 0; i < num_subresources; i++)
+                tracked_subresource_access[i] = tracked_access;
+        }
+
+        return tracked_subresource_access;
+    }
 };
 
 struct GnTextureView_t
 {
     GnFormat format;
+    uint32_t bindless_index; // GN_INVALID if the view is not in the bindless heap.
 };
 
-struct GnRenderGraph_t
+struct GnRenderGraphResourceEntry
+{
+    bool                    imported;
+    bool                    is_texture;
+    GnTextureDesc           texture_desc;
+    GnBufferDesc            buffer_desc;
+    GnTexture               texture;
+    GnBuffer                buffer;
+    GnResourceAccessFlags   initial_access;
+    GnResourceAccessFlags   final_access;
+    GnResourceAccessFlags   current_access;     // Used while compiling
+    uint32_t                first_use;          // Position in the execution order, GN_INVALID if never used
+    uint32_t                last_use;
+    uint32_t                memory_index;       // Index into GnRenderGraph_t::memories
+    GnDeviceSize            memory_offset;
+    GnDeviceSize            memory_size;
+};
+
+struct GnRenderGraphPassEntry
+{
+    uint32_t                first_access;
+    uint32_t                num_accesses;
+    bool                    has_side_effects;
+    GnRenderGraphExecuteFn  execute_fn;
+    void*                   userdata;
+    bool                    kept;
+    uint32_t                num_dependencies;   // Used while sorting
+    uint32_t                first_buffer_barrier;
+    uint32_t                num_buffer_barriers;
+    uint32_t                first_texture_barrier;
+    uint32_t                num_texture_barriers;
+    bool                    has_render_pass;
+    uint32_t                first_color_target;     // Index into GnRenderGraph_t::color_targets
+    uint32_t                num_color_targets;
+    uint32_t                depth_stencil_target;   // Index into GnRenderGraph_t::depth_stencil_targets, GN_INVALID if none
+    uint32_t                first_input_target;     // Index into GnRenderGraph_t::input_targets
+    uint32_t                num_input_targets;
+    uint32_t                render_pass_group;      // GN_INVALID if the pass does not render
+    uint32_t                subpass;
+};
+
+// Consecutive passes that render inside one render pass, each pass being one subpass.
+struct GnRenderGraphRenderPassGroup
+{
+    uint32_t                            first_position;     // Position of the first pass in the execution order
+    uint32_t                            num_passes;
+    uint32_t                            num_color_targets;
+    GnRenderGraphResource               color_target_resources[GN_MAX_COLOR_TARGETS];
+    GnRenderGraphResource               depth_stencil_resource; // GN_INVALID if none
+    GnRenderPassColorTargetDesc         color_targets[GN_MAX_COLOR_TARGETS];
+    GnRenderPassDepthStencilTargetDesc  depth_stencil_target;
+    uint32_t                            first_subpass;      // Index into GnRenderGraph_t::subpasses
+    GnRenderPassBeginDesc               begin_desc;
+};
+
+struct GnRenderGraphEdge
+{
+    uint32_t    src_pass;
+    uint32_t    dst_pass;
+    bool        data_flow;  // dst_pass reads what src_pass writes
+};
+
+struct GnRenderGraphMemoryEntry
 {
+    GnMemory        memory;
+    uint32_t        memory_type_index;
+    bool            for_textures;
+    bool            multisampled;
+    GnDeviceSize    size;
+};
 
+struct GnRenderGraph_t
+{
+    GnVector<GnRenderGraphResourceEntry>    resources;
+    GnVector<GnRenderGraphPassEntry>        passes;
+    GnVector<GnRenderGraphResourceAccess>   accesses;
+    GnVector<GnRenderGraphEdge>             edges;
+    GnVector<uint32_t>                      execution_order;
+    GnVector<GnBufferBarrier>               buffer_barriers;
+    GnVector<GnTextureBarrier>              texture_barriers;
+    GnVector<GnRenderGraphMemoryEntry>      memories;
+    GnVector<GnRenderGraphColorTargetDesc>  color_targets;
+    GnVector<GnRenderGraphDepthStencilTargetDesc> depth_stencil_targets;
+    GnVector<GnRenderGraphResource>         input_targets;
+    GnVector<GnRenderGraphRenderPassGroup>  render_pass_groups;
+    GnVector<GnRenderPassSubpassDesc>       subpasses;
+    GnVector<uint32_t>                      subpass_targets;
+    uint32_t                                num_final_buffer_barriers = 0;  // Recorded after the last pass
+    uint32_t                                num_final_texture_barriers = 0;
+    bool                                    merge_subpasses = true;
+    bool                                    compiled = false;
 };
 
 struct GnDescriptorTableLayout_t
 {
+    uint64_t content_hash;  // GnHashDescriptorTableLayoutDesc of the description
 };
 
 struct GnPipelineLayout_t
@@ -173,16 +494,227 @@ struct GnPipelineLayout_t
     uint32_t num_resource_tables;
     uint32_t num_resources;
     uint32_t num_shader_constants;
+    uint32_t global_resource_binding_mask;  // One bit per binding of the global resources
+    uint64_t content_hash;                  // GnHashPipelineLayoutDesc of the description
+};
+
+struct GnPipelineCache_t
+{
+};
+
+// Prepended to serialized pipeline cache data.
+struct GnPipelineCacheHeader
+{
+    static constexpr uint32_t magic_value = 0x4350474E; // "GNPC"
+    static constexpr uint32_t current_version = 1;
+
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    vendor_id;
+    uint32_t    device_id;
+    uint8_t     driver_uuid[16];
+    uint8_t     cache_uuid[16];
+    uint64_t    data_size;  // Size of the backend data following the header
+
+    // Returns the backend data if the header matches the expected adapter and driver, nullptr otherwise.
+    static const void* Validate(const GnPipelineCacheHeader& expected, size_t data_size, const void* data, size_t* backend_data_size) noexcept
+    {
+        if (data == nullptr || data_size < sizeof(GnPipelineCacheHeader))
+            return nullptr;
+
+        GnPipelineCacheHeader header;
+        std::memcpy(&header, data, sizeof(GnPipelineCacheHeader));
+
+        if (header.magic != magic_value ||
+            header.version != current_version ||
+            header.vendor_id != expected.vendor_id ||
+            header.device_id != expected.device_id ||
+            std::memcmp(header.driver_uuid, expected.driver_uuid, sizeof(driver_uuid)) != 0 ||
+            std::memcmp(header.cache_uuid, expected.cache_uuid, sizeof(cache_uuid)) != 0 ||
+            header.data_size > data_size - sizeof(GnPipelineCacheHeader))
+        {
+            return nullptr;
+        }
+
+        *backend_data_size = (size_t)header.data_size;
+
+        return (const uint8_t*)data + sizeof(GnPipelineCacheHeader);
+    }
 };
 
 struct GnPipeline_t
 {
-    GnPipelineType  type;
-    uint32_t        num_viewports;
+    GnPipelineType          type;
+    uint32_t                num_viewports;
+    std::atomic<GnResult>   status;             // GnNotReady while compiling in the background
+    GnPipeline              fallback_pipeline;  // Bound in place of the pipeline until it is ready
 };
 
+// Decodes a pipeline stream in a single pass and passes every token to on_token. Tight streams are decoded in place,
+// pointers in the tokens refer to the stream data. Returns GnError_InvalidArgs on a malformed stream.
+template<typename Fn>
+GnResult GnParsePipelineStream(const GnPipelineStreamDesc* desc, Fn&& on_token) noexcept
+{
+    if (!desc->tight_stream) {
+        if (desc->stream_size % sizeof(GnPipelineStreamToken) != 0)
+            return GnError_InvalidArgs;
+
+        const GnPipelineStreamToken* tokens = (const GnPipelineStreamToken*)desc->stream_data;
+        size_t num_tokens = desc->stream_size / sizeof(GnPipelineStreamToken);
+
+        for (size_t i = 0; i < num_tokens; i++) {
+            GnResult result = on_token(tokens[i]);
+
+            if (GN_FAILED(result))
+                return result;
+        }
+
+        return GnSuccess;
+    }
+
+    if (((uintptr_t)desc->stream_data & 3) != 0)
+        return GnError_InvalidArgs;
+
+    const uint8_t* stream = (const uint8_t*)desc->stream_data;
+    const uint8_t* stream_end = stream + desc->stream_size;
+
+    while (stream != stream_end) {
+        GnPipelineStreamTokenHeader header;
+
+        if ((size_t)(stream_end - stream) < sizeof(header))
+            return GnError_InvalidArgs;
+
+        std::memcpy(&header, stream, sizeof(header));
+        stream += sizeof(header);
+
+        size_t padded_size = ((size_t)header.payload_size + 3) & ~(size_t)3;
+
+        if ((size_t)(stream_end - stream) < padded_size)
+            return GnError_InvalidArgs;
+
+        const uint8_t* payload = stream;
+        stream += padded_size;
+
+        GnPipelineStreamToken token;
+        token.type = (GnPipelineStreamTokenType)header.type;
+
+        // Copies a payload that is laid out exactly like its token struct.
+        auto read_payload = [&header, payload](auto& dst) -> bool {
+            if (header.payload_size != sizeof(dst))
+                return false;
+
+            std::memcpy(&dst, payload, sizeof(dst));
+            return true;
+        };
+
+        bool valid = true;
+
+        switch (token.type) {
+            case GnPipelineStreamTokenType_VS:
+            case GnPipelineStreamTokenType_FS:
+            case GnPipelineStreamTokenType_CS:
+            {
+                uint32_t sizes[2]; // bytecode_size, entry_point_size
+
+                if (header.payload_size < sizeof(sizes)) {
+                    valid = false;
+                    break;
+                }
+
+                std::memcpy(sizes, payload, sizeof(sizes));
+
+                const uint8_t* bytecode = payload + sizeof(sizes);
+                const char* entry_point = (const char*)bytecode + sizes[0];
+
+                valid = (sizes[0] & 3) == 0 && sizes[1] > 0 &&
+                        (uint64_t)sizes[0] + sizes[1] <= header.payload_size - sizeof(sizes) &&
+                        entry_point[sizes[1] - 1] == '\0';
+
+                token.token.shader.size = sizes[0];
+                token.token.shader.bytecode = bytecode;
+                token.token.shader.entry_point = entry_point;
+                break;
+            }
+            case GnPipelineStreamTokenType_FragmentInterface:
+            {
+                uint32_t fields[3]; // num_color_targets, resolve_target_mask, depth_stencil_target_format
+
+                if (header.payload_size < sizeof(fields)) {
+                    valid = false;
+                    break;
+                }
+
+                std::memcpy(fields, payload, sizeof(fields));
+
+                GnFragmentInterfaceStateDesc& fragment_interface = token.token.fragment_interface;
+                fragment_interface.num_color_targets = fields[0];
+                fragment_interface.resolve_target_mask = fields[1];
+                fragment_interface.depth_stencil_target_format = (GnFormat)fields[2];
+                fragment_interface.color_target_formats = (GnFormat*)(payload + sizeof(fields));
+
+                valid = fields[0] <= GN_MAX_COLOR_TARGETS &&
+                        header.payload_size == sizeof(fields) + fields[0] * sizeof(GnFormat);
+                break;
+            }
+            case GnPipelineStreamTokenType_Layout:
+            {
+                uint32_t index;
+                valid = read_payload(index) && index < desc->num_layouts;
+
+                if (valid)
+                    token.token.layout = desc->layouts[index];
+
+                break;
+            }
+            case GnPipelineStreamTokenType_EnableIndependentBlend:
+                valid = header.payload_size == 0;
+                break;
+            case GnPipelineStreamTokenType_VertexAttribute:
+                valid = read_payload(token.token.vertex_attribute);
+                break;
+            case GnPipelineStreamTokenType_InputAssembly:
+                valid = read_payload(token.token.input_assembly);
+                break;
+            case GnPipelineStreamTokenType_RasterizationState:
+                valid = read_payload(token.token.rasterization);
+                break;
+            case GnPipelineStreamTokenType_DepthStencilState:
+                valid = read_payload(token.token.depth_stencil);
+                break;
+            case GnPipelineStreamTokenType_MultisampleState:
+                valid = read_payload(token.token.multisample);
+                break;
+            case GnPipelineStreamTokenType_AttachmentBlendState:
+                valid = read_payload(token.token.color_target_blend);
+                break;
+            case GnPipelineStreamTokenType_VertexInputSlot:
+                valid = read_payload(token.token.vertex_input_slot);
+                break;
+            case GnPipelineStreamTokenType_NumViewports:
+                valid = read_payload(token.token.num_viewports);
+                break;
+            default:
+                valid = false;
+                break;
+        }
+
+        if (!valid)
+            return GnError_InvalidArgs;
+
+        GnResult result = on_token(token);
+
+        if (GN_FAILED(result))
+            return result;
+    }
+
+    return GnSuccess;
+}
+
 struct GnDescriptorPool_t
 {
+    GnDescriptorTableType   type;
+    GnDescriptorPoolMode    mode;
+    uint32_t                max_descriptor_tables;
 };
 
 struct GnDescriptorTable_t
@@ -209,8 +741,9 @@ struct GnCommandListState
 {
     enum
     {
-        GraphicsStateUpdate = (1 << 10) - 1,
-        ComputeStateUpdate = ~GraphicsStateUpdate
+        PendingBarriers = 1 << 14,
+        GraphicsStateUpdate = ((1 << 10) - 1) | PendingBarriers,
+        ComputeStateUpdate = ~((1 << 10) - 1)
     };
 
     GnPipelineState graphics, compute;
@@ -252,6 +785,9 @@ struct GnCommandListState
             bool compute_pipeline_layout : 1;
             bool compute_resource_binding : 1;
             bool compute_shader_constants : 1;
+
+            // Set by backends that defer barriers until the next draw/dispatch.
+            bool pending_barriers : 1;
         };
 
         uint32_t    u32;
@@ -275,6 +811,59 @@ typedef void (GN_FPTR* GnDrawIndexedCmdFn)(void* cmd_data, uint32_t num_indices,
 typedef void (GN_FPTR* GnDispatchCmdFn)(void* cmd_data, uint32_t num_thread_group_x, uint32_t num_thread_group_y, uint32_t num_thread_group_z);
 typedef void (GN_FPTR* GnBarrierCmdFn)(GnCommandList command_list);
 
+// Accesses that must be ordered against any other access of the same resource.
+static constexpr GnResourceAccessFlags GnResourceAccess_AnyWrite =
+    GnResourceAccess_ShaderWrite | GnResourceAccess_ColorTargetWrite | GnResourceAccess_DepthStencilTargetWrite |
+    GnResourceAccess_CopyDst | GnResourceAccess_BlitDst | GnResourceAccess_ClearDst | GnResourceAccess_HostWrite;
+
+struct GnTrackedStateKey
+{
+    const void* resource;
+    uint32_t    subresource;
+
+    inline bool operator==(const GnTrackedStateKey& other) const noexcept
+    {
+        return resource == other.resource && subresource == other.subresource;
+    }
+};
+
+struct GnTrackedStateKeyHash
+{
+    inline size_t operator()(const GnTrackedStateKey& key) const noexcept
+    {
+        size_t hash = 0;
+        GnCombineHash(hash, key.resource, key.subresource);
+        return hash;
+    }
+};
+
+struct GnTrackedResourceState
+{
+    GnBuffer                buffer;
+    GnTexture               texture;
+    uint32_t                subresource; // Texture only, (mip_level * array_layers + array_layer)
+    GnTextureAspectFlags    aspect;
+    GnResourceAccessFlags   first_access; // The access expected when the command list starts executing.
+    GnResourceAccessFlags   last_access;  // The access after the command list finished executing.
+};
+
+// Per command list resource state, only used when the command list is begun with GnCommandListBegin_TrackResourceState.
+struct GnResourceStateTracker
+{
+    std::unordered_map<GnTrackedStateKey, uint32_t, GnTrackedStateKeyHash> state_index;
+    GnVector<GnTrackedResourceState> states; // Ordered by first use.
+
+    inline void Reset() noexcept
+    {
+        state_index.clear();
+        states.resize(0);
+    }
+
+    // Returns the state of the resource in this command list, or nullptr if we ran out of memory. If the resource has
+    // not been used yet, a new state is created and *first_use is set to true; the caller must fill the accesses.
+    GnTrackedResourceState* Track(GnBuffer buffer, GnTexture texture, uint32_t subresource, bool* first_use) noexcept;
+};
+
 struct GnCommandList_t : public GnTrackedResource<GnCommandList_t>
 {
     GnCommandListState  state{};
@@ -289,12 +878,22 @@ struct GnCommandList_t : public GnTrackedResource<GnCommandList_t>
     bool                recording = false;
     bool                inside_render_pass = false;
     bool                standalone = false;
+    bool                track_resource_state = false;
+    bool                skip_draws = false; // The bound graphics pipeline is not ready and has no fallback
     GnResult            last_error = GnSuccess;
-    
+    GnResourceStateTracker* state_tracker = nullptr; // Allocated on first tracked use, kept across Begin()
+
+    virtual ~GnCommandList_t()
+    {
+        delete state_tracker;
+    }
+
     virtual GnResult Begin(const GnCommandListBeginDesc* desc) noexcept = 0;
     
     virtual void BeginRenderPass(const GnRenderPassBeginDesc* desc) noexcept = 0;
     
+    virtual void NextSubpass() noexcept = 0;
+
     virtual void EndRenderPass() noexcept = 0;
     
     virtual void Barrier(uint32_t num_buffer_barriers,
@@ -312,6 +911,8 @@ struct GnCommandList_t : public GnTrackedResource<GnCommandList_t>
                              GnResourceAccessFlags dst_texture_access,
                              GnExtent3 extent) noexcept = 0;
 
+    virtual void CopyTextureToBuffer(GnTexture src_texture, GnResourceAccessFlags src_texture_access, GnBuffer dst_buffer) noexcept = 0;
+
     virtual GnResult End() noexcept = 0;
 };
 
@@ -338,6 +939,7 @@ struct GnCommandListFallback : public GnCommandList_t
     
     GnResult Begin(const GnCommandListBeginDesc* desc) noexcept override;
     void BeginRenderPass(const GnRenderPassBeginDesc* desc) noexcept override;
+    void NextSubpass() noexcept override;
     void EndRenderPass() noexcept override;
     GnResult End() noexcept override;
 };
@@ -462,20 +1064,41 @@ GnBackend GnGetBackend(GnInstance instance)
     return instance->backend;
 }
 
+void GnGetInstanceStartupTimings(GnInstance instance, GnInstanceStartupTimings* timings)
+{
+    timings->load_backend_ns = instance->load_backend_ns;
+    timings->create_instance_ns = instance->create_instance_ns;
+    timings->enumerate_adapters_ns = instance->enumerate_adapters_ns;
+    timings->query_adapters_ns = 0;
+    timings->create_devices_ns = 0;
+    timings->num_queried_adapters = 0;
+
+    for (GnAdapter adapter = instance->adapters; adapter != nullptr; adapter = adapter->next_adapter) {
+        timings->query_adapters_ns += adapter->query_ns;
+        timings->create_devices_ns += adapter->create_device_ns;
+
+        if (adapter->queried)
+            timings->num_queried_adapters++;
+    }
+}
+
 // -- [GnAdapter] --
 
 void GnGetAdapterProperties(GnAdapter adapter, GnAdapterProperties* properties)
 {
+    adapter->EnsureQueried();
     *properties = adapter->properties;
 }
 
 void GnGetAdapterLimits(GnAdapter adapter, GnAdapterLimits* limits)
 {
+    adapter->EnsureQueried();
     *limits = adapter->limits;
 }
 
 uint32_t GnGetAdapterFeatureCount(GnAdapter adapter)
 {
+    adapter->EnsureQueried();
     uint32_t n = 0;
 
     for (uint32_t i = 0; i < GnFeature_Count; i++) {
@@ -488,6 +1111,7 @@ uint32_t GnGetAdapterFeatureCount(GnAdapter adapter)
 
 void GnGetAdapterFeatures(GnAdapter adapter, uint32_t num_features, GnFeature* features)
 {
+    adapter->EnsureQueried();
     uint32_t n = 0;
 
     for (uint32_t i = 0; i < GnFeature_Count && n < num_features; i++) {
@@ -502,6 +1126,7 @@ void GnGetAdapterFeatures(GnAdapter adapter, uint32_t num_features, GnFeature* f
 
 void GnEnumerateAdapterFeatures(GnAdapter adapter, void* userdata, GnGetAdapterFeatureCallbackFn callback_fn)
 {
+    adapter->EnsureQueried();
     for (uint32_t i = 0; i < GnFeature_Count; i++) {
         if (!adapter->features[i]) continue;
         callback_fn(userdata, (GnFeature)i);
@@ -513,6 +1138,7 @@ GnBool GnIsAdapterFeaturePresent(GnAdapter adapter, GnFeature feature)
     if (feature >= GnFeature_Count)
         return GN_FALSE;
 
+    adapter->EnsureQueried();
     return (GnBool)adapter->features[feature];
 }
 
@@ -542,28 +1168,33 @@ GnBool GnIsVertexFormatSupported(GnAdapter adapter, GnFormat format)
 
 uint32_t GnGetAdapterQueueGroupCount(GnAdapter adapter)
 {
+    adapter->EnsureQueried();
     return adapter->num_queue_groups;
 }
 
 void GnGetAdapterQueueGroupProperties(GnAdapter adapter, uint32_t num_queues, GnQueueGroupProperties* queue_properties)
 {
+    adapter->EnsureQueried();
     uint32_t n = std::min(num_queues, adapter->num_queue_groups);
     std::memcpy(queue_properties, adapter->queue_group_properties, sizeof(GnQueueGroupProperties) * n);
 }
 
 void GnEnumerateAdapterQueueGroupProperties(GnAdapter adapter, void* userdata, GnGetAdapterQueueGroupPropertiesCallbackFn callback_fn)
 {
+    adapter->EnsureQueried();
     for (uint32_t i = 0; i < adapter->num_queue_groups; i++)
         callback_fn(userdata, &adapter->queue_group_properties[i]);
 }
 
 void GnGetAdapterMemoryProperties(GnAdapter adapter, GnMemoryProperties* memory_properties)
 {
+    adapter->EnsureQueried();
     std::memcpy(memory_properties, &adapter->memory_properties, sizeof(GnMemoryProperties));
 }
 
 uint32_t GnFindMemoryType(GnAdapter adapter, GnMemoryAttributeFlags memory_attribute, uint32_t start_index)
 {
+    adapter->EnsureQueried();
     if (start_index >= adapter->memory_properties.num_memory_types) return GN_INVALID;
 
     for (uint32_t i = start_index; i < adapter->memory_properties.num_memory_types; i++) {
@@ -577,10 +1208,32 @@ uint32_t GnFindMemoryType(GnAdapter adapter, GnMemoryAttributeFlags memory_attri
 
 uint32_t GnFindSupportedMemoryType(GnAdapter adapter, uint32_t memory_type_bits, GnMemoryAttributeFlags preferred_flags, GnMemoryAttributeFlags required_flags, uint32_t start_index)
 {
+    adapter->EnsureQueried();
     if (start_index >= adapter->memory_properties.num_memory_types) return GN_INVALID;
     if (required_flags == 0) return GN_INVALID;
 
     uint32_t ret = GN_INVALID;
+    const GnMemoryAttributeFlags lazy_flags = required_flags | GnMemoryAttribute_LazilyAllocated;
+
+    // Lazily allocated types come first, the preferred flags still decide between several of them.
+    for (uint32_t i = start_index; i < adapter->memory_properties.num_memory_types; i++) {
+        if (!GnHasBit(memory_type_bits, 1 << i))
+            continue;
+
+        const GnMemoryType& type = adapter->memory_properties.memory_types[i];
+
+        if (!GnContainsBit(type.attribute, lazy_flags))
+            continue;
+
+        if (GnContainsBit(type.attribute, preferred_flags))
+            return i;
+
+        if (ret == GN_INVALID)
+            ret = i;
+    }
+
+    if (ret != GN_INVALID)
+        return ret;
 
     for (uint32_t i = start_index; i < adapter->memory_properties.num_memory_types; i++) {
         if (!GnHasBit(memory_type_bits, 1 << i))
@@ -633,6 +1286,7 @@ GnBool GnIsSurfacePresentationSupported(GnAdapter adapter, uint32_t queue_group_
 
 void GnEnumeratePresentationQueueGroup(GnAdapter adapter, GnSurface surface, void* userdata, GnGetAdapterQueueGroupPropertiesCallbackFn callback_fn)
 {
+    adapter->EnsureQueried();
     for (uint32_t i = 0; i < adapter->num_queue_groups; i++)
         if (adapter->IsSurfacePresentationSupported(i, surface))
             callback_fn(userdata, &adapter->queue_group_properties[i]);
@@ -663,43 +1317,452 @@ GnResult GnEnumerateSurfaceFormats(GnAdapter adapter, GnSurface surface, void* u
     return adapter->GnEnumerateSurfaceFormats(surface, userdata, callback_fn);
 }
 
-// -- [GnDevice] --
+// -- [GnDeferredDestructionQueue] --
 
-bool GnValidateCreateDeviceParam(GnAdapter adapter, const GnDeviceDesc* desc, GnDevice* device) noexcept
+inline static void GnDestroyDeferredObject(GnDevice device, const GnDeferredObject& object) noexcept
 {
-    bool error = false;
+    switch (object.type) {
+        case GnDeferredObjectType_Memory:       device->DestroyMemory((GnMemory)object.object); break;
+        case GnDeferredObjectType_Buffer:       device->DestroyBuffer((GnBuffer)object.object); break;
+        case GnDeferredObjectType_Texture:      device->DestroyTexture((GnTexture)object.object); break;
+        case GnDeferredObjectType_TextureView:  device->DestroyTextureView((GnTextureView)object.object); break;
+        case GnDeferredObjectType_Pipeline:     device->DestroyPipeline((GnPipeline)object.object); break;
+        default:                                GN_UNREACHABLE();
+    }
+}
 
-    if (adapter == nullptr) return true;
+inline static bool GnIsDeferredDestructionFrameComplete(const GnDeferredDestructionFrame& frame) noexcept
+{
+    if (frame.fence->timeline) {
+        uint64_t value = 0;
+        return !GN_FAILED(frame.fence->GetValue(&value)) && value >= frame.value;
+    }
 
-    if (device == nullptr) return true;
+    return frame.fence->GetStatus() == GnSuccess;
+}
 
-    // Validate enabled queue group desc.
-    if (desc != nullptr && desc->num_enabled_queue_groups > 0 && desc->queue_group_descs != nullptr) {
-        if (desc->num_enabled_queue_groups <= adapter->num_queue_groups)
-            return false;
+bool GnDeferredDestructionQueue::Push(GnDeferredObjectType type, void* object) noexcept
+{
+    std::scoped_lock lock(mutex);
+    return objects.push_back(GnDeferredObject{ type, object });
+}
 
-        uint32_t group_index[GN_MAX_QUEUE];
+bool GnDeferredDestructionQueue::Retire(GnFence fence, uint64_t value) noexcept
+{
+    std::scoped_lock lock(mutex);
+    size_t frame_begin = first_frame < frames.size() ? frames[frames.size() - 1].end_object : first_object;
 
-        for (uint32_t i = 0; i < desc->num_enabled_queue_groups; i++)
-            group_index[i] = desc->queue_group_descs[i].index;
+    // Nothing was queued since the last retired frame.
+    if (frame_begin == objects.size())
+        return true;
 
-        // Check if each queue group index is valid
-        bool has_invalid_index = false;
-        for (uint32_t i = 0; i < desc->num_enabled_queue_groups; i++) {
-            if (group_index[i] > adapter->num_queue_groups - 1) {
-                has_invalid_index = true;
-                error = error || true;
-            }
-        }
+    return frames.push_back(GnDeferredDestructionFrame{ fence, value, objects.size() });
+}
 
-        // Check if each queue count is valid
-        if (!has_invalid_index) {
-            for (uint32_t i = 0; i < desc->num_enabled_queue_groups; i++) {
-                GnQueueGroupProperties& queue_group_properties = adapter->queue_group_properties[group_index[i]];
-                if (desc->queue_group_descs[i].num_enabled_queues == 0 ||
-                    desc->queue_group_descs[i].num_enabled_queues > queue_group_properties.num_queues)
-                {
-                    error = error || true;
+// Expired objects are taken out of the queue under the lock and destroyed after it is released, so that other threads
+// can keep queueing objects while the backend destroys them.
+void GnDeferredDestructionQueue::Release(GnDevice device, uint32_t max_objects) noexcept
+{
+    GnSmallVector<GnDeferredObject, 64> expired_objects;
+
+    {
+        std::scoped_lock lock(mutex);
+        uint32_t budget = max_objects > 0 ? max_objects : UINT32_MAX;
+        bool out_of_memory = false;
+
+        while (first_frame < frames.size() && budget > 0 && !out_of_memory) {
+            const GnDeferredDestructionFrame& frame = frames[first_frame];
+
+            if (!GnIsDeferredDestructionFrameComplete(frame))
+                break;
+
+            // Objects that don't fit stay queued until the next release.
+            for (; first_object < frame.end_object && budget > 0; budget--) {
+                if (!expired_objects.push_back(objects[first_object])) {
+                    out_of_memory = true;
+                    break;
+                }
+
+                first_object++;
+            }
+
+            if (first_object == frame.end_object)
+                first_frame++;
+        }
+
+        Compact();
+    }
+
+    for (size_t i = 0; i < expired_objects.size; i++)
+        GnDestroyDeferredObject(device, expired_objects[i]);
+}
+
+void GnDeferredDestructionQueue::ReleaseAll(GnDevice device) noexcept
+{
+    GnVector<GnDeferredObject> expired_objects;
+    size_t first_expired_object;
+
+    {
+        std::scoped_lock lock(mutex);
+        expired_objects = std::move(objects);
+        first_expired_object = first_object;
+        first_object = 0;
+        frames.resize(0);
+        first_frame = 0;
+    }
+
+    for (size_t i = first_expired_object; i < expired_objects.size(); i++)
+        GnDestroyDeferredObject(device, expired_objects[i]);
+}
+
+void GnDeferredDestructionQueue::GetStats(GnDeferredDestructionStats* stats) noexcept
+{
+    std::scoped_lock lock(mutex);
+    stats->num_pending_objects = (uint32_t)(objects.size() - first_object);
+    stats->num_pending_frames = (uint32_t)(frames.size() - first_frame);
+}
+
+void GnDeferredDestructionQueue::Compact() noexcept
+{
+    if (first_frame == frames.size()) {
+        frames.resize(0);
+        first_frame = 0;
+    }
+
+    // Move the remaining objects to the front once the released part dominates the storage.
+    if (first_object == 0 || first_object * 2 < objects.size())
+        return;
+
+    size_t num_remaining = objects.size() - first_object;
+    std::memmove(objects.data(), objects.data() + first_object, num_remaining * sizeof(GnDeferredObject));
+    objects.resize(num_remaining);
+
+    for (size_t i = first_frame; i < frames.size(); i++)
+        frames[i].end_object -= first_object;
+
+    first_object = 0;
+}
+
+// -- [GnPipelineDedupTable] --
+
+// Layouts with equal hashes are assumed to be identical, which lets the pipeline deduplication table key pipelines by
+// layout contents rather than by handles that may be reused after the layout is destroyed.
+inline static uint64_t GnHashDescriptorTableLayoutDesc(const GnDescriptorTableLayoutDesc* desc) noexcept
+{
+    return GnHashBytes64(desc->bindings, desc->num_bindings * sizeof(GnDescriptorTableBinding));
+}
+
+inline static uint64_t GnHashPipelineLayoutDesc(const GnPipelineLayoutDesc* desc) noexcept
+{
+    uint64_t hash = GnHashBytes64(desc->resources, desc->num_resources * sizeof(GnShaderResource));
+
+    for (uint32_t i = 0; i < desc->num_descriptor_tables; i++)
+        hash = GnHashBytes64(&desc->descriptor_tables[i]->content_hash, sizeof(uint64_t), hash);
+
+    hash = GnHashBytes64(desc->constant_ranges, desc->num_constant_ranges * sizeof(GnShaderConstantRange), hash);
+
+    return GnHashBytes64(&desc->use_bindless_resources, sizeof(GnBool), hash);
+}
+
+// Serializes everything that affects the compiled pipeline. Shaders are written out in full (size, bytecode and entry
+// point) so that equal keys always mean equal pipelines. The layout is written as the hash of its description since
+// its handle may be reused by another layout once destroyed. The pipeline cache is left out as it does not change
+// the result.
+bool GnPipelineDedupTable::WriteKey(const GnGraphicsPipelineDesc* desc, GnVector<uint8_t>& key_data) noexcept
+{
+    if (!key_data.reserve(key_data.size() + 512))
+        return false;
+
+    auto write = [&key_data](const void* data, size_t size) -> bool {
+        size_t offset = key_data.size();
+
+        if (size == 0)
+            return true;
+
+        if (offset + size > key_data.capacity() && !key_data.reserve((offset + size) * 2))
+            return false;
+
+        key_data.resize(offset + size);
+        std::memcpy(key_data.data() + offset, data, size);
+
+        return true;
+    };
+
+    auto write_shader = [&write](const GnShaderBytecode* shader) -> bool {
+        uint64_t size = shader->size;
+
+        return write(&size, sizeof(size)) &&
+               write(shader->bytecode, shader->size) &&
+               write(shader->entry_point, std::strlen(shader->entry_point) + 1);
+    };
+
+    auto write_subpasses = [&write](const GnGraphicsPipelineDesc* desc) -> bool {
+        if (!write(&desc->num_subpasses, sizeof(uint32_t)) || !write(&desc->subpass, sizeof(uint32_t)))
+            return false;
+
+        for (uint32_t i = 0; i < desc->num_subpasses; i++) {
+            const GnRenderPassSubpassDesc& subpass = desc->subpasses[i];
+
+            if (!write(&subpass.num_color_targets, sizeof(uint32_t)) ||
+                !write(subpass.color_targets, subpass.num_color_targets * sizeof(uint32_t)) ||
+                !write(&subpass.num_input_targets, sizeof(uint32_t)) ||
+                !write(subpass.input_targets, subpass.num_input_targets * sizeof(uint32_t)) ||
+                !write(&subpass.use_depth_stencil_target, sizeof(GnBool)))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    const GnVertexInputStateDesc* vertex_input = desc->vertex_input;
+    const GnFragmentInterfaceStateDesc* fragment_interface = desc->fragment_interface;
+    const GnBlendStateDesc* blend = desc->blend;
+    uint32_t has_depth_stencil = desc->depth_stencil != nullptr;
+    uint64_t layout_hash = desc->layout != nullptr ? desc->layout->content_hash : 0;
+
+    return write_shader(desc->vs) &&
+           write_shader(desc->fs) &&
+           write(&vertex_input->num_input_slots, sizeof(uint32_t)) &&
+           write(vertex_input->input_slots, vertex_input->num_input_slots * sizeof(GnVertexInputSlotDesc)) &&
+           write(&vertex_input->num_attributes, sizeof(uint32_t)) &&
+           write(vertex_input->attributes, vertex_input->num_attributes * sizeof(GnVertexInputAttributeDesc)) &&
+           write(desc->input_assembly, sizeof(GnInputAssemblyStateDesc)) &&
+           write(desc->rasterization, sizeof(GnRasterizationStateDesc)) &&
+           write(desc->multisample, sizeof(GnMultisampleStateDesc)) &&
+           write(&fragment_interface->num_color_targets, sizeof(uint32_t)) &&
+           write(fragment_interface->color_target_formats, fragment_interface->num_color_targets * sizeof(GnFormat)) &&
+           write(&fragment_interface->resolve_target_mask, sizeof(uint32_t)) &&
+           write(&fragment_interface->depth_stencil_target_format, sizeof(GnFormat)) &&
+           write(&has_depth_stencil, sizeof(uint32_t)) &&
+           (!has_depth_stencil || write(desc->depth_stencil, sizeof(GnDepthStencilStateDesc))) &&
+           write(&blend->independent_blend, sizeof(GnBool)) &&
+           write(&blend->num_blend_states, sizeof(uint32_t)) &&
+           write(blend->blend_states, blend->num_blend_states * sizeof(GnColorTargetBlendStateDesc)) &&
+           write(&desc->num_viewports, sizeof(uint32_t)) &&
+           write(&layout_hash, sizeof(uint64_t)) &&
+           write_subpasses(desc);
+}
+
+GnPipeline GnPipelineDedupTable::Acquire(uint64_t hash, const uint8_t* key_data, size_t key_size) noexcept
+{
+    std::scoped_lock lock(mutex);
+    auto item = entries.find(hash);
+
+    if (item != entries.end()) {
+        GnPipelineDedupEntry& entry = item->second;
+
+        if (entry.key_data.size() == key_size && std::memcmp(entry.key_data.data(), key_data, key_size) == 0) {
+            entry.ref_count++;
+            num_hits++;
+            return entry.pipeline;
+        }
+    }
+
+    num_misses++;
+
+    return nullptr;
+}
+
+// Returns the pipeline to hand out. This is an existing pipeline when an identical one was inserted by another create
+// call in the meantime, the caller then destroys its own. On a hash collision the new pipeline is left untracked.
+GnPipeline GnPipelineDedupTable::Insert(uint64_t hash, const uint8_t* key_data, size_t key_size, GnPipeline pipeline) noexcept
+{
+    std::scoped_lock lock(mutex);
+    auto item = entries.find(hash);
+
+    if (item != entries.end()) {
+        GnPipelineDedupEntry& entry = item->second;
+
+        if (entry.key_data.size() == key_size && std::memcmp(entry.key_data.data(), key_data, key_size) == 0) {
+            entry.ref_count++;
+            return entry.pipeline;
+        }
+
+        return pipeline;
+    }
+
+    GnVector<uint8_t> entry_key_data;
+
+    if (!entry_key_data.resize(key_size))
+        return pipeline;
+
+    std::memcpy(entry_key_data.data(), key_data, key_size);
+
+    // Out of memory leaves the pipeline untracked, like a hash collision.
+    try {
+        auto entry = entries.emplace(hash, GnPipelineDedupEntry{ pipeline, 1, std::move(entry_key_data) }).first;
+
+        try {
+            pipeline_hashes.emplace(pipeline, hash);
+        }
+        catch (...) {
+            entries.erase(entry);
+        }
+    }
+    catch (...) {
+    }
+
+    return pipeline;
+}
+
+// Returns true when the pipeline must be destroyed.
+bool GnPipelineDedupTable::Release(GnPipeline pipeline) noexcept
+{
+    std::scoped_lock lock(mutex);
+    auto item = pipeline_hashes.find(pipeline);
+
+    if (item == pipeline_hashes.end())
+        return true;
+
+    auto entry = entries.find(item->second);
+
+    if (--entry->second.ref_count > 0)
+        return false;
+
+    entries.erase(entry);
+    pipeline_hashes.erase(item);
+
+    return true;
+}
+
+// -- [GnPipelineCompiler] --
+
+GnResult GnPipelineCompiler::Enqueue(GnDevice device, GnPipelineCompileJob&& job) noexcept
+{
+    std::scoped_lock lock(mutex);
+
+    if (num_jobs == max_queued_jobs)
+        return GnError_OutOfHostMemory;
+
+    if (!thread.joinable()) {
+        try {
+            thread = std::thread([this, device]() { Run(device); });
+        }
+        catch (...) {
+            return GnError_InternalError;
+        }
+    }
+
+    jobs[(first_job + num_jobs) % max_queued_jobs] = std::move(job);
+    num_jobs++;
+    job_available.notify_one();
+
+    return GnSuccess;
+}
+
+// Removes the pipeline from the queue, or waits until it finishes compiling.
+void GnPipelineCompiler::Cancel(GnPipeline pipeline) noexcept
+{
+    std::unique_lock lock(mutex);
+
+    // Queued jobs are only marked, the compile thread drops them.
+    for (uint32_t i = 0; i < num_jobs; i++) {
+        GnPipelineCompileJob& job = jobs[(first_job + i) % max_queued_jobs];
+
+        if (job.pipeline == pipeline) {
+            job.pipeline = nullptr;
+            return;
+        }
+    }
+
+    job_finished.wait(lock, [this, pipeline]() { return compiling_pipeline != pipeline; });
+}
+
+// Pipelines still queued are never compiled, they fail with GnError_Unknown instead of staying GnNotReady.
+void GnPipelineCompiler::Shutdown() noexcept
+{
+    {
+        std::scoped_lock lock(mutex);
+        stop = true;
+
+        for (uint32_t i = 0; i < num_jobs; i++) {
+            GnPipelineCompileJob& job = jobs[(first_job + i) % max_queued_jobs];
+
+            if (job.pipeline != nullptr)
+                job.pipeline->status.store(GnError_Unknown, std::memory_order_release);
+
+            job.storage = GnVector<uint8_t>();
+        }
+
+        num_jobs = 0;
+        job_available.notify_one();
+    }
+
+    if (thread.joinable())
+        thread.join();
+}
+
+void GnPipelineCompiler::Run(GnDevice device) noexcept
+{
+    std::unique_lock lock(mutex);
+
+    while (true) {
+        job_available.wait(lock, [this]() { return stop || num_jobs > 0; });
+
+        if (stop)
+            return;
+
+        GnPipelineCompileJob job = std::move(jobs[first_job]);
+        first_job = (first_job + 1) % max_queued_jobs;
+        num_jobs--;
+
+        if (job.pipeline == nullptr)
+            continue;
+
+        compiling_pipeline = job.pipeline;
+        lock.unlock();
+
+        // The backend fills in the pipeline before the status is published.
+        GnResult result = device->CompilePendingGraphicsPipeline(job.pipeline, &job.desc);
+        job.pipeline->status.store(result, std::memory_order_release);
+
+        lock.lock();
+        compiling_pipeline = nullptr;
+        job_finished.notify_all();
+    }
+}
+
+// -- [GnDevice] --
+
+bool GnValidateCreateDeviceParam(GnAdapter adapter, const GnDeviceDesc* desc, GnDevice* device) noexcept
+{
+    bool error = false;
+
+    if (adapter == nullptr) return true;
+
+    if (device == nullptr) return true;
+
+    adapter->EnsureQueried();
+
+    // Validate enabled queue group desc.
+    if (desc != nullptr && desc->num_enabled_queue_groups > 0 && desc->queue_group_descs != nullptr) {
+        if (desc->num_enabled_queue_groups <= adapter->num_queue_groups)
+            return false;
+
+        uint32_t group_index[GN_MAX_QUEUE];
+
+        for (uint32_t i = 0; i < desc->num_enabled_queue_groups; i++)
+            group_index[i] = desc->queue_group_descs[i].index;
+
+        // Check if each queue group index is valid
+        bool has_invalid_index = false;
+        for (uint32_t i = 0; i < desc->num_enabled_queue_groups; i++) {
+            if (group_index[i] > adapter->num_queue_groups - 1) {
+                has_invalid_index = true;
+                error = error || true;
+            }
+        }
+
+        // Check if each queue count is valid
+        if (!has_invalid_index) {
+            for (uint32_t i = 0; i < desc->num_enabled_queue_groups; i++) {
+                GnQueueGroupProperties& queue_group_properties = adapter->queue_group_properties[group_index[i]];
+                if (desc->queue_group_descs[i].num_enabled_queues == 0 ||
+                    desc->queue_group_descs[i].num_enabled_queues > queue_group_properties.num_queues)
+                {
+                    error = error || true;
                     break;
                 }
             }
@@ -745,11 +1808,17 @@ GnResult GnCreateDevice(GnAdapter adapter, const GnDeviceDesc* desc, GnDevice* d
         tmp_desc.enabled_features = enabled_features;
     }
 
-    return adapter->CreateDevice(&tmp_desc, device);
+    uint64_t start = GnGetTimeNs();
+    GnResult result = adapter->CreateDevice(&tmp_desc, device);
+    adapter->create_device_ns += GnGetTimeNs() - start;
+
+    return result;
 }
 
 void GnDestroyDevice(GnDevice device)
 {
+    device->pipeline_compiler.Shutdown();
+    GnFlushDeferredDestruction(device);
     delete device;
 }
 
@@ -769,300 +1838,2628 @@ GnResult GnDeviceWaitIdle(GnDevice device)
     return device->DeviceWaitIdle();
 }
 
-// -- [GnSwapchain] --
-
-GnResult GnCreateSwapchain(GnDevice device, const GnSwapchainDesc* desc, GnSwapchain* swapchain)
+void GnSetDeviceDeferredDestruction(GnDevice device, GnBool enable, uint32_t max_destroys_per_frame)
 {
-    return device->CreateSwapchain(desc, swapchain);
+    device->deferred_destruction = enable;
+    device->max_destroys_per_frame = max_destroys_per_frame;
 }
 
-void GnDestroySwapchain(GnDevice device, GnSwapchain swapchain)
+GnResult GnRetireDeviceFrame(GnDevice device, GnFence fence, uint64_t value)
 {
-    device->DestroySwapchain(swapchain);
-}
+    if (fence == nullptr) return GnError_InvalidArgs;
 
-uint32_t GnGetSwapchainBackBufferCount(GnSwapchain swapchain)
-{
-    return swapchain->swapchain_desc.num_buffers;
+    if (!device->deferred_destruction_queue.Retire(fence, value))
+        return GnError_OutOfHostMemory;
+
+    device->deferred_destruction_queue.Release(device, device->max_destroys_per_frame);
+
+    return GnSuccess;
 }
 
-uint32_t GnGetCurrentBackBufferIndex(GnSwapchain swapchain)
+GnResult GnFlushDeferredDestruction(GnDevice device)
 {
-    return swapchain->current_frame;
+    GnDeferredDestructionStats stats;
+    device->deferred_destruction_queue.GetStats(&stats);
+
+    if (stats.num_pending_objects == 0)
+        return GnSuccess;
+
+    GnResult result = device->DeviceWaitIdle();
+    if (GN_FAILED(result)) return result;
+
+    device->deferred_destruction_queue.ReleaseAll(device);
+
+    return GnSuccess;
 }
 
-GnTexture GnGetSwapchainBackBuffer(GnSwapchain swapchain, uint32_t index)
+void GnGetDeferredDestructionStats(GnDevice device, GnDeferredDestructionStats* stats)
 {
-    if (index > swapchain->swapchain_desc.num_buffers - 1) return nullptr;
-    return swapchain->GetBackBuffer(index);
+    device->deferred_destruction_queue.GetStats(stats);
 }
 
-GnResult GnUpdateSwapchain(GnSwapchain swapchain, GnFormat format, uint32_t width, uint32_t height, uint32_t num_buffers, GnBool vsync)
+// Returns true if the object has been queued for deferred destruction. Falls back to immediate destruction if the
+// queue cannot grow.
+inline static bool GnDeferDestroy(GnDevice device, GnDeferredObjectType type, void* object) noexcept
 {
-    return swapchain->Update(format, width, height, num_buffers, vsync);
+    return device->deferred_destruction && device->deferred_destruction_queue.Push(type, object);
 }
 
-// -- [GnQueue] --
+// -- [GnSwapchain] --
 
-GnResult GnEnqueueWaitSemaphore(GnQueue queue, uint32_t num_wait_semaphores, const GnSemaphore* wait_semaphores)
+GnResult GnCreateSwapchain(GnDevice device, const GnSwapchainDesc* desc, GnSwapchain* swapchain)
 {
-    return queue->EnqueueWaitSemaphore(num_wait_semaphores, wait_semaphores);
+    if (desc->direct_present && desc->present_queue == nullptr) return GnError_InvalidArgs;
+    return device->CreateSwapchain(desc, swapchain);
 }
 
-GnResult GnEnqueueCommandLists(GnQueue queue, uint32_t num_command_lists, const GnCommandList* command_lists)
+void GnDestroySwapchain(GnDevice device, GnSwapchain swapchain)
 {
-    return queue->EnqueueCommandLists(num_command_lists, command_lists);
+    device->DestroySwapchain(swapchain);
 }
 
-GnResult GnEnqueueSignalSemaphore(GnQueue queue, uint32_t num_signal_semaphores, const GnSemaphore* signal_semaphores)
+uint32_t GnGetSwapchainBackBufferCount(GnSwapchain swapchain)
 {
-    return queue->EnqueueSignalSemaphore(num_signal_semaphores, signal_semaphores);
+    return swapchain->GetBackBufferCount();
 }
 
-GnResult GnFlushQueue(GnQueue queue, GnFence fence)
+uint32_t GnGetCurrentBackBufferIndex(GnSwapchain swapchain)
 {
-    return queue->Flush(fence, false);
+    return swapchain->GetCurrentBackBufferIndex();
 }
 
-GnResult GnFlushQueueAndWait(GnQueue queue) 
+GnResult GnAcquireNextBackBuffer(GnSwapchain swapchain, uint32_t* index)
 {
-    return queue->Flush(nullptr, true);
+    if (index == nullptr) return GnError_InvalidArgs;
+    return swapchain->AcquireNextBackBuffer(index);
 }
 
-GnResult GnWaitQueue(GnQueue queue)
+GnResult GnWaitForPresentSlot(GnSwapchain swapchain, uint64_t timeout)
 {
-    return GnError_Unimplemented;
+    return swapchain->WaitForPresentSlot(timeout);
 }
 
-GnResult GnPresentSwapchain(GnQueue queue, GnSwapchain swapchain)
+GnTexture GnGetSwapchainBackBuffer(GnSwapchain swapchain, uint32_t index)
 {
-    return queue->PresentSwapchain(swapchain);
+    if (index >= swapchain->GetBackBufferCount()) return nullptr;
+    return swapchain->GetBackBuffer(index);
 }
 
-// -- [GnSemaphore] --
-
-GnResult GnCreateSemaphore(GnDevice device, GnSemaphore* semaphore)
+GnResult GnUpdateSwapchain(GnSwapchain swapchain, GnFormat format, uint32_t width, uint32_t height, uint32_t num_buffers, GnBool vsync)
 {
-    return GnResult();
+    return swapchain->Update(format, width, height, num_buffers, vsync);
 }
 
-void GnDestroySemaphore(GnDevice device, GnSemaphore semaphore)
+// -- [GnResourceStateTracker] --
+
+GnTrackedResourceState* GnResourceStateTracker::Track(GnBuffer buffer, GnTexture texture, uint32_t subresource, bool* first_use) noexcept
 {
-}
+    GnTrackedStateKey key;
+    key.resource = buffer != nullptr ? (const void*)buffer : (const void*)texture;
+    key.subresource = subresource;
 
-// -- [GnFence] --
+    auto item = state_index.find(key);
 
-bool GnValidateCreateFenceParam(GnDevice device, bool signaled, GnFence* fence)
-{
-    bool error = false;
-    if (device == nullptr) error = true;
-    if (fence == nullptr) error = true;
-    return error;
-}
+    if (item != state_index.end()) {
+        *first_use = false;
+        return &states[item->second];
+    }
 
-GnResult GnCreateFence(GnDevice device, GnBool signaled, GnFence* fence)
-{
-    if (GnValidateCreateFenceParam(device, signaled, fence)) return GnError_InvalidArgs;
-    return device->CreateFence(signaled, fence);
-}
+    GnTrackedResourceState new_state{};
+    new_state.buffer = buffer;
+    new_state.texture = texture;
+    new_state.subresource = subresource;
 
-void GnDestroyFence(GnDevice device, GnFence fence)
-{
-    device->DestroyFence(fence);
-}
+    if (!states.push_back(new_state))
+        return nullptr;
 
-GnResult GnGetFenceStatus(GnFence fence)
-{
-    return GnError_Unimplemented;
+    state_index.emplace(key, (uint32_t)states.size() - 1);
+    *first_use = true;
+
+    return &states[states.size() - 1];
 }
 
-GnResult GnWaitFence(GnFence fence, uint64_t timeout)
+// Buffers have no layout, so read accesses never have to wait for each other. Textures have to be transitioned
+// whenever the access changes since different accesses may use different layouts.
+inline static bool GnAccessNeedsBarrier(GnResourceAccessFlags prev_access, GnResourceAccessFlags next_access, bool is_texture) noexcept
 {
-    return fence->Wait(timeout);
+    if (GnHasBit(prev_access | next_access, GnResourceAccess_AnyWrite))
+        return true;
+
+    return is_texture && prev_access != next_access;
 }
 
-GnResult GnResetFence(GnFence fence)
+inline static GnResourceAccessFlags GnMergeBufferReadAccess(GnResourceAccessFlags prev_access, GnResourceAccessFlags next_access) noexcept
 {
-    return fence->Reset();
-}
+    // Keep every pending read so that the next write waits for all of them.
+    if (!GnHasBit(prev_access | next_access, GnResourceAccess_AnyWrite))
+        return prev_access | next_access;
 
-// -- [GnMemory] --
+    return next_access;
+}
 
-GnResult GnCreateMemory(GnDevice device, const GnMemoryDesc* desc, GnMemory* memory)
+static void GnTrackBufferAccess(GnCommandList command_list, GnBuffer buffer, GnResourceAccessFlags prev_access, GnResourceAccessFlags next_access, bool emit_barrier) noexcept
 {
-    return device->CreateMemory(desc, memory);
-}
+    bool first_use;
+    GnTrackedResourceState* tracked_state = command_list->state_tracker->Track(buffer, nullptr, 0, &first_use);
+
+    if (tracked_state == nullptr) {
+        command_list->last_error = GnError_OutOfHostMemory;
+        return;
+    }
+
+    if (first_use) {
+        // The state before this command list is resolved when the command list is enqueued.
+        tracked_state->first_access = emit_barrier ? next_access : prev_access;
+        tracked_state->last_access = next_access;
+        return;
+    }
+
+    if (!emit_barrier) {
+        tracked_state->last_access = next_access;
+        return;
+    }
+
+    if (!GnAccessNeedsBarrier(tracked_state->last_access, next_access, false)) {
+        tracked_state->last_access = GnMergeBufferReadAccess(tracked_state->last_access, next_access);
+        return;
+    }
+
+    GnBufferBarrier barrier;
+    barrier.buffer = buffer;
+    barrier.offset = 0;
+    barrier.size = buffer->desc.size;
+    barrier.prev_access = tracked_state->last_access;
+    barrier.next_access = next_access;
+    barrier.queue_group_index_before = 0;
+    barrier.queue_group_index_after = 0;
+
+    tracked_state->last_access = next_access;
+    command_list->Barrier(1, &barrier, 0, nullptr);
+}
+
+static void GnTrackTextureAccess(GnCommandList command_list, GnTexture texture, const GnTextureSubresourceRange& subresource_range, GnResourceAccessFlags prev_access, GnResourceAccessFlags next_access, bool emit_barrier) noexcept
+{
+    GnResourceStateTracker* state_tracker = command_list->state_tracker;
+    const uint32_t array_layers = texture->desc.array_layers;
+    const uint32_t last_mip_level = subresource_range.base_mip_level + subresource_range.num_mip_levels;
+    const uint32_t last_array_layer = subresource_range.base_array_layer + subresource_range.num_array_layers;
+
+    // Subresources are visited in mip-major order. Adjacent layers with the same previous access are combined into
+    // one barrier, then adjacent mips with identical layer ranges are combined as well.
+    GnTextureBarrier layer_run{};
+    GnTextureBarrier mip_run{};
+    bool has_layer_run = false;
+    bool has_mip_run = false;
+
+    auto flush_layer_run = [&]() {
+        if (!has_layer_run)
+            return;
+
+        has_layer_run = false;
+
+        const GnTextureSubresourceRange& layer_range = layer_run.subresource_range;
+        GnTextureSubresourceRange& mip_range = mip_run.subresource_range;
+
+        if (has_mip_run &&
+            mip_run.prev_access == layer_run.prev_access &&
+            mip_range.base_mip_level + mip_range.num_mip_levels == layer_range.base_mip_level &&
+            mip_range.base_array_layer == layer_range.base_array_layer &&
+            mip_range.num_array_layers == layer_range.num_array_layers)
+        {
+            mip_range.num_mip_levels++;
+            return;
+        }
+
+        if (has_mip_run)
+            command_list->Barrier(0, nullptr, 1, &mip_run);
+
+        mip_run = layer_run;
+        has_mip_run = true;
+    };
+
+    for (uint32_t mip_level = subresource_range.base_mip_level; mip_level < last_mip_level; mip_level++) {
+        for (uint32_t array_layer = subresource_range.base_array_layer; array_layer < last_array_layer; array_layer++) {
+            bool first_use;
+            GnTrackedResourceState* tracked_state = state_tracker->Track(nullptr, texture, mip_level * array_layers + array_layer, &first_use);
+
+            if (tracked_state == nullptr) {
+                command_list->last_error = GnError_OutOfHostMemory;
+                return;
+            }
+
+            tracked_state->aspect = subresource_range.aspect;
+
+            if (first_use) {
+                tracked_state->first_access = emit_barrier ? next_access : prev_access;
+                tracked_state->last_access = next_access;
+                flush_layer_run();
+                continue;
+            }
+
+            GnResourceAccessFlags last_access = tracked_state->last_access;
+            tracked_state->last_access = next_access;
+
+            if (!emit_barrier || !GnAccessNeedsBarrier(last_access, next_access, true)) {
+                flush_layer_run();
+                continue;
+            }
+
+            GnTextureSubresourceRange& run_range = layer_run.subresource_range;
+
+            if (has_layer_run &&
+                layer_run.prev_access == last_access &&
+                run_range.base_mip_level == mip_level &&
+                run_range.base_array_layer + run_range.num_array_layers == array_layer)
+            {
+                run_range.num_array_layers++;
+                continue;
+            }
+
+            flush_layer_run();
+
+            layer_run.texture = texture;
+            layer_run.subresource_range.aspect = subresource_range.aspect;
+            layer_run.subresource_range.base_mip_level = mip_level;
+            layer_run.subresource_range.num_mip_levels = 1;
+            layer_run.subresource_range.base_array_layer = array_layer;
+            layer_run.subresource_range.num_array_layers = 1;
+            layer_run.prev_access = last_access;
+            layer_run.next_access = next_access;
+            layer_run.queue_group_index_before = 0;
+            layer_run.queue_group_index_after = 0;
+            has_layer_run = true;
+        }
+
+        flush_layer_run();
+    }
+
+    if (has_mip_run)
+        command_list->Barrier(0, nullptr, 1, &mip_run);
+}
+
+// Barriers cannot be recorded inside a render pass. A buffer first used by a draw is brought into the right state when
+// the command list is enqueued, any other transition must be declared before the render pass.
+static void GnTrackRenderPassBufferAccess(GnCommandList command_list, GnBuffer buffer, GnResourceAccessFlags access) noexcept
+{
+    bool first_use;
+    GnTrackedResourceState* tracked_state = command_list->state_tracker->Track(buffer, nullptr, 0, &first_use);
+
+    if (tracked_state == nullptr) {
+        command_list->last_error = GnError_OutOfHostMemory;
+        return;
+    }
+
+    if (first_use) {
+        tracked_state->first_access = access;
+        tracked_state->last_access = access;
+        return;
+    }
+
+    if (GnContainsBit(tracked_state->last_access, access))
+        return;
+
+    if (GnAccessNeedsBarrier(tracked_state->last_access, access, false)) {
+        command_list->last_error = GnError_InvalidArgs;
+        return;
+    }
+
+    tracked_state->last_access = GnMergeBufferReadAccess(tracked_state->last_access, access);
+}
+
+// Tracks the buffers bound to the global resources of the current pipeline layout.
+static void GnTrackBoundBuffers(GnCommandList command_list, const GnPipelineState& pipeline_state, GnResourceAccessFlags uniform_access, GnResourceAccessFlags storage_access) noexcept
+{
+    if (pipeline_state.pipeline_layout == nullptr)
+        return;
+
+    const uint32_t binding_mask = pipeline_state.pipeline_layout->global_resource_binding_mask;
+
+    for (uint32_t i = 0; i < 32; i++) {
+        GnBuffer buffer = pipeline_state.global_buffers[i];
+
+        if (!GnContainsBit(binding_mask, 1u << i) || buffer == nullptr)
+            continue;
+
+        const GnResourceAccessFlags access = GnContainsBit(pipeline_state.global_buffers_type_bits, 1u << i) ? storage_access : uniform_access;
+
+        if (command_list->inside_render_pass)
+            GnTrackRenderPassBufferAccess(command_list, buffer, access);
+        else
+            GnTrackBufferAccess(command_list, buffer, GnResourceAccess_Undefined, access, true);
+    }
+}
+
+static void GnTrackDrawResources(GnCommandList command_list, bool indexed) noexcept
+{
+    const GnCommandListState& state = command_list->state;
+
+    if (indexed && state.index_buffer != nullptr)
+        GnTrackRenderPassBufferAccess(command_list, state.index_buffer, GnResourceAccess_IndexBuffer);
+
+    for (uint32_t i = 0; i < 32; i++)
+        if (state.vertex_buffers[i] != nullptr)
+            GnTrackRenderPassBufferAccess(command_list, state.vertex_buffers[i], GnResourceAccess_VertexBuffer);
+
+    GnTrackBoundBuffers(command_list, state.graphics,
+                        GnResourceAccess_VSUniformBuffer | GnResourceAccess_FSUniformBuffer,
+                        GnResourceAccess_VSRead | GnResourceAccess_FSRead | GnResourceAccess_VSWrite | GnResourceAccess_FSWrite);
+}
+
+// Brings every resource used by a tracked command list into the state it expects. Nothing is published here, the
+// state the command list leaves the resources in is published by GnCommitTrackedResourceState once it is enqueued.
+static GnResult GnResolveTrackedResourceState(GnQueue queue, GnCommandList command_list) noexcept
+{
+    GnResourceStateTracker* state_tracker = command_list->state_tracker;
+    GnVector<GnBufferBarrier>& buffer_barriers = queue->tracked_buffer_barriers;
+    GnVector<GnTextureBarrier>& texture_barriers = queue->tracked_texture_barriers;
+
+    buffer_barriers.resize(0);
+    texture_barriers.resize(0);
+
+    for (size_t i = 0; i < state_tracker->states.size(); i++) {
+        const GnTrackedResourceState& tracked_state = state_tracker->states[i];
+
+        if (tracked_state.buffer != nullptr) {
+            GnBuffer buffer = tracked_state.buffer;
+            GnResourceAccessFlags queue_access = buffer->tracked_access;
+
+            // Nothing has been written to the buffer yet, there is nothing to wait for.
+            if (queue_access != GnResourceAccess_Undefined &&
+                GnAccessNeedsBarrier(queue_access, tracked_state.first_access, false))
+            {
+                GnBufferBarrier barrier;
+                barrier.buffer = buffer;
+                barrier.offset = 0;
+                barrier.size = buffer->desc.size;
+                barrier.prev_access = queue_access;
+                barrier.next_access = tracked_state.first_access;
+                barrier.queue_group_index_before = 0;
+                barrier.queue_group_index_after = 0;
+
+                if (!buffer_barriers.push_back(barrier))
+                    return GnError_OutOfHostMemory;
+            }
+
+            continue;
+        }
+
+        GnTexture texture = tracked_state.texture;
+        GnResourceAccessFlags* queue_access = texture->GetTrackedAccess();
+
+        if (queue_access == nullptr)
+            return GnError_OutOfHostMemory;
+
+        GnResourceAccessFlags subresource_access = queue_access[tracked_state.subresource];
+
+        if (GnAccessNeedsBarrier(subresource_access, tracked_state.first_access, true)) {
+            const uint32_t array_layers = texture->desc.array_layers;
+
+            GnTextureBarrier barrier;
+            barrier.texture = texture;
+            barrier.subresource_range.aspect = tracked_state.aspect;
+            barrier.subresource_range.base_mip_level = tracked_state.subresource / array_layers;
+            barrier.subresource_range.num_mip_levels = 1;
+            barrier.subresource_range.base_array_layer = tracked_state.subresource % array_layers;
+            barrier.subresource_range.num_array_layers = 1;
+            barrier.prev_access = subresource_access;
+            barrier.next_access = tracked_state.first_access;
+            barrier.queue_group_index_before = 0;
+            barrier.queue_group_index_after = 0;
+
+            if (!texture_barriers.push_back(barrier))
+                return GnError_OutOfHostMemory;
+        }
+    }
+
+    if (buffer_barriers.size() == 0 && texture_barriers.size() == 0)
+        return GnSuccess;
+
+    return queue->EnqueueStateFixup((uint32_t)buffer_barriers.size(), buffer_barriers.data(),
+                                    (uint32_t)texture_barriers.size(), texture_barriers.data());
+}
+
+// Publishes the state a tracked command list leaves its resources in. Command lists are assumed to execute in the
+// order they are enqueued. Cannot fail, the tracked access of every texture was allocated while resolving.
+static void GnCommitTrackedResourceState(GnCommandList command_list) noexcept
+{
+    GnResourceStateTracker* state_tracker = command_list->state_tracker;
+
+    for (size_t i = 0; i < state_tracker->states.size(); i++) {
+        const GnTrackedResourceState& tracked_state = state_tracker->states[i];
+
+        if (tracked_state.buffer != nullptr) {
+            GnBuffer buffer = tracked_state.buffer;
+            buffer->tracked_access = GnMergeBufferReadAccess(buffer->tracked_access, tracked_state.last_access);
+            continue;
+        }
+
+        tracked_state.texture->GetTrackedAccess()[tracked_state.subresource] = tracked_state.last_access;
+    }
+}
+
+// -- [GnQueue] --
+
+GnResult GnEnqueueWaitSemaphore(GnQueue queue, uint32_t num_wait_semaphores, const GnSemaphore* wait_semaphores)
+{
+    return queue->EnqueueWaitSemaphore(num_wait_semaphores, wait_semaphores, nullptr);
+}
+
+GnResult GnEnqueueWaitSemaphoreStages(GnQueue queue, uint32_t num_wait_semaphores, const GnSemaphore* wait_semaphores, const GnPipelineStageFlags* wait_stages)
+{
+    if (wait_stages == nullptr) return GnError_InvalidArgs;
+
+    for (uint32_t i = 0; i < num_wait_semaphores; i++)
+        if (wait_stages[i] == 0) return GnError_InvalidArgs;
+
+    return queue->EnqueueWaitSemaphore(num_wait_semaphores, wait_semaphores, wait_stages);
+}
+
+GnResult GnEnqueueCommandLists(GnQueue queue, uint32_t num_command_lists, const GnCommandList* command_lists)
+{
+    uint32_t first_untracked = 0;
+
+    for (uint32_t i = 0; i < num_command_lists; i++) {
+        GnCommandList command_list = command_lists[i];
+
+        if (!command_list->track_resource_state)
+            continue;
+
+        // Enqueue the preceding untracked command lists first to keep the submission order.
+        if (first_untracked < i) {
+            GnResult result = queue->EnqueueCommandLists(i - first_untracked, &command_lists[first_untracked]);
+            if (GN_FAILED(result)) return result;
+        }
+
+        first_untracked = i + 1;
+
+        GnResult result = GnResolveTrackedResourceState(queue, command_list);
+        if (GN_FAILED(result)) return result;
+
+        result = queue->EnqueueCommandLists(1, &command_list);
+        if (GN_FAILED(result)) return result;
+
+        GnCommitTrackedResourceState(command_list);
+    }
+
+    if (first_untracked == num_command_lists)
+        return GnSuccess;
+
+    return queue->EnqueueCommandLists(num_command_lists - first_untracked, &command_lists[first_untracked]);
+}
+
+GnResult GnEnqueueSignalSemaphore(GnQueue queue, uint32_t num_signal_semaphores, const GnSemaphore* signal_semaphores)
+{
+    return queue->EnqueueSignalSemaphore(num_signal_semaphores, signal_semaphores);
+}
+
+GnResult GnFlushQueue(GnQueue queue, GnFence fence)
+{
+    // Timeline fences are signaled with GnEnqueueSignalFence instead.
+    if (fence != nullptr && fence->timeline) return GnError_InvalidArgs;
+    return queue->Flush(fence, false);
+}
+
+GnResult GnFlushQueueAndWait(GnQueue queue) 
+{
+    return queue->Flush(nullptr, true);
+}
+
+void GnSetQueueDeferredSubmission(GnQueue queue, GnBool enable)
+{
+    queue->deferred_submission = enable;
+}
+
+GnResult GnCommitQueue(GnQueue queue, GnFence fence)
+{
+    if (fence != nullptr && fence->timeline) return GnError_InvalidArgs;
+    return queue->Commit(fence);
+}
+
+GnResult GnWaitQueue(GnQueue queue)
+{
+    return GnError_Unimplemented;
+}
+
+GnResult GnPresentSwapchain(GnQueue queue, GnSwapchain swapchain)
+{
+    return queue->PresentSwapchain(swapchain);
+}
+
+inline static GnResult GnEnqueueWaitQueueProgress(GnQueue queue, GnQueue src_queue, uint64_t value, GnPipelineStageFlags wait_stages) noexcept
+{
+    GnQueueProgressWait* last_wait = nullptr;
+
+    for (size_t i = 0; i < queue->progress_waits.size(); i++) {
+        if (queue->progress_waits[i].queue == src_queue) {
+            last_wait = &queue->progress_waits[i];
+            break;
+        }
+    }
+
+    if (last_wait != nullptr) {
+        // Progress values only grow, so an earlier wait for a greater or equal value already covers this one, as long
+        // as it blocked every stage this wait needs.
+        if (last_wait->value >= value && GnContainsBit(last_wait->wait_stages, wait_stages))
+            return GnSuccess;
+
+        // Wait for the highest value at the union of the stages so that a single record still describes every wait.
+        value = GnMax(value, last_wait->value);
+        wait_stages |= last_wait->wait_stages;
+    }
+
+    GnFence progress_fence;
+    GnResult result = src_queue->GetProgressFence(&progress_fence);
+    if (GN_FAILED(result)) return result;
+
+    result = queue->EnqueueWaitFence(progress_fence, value, wait_stages);
+    if (GN_FAILED(result)) return result;
+
+    if (last_wait != nullptr) {
+        last_wait->value = value;
+        last_wait->wait_stages = wait_stages;
+    }
+    else if (!queue->progress_waits.push_back(GnQueueProgressWait{ src_queue, value, wait_stages })) {
+        return GnError_OutOfHostMemory;
+    }
+
+    return GnSuccess;
+}
+
+GnResult GnEnqueueSubmissions(uint32_t num_submissions, const GnQueueSubmission* submissions)
+{
+    if (num_submissions == 0) return GnSuccess;
+    if (submissions == nullptr) return GnError_InvalidArgs;
+
+    // Progress value signaled by each submission, non-zero only if another queue depends on it.
+    GnVector<uint64_t> signal_values;
+    if (!signal_values.resize(num_submissions)) return GnError_OutOfHostMemory;
+
+    for (uint32_t i = 0; i < num_submissions; i++)
+        signal_values[i] = 0;
+
+    for (uint32_t i = 0; i < num_submissions; i++) {
+        const GnQueueSubmission& submission = submissions[i];
+        if (submission.queue == nullptr || (submission.num_dependencies > 0 && submission.dependencies == nullptr))
+            return GnError_InvalidArgs;
+
+        for (uint32_t j = 0; j < submission.num_dependencies; j++) {
+            uint32_t dependency = submission.dependencies[j];
+            if (dependency >= i) return GnError_InvalidArgs;
+            if (submissions[dependency].queue != submission.queue) {
+                if (submission.wait_stages == 0) return GnError_InvalidArgs;
+                signal_values[dependency] = 1;
+            }
+        }
+    }
+
+    // Everything that can fail is done before the first enqueue, so that a failure does not leave waits on the queues
+    // for progress values that are never signaled. State fixups of tracked command lists may still fail.
+    for (uint32_t i = 0; i < num_submissions; i++) {
+        GnQueue queue = submissions[i].queue;
+        bool reserved = false;
+
+        for (uint32_t j = 0; j < i && !reserved; j++)
+            reserved = submissions[j].queue == queue;
+
+        if (reserved)
+            continue;
+
+        uint32_t num_waits = 0;
+        uint32_t num_command_lists = 0;
+        uint32_t num_signals = 0;
+
+        for (uint32_t j = i; j < num_submissions; j++) {
+            const GnQueueSubmission& submission = submissions[j];
+
+            if (submission.queue != queue)
+                continue;
+
+            num_waits += submission.num_dependencies;
+            num_command_lists += submission.num_command_lists;
+
+            // Each tracked command list may be preceded by a state fixup
+            for (uint32_t k = 0; k < submission.num_command_lists; k++)
+                if (submission.command_lists[k]->track_resource_state)
+                    num_command_lists++;
+
+            if (signal_values[j] != 0) {
+                GnFence progress_fence;
+                GnResult result = queue->GetProgressFence(&progress_fence);
+                if (GN_FAILED(result)) return result;
+
+                num_signals++;
+            }
+        }
+
+        if (!queue->progress_waits.reserve(queue->progress_waits.size() + num_waits))
+            return GnError_OutOfHostMemory;
+
+        GnResult result = queue->Reserve(num_waits, num_command_lists, num_signals);
+        if (GN_FAILED(result)) return result;
+    }
+
+    for (uint32_t i = 0; i < num_submissions; i++) {
+        const GnQueueSubmission& submission = submissions[i];
+        GnQueue queue = submission.queue;
+
+        for (uint32_t j = 0; j < submission.num_dependencies; j++) {
+            GnQueue src_queue = submissions[submission.dependencies[j]].queue;
+            uint64_t value = signal_values[submission.dependencies[j]];
+
+            if (src_queue == queue)
+                continue;
+
+            // Only the latest dependency on each queue needs a wait.
+            bool superseded = false;
+            for (uint32_t k = 0; k < submission.num_dependencies && !superseded; k++) {
+                uint32_t other = submission.dependencies[k];
+                superseded = submissions[other].queue == src_queue && (signal_values[other] > value || (signal_values[other] == value && k < j));
+            }
+
+            if (superseded)
+                continue;
+
+            GnResult result = GnEnqueueWaitQueueProgress(queue, src_queue, value, submission.wait_stages);
+            if (GN_FAILED(result)) return result;
+        }
+
+        GnResult result = GnEnqueueCommandLists(queue, submission.num_command_lists, submission.command_lists);
+        if (GN_FAILED(result)) return result;
+
+        if (signal_values[i] != 0) {
+            GnFence progress_fence;
+            result = queue->GetProgressFence(&progress_fence);
+            if (GN_FAILED(result)) return result;
+
+            signal_values[i] = queue->progress_value + 1;
+
+            result = queue->EnqueueSignalFence(progress_fence, signal_values[i]);
+            if (GN_FAILED(result)) return result;
+
+            queue->progress_value = signal_values[i];
+        }
+    }
+
+    // Timeline waits may be submitted before their signal, so the flush order does not matter.
+    for (uint32_t i = 0; i < num_submissions; i++) {
+        GnQueue queue = submissions[i].queue;
+        bool flushed = false;
+
+        for (uint32_t j = 0; j < i && !flushed; j++)
+            flushed = submissions[j].queue == queue;
+
+        if (flushed)
+            continue;
+
+        GnResult result = queue->Flush(nullptr, false);
+        if (GN_FAILED(result)) return result;
+    }
+
+    return GnSuccess;
+}
+
+// -- [GnSemaphore] --
+
+GnResult GnCreateSemaphore(GnDevice device, GnSemaphore* semaphore)
+{
+    return GnResult();
+}
+
+void GnDestroySemaphore(GnDevice device, GnSemaphore semaphore)
+{
+}
+
+// -- [GnFence] --
+
+bool GnValidateCreateFenceParam(GnDevice device, bool signaled, GnFence* fence)
+{
+    bool error = false;
+    if (device == nullptr) error = true;
+    if (fence == nullptr) error = true;
+    return error;
+}
+
+GnResult GnCreateFence(GnDevice device, GnBool signaled, GnFence* fence)
+{
+    if (GnValidateCreateFenceParam(device, signaled, fence)) return GnError_InvalidArgs;
+    return device->CreateFence(signaled, fence);
+}
+
+void GnDestroyFence(GnDevice device, GnFence fence)
+{
+    device->DestroyFence(fence);
+}
+
+GnResult GnGetFenceStatus(GnFence fence)
+{
+    return fence->GetStatus();
+}
+
+GnResult GnWaitFence(GnFence fence, uint64_t timeout)
+{
+    if (fence == nullptr) return GnError_InvalidArgs;
+    return fence->Wait(timeout);
+}
+
+GnResult GnResetFence(GnFence fence)
+{
+    return fence->Reset();
+}
+
+GnResult GnCreateTimelineFence(GnDevice device, uint64_t initial_value, GnFence* fence)
+{
+    if (device == nullptr || fence == nullptr) return GnError_InvalidArgs;
+    return device->CreateTimelineFence(initial_value, fence);
+}
+
+GnResult GnGetFenceValue(GnFence fence, uint64_t* value)
+{
+    if (fence == nullptr || !fence->timeline || value == nullptr) return GnError_InvalidArgs;
+    return fence->GetValue(value);
+}
+
+GnResult GnWaitFenceValue(GnFence fence, uint64_t value, uint64_t timeout)
+{
+    if (fence == nullptr || !fence->timeline) return GnError_InvalidArgs;
+    return fence->WaitValue(value, timeout);
+}
+
+GnResult GnEnqueueWaitFence(GnQueue queue, GnFence fence, uint64_t value)
+{
+    if (fence == nullptr || !fence->timeline) return GnError_InvalidArgs;
+    return queue->EnqueueWaitFence(fence, value, GnPipelineStage_AllCommands);
+}
+
+GnResult GnEnqueueWaitFenceStages(GnQueue queue, GnFence fence, uint64_t value, GnPipelineStageFlags wait_stages)
+{
+    if (fence == nullptr || !fence->timeline || wait_stages == 0) return GnError_InvalidArgs;
+    return queue->EnqueueWaitFence(fence, value, wait_stages);
+}
+
+GnResult GnEnqueueSignalFence(GnQueue queue, GnFence fence, uint64_t value)
+{
+    if (fence == nullptr || !fence->timeline) return GnError_InvalidArgs;
+    return queue->EnqueueSignalFence(fence, value);
+}
+
+// -- [GnMemory] --
+
+GnResult GnCreateMemory(GnDevice device, const GnMemoryDesc* desc, GnMemory* memory)
+{
+    return device->CreateMemory(desc, memory);
+}
 
 void GnDestroyMemory(GnDevice device, GnMemory memory)
 {
-    device->DestroyMemory(memory);
+    if (GnDeferDestroy(device, GnDeferredObjectType_Memory, memory)) return;
+    device->DestroyMemory(memory);
+}
+
+// -- [GnBuffer] --
+
+GnResult GnCreateBuffer(GnDevice device, const GnBufferDesc* desc, GnBuffer* buffer)
+{
+    GnResult result = device->CreateBuffer(desc, buffer);
+
+    if (GN_FAILED(result))
+        return result;
+
+    (*buffer)->tracked_access = GnResourceAccess_Undefined;
+
+    return result;
+}
+
+void GnDestroyBuffer(GnDevice device, GnBuffer buffer)
+{
+    if (GnDeferDestroy(device, GnDeferredObjectType_Buffer, buffer)) return;
+    device->DestroyBuffer(buffer);
+}
+
+void GnGetBufferDesc(GnBuffer buffer, GnBufferDesc* texture_desc)
+{
+    *texture_desc = buffer->desc;
+}
+
+void GnGetBufferMemoryRequirements(GnDevice device, GnBuffer buffer, GnMemoryRequirements* memory_requirements)
+{
+    *memory_requirements = buffer->memory_requirements;
+}
+
+GnResult GnBindBufferMemory(GnDevice device, GnBuffer buffer, GnMemory memory, GnDeviceSize aligned_offset)
+{
+    return device->BindBufferMemory(buffer, memory, aligned_offset);
+}
+
+GnResult GnBindBufferDedicatedMemory(GnDevice device, GnBuffer buffer, uint32_t memory_type_index)
+{
+    return GnResult();
+}
+
+GnResult GnMapBuffer(GnDevice device, GnBuffer buffer, const GnMemoryRange* memory_range, void** mapped_memory)
+{
+    return device->MapBuffer(buffer, memory_range, mapped_memory);
+}
+
+void GnUnmapBuffer(GnDevice device, GnBuffer buffer, const GnMemoryRange* memory_range)
+{
+    device->UnmapBuffer(buffer, memory_range);
+}
+
+GnResult GnWriteBuffer(GnDevice device, GnBuffer buffer, GnDeviceSize offset, GnDeviceSize size, const void* data)
+{
+    GnMemoryRange memory_range;
+    memory_range.offset = offset;
+    memory_range.size = size;
+    return device->WriteBufferRange(buffer, &memory_range, data);
+}
+
+GnResult GnWriteBufferRange(GnDevice device, GnBuffer buffer, const GnMemoryRange* memory_range, const void* data)
+{
+    return device->WriteBufferRange(buffer, memory_range, data);
+}
+
+// -- [GnTexture] --
+
+// Usages a texture created with GnTextureUsage_Transient may have.
+static constexpr GnTextureUsageFlags GnTextureUsage_TransientCompatible =
+    GnTextureUsage_ColorTarget | GnTextureUsage_DepthStencilTarget | GnTextureUsage_InputAttachment | GnTextureUsage_Transient;
+
+GnResult GnCreateTexture(GnDevice device, const GnTextureDesc* desc, GnTexture* texture)
+{
+    if (GnHasBit(desc->usage, GnTextureUsage_Transient) && (desc->usage & ~GnTextureUsage_TransientCompatible) != 0)
+        return GnError_InvalidArgs;
+
+    GnResult result = device->CreateTexture(desc, texture);
+
+    if (GN_FAILED(result))
+        return result;
+
+    (*texture)->direct_present = false;
+    (*texture)->tracked_access = GnResourceAccess_Undefined;
+    (*texture)->tracked_subresource_access = nullptr;
+
+    return result;
+}
+
+void GnDestroyTexture(GnDevice device, GnTexture texture)
+{
+    if (texture->tracked_subresource_access != nullptr) {
+        GnFree(texture->tracked_subresource_access);
+        texture->tracked_subresource_access = nullptr;
+    }
+
+    if (GnDeferDestroy(device, GnDeferredObjectType_Texture, texture)) return;
+    device->DestroyTexture(texture);
+}
+
+void GnGetTextureDesc(GnTexture texture, GnTextureDesc* texture_desc)
+{
+    *texture_desc = texture->desc;
+}
+
+void GnGetTextureMemoryRequirements(GnDevice device, GnTexture texture, GnMemoryRequirements* memory_requirements)
+{
+    *memory_requirements = texture->memory_requirements;
+}
+
+GnResult GnBindTextureMemory(GnDevice device, GnTexture texture, GnMemory memory, GnDeviceSize aligned_offset)
+{
+    return device->BindTextureMemory(texture, memory, aligned_offset);
+}
+
+// -- [GnTextureView] --
+
+bool GnValidateCreateTextureViewParam(GnDevice device, const GnTextureViewDesc* desc, GnTextureView* texture_view)
+{
+    return true;
+}
+
+GnResult GnCreateTextureView(GnDevice device, const GnTextureViewDesc* desc, GnTextureView* texture_view)
+{
+    if (!GnValidateCreateTextureViewParam(device, desc, texture_view)) return GnError_InvalidArgs;
+    return device->CreateTextureView(desc, texture_view);
+}
+
+void GnDestroyTextureView(GnDevice device, GnTextureView texture_view)
+{
+    if (GnDeferDestroy(device, GnDeferredObjectType_TextureView, texture_view)) return;
+    device->DestroyTextureView(texture_view);
+}
+
+uint32_t GnGetTextureViewBindlessIndex(GnTextureView texture_view)
+{
+    return texture_view->bindless_index;
+}
+
+uint32_t GnGetBufferBindlessIndex(GnBuffer buffer)
+{
+    return buffer->bindless_index;
+}
+
+// -- [GnRenderGraph] --
+
+GnResult GnCreateRenderGraph(GnDevice device, const GnRenderGraphDesc* desc, GnRenderGraph* render_graph)
+{
+    return device->CreateRenderGraph(desc, render_graph);
+}
+
+void GnDestroyRenderGraph(GnDevice device, GnRenderGraph render_graph)
+{
+    GnResetRenderGraph(device, render_graph);
+    device->DestroyRenderGraph(render_graph);
+}
+
+static GnTextureAspectFlags GnGetRenderGraphTextureAspect(GnFormat format) noexcept
+{
+    switch (format) {
+        case GnFormat_D16Unorm:
+        case GnFormat_D32Float:
+            return GnTextureAspect_Depth;
+        case GnFormat_D16Unorm_S8Uint:
+        case GnFormat_D32Float_S8Uint:
+            return GnTextureAspect_Depth | GnTextureAspect_Stencil;
+        default:
+            break;
+    }
+
+    return GnTextureAspect_Color;
+}
+
+// Destroys everything created by GnCompileRenderGraph while keeping the declared passes and resources.
+static void GnReleaseCompiledRenderGraph(GnDevice device, GnRenderGraph render_graph) noexcept
+{
+    for (size_t i = 0; i < render_graph->render_pass_groups.size(); i++) {
+        GnRenderGraphRenderPassGroup& group = render_graph->render_pass_groups[i];
+
+        for (uint32_t j = 0; j < group.num_color_targets; j++)
+            if (group.color_targets[j].view != nullptr)
+                GnDestroyTextureView(device, group.color_targets[j].view);
+
+        if (group.depth_stencil_target.view != nullptr)
+            GnDestroyTextureView(device, group.depth_stencil_target.view);
+    }
+
+    for (size_t i = 0; i < render_graph->resources.size(); i++) {
+        GnRenderGraphResourceEntry& resource = render_graph->resources[i];
+
+        if (resource.imported)
+            continue;
+
+        if (resource.texture != nullptr) {
+            GnDestroyTexture(device, resource.texture);
+            resource.texture = nullptr;
+        }
+
+        if (resource.buffer != nullptr) {
+            GnDestroyBuffer(device, resource.buffer);
+            resource.buffer = nullptr;
+        }
+    }
+
+    for (size_t i = 0; i < render_graph->memories.size(); i++)
+        if (render_graph->memories[i].memory != nullptr)
+            GnDestroyMemory(device, render_graph->memories[i].memory);
+
+    render_graph->edges.resize(0);
+    render_graph->execution_order.resize(0);
+    render_graph->buffer_barriers.resize(0);
+    render_graph->texture_barriers.resize(0);
+    render_graph->memories.resize(0);
+    render_graph->render_pass_groups.resize(0);
+    render_graph->subpasses.resize(0);
+    render_graph->subpass_targets.resize(0);
+    render_graph->num_final_buffer_barriers = 0;
+    render_graph->num_final_texture_barriers = 0;
+    render_graph->compiled = false;
+}
+
+static GnResult GnAddRenderGraphResource(GnRenderGraph render_graph, const GnRenderGraphResourceEntry& entry, GnRenderGraphResource* resource) noexcept
+{
+    if (!render_graph->resources.push_back(entry))
+        return GnError_OutOfHostMemory;
+
+    *resource = (GnRenderGraphResource)render_graph->resources.size() - 1;
+    render_graph->compiled = false;
+
+    return GnSuccess;
+}
+
+GnResult GnRenderGraphImportTexture(GnRenderGraph render_graph, GnTexture texture, GnResourceAccessFlags initial_access, GnResourceAccessFlags final_access, GnRenderGraphResource* resource)
+{
+    if (texture == nullptr) return GnError_InvalidArgs;
+
+    GnRenderGraphResourceEntry entry{};
+    entry.imported = true;
+    entry.is_texture = true;
+    entry.texture_desc = texture->desc;
+    entry.texture = texture;
+    entry.initial_access = initial_access;
+    entry.final_access = final_access;
+
+    return GnAddRenderGraphResource(render_graph, entry, resource);
+}
+
+GnResult GnRenderGraphImportBuffer(GnRenderGraph render_graph, GnBuffer buffer, GnResourceAccessFlags initial_access, GnResourceAccessFlags final_access, GnRenderGraphResource* resource)
+{
+    if (buffer == nullptr) return GnError_InvalidArgs;
+
+    GnRenderGraphResourceEntry entry{};
+    entry.imported = true;
+    entry.is_texture = false;
+    entry.buffer_desc = buffer->desc;
+    entry.buffer = buffer;
+    entry.initial_access = initial_access;
+    entry.final_access = final_access;
+
+    return GnAddRenderGraphResource(render_graph, entry, resource);
+}
+
+GnResult GnRenderGraphCreateTexture(GnRenderGraph render_graph, const GnTextureDesc* desc, GnRenderGraphResource* resource)
+{
+    GnRenderGraphResourceEntry entry{};
+    entry.imported = false;
+    entry.is_texture = true;
+    entry.texture_desc = *desc;
+
+    return GnAddRenderGraphResource(render_graph, entry, resource);
+}
+
+GnResult GnRenderGraphCreateBuffer(GnRenderGraph render_graph, const GnBufferDesc* desc, GnRenderGraphResource* resource)
+{
+    GnRenderGraphResourceEntry entry{};
+    entry.imported = false;
+    entry.is_texture = false;
+    entry.buffer_desc = *desc;
+
+    return GnAddRenderGraphResource(render_graph, entry, resource);
+}
+
+static bool GnIsRenderGraphDepthStencilFormat(GnFormat format) noexcept
+{
+    return GnGetRenderGraphTextureAspect(format) != GnTextureAspect_Color;
+}
+
+// Every target of a render pass must be a texture of the same size and sample count. Targets that are only read as
+// input attachments still need an attachment slot, so they are counted as well.
+static bool GnValidateRenderGraphRenderPass(GnRenderGraph render_graph, const GnRenderGraphRenderPassDesc* desc) noexcept
+{
+    if (desc->num_color_targets > GN_MAX_COLOR_TARGETS ||
+        (desc->num_color_targets > 0 && desc->color_targets == nullptr) ||
+        (desc->num_input_targets > 0 && desc->input_targets == nullptr) ||
+        (desc->num_color_targets == 0 && desc->depth_stencil_target == nullptr))
+    {
+        return false;
+    }
+
+    const GnTextureDesc* reference = nullptr;
+    GnRenderGraphResource depth_stencil_resource = GN_INVALID;
+    uint32_t num_attachments = desc->num_color_targets;
+
+    auto check_target = [render_graph, &reference](GnRenderGraphResource resource) -> const GnTextureDesc* {
+        if (resource >= render_graph->resources.size() || !render_graph->resources[resource].is_texture)
+            return nullptr;
+
+        const GnTextureDesc* texture_desc = &render_graph->resources[resource].texture_desc;
+
+        if (reference == nullptr)
+            reference = texture_desc;
+
+        if (texture_desc->width != reference->width || texture_desc->height != reference->height || texture_desc->samples != reference->samples)
+            return nullptr;
+
+        return texture_desc;
+    };
+
+    for (uint32_t i = 0; i < desc->num_color_targets; i++) {
+        const GnTextureDesc* texture_desc = check_target(desc->color_targets[i].resource);
+
+        if (texture_desc == nullptr || GnIsRenderGraphDepthStencilFormat(texture_desc->format))
+            return false;
+
+        for (uint32_t j = 0; j < i; j++)
+            if (desc->color_targets[j].resource == desc->color_targets[i].resource)
+                return false;
+    }
+
+    if (desc->depth_stencil_target != nullptr) {
+        depth_stencil_resource = desc->depth_stencil_target->resource;
+        const GnTextureDesc* texture_desc = check_target(depth_stencil_resource);
+
+        if (texture_desc == nullptr || !GnIsRenderGraphDepthStencilFormat(texture_desc->format))
+            return false;
+    }
+
+    for (uint32_t i = 0; i < desc->num_input_targets; i++) {
+        GnRenderGraphResource resource = desc->input_targets[i];
+        const GnTextureDesc* texture_desc = check_target(resource);
+
+        if (texture_desc == nullptr)
+            return false;
+
+        if (GnIsRenderGraphDepthStencilFormat(texture_desc->format)) {
+            // There is only one depth-stencil attachment.
+            if (depth_stencil_resource == GN_INVALID)
+                depth_stencil_resource = resource;
+            else if (depth_stencil_resource != resource)
+                return false;
+
+            continue;
+        }
+
+        bool found = false;
+
+        for (uint32_t j = 0; j < desc->num_color_targets && !found; j++)
+            found = desc->color_targets[j].resource == resource;
+
+        for (uint32_t j = 0; j < i && !found; j++)
+            found = desc->input_targets[j] == resource;
+
+        if (!found)
+            num_attachments++;
+    }
+
+    return num_attachments <= GN_MAX_COLOR_TARGETS;
+}
+
+GnResult GnRenderGraphAddPass(GnRenderGraph render_graph, const GnRenderGraphPassDesc* desc)
+{
+    for (uint32_t i = 0; i < desc->num_accesses; i++)
+        if (desc->accesses[i].resource >= render_graph->resources.size())
+            return GnError_InvalidArgs;
+
+    const GnRenderGraphRenderPassDesc* render_pass = desc->render_pass;
+
+    if (render_pass != nullptr && !GnValidateRenderGraphRenderPass(render_graph, render_pass))
+        return GnError_InvalidArgs;
+
+    GnRenderGraphPassEntry pass{};
+    pass.first_access = (uint32_t)render_graph->accesses.size();
+    pass.has_side_effects = desc->has_side_effects;
+    pass.execute_fn = desc->execute_fn;
+    pass.userdata = desc->userdata;
+    pass.has_render_pass = render_pass != nullptr;
+    pass.first_color_target = (uint32_t)render_graph->color_targets.size();
+    pass.depth_stencil_target = GN_INVALID;
+    pass.first_input_target = (uint32_t)render_graph->input_targets.size();
+    pass.render_pass_group = GN_INVALID;
+
+    uint32_t num_target_accesses = 0;
+
+    if (render_pass != nullptr)
+        num_target_accesses = render_pass->num_color_targets + (render_pass->depth_stencil_target != nullptr) + render_pass->num_input_targets;
+
+    if (!render_graph->accesses.reserve(pass.first_access + desc->num_accesses + num_target_accesses))
+        return GnError_OutOfHostMemory;
+
+    auto add_access = [render_graph, &pass](GnRenderGraphResource resource, GnResourceAccessFlags access) {
+        for (uint32_t j = pass.first_access; j < render_graph->accesses.size(); j++) {
+            if (render_graph->accesses[j].resource == resource) {
+                render_graph->accesses[j].access |= access;
+                return;
+            }
+        }
+
+        render_graph->accesses.push_back({ resource, access });
+    };
+
+    for (uint32_t i = 0; i < desc->num_accesses; i++)
+        add_access(desc->accesses[i].resource, desc->accesses[i].access);
+
+    bool succeeded = true;
+
+    if (render_pass != nullptr) {
+        for (uint32_t i = 0; i < render_pass->num_color_targets; i++) {
+            const GnRenderGraphColorTargetDesc& color_target = render_pass->color_targets[i];
+            GnResourceAccessFlags access = GnResourceAccess_ColorTargetWrite;
+
+            if (color_target.load_op == GnRenderPassOp_Load)
+                access |= GnResourceAccess_ColorTargetRead;
+
+            add_access(color_target.resource, access);
+            succeeded = succeeded && render_graph->color_targets.push_back(color_target);
+        }
+
+        if (render_pass->depth_stencil_target != nullptr) {
+            add_access(render_pass->depth_stencil_target->resource, GnResourceAccess_DepthStencilTarget);
+            pass.depth_stencil_target = (uint32_t)render_graph->depth_stencil_targets.size();
+            succeeded = succeeded && render_graph->depth_stencil_targets.push_back(*render_pass->depth_stencil_target);
+        }
+
+        for (uint32_t i = 0; i < render_pass->num_input_targets; i++) {
+            add_access(render_pass->input_targets[i], GnResourceAccess_FSRead);
+            succeeded = succeeded && render_graph->input_targets.push_back(render_pass->input_targets[i]);
+        }
+
+        pass.num_color_targets = render_pass->num_color_targets;
+        pass.num_input_targets = render_pass->num_input_targets;
+    }
+
+    pass.num_accesses = (uint32_t)render_graph->accesses.size() - pass.first_access;
+
+    if (!succeeded || !render_graph->passes.push_back(pass)) {
+        render_graph->accesses.resize(pass.first_access);
+        render_graph->color_targets.resize(pass.first_color_target);
+        render_graph->input_targets.resize(pass.first_input_target);
+
+        if (pass.depth_stencil_target != GN_INVALID)
+            render_graph->depth_stencil_targets.resize(pass.depth_stencil_target);
+
+        return GnError_OutOfHostMemory;
+    }
+
+    render_graph->compiled = false;
+
+    return GnSuccess;
+}
+
+// Adds an edge for every pass that has to run before pass_index, based on the passes declared before it.
+static bool GnAddRenderGraphPassEdges(GnRenderGraph render_graph, uint32_t pass_index, GnVector<uint32_t>& last_writers) noexcept
+{
+    const GnRenderGraphPassEntry& pass = render_graph->passes[pass_index];
+
+    for (uint32_t i = 0; i < pass.num_accesses; i++) {
+        const GnRenderGraphResourceAccess& access = render_graph->accesses[pass.first_access + i];
+        uint32_t last_writer = last_writers[access.resource];
+        bool writes = GnHasBit(access.access, GnResourceAccess_AnyWrite);
+        bool reads = (access.access & ~GnResourceAccess_AnyWrite) != 0;
+
+        if (last_writer != GN_INVALID && !render_graph->edges.push_back({ last_writer, pass_index, reads }))
+            return false;
+
+        if (!writes)
+            continue;
+
+        // Write-after-read, every reader since the last write must finish first.
+        uint32_t first_reader = last_writer == GN_INVALID ? 0 : last_writer + 1;
+
+        for (uint32_t j = first_reader; j < pass_index; j++) {
+            const GnRenderGraphPassEntry& prev_pass = render_graph->passes[j];
+
+            for (uint32_t k = 0; k < prev_pass.num_accesses; k++) {
+                if (render_graph->accesses[prev_pass.first_access + k].resource != access.resource)
+                    continue;
+
+                if (!render_graph->edges.push_back({ j, pass_index, false }))
+                    return false;
+
+                break;
+            }
+        }
+
+        last_writers[access.resource] = pass_index;
+    }
+
+    return true;
+}
+
+static GnResult GnPlaceRenderGraphResources(GnDevice device, GnRenderGraph render_graph) noexcept
+{
+    GnVector<uint32_t> transients;
+
+    for (uint32_t i = 0; i < render_graph->resources.size(); i++) {
+        GnRenderGraphResourceEntry& resource = render_graph->resources[i];
+
+        if (resource.imported || resource.first_use == GN_INVALID)
+            continue;
+
+        GnMemoryRequirements memory_requirements;
+        GnResult result;
+
+        if (resource.is_texture) {
+            // Targets that never outlive their render pass do not need to be backed by memory on tiled GPUs.
+            GnTextureDesc texture_desc = resource.texture_desc;
+            const GnRenderGraphPassEntry& first_pass = render_graph->passes[render_graph->execution_order[resource.first_use]];
+
+            if ((texture_desc.usage & ~GnTextureUsage_TransientCompatible) == 0 && first_pass.render_pass_group != GN_INVALID) {
+                const GnRenderGraphRenderPassGroup& group = render_graph->render_pass_groups[first_pass.render_pass_group];
+
+                if (resource.last_use < group.first_position + group.num_passes)
+                    texture_desc.usage |= GnTextureUsage_Transient;
+            }
+
+            result = GnCreateTexture(device, &texture_desc, &resource.texture);
+            if (GN_FAILED(result)) return result;
+            memory_requirements = resource.texture->memory_requirements;
+        }
+        else {
+            result = GnCreateBuffer(device, &resource.buffer_desc, &resource.buffer);
+            if (GN_FAILED(result)) return result;
+            memory_requirements = resource.buffer->memory_requirements;
+        }
+
+        uint32_t memory_type_index = GnFindSupportedMemoryType(device->parent_adapter, memory_requirements.supported_memory_type_bits,
+                                                               GnMemoryAttribute_DeviceLocal, GnMemoryAttribute_DeviceLocal, 0);
+
+        if (memory_type_index == GN_INVALID)
+            return GnError_InternalError;
+
+        // Buffers and textures never share a memory, so the placement does not have to care about the buffer-image
+        // granularity.
+        uint32_t memory_index = GN_INVALID;
+
+        for (uint32_t j = 0; j < render_graph->memories.size(); j++) {
+            const GnRenderGraphMemoryEntry& memory = render_graph->memories[j];
+
+            if (memory.memory_type_index == memory_type_index && memory.for_textures == resource.is_texture) {
+                memory_index = j;
+                break;
+            }
+        }
+
+        if (memory_index == GN_INVALID) {
+            if (!render_graph->memories.push_back({ nullptr, memory_type_index, resource.is_texture, false, 0 }))
+                return GnError_OutOfHostMemory;
+
+            memory_index = (uint32_t)render_graph->memories.size() - 1;
+        }
+
+        if (resource.is_texture && resource.texture_desc.samples > GnSampleCount_X1)
+            render_graph->memories[memory_index].multisampled = true;
+
+        resource.memory_index = memory_index;
+        resource.memory_offset = memory_requirements.alignment; // Stashed here until the resource is placed
+        resource.memory_size = memory_requirements.size;
+
+        if (!transients.push_back(i))
+            return GnError_OutOfHostMemory;
+    }
+
+    // Larger resources first, each one goes to the lowest offset that does not overlap a placed resource that is
+    // alive at the same time.
+    std::sort(transients.data(), transients.data() + transients.size(), [render_graph](uint32_t a, uint32_t b) {
+        GnDeviceSize size_a = render_graph->resources[a].memory_size;
+        GnDeviceSize size_b = render_graph->resources[b].memory_size;
+        return size_a != size_b ? size_a > size_b : a < b;
+    });
+
+    for (uint32_t i = 0; i < transients.size(); i++) {
+        GnRenderGraphResourceEntry& resource = render_graph->resources[transients[i]];
+        GnDeviceSize alignment = GnMax(resource.memory_offset, (GnDeviceSize)1);
+        GnDeviceSize offset = 0;
+        bool overlapped = true;
+
+        while (overlapped) {
+            overlapped = false;
+
+            for (uint32_t j = 0; j < i; j++) {
+                const GnRenderGraphResourceEntry& placed = render_graph->resources[transients[j]];
+
+                if (placed.memory_index != resource.memory_index ||
+                    placed.last_use < resource.first_use || resource.last_use < placed.first_use ||
+                    placed.memory_offset + placed.memory_size <= offset || offset + resource.memory_size <= placed.memory_offset)
+                {
+                    continue;
+                }
+
+                offset = (placed.memory_offset + placed.memory_size + alignment - 1) / alignment * alignment;
+                overlapped = true;
+            }
+        }
+
+        resource.memory_offset = offset;
+
+        GnRenderGraphMemoryEntry& memory = render_graph->memories[resource.memory_index];
+        memory.size = GnMax(memory.size, offset + resource.memory_size);
+    }
+
+    for (uint32_t i = 0; i < render_graph->memories.size(); i++) {
+        GnRenderGraphMemoryEntry& memory = render_graph->memories[i];
+
+        GnMemoryDesc memory_desc{};
+        memory_desc.flags = memory.multisampled ? GnMemoryUsage_MultisampledResourcePlacement : 0;
+        memory_desc.memory_type_index = memory.memory_type_index;
+        memory_desc.size = memory.size;
+
+        GnResult result = GnCreateMemory(device, &memory_desc, &memory.memory);
+
+        if (GN_FAILED(result)) {
+            memory.memory = nullptr;
+            return result;
+        }
+    }
+
+    for (uint32_t i = 0; i < transients.size(); i++) {
+        const GnRenderGraphResourceEntry& resource = render_graph->resources[transients[i]];
+        GnMemory memory = render_graph->memories[resource.memory_index].memory;
+        GnResult result = resource.is_texture ?
+            GnBindTextureMemory(device, resource.texture, memory, resource.memory_offset) :
+            GnBindBufferMemory(device, resource.buffer, memory, resource.memory_offset);
+
+        if (GN_FAILED(result))
+            return result;
+    }
+
+    return GnSuccess;
+}
+
+// Returns the union of the final accesses of every transient resource that occupies a part of the memory of
+// resource_index. With previous_run, these are the occupants from the previous execution of the graph that may still
+// access the memory when resource_index is first used again: resource_index itself and the resources placed after it.
+// Otherwise, these are the resources that occupied the memory before its first use in the same execution.
+static GnResourceAccessFlags GnGetAliasedOccupantAccess(GnRenderGraph render_graph, uint32_t resource_index, bool previous_run) noexcept
+{
+    const GnRenderGraphResourceEntry& resource = render_graph->resources[resource_index];
+    GnResourceAccessFlags access = previous_run ? resource.current_access : GnResourceAccess_Undefined;
+
+    for (uint32_t i = 0; i < render_graph->resources.size(); i++) {
+        const GnRenderGraphResourceEntry& other = render_graph->resources[i];
+        bool occupant = previous_run ? other.first_use > resource.last_use : other.last_use < resource.first_use;
+
+        if (i == resource_index || other.imported || other.first_use == GN_INVALID || !occupant ||
+            other.memory_index != resource.memory_index ||
+            other.memory_offset + other.memory_size <= resource.memory_offset ||
+            resource.memory_offset + resource.memory_size <= other.memory_offset)
+        {
+            continue;
+        }
+
+        access |= other.current_access;
+    }
+
+    return access;
+}
+
+static bool GnAddRenderGraphBarrier(GnRenderGraph render_graph, const GnRenderGraphResourceEntry& resource, GnResourceAccessFlags prev_access, GnResourceAccessFlags next_access) noexcept
+{
+    if (resource.is_texture) {
+        GnTextureBarrier barrier{};
+        barrier.texture = resource.texture;
+        barrier.subresource_range.aspect = GnGetRenderGraphTextureAspect(resource.texture_desc.format);
+        barrier.subresource_range.num_mip_levels = resource.texture_desc.mip_levels;
+        barrier.subresource_range.num_array_layers = resource.texture_desc.array_layers;
+        barrier.prev_access = prev_access;
+        barrier.next_access = next_access;
+        return render_graph->texture_barriers.push_back(barrier);
+    }
+
+    GnBufferBarrier barrier{};
+    barrier.buffer = resource.buffer;
+    barrier.size = resource.buffer_desc.size;
+    barrier.prev_access = prev_access;
+    barrier.next_access = next_access;
+    return render_graph->buffer_barriers.push_back(barrier);
+}
+
+// Barriers cannot be recorded inside a render pass, so every pass of a render pass group shares the barriers
+// recorded before its first pass, which transition each resource to the union of the accesses of the group.
+static GnResult GnComputeRenderGraphBarriers(GnRenderGraph render_graph) noexcept
+{
+    struct GnRenderGraphWrapAroundBarrier
+    {
+        uint32_t resource;
+        uint32_t barrier_index;
+    };
+
+    GnVector<GnRenderGraphResourceAccess> batch_accesses;
+    GnVector<GnRenderGraphWrapAroundBarrier> wrap_around_barriers;
+
+    for (uint32_t i = 0; i < render_graph->resources.size(); i++) {
+        GnRenderGraphResourceEntry& resource = render_graph->resources[i];
+        resource.current_access = resource.imported ? resource.initial_access : GnResourceAccess_Undefined;
+    }
+
+    for (uint32_t i = 0; i < render_graph->execution_order.size();) {
+        GnRenderGraphPassEntry& pass = render_graph->passes[render_graph->execution_order[i]];
+        uint32_t batch_end = i + 1;
+
+        if (pass.render_pass_group != GN_INVALID)
+            batch_end = i + render_graph->render_pass_groups[pass.render_pass_group].num_passes;
+
+        batch_accesses.resize(0);
+
+        for (uint32_t j = i; j < batch_end; j++) {
+            const GnRenderGraphPassEntry& batch_pass = render_graph->passes[render_graph->execution_order[j]];
+
+            for (uint32_t k = 0; k < batch_pass.num_accesses; k++) {
+                const GnRenderGraphResourceAccess& access = render_graph->accesses[batch_pass.first_access + k];
+                bool merged = false;
+
+                for (uint32_t l = 0; l < batch_accesses.size() && !merged; l++) {
+                    if (batch_accesses[l].resource == access.resource) {
+                        batch_accesses[l].access |= access.access;
+                        merged = true;
+                    }
+                }
+
+                if (!merged && !batch_accesses.push_back(access))
+                    return GnError_OutOfHostMemory;
+            }
+        }
+
+        pass.first_buffer_barrier = (uint32_t)render_graph->buffer_barriers.size();
+        pass.first_texture_barrier = (uint32_t)render_graph->texture_barriers.size();
+
+        for (uint32_t j = 0; j < batch_accesses.size(); j++) {
+            const GnRenderGraphResourceAccess& access = batch_accesses[j];
+            GnRenderGraphResourceEntry& resource = render_graph->resources[access.resource];
+
+            if (!resource.imported && resource.first_use == i) {
+                // The memory may still be in use by the previous occupants, wait for all of them and discard their
+                // contents. The occupants from the previous execution of the graph are only known once every
+                // access has been visited.
+                GnResourceAccessFlags prev_access = GnGetAliasedOccupantAccess(render_graph, access.resource, false);
+                GnRenderGraphWrapAroundBarrier wrap_around_barrier;
+                wrap_around_barrier.resource = access.resource;
+                wrap_around_barrier.barrier_index = resource.is_texture ?
+                    (uint32_t)render_graph->texture_barriers.size() : (uint32_t)render_graph->buffer_barriers.size();
+
+                if (!GnAddRenderGraphBarrier(render_graph, resource, prev_access | GnResourceAccess_Discard, access.access) ||
+                    !wrap_around_barriers.push_back(wrap_around_barrier))
+                {
+                    return GnError_OutOfHostMemory;
+                }
+
+                resource.current_access = access.access;
+                continue;
+            }
+
+            if (GnAccessNeedsBarrier(resource.current_access, access.access, resource.is_texture)) {
+                if (!GnAddRenderGraphBarrier(render_graph, resource, resource.current_access, access.access))
+                    return GnError_OutOfHostMemory;
+
+                resource.current_access = access.access;
+            }
+            else if (!resource.is_texture) {
+                resource.current_access = GnMergeBufferReadAccess(resource.current_access, access.access);
+            }
+        }
+
+        pass.num_buffer_barriers = (uint32_t)render_graph->buffer_barriers.size() - pass.first_buffer_barrier;
+        pass.num_texture_barriers = (uint32_t)render_graph->texture_barriers.size() - pass.first_texture_barrier;
+
+        for (uint32_t j = i + 1; j < batch_end; j++) {
+            GnRenderGraphPassEntry& batch_pass = render_graph->passes[render_graph->execution_order[j]];
+            batch_pass.first_buffer_barrier = (uint32_t)render_graph->buffer_barriers.size();
+            batch_pass.num_buffer_barriers = 0;
+            batch_pass.first_texture_barrier = (uint32_t)render_graph->texture_barriers.size();
+            batch_pass.num_texture_barriers = 0;
+        }
+
+        i = batch_end;
+    }
+
+    // A compiled graph may be executed again, the first use of each transient resource also waits for the last
+    // accesses made to its memory by the previous execution.
+    for (uint32_t i = 0; i < wrap_around_barriers.size(); i++) {
+        const GnRenderGraphWrapAroundBarrier& wrap_around_barrier = wrap_around_barriers[i];
+        GnResourceAccessFlags prev_access = GnGetAliasedOccupantAccess(render_graph, wrap_around_barrier.resource, true);
+
+        if (render_graph->resources[wrap_around_barrier.resource].is_texture)
+            render_graph->texture_barriers[wrap_around_barrier.barrier_index].prev_access |= prev_access;
+        else
+            render_graph->buffer_barriers[wrap_around_barrier.barrier_index].prev_access |= prev_access;
+    }
+
+    size_t num_buffer_barriers = render_graph->buffer_barriers.size();
+    size_t num_texture_barriers = render_graph->texture_barriers.size();
+
+    for (uint32_t i = 0; i < render_graph->resources.size(); i++) {
+        const GnRenderGraphResourceEntry& resource = render_graph->resources[i];
+
+        if (!resource.imported || !GnAccessNeedsBarrier(resource.current_access, resource.final_access, resource.is_texture))
+            continue;
+
+        if (!GnAddRenderGraphBarrier(render_graph, resource, resource.current_access, resource.final_access))
+            return GnError_OutOfHostMemory;
+    }
+
+    render_graph->num_final_buffer_barriers = (uint32_t)(render_graph->buffer_barriers.size() - num_buffer_barriers);
+    render_graph->num_final_texture_barriers = (uint32_t)(render_graph->texture_barriers.size() - num_texture_barriers);
+
+    return GnSuccess;
+}
+
+// Returns the union of the accesses made to resource by the passes of group.
+static GnResourceAccessFlags GnGetRenderGraphGroupAccess(GnRenderGraph render_graph, const GnRenderGraphRenderPassGroup& group, GnRenderGraphResource resource) noexcept
+{
+    GnResourceAccessFlags access = 0;
+
+    for (uint32_t i = 0; i < group.num_passes; i++) {
+        const GnRenderGraphPassEntry& pass = render_graph->passes[render_graph->execution_order[group.first_position + i]];
+
+        for (uint32_t j = 0; j < pass.num_accesses; j++) {
+            const GnRenderGraphResourceAccess& pass_access = render_graph->accesses[pass.first_access + j];
+
+            if (pass_access.resource == resource)
+                access |= pass_access.access;
+        }
+    }
+
+    return access;
 }
 
-// -- [GnBuffer] --
+// Returns the attachment index of resource in group, GN_DEPTH_STENCIL_TARGET, or GN_INVALID if it is not a target.
+static uint32_t GnFindRenderGraphGroupTarget(const GnRenderGraphRenderPassGroup& group, GnRenderGraphResource resource) noexcept
+{
+    if (group.depth_stencil_resource == resource)
+        return GN_DEPTH_STENCIL_TARGET;
+
+    for (uint32_t i = 0; i < group.num_color_targets; i++)
+        if (group.color_target_resources[i] == resource)
+            return i;
+
+    return GN_INVALID;
+}
+
+static bool GnIsRenderGraphPassTarget(GnRenderGraph render_graph, const GnRenderGraphPassEntry& pass, GnRenderGraphResource resource, bool* cleared) noexcept
+{
+    *cleared = false;
+
+    for (uint32_t i = 0; i < pass.num_color_targets; i++) {
+        const GnRenderGraphColorTargetDesc& color_target = render_graph->color_targets[pass.first_color_target + i];
+
+        if (color_target.resource == resource) {
+            *cleared = color_target.load_op == GnRenderPassOp_Clear;
+            return true;
+        }
+    }
+
+    if (pass.depth_stencil_target != GN_INVALID) {
+        const GnRenderGraphDepthStencilTargetDesc& depth_stencil_target = render_graph->depth_stencil_targets[pass.depth_stencil_target];
+
+        if (depth_stencil_target.resource == resource) {
+            *cleared = depth_stencil_target.depth_load_op == GnRenderPassOp_Clear || depth_stencil_target.stencil_load_op == GnRenderPassOp_Clear;
+            return true;
+        }
+    }
+
+    for (uint32_t i = 0; i < pass.num_input_targets; i++)
+        if (render_graph->input_targets[pass.first_input_target + i] == resource)
+            return true;
+
+    return false;
+}
+
+// Every target of a pass has the same size and sample count, see GnValidateRenderGraphRenderPass.
+static const GnTextureDesc& GnGetRenderGraphPassTargetDesc(GnRenderGraph render_graph, const GnRenderGraphPassEntry& pass) noexcept
+{
+    GnRenderGraphResource resource = pass.num_color_targets > 0 ?
+        render_graph->color_targets[pass.first_color_target].resource :
+        render_graph->depth_stencil_targets[pass.depth_stencil_target].resource;
+
+    return render_graph->resources[resource].texture_desc;
+}
+
+// A pass can become the next subpass of group if both render to the same size, the attachments still fit, and
+// everything the pass shares with group is either a target of both or needs no barrier in between.
+static bool GnCanMergeRenderGraphPass(GnRenderGraph render_graph, const GnRenderGraphRenderPassGroup& group, const GnRenderGraphPassEntry& pass) noexcept
+{
+    if (group.num_passes >= GN_MAX_SUBPASSES)
+        return false;
+
+    const GnRenderGraphPassEntry& group_pass = render_graph->passes[render_graph->execution_order[group.first_position]];
+    const GnTextureDesc& group_desc = GnGetRenderGraphPassTargetDesc(render_graph, group_pass);
+    const GnTextureDesc& pass_desc = GnGetRenderGraphPassTargetDesc(render_graph, pass);
+
+    if (group_desc.width != pass_desc.width || group_desc.height != pass_desc.height || group_desc.samples != pass_desc.samples)
+        return false;
+
+    GnRenderGraphResource depth_stencil_resource = group.depth_stencil_resource;
+    GnRenderGraphResource new_color_targets[GN_MAX_COLOR_TARGETS];
+    uint32_t num_new_color_targets = 0;
+
+    auto add_target = [&](GnRenderGraphResource resource) -> bool {
+        if (GnIsRenderGraphDepthStencilFormat(render_graph->resources[resource].texture_desc.format)) {
+            if (depth_stencil_resource == GN_INVALID)
+                depth_stencil_resource = resource;
+
+            return depth_stencil_resource == resource;
+        }
+
+        if (GnFindRenderGraphGroupTarget(group, resource) != GN_INVALID)
+            return true;
+
+        for (uint32_t i = 0; i < num_new_color_targets; i++)
+            if (new_color_targets[i] == resource)
+                return true;
+
+        if (group.num_color_targets + num_new_color_targets >= GN_MAX_COLOR_TARGETS)
+            return false;
+
+        new_color_targets[num_new_color_targets++] = resource;
+
+        return true;
+    };
+
+    for (uint32_t i = 0; i < pass.num_color_targets; i++)
+        if (!add_target(render_graph->color_targets[pass.first_color_target + i].resource))
+            return false;
+
+    if (pass.depth_stencil_target != GN_INVALID && !add_target(render_graph->depth_stencil_targets[pass.depth_stencil_target].resource))
+        return false;
+
+    for (uint32_t i = 0; i < pass.num_input_targets; i++)
+        if (!add_target(render_graph->input_targets[pass.first_input_target + i]))
+            return false;
+
+    for (uint32_t i = 0; i < pass.num_accesses; i++) {
+        const GnRenderGraphResourceAccess& access = render_graph->accesses[pass.first_access + i];
+        GnResourceAccessFlags group_access = GnGetRenderGraphGroupAccess(render_graph, group, access.resource);
+
+        if (group_access == 0)
+            continue;
+
+        // Attachments are synchronized by the subpass dependencies, but clearing one would overwrite what the
+        // previous subpasses rendered.
+        bool cleared;
+
+        if (GnIsRenderGraphPassTarget(render_graph, pass, access.resource, &cleared) &&
+            GnFindRenderGraphGroupTarget(group, access.resource) != GN_INVALID)
+        {
+            if (cleared)
+                return false;
+
+            continue;
+        }
+
+        if (GnAccessNeedsBarrier(group_access, access.access, render_graph->resources[access.resource].is_texture))
+            return false;
+    }
+
+    return true;
+}
+
+static void GnAddRenderGraphPassTargets(GnRenderGraph render_graph, GnRenderGraphRenderPassGroup& group, const GnRenderGraphPassEntry& pass) noexcept
+{
+    // Targets that are only read keep their contents.
+    auto add_color_target = [&group](GnRenderGraphResource resource) -> uint32_t {
+        uint32_t index = group.num_color_targets++;
+        GnRenderPassColorTargetDesc& color_target = group.color_targets[index];
+        color_target = {};
+        color_target.load_op = GnRenderPassOp_Load;
+        color_target.store_op = GnRenderPassOp_Store;
+        group.color_target_resources[index] = resource;
+        return index;
+    };
+
+    auto set_depth_stencil_target = [&group](GnRenderGraphResource resource) {
+        GnRenderPassDepthStencilTargetDesc& depth_stencil_target = group.depth_stencil_target;
+        depth_stencil_target = {};
+        depth_stencil_target.depth_load_op = GnRenderPassOp_Load;
+        depth_stencil_target.depth_store_op = GnRenderPassOp_Store;
+        depth_stencil_target.stencil_load_op = GnRenderPassOp_Load;
+        depth_stencil_target.stencil_store_op = GnRenderPassOp_Store;
+        group.depth_stencil_resource = resource;
+    };
+
+    // The load operation comes from the first pass using a target, the store operation from the last one.
+    for (uint32_t i = 0; i < pass.num_color_targets; i++) {
+        const GnRenderGraphColorTargetDesc& desc = render_graph->color_targets[pass.first_color_target + i];
+        uint32_t index = GnFindRenderGraphGroupTarget(group, desc.resource);
+
+        if (index == GN_INVALID) {
+            index = add_color_target(desc.resource);
+            group.color_targets[index].load_op = desc.load_op;
+            group.color_targets[index].clear_value = desc.clear_value;
+        }
+
+        group.color_targets[index].store_op = desc.store_op;
+    }
+
+    if (pass.depth_stencil_target != GN_INVALID) {
+        const GnRenderGraphDepthStencilTargetDesc& desc = render_graph->depth_stencil_targets[pass.depth_stencil_target];
+        GnRenderPassDepthStencilTargetDesc& depth_stencil_target = group.depth_stencil_target;
+
+        if (group.depth_stencil_resource == GN_INVALID) {
+            set_depth_stencil_target(desc.resource);
+            depth_stencil_target.depth_load_op = desc.depth_load_op;
+            depth_stencil_target.stencil_load_op = desc.stencil_load_op;
+            depth_stencil_target.clear_value = desc.clear_value;
+        }
+
+        depth_stencil_target.depth_store_op = desc.depth_store_op;
+        depth_stencil_target.stencil_store_op = desc.stencil_store_op;
+    }
+
+    for (uint32_t i = 0; i < pass.num_input_targets; i++) {
+        GnRenderGraphResource resource = render_graph->input_targets[pass.first_input_target + i];
+
+        if (GnFindRenderGraphGroupTarget(group, resource) != GN_INVALID)
+            continue;
+
+        if (GnIsRenderGraphDepthStencilFormat(render_graph->resources[resource].texture_desc.format))
+            set_depth_stencil_target(resource);
+        else
+            add_color_target(resource);
+    }
+}
+
+// Splits the passes that render into render pass groups, merging consecutive passes into subpasses when possible.
+static GnResult GnGroupRenderGraphPasses(GnRenderGraph render_graph) noexcept
+{
+    uint32_t num_subpass_targets = 0;
+
+    for (uint32_t i = 0; i < render_graph->execution_order.size(); i++) {
+        GnRenderGraphPassEntry& pass = render_graph->passes[render_graph->execution_order[i]];
+        pass.render_pass_group = GN_INVALID;
+        pass.subpass = 0;
+
+        if (!pass.has_render_pass)
+            continue;
+
+        num_subpass_targets += pass.num_color_targets + pass.num_input_targets;
+
+        GnRenderGraphRenderPassGroup* group = nullptr;
+
+        if (render_graph->merge_subpasses && render_graph->render_pass_groups.size() > 0) {
+            GnRenderGraphRenderPassGroup& last_group = render_graph->render_pass_groups[render_graph->render_pass_groups.size() - 1];
+
+            if (last_group.first_position + last_group.num_passes == i && GnCanMergeRenderGraphPass(render_graph, last_group, pass))
+                group = &last_group;
+        }
+
+        if (group == nullptr) {
+            GnRenderGraphRenderPassGroup new_group{};
+            new_group.first_position = i;
+            new_group.depth_stencil_resource = GN_INVALID;
+
+            if (!render_graph->render_pass_groups.push_back(new_group))
+                return GnError_OutOfHostMemory;
+
+            group = &render_graph->render_pass_groups[render_graph->render_pass_groups.size() - 1];
+        }
+
+        GnAddRenderGraphPassTargets(render_graph, *group, pass);
+        pass.render_pass_group = (uint32_t)render_graph->render_pass_groups.size() - 1;
+        pass.subpass = group->num_passes++;
+    }
+
+    // The subpass descriptions point into subpass_targets, so it must not grow past the reserved size.
+    if (!render_graph->subpass_targets.reserve(num_subpass_targets))
+        return GnError_OutOfHostMemory;
+
+    for (uint32_t i = 0; i < render_graph->render_pass_groups.size(); i++) {
+        GnRenderGraphRenderPassGroup& group = render_graph->render_pass_groups[i];
+        const GnRenderGraphPassEntry& first_pass = render_graph->passes[render_graph->execution_order[group.first_position]];
+        const GnTextureDesc& target_desc = GnGetRenderGraphPassTargetDesc(render_graph, first_pass);
+
+        group.first_subpass = (uint32_t)render_graph->subpasses.size();
+        group.begin_desc.sample_count = (GnSampleCount)target_desc.samples;
+        group.begin_desc.width = target_desc.width;
+        group.begin_desc.height = target_desc.height;
+        group.begin_desc.num_color_targets = group.num_color_targets;
+
+        // A single pass that writes its color targets in order is the default subpass.
+        if (group.num_passes == 1 && first_pass.num_input_targets == 0)
+            continue;
+
+        for (uint32_t j = 0; j < group.num_passes; j++) {
+            const GnRenderGraphPassEntry& pass = render_graph->passes[render_graph->execution_order[group.first_position + j]];
+
+            GnRenderPassSubpassDesc subpass{};
+            subpass.num_color_targets = pass.num_color_targets;
+            subpass.color_targets = render_graph->subpass_targets.data() + render_graph->subpass_targets.size();
+
+            for (uint32_t k = 0; k < pass.num_color_targets; k++)
+                render_graph->subpass_targets.push_back(GnFindRenderGraphGroupTarget(group, render_graph->color_targets[pass.first_color_target + k].resource));
+
+            subpass.num_input_targets = pass.num_input_targets;
+            subpass.input_targets = render_graph->subpass_targets.data() + render_graph->subpass_targets.size();
+
+            for (uint32_t k = 0; k < pass.num_input_targets; k++)
+                render_graph->subpass_targets.push_back(GnFindRenderGraphGroupTarget(group, render_graph->input_targets[pass.first_input_target + k]));
+
+            subpass.use_depth_stencil_target = pass.depth_stencil_target != GN_INVALID;
+
+            if (!render_graph->subpasses.push_back(subpass))
+                return GnError_OutOfHostMemory;
+        }
+
+        group.begin_desc.num_subpasses = group.num_passes;
+    }
+
+    for (uint32_t i = 0; i < render_graph->render_pass_groups.size(); i++) {
+        GnRenderGraphRenderPassGroup& group = render_graph->render_pass_groups[i];
+        group.begin_desc.color_targets = group.color_targets;
+        group.begin_desc.depth_stencil_target = group.depth_stencil_resource != GN_INVALID ? &group.depth_stencil_target : nullptr;
+        group.begin_desc.subpasses = group.begin_desc.num_subpasses > 0 ? render_graph->subpasses.data() + group.first_subpass : nullptr;
+    }
+
+    return GnSuccess;
+}
+
+static GnResult GnCreateRenderGraphTargetView(GnDevice device, const GnRenderGraphResourceEntry& resource, GnTextureView* view) noexcept
+{
+    GnTextureViewDesc desc{};
+    desc.texture = resource.texture;
+    desc.type = GnTextureViewType_2D;
+    desc.format = resource.texture_desc.format;
+    desc.subresource_range.aspect = GnGetRenderGraphTextureAspect(resource.texture_desc.format);
+    desc.subresource_range.num_mip_levels = 1;
+    desc.subresource_range.num_array_layers = 1;
+
+    GnResult result = GnCreateTextureView(device, &desc, view);
+
+    if (GN_FAILED(result))
+        *view = nullptr;
+
+    return result;
+}
+
+// Fills in the views and accesses of the targets once the resources exist and the barriers are known. Transient
+// targets that are not used after their render pass are never stored.
+static GnResult GnPrepareRenderGraphRenderPasses(GnDevice device, GnRenderGraph render_graph) noexcept
+{
+    for (uint32_t i = 0; i < render_graph->render_pass_groups.size(); i++) {
+        GnRenderGraphRenderPassGroup& group = render_graph->render_pass_groups[i];
+        uint32_t group_end = group.first_position + group.num_passes;
+
+        for (uint32_t j = 0; j < group.num_color_targets; j++) {
+            const GnRenderGraphResourceEntry& resource = render_graph->resources[group.color_target_resources[j]];
+            GnRenderPassColorTargetDesc& color_target = group.color_targets[j];
+            color_target.access = GnGetRenderGraphGroupAccess(render_graph, group, group.color_target_resources[j]);
+
+            if (!resource.imported && resource.last_use < group_end)
+                color_target.store_op = GnRenderPassOp_Discard;
+
+            GnResult result = GnCreateRenderGraphTargetView(device, resource, &color_target.view);
+            if (GN_FAILED(result)) return result;
+        }
+
+        if (group.depth_stencil_resource != GN_INVALID) {
+            const GnRenderGraphResourceEntry& resource = render_graph->resources[group.depth_stencil_resource];
+            GnRenderPassDepthStencilTargetDesc& depth_stencil_target = group.depth_stencil_target;
+            depth_stencil_target.access = GnGetRenderGraphGroupAccess(render_graph, group, group.depth_stencil_resource);
+
+            if (!resource.imported && resource.last_use < group_end) {
+                depth_stencil_target.depth_store_op = GnRenderPassOp_Discard;
+                depth_stencil_target.stencil_store_op = GnRenderPassOp_Discard;
+            }
+
+            GnResult result = GnCreateRenderGraphTargetView(device, resource, &depth_stencil_target.view);
+            if (GN_FAILED(result)) return result;
+        }
+    }
+
+    return GnSuccess;
+}
+
+GnResult GnCompileRenderGraph(GnDevice device, GnRenderGraph render_graph)
+{
+    GnReleaseCompiledRenderGraph(device, render_graph);
+
+    uint32_t num_passes = (uint32_t)render_graph->passes.size();
+    uint32_t num_resources = (uint32_t)render_graph->resources.size();
+    GnVector<uint32_t> last_writers;
+
+    if (!last_writers.resize(num_resources) || !render_graph->execution_order.reserve(num_passes))
+        return GnError_OutOfHostMemory;
+
+    for (uint32_t i = 0; i < num_resources; i++)
+        last_writers[i] = GN_INVALID;
+
+    for (uint32_t i = 0; i < num_passes; i++) {
+        if (!GnAddRenderGraphPassEdges(render_graph, i, last_writers))
+            return GnError_OutOfHostMemory;
+
+        // Passes that write to an imported resource are visible outside of the graph.
+        GnRenderGraphPassEntry& pass = render_graph->passes[i];
+        pass.kept = pass.has_side_effects;
+
+        for (uint32_t j = 0; j < pass.num_accesses && !pass.kept; j++) {
+            const GnRenderGraphResourceAccess& access = render_graph->accesses[pass.first_access + j];
+            pass.kept = render_graph->resources[access.resource].imported && GnHasBit(access.access, GnResourceAccess_AnyWrite);
+        }
+    }
+
+    // Edges are sorted by destination pass, so walking them backwards visits every edge leaving a pass before the
+    // edges entering it. This keeps every pass whose output is read by a kept pass.
+    for (size_t i = render_graph->edges.size(); i > 0; i--) {
+        const GnRenderGraphEdge& edge = render_graph->edges[i - 1];
+
+        if (edge.data_flow && render_graph->passes[edge.dst_pass].kept)
+            render_graph->passes[edge.src_pass].kept = true;
+    }
+
+    for (uint32_t i = 0; i < num_passes; i++)
+        render_graph->passes[i].num_dependencies = 0;
+
+    for (size_t i = 0; i < render_graph->edges.size(); i++) {
+        const GnRenderGraphEdge& edge = render_graph->edges[i];
+
+        if (render_graph->passes[edge.src_pass].kept)
+            render_graph->passes[edge.dst_pass].num_dependencies++;
+    }
+
+    // Kahn's algorithm, always picking the earliest declared pass that is ready.
+    uint32_t num_kept_passes = 0;
+
+    for (uint32_t i = 0; i < num_passes; i++)
+        if (render_graph->passes[i].kept)
+            num_kept_passes++;
+
+    while (render_graph->execution_order.size() < num_kept_passes) {
+        uint32_t next_pass = GN_INVALID;
+
+        for (uint32_t i = 0; i < num_passes; i++) {
+            const GnRenderGraphPassEntry& pass = render_graph->passes[i];
+
+            if (pass.kept && pass.num_dependencies == 0) {
+                next_pass = i;
+                break;
+            }
+        }
+
+        if (next_pass == GN_INVALID)
+            return GnError_InternalError;
+
+        render_graph->passes[next_pass].num_dependencies = GN_INVALID;
+        render_graph->execution_order.push_back(next_pass);
+
+        for (size_t i = 0; i < render_graph->edges.size(); i++) {
+            const GnRenderGraphEdge& edge = render_graph->edges[i];
+
+            if (edge.src_pass == next_pass && render_graph->passes[edge.dst_pass].kept)
+                render_graph->passes[edge.dst_pass].num_dependencies--;
+        }
+    }
+
+    GnResult result = GnGroupRenderGraphPasses(render_graph);
+
+    if (GN_FAILED(result)) {
+        GnReleaseCompiledRenderGraph(device, render_graph);
+        return result;
+    }
+
+    for (uint32_t i = 0; i < num_resources; i++) {
+        GnRenderGraphResourceEntry& resource = render_graph->resources[i];
+        resource.first_use = GN_INVALID;
+        resource.last_use = GN_INVALID;
+        resource.memory_index = GN_INVALID;
+    }
+
+    // Resources used by a render pass group stay alive during the whole group.
+    for (uint32_t i = 0; i < render_graph->execution_order.size(); i++) {
+        const GnRenderGraphPassEntry& pass = render_graph->passes[render_graph->execution_order[i]];
+        uint32_t first_use = i;
+        uint32_t last_use = i;
+
+        if (pass.render_pass_group != GN_INVALID) {
+            const GnRenderGraphRenderPassGroup& group = render_graph->render_pass_groups[pass.render_pass_group];
+            first_use = group.first_position;
+            last_use = group.first_position + group.num_passes - 1;
+        }
+
+        for (uint32_t j = 0; j < pass.num_accesses; j++) {
+            GnRenderGraphResourceEntry& resource = render_graph->resources[render_graph->accesses[pass.first_access + j].resource];
+
+            if (resource.first_use == GN_INVALID)
+                resource.first_use = first_use;
+
+            resource.last_use = last_use;
+        }
+    }
+
+    result = GnPlaceRenderGraphResources(device, render_graph);
+
+    if (GN_FAILED(result)) {
+        GnReleaseCompiledRenderGraph(device, render_graph);
+        return result;
+    }
+
+    result = GnComputeRenderGraphBarriers(render_graph);
+
+    if (GN_FAILED(result)) {
+        GnReleaseCompiledRenderGraph(device, render_graph);
+        return result;
+    }
+
+    result = GnPrepareRenderGraphRenderPasses(device, render_graph);
+
+    if (GN_FAILED(result)) {
+        GnReleaseCompiledRenderGraph(device, render_graph);
+        return result;
+    }
+
+    render_graph->compiled = true;
+
+    return GnSuccess;
+}
+
+void GnExecuteRenderGraph(GnCommandList command_list, GnRenderGraph render_graph)
+{
+    if (!render_graph->compiled) return;
+
+    for (uint32_t i = 0; i < render_graph->execution_order.size(); i++) {
+        const GnRenderGraphPassEntry& pass = render_graph->passes[render_graph->execution_order[i]];
+        const GnRenderGraphRenderPassGroup* group = nullptr;
+
+        if (pass.render_pass_group != GN_INVALID)
+            group = &render_graph->render_pass_groups[pass.render_pass_group];
+
+        if (pass.subpass == 0) {
+            GnCmdBarrier(command_list,
+                         pass.num_buffer_barriers, render_graph->buffer_barriers.data() + pass.first_buffer_barrier,
+                         pass.num_texture_barriers, render_graph->texture_barriers.data() + pass.first_texture_barrier);
+
+            if (group != nullptr)
+                GnCmdBeginRenderPass(command_list, &group->begin_desc);
+        }
+        else {
+            GnCmdNextSubpass(command_list);
+        }
+
+        if (pass.execute_fn != nullptr)
+            pass.execute_fn(pass.userdata, command_list, render_graph);
+
+        if (group != nullptr && pass.subpass == group->num_passes - 1)
+            GnCmdEndRenderPass(command_list);
+    }
+
+    GnCmdBarrier(command_list,
+                 render_graph->num_final_buffer_barriers,
+                 render_graph->buffer_barriers.data() + render_graph->buffer_barriers.size() - render_graph->num_final_buffer_barriers,
+                 render_graph->num_final_texture_barriers,
+                 render_graph->texture_barriers.data() + render_graph->texture_barriers.size() - render_graph->num_final_texture_barriers);
+}
+
+void GnSetRenderGraphSubpassMerging(GnRenderGraph render_graph, GnBool enable)
+{
+    render_graph->merge_subpasses = enable;
+    render_graph->compiled = false;
+}
+
+GnResult GnGetRenderGraphPassLayout(GnRenderGraph render_graph, uint32_t pass_index, GnRenderGraphPassLayout* layout)
+{
+    if (!render_graph->compiled || pass_index >= render_graph->passes.size())
+        return GnError_InvalidArgs;
+
+    const GnRenderGraphPassEntry& pass = render_graph->passes[pass_index];
+
+    if (!pass.kept || pass.render_pass_group == GN_INVALID)
+        return GnError_InvalidArgs;
+
+    const GnRenderGraphRenderPassGroup& group = render_graph->render_pass_groups[pass.render_pass_group];
+
+    *layout = {};
+    layout->num_color_targets = group.num_color_targets;
+    layout->depth_stencil_target_format = GnFormat_Unknown;
+    layout->sample_count = group.begin_desc.sample_count;
+    layout->num_subpasses = group.begin_desc.num_subpasses;
+    layout->subpasses = group.begin_desc.subpasses;
+    layout->subpass = pass.subpass;
+
+    for (uint32_t i = 0; i < group.num_color_targets; i++)
+        layout->color_target_formats[i] = render_graph->resources[group.color_target_resources[i]].texture_desc.format;
+
+    if (group.depth_stencil_resource != GN_INVALID)
+        layout->depth_stencil_target_format = render_graph->resources[group.depth_stencil_resource].texture_desc.format;
+
+    return GnSuccess;
+}
+
+GnResult GnGetRenderGraphPassInfo(GnRenderGraph render_graph, uint32_t pass_index, GnRenderGraphPassInfo* info)
+{
+    if (!render_graph->compiled || pass_index >= render_graph->passes.size())
+        return GnError_InvalidArgs;
+
+    const GnRenderGraphPassEntry& pass = render_graph->passes[pass_index];
+
+    *info = {};
+    info->execution_position = GN_INVALID;
+
+    if (!pass.kept)
+        return GnSuccess;
+
+    for (uint32_t i = 0; i < render_graph->execution_order.size(); i++) {
+        if (render_graph->execution_order[i] == pass_index) {
+            info->execution_position = i;
+            break;
+        }
+    }
+
+    info->num_buffer_barriers = pass.num_buffer_barriers;
+    info->buffer_barriers = render_graph->buffer_barriers.data() + pass.first_buffer_barrier;
+    info->num_texture_barriers = pass.num_texture_barriers;
+    info->texture_barriers = render_graph->texture_barriers.data() + pass.first_texture_barrier;
 
-GnResult GnCreateBuffer(GnDevice device, const GnBufferDesc* desc, GnBuffer* buffer)
-{
-    return device->CreateBuffer(desc, buffer);
+    return GnSuccess;
 }
 
-void GnDestroyBuffer(GnDevice device, GnBuffer buffer)
+GnTexture GnGetRenderGraphTexture(GnRenderGraph render_graph, GnRenderGraphResource resource)
 {
-    device->DestroyBuffer(buffer);
+    if (resource >= render_graph->resources.size()) return nullptr;
+    return render_graph->resources[resource].texture;
 }
 
-void GnGetBufferDesc(GnBuffer buffer, GnBufferDesc* texture_desc)
+GnBuffer GnGetRenderGraphBuffer(GnRenderGraph render_graph, GnRenderGraphResource resource)
 {
-    *texture_desc = buffer->desc;
+    if (resource >= render_graph->resources.size()) return nullptr;
+    return render_graph->resources[resource].buffer;
 }
 
-void GnGetBufferMemoryRequirements(GnDevice device, GnBuffer buffer, GnMemoryRequirements* memory_requirements)
+GnMemory GnGetRenderGraphResourceMemory(GnRenderGraph render_graph, GnRenderGraphResource resource, GnDeviceSize* offset)
 {
-    *memory_requirements = buffer->memory_requirements;
-}
+    *offset = 0;
 
-GnResult GnBindBufferMemory(GnDevice device, GnBuffer buffer, GnMemory memory, GnDeviceSize aligned_offset)
-{
-    return device->BindBufferMemory(buffer, memory, aligned_offset);
+    if (!render_graph->compiled || resource >= render_graph->resources.size()) return nullptr;
+
+    const GnRenderGraphResourceEntry& entry = render_graph->resources[resource];
+    if (entry.imported || entry.first_use == GN_INVALID) return nullptr;
+
+    *offset = entry.memory_offset;
+    return render_graph->memories[entry.memory_index].memory;
 }
 
-GnResult GnBindBufferDedicatedMemory(GnDevice device, GnBuffer buffer, uint32_t memory_type_index)
+void GnResetRenderGraph(GnDevice device, GnRenderGraph render_graph)
 {
-    return GnResult();
+    GnReleaseCompiledRenderGraph(device, render_graph);
+    render_graph->resources.resize(0);
+    render_graph->passes.resize(0);
+    render_graph->accesses.resize(0);
+    render_graph->color_targets.resize(0);
+    render_graph->depth_stencil_targets.resize(0);
+    render_graph->input_targets.resize(0);
 }
 
-GnResult GnMapBuffer(GnDevice device, GnBuffer buffer, const GnMemoryRange* memory_range, void** mapped_memory)
+// -- [GnResourceTableLayout] --
+
+GnResult GnCreateDescriptorTableLayout(GnDevice device, const GnDescriptorTableLayoutDesc* desc, GnDescriptorTableLayout* descriptor_table_layout)
 {
-    return device->MapBuffer(buffer, memory_range, mapped_memory);
+    return device->CreateDescriptorTableLayout(desc, descriptor_table_layout);
 }
 
-void GnUnmapBuffer(GnDevice device, GnBuffer buffer, const GnMemoryRange* memory_range)
+void GnDestroyDescriptorTableLayout(GnDevice device, GnDescriptorTableLayout descriptor_table_layout)
 {
-    device->UnmapBuffer(buffer, memory_range);
+    device->DestroyDescriptorTableLayout(descriptor_table_layout);
 }
 
-GnResult GnWriteBuffer(GnDevice device, GnBuffer buffer, GnDeviceSize offset, GnDeviceSize size, const void* data)
+// -- [GnPipelineLayout] --
+
+GnResult GnCreatePipelineLayout(GnDevice device, const GnPipelineLayoutDesc* desc, GnPipelineLayout* pipeline_layout)
 {
-    GnMemoryRange memory_range;
-    memory_range.offset = offset;
-    memory_range.size = size;
-    return device->WriteBufferRange(buffer, &memory_range, data);
+    return device->CreatePipelineLayout(desc, pipeline_layout);
 }
 
-GnResult GnWriteBufferRange(GnDevice device, GnBuffer buffer, const GnMemoryRange* memory_range, const void* data)
+void GnDestroyPipelineLayout(GnDevice device, GnPipelineLayout pipeline_layout)
 {
-    return device->WriteBufferRange(buffer, memory_range, data);
+    device->DestroyPipelineLayout(pipeline_layout);
 }
 
-// -- [GnTexture] --
+// -- [GnPipelineCache] --
 
-GnResult GnCreateTexture(GnDevice device, const GnTextureDesc* desc, GnTexture* texture)
+GnResult GnCreatePipelineCache(GnDevice device, const GnPipelineCacheDesc* desc, GnPipelineCache* pipeline_cache)
 {
-    return device->CreateTexture(desc, texture);
+    if (desc == nullptr || pipeline_cache == nullptr) return GnError_InvalidArgs;
+    return device->CreatePipelineCache(desc, pipeline_cache);
 }
 
-void GnDestroyTexture(GnDevice device, GnTexture texture)
+void GnDestroyPipelineCache(GnDevice device, GnPipelineCache pipeline_cache)
 {
-    device->DestroyTexture(texture);
+    device->DestroyPipelineCache(pipeline_cache);
 }
 
-void GnGetTextureDesc(GnTexture texture, GnTextureDesc* texture_desc)
+GnResult GnGetPipelineCacheData(GnDevice device, GnPipelineCache pipeline_cache, size_t* data_size, void* data)
 {
-    *texture_desc = texture->desc;
+    if (pipeline_cache == nullptr || data_size == nullptr) return GnError_InvalidArgs;
+    return device->GetPipelineCacheData(pipeline_cache, data_size, data);
 }
 
-void GnGetTextureMemoryRequirements(GnDevice device, GnTexture texture, GnMemoryRequirements* memory_requirements)
+GnResult GnMergePipelineCaches(GnDevice device, GnPipelineCache dst_cache, uint32_t num_src_caches, const GnPipelineCache* src_caches)
 {
+    if (dst_cache == nullptr || (num_src_caches > 0 && src_caches == nullptr)) return GnError_InvalidArgs;
+
+    for (uint32_t i = 0; i < num_src_caches; i++)
+        if (src_caches[i] == dst_cache) return GnError_InvalidArgs;
+
+    if (num_src_caches == 0) return GnSuccess;
+
+    return device->MergePipelineCaches(dst_cache, num_src_caches, src_caches);
 }
 
-// -- [GnTextureView] --
+// -- [GnPipeline] --
 
-bool GnValidateCreateTextureViewParam(GnDevice device, const GnTextureViewDesc* desc, GnTextureView* texture_view)
+struct GnDefaultGraphicsPipelineStates
 {
-    return true;
-}
+    GnMultisampleStateDesc      multisample;
+    GnColorTargetBlendStateDesc color_blend_state;
+    GnBlendStateDesc            blend;
 
-GnResult GnCreateTextureView(GnDevice device, const GnTextureViewDesc* desc, GnTextureView* texture_view)
+    GnDefaultGraphicsPipelineStates() noexcept
+    {
+        multisample.num_samples = GnSampleCount_X1;
+        multisample.sample_mask = 0;
+        multisample.alpha_to_coverage = GN_FALSE;
+
+        color_blend_state.blend_enable = GN_FALSE;
+        color_blend_state.src_color_blend_factor = GnBlendFactor_One;
+        color_blend_state.dst_color_blend_factor = GnBlendFactor_Zero;
+        color_blend_state.color_blend_op = GnBlendOp_Add;
+        color_blend_state.src_alpha_blend_factor = GnBlendFactor_One;
+        color_blend_state.dst_alpha_blend_factor = GnBlendFactor_Zero;
+        color_blend_state.alpha_blend_op = GnBlendOp_Add;
+        color_blend_state.color_write_mask = GnColorComponent_All;
+
+        blend.independent_blend = false;
+        blend.num_blend_states = 1;
+        blend.blend_states = &color_blend_state;
+    }
+};
+
+inline static void GnApplyDefaultGraphicsPipelineStates(GnGraphicsPipelineDesc* desc) noexcept
 {
-    if (!GnValidateCreateTextureViewParam(device, desc, texture_view)) return GnError_InvalidArgs;
-    return device->CreateTextureView(desc, texture_view);
+    static const GnDefaultGraphicsPipelineStates default_states;
+
+    if (desc->multisample == nullptr)
+        desc->multisample = &default_states.multisample;
+
+    // When blend is NULL, we provide the default values for the color blend state
+    if (desc->blend == nullptr)
+        desc->blend = &default_states.blend;
 }
 
-void GnDestroyTextureView(GnDevice device, GnTextureView texture_view)
+// Hands out the pipeline kept by the dedup table, destroying the new one when an identical pipeline got there first.
+inline static GnPipeline GnAddDeduplicatedPipeline(GnDevice device, uint64_t hash, const uint8_t* key_data, size_t key_size, GnPipeline pipeline) noexcept
 {
-    device->DestroyTextureView(texture_view);
-}
+    GnPipeline shared_pipeline = device->pipeline_dedup_table.Insert(hash, key_data, key_size, pipeline);
 
-// -- [GnRenderGraph] --
+    if (shared_pipeline != pipeline)
+        device->DestroyPipeline(pipeline);
 
-GnResult GnCreateRenderGraph(GnDevice device, const GnRenderGraphDesc* desc, GnRenderGraph* render_graph)
-{
-    return device->CreateRenderGraph(desc, render_graph);
+    return shared_pipeline;
 }
 
-void GnDestroyRenderGraph(GnDevice device, GnRenderGraph render_graph)
+GnResult GnCreateGraphicsPipeline(GnDevice device, const GnGraphicsPipelineDesc* desc, GnPipeline* graphics_pipeline)
 {
-    device->DestroyRenderGraph(render_graph);
-}
+    GnGraphicsPipelineDesc tmp_desc = *desc;
+    GnApplyDefaultGraphicsPipelineStates(&tmp_desc);
 
-// -- [GnResourceTableLayout] --
+    if (!device->pipeline_deduplication)
+        return device->CreateGraphicsPipeline(&tmp_desc, graphics_pipeline);
 
-GnResult GnCreateDescriptorTableLayout(GnDevice device, const GnDescriptorTableLayoutDesc* desc, GnDescriptorTableLayout* descriptor_table_layout)
-{
-    return device->CreateDescriptorTableLayout(desc, descriptor_table_layout);
+    GnPipelineDedupTable& dedup_table = device->pipeline_dedup_table;
+    GnVector<uint8_t> key_data;
+
+    if (!GnPipelineDedupTable::WriteKey(&tmp_desc, key_data)) return GnError_OutOfHostMemory;
+
+    uint64_t hash = GnHashBytes64(key_data.data(), key_data.size());
+    GnPipeline pipeline = dedup_table.Acquire(hash, key_data.data(), key_data.size());
+
+    if (pipeline == nullptr) {
+        GnResult result = device->CreateGraphicsPipeline(&tmp_desc, &pipeline);
+        if (GN_FAILED(result)) return result;
+
+        pipeline = GnAddDeduplicatedPipeline(device, hash, key_data.data(), key_data.size(), pipeline);
+    }
+
+    *graphics_pipeline = pipeline;
+
+    return GnSuccess;
 }
 
-void GnDestroyDescriptorTableLayout(GnDevice device, GnDescriptorTableLayout descriptor_table_layout)
+// Batched creation of pipelines whose default states are already applied.
+inline static GnResult GnCreateGraphicsPipelinesBatched(GnDevice device, uint32_t num_pipelines, const GnGraphicsPipelineDesc* descs, GnPipeline* graphics_pipelines, GnResult* results) noexcept
 {
-    device->DestroyDescriptorTableLayout(descriptor_table_layout);
-}
+    GnResult result = device->CreateGraphicsPipelines(num_pipelines, descs, graphics_pipelines, results);
 
-// -- [GnPipelineLayout] --
+    if (result != GnError_Unimplemented)
+        return result;
 
-GnResult GnCreatePipelineLayout(GnDevice device, const GnPipelineLayoutDesc* desc, GnPipelineLayout* pipeline_layout)
+    // The backend has no batched path, create them one by one.
+    result = GnSuccess;
+
+    for (uint32_t i = 0; i < num_pipelines; i++) {
+        GnResult pipeline_result = device->CreateGraphicsPipeline(&descs[i], &graphics_pipelines[i]);
+
+        if (GN_FAILED(pipeline_result)) {
+            graphics_pipelines[i] = nullptr;
+
+            if (result == GnSuccess)
+                result = pipeline_result;
+        }
+
+        if (results != nullptr)
+            results[i] = pipeline_result;
+    }
+
+    return result;
+}
+
+GnResult GnCreateGraphicsPipelines(GnDevice device, uint32_t num_pipelines, const GnGraphicsPipelineDesc* descs, GnPipeline* graphics_pipelines, GnResult* results)
 {
-    return device->CreatePipelineLayout(desc, pipeline_layout);
+    if (num_pipelines == 0) return GnSuccess;
+
+    GN_DBG_ASSERT(descs != nullptr && graphics_pipelines != nullptr);
+
+    if (descs == nullptr || graphics_pipelines == nullptr) return GnError_InvalidArgs;
+
+    GnSmallVector<GnGraphicsPipelineDesc, 16> tmp_descs;
+
+    if (!tmp_descs.resize(num_pipelines)) return GnError_OutOfHostMemory;
+
+    for (uint32_t i = 0; i < num_pipelines; i++) {
+        tmp_descs[i] = descs[i];
+        GnApplyDefaultGraphicsPipelineStates(&tmp_descs[i]);
+    }
+
+    if (!device->pipeline_deduplication)
+        return GnCreateGraphicsPipelinesBatched(device, num_pipelines, tmp_descs.storage, graphics_pipelines, results);
+
+    GnPipelineDedupTable& dedup_table = device->pipeline_dedup_table;
+    GnVector<uint8_t> key_data;
+    GnSmallVector<size_t, 16> key_offsets;
+    GnSmallVector<uint64_t, 16> key_hashes;
+    GnSmallVector<uint32_t, 16> miss_indices;
+    GnSmallVector<GnPipeline, 16> miss_pipelines;
+    GnSmallVector<GnResult, 16> miss_results;
+
+    if (!(key_offsets.resize(num_pipelines + 1) && key_hashes.resize(num_pipelines) && miss_indices.resize(num_pipelines)))
+        return GnError_OutOfHostMemory;
+
+    for (uint32_t i = 0; i < num_pipelines; i++) {
+        key_offsets[i] = key_data.size();
+
+        if (!GnPipelineDedupTable::WriteKey(&tmp_descs[i], key_data))
+            return GnError_OutOfHostMemory;
+    }
+
+    key_offsets[num_pipelines] = key_data.size();
+
+    // Only pipelines missing from the table are compiled, still as a single batch. Their descriptions are moved to
+    // the front of tmp_descs.
+    uint32_t num_misses = 0;
+
+    for (uint32_t i = 0; i < num_pipelines; i++) {
+        const uint8_t* key = key_data.data() + key_offsets[i];
+        size_t key_size = key_offsets[i + 1] - key_offsets[i];
+
+        key_hashes[i] = GnHashBytes64(key, key_size);
+        graphics_pipelines[i] = dedup_table.Acquire(key_hashes[i], key, key_size);
+
+        if (results != nullptr)
+            results[i] = GnSuccess;
+
+        if (graphics_pipelines[i] == nullptr) {
+            miss_indices[num_misses] = i;
+            tmp_descs[num_misses++] = tmp_descs[i];
+        }
+    }
+
+    if (num_misses == 0)
+        return GnSuccess;
+
+    if (!(miss_pipelines.resize(num_misses) && miss_results.resize(num_misses)))
+        return GnError_OutOfHostMemory;
+
+    // The backend may bail out before touching these when it runs out of memory.
+    for (uint32_t i = 0; i < num_misses; i++) {
+        miss_pipelines[i] = nullptr;
+        miss_results[i] = GnError_OutOfHostMemory;
+    }
+
+    GnResult result = GnCreateGraphicsPipelinesBatched(device, num_misses, tmp_descs.storage, miss_pipelines.storage, miss_results.storage);
+
+    for (uint32_t i = 0; i < num_misses; i++) {
+        uint32_t index = miss_indices[i];
+
+        if (miss_pipelines[i] == nullptr) {
+            if (results != nullptr)
+                results[index] = miss_results[i];
+
+            continue;
+        }
+
+        graphics_pipelines[index] = GnAddDeduplicatedPipeline(device, key_hashes[index],
+                                                              key_data.data() + key_offsets[index],
+                                                              key_offsets[index + 1] - key_offsets[index],
+                                                              miss_pipelines[i]);
+    }
+
+    return result;
 }
 
-void GnDestroyPipelineLayout(GnDevice device, GnPipelineLayout pipeline_layout)
+// Copies the description and everything it points to into storage, so that it outlives the caller's data.
+inline static bool GnCopyGraphicsPipelineDesc(const GnGraphicsPipelineDesc* src, GnGraphicsPipelineDesc* dst, GnVector<uint8_t>& storage) noexcept
 {
-    device->DestroyPipelineLayout(pipeline_layout);
+    uint8_t* base = nullptr;
+    size_t offset = 0;
+
+    // The first pass only measures, the second pass copies.
+    auto copy = [&base, &offset](const void* data, size_t size) -> void* {
+        void* copied = base != nullptr ? base + offset : nullptr;
+
+        if (copied != nullptr && size > 0)
+            std::memcpy(copied, data, size);
+
+        offset += (size + 7) & ~(size_t)7;
+
+        return copied;
+    };
+
+    auto copy_shader = [&copy](const GnShaderBytecode* shader) -> const GnShaderBytecode* {
+        GnShaderBytecode tmp_shader;
+        tmp_shader.size = shader->size;
+        tmp_shader.bytecode = copy(shader->bytecode, shader->size);
+        tmp_shader.entry_point = (const char*)copy(shader->entry_point, std::strlen(shader->entry_point) + 1);
+        return (const GnShaderBytecode*)copy(&tmp_shader, sizeof(tmp_shader));
+    };
+
+    for (uint32_t pass = 0; pass < 2; pass++) {
+        *dst = *src;
+        dst->vs = copy_shader(src->vs);
+        dst->fs = copy_shader(src->fs);
+
+        GnVertexInputStateDesc vertex_input = *src->vertex_input;
+        vertex_input.input_slots = (const GnVertexInputSlotDesc*)copy(vertex_input.input_slots, vertex_input.num_input_slots * sizeof(GnVertexInputSlotDesc));
+        vertex_input.attributes = (const GnVertexInputAttributeDesc*)copy(vertex_input.attributes, vertex_input.num_attributes * sizeof(GnVertexInputAttributeDesc));
+        dst->vertex_input = (const GnVertexInputStateDesc*)copy(&vertex_input, sizeof(vertex_input));
+
+        dst->input_assembly = (const GnInputAssemblyStateDesc*)copy(src->input_assembly, sizeof(GnInputAssemblyStateDesc));
+        dst->rasterization = (const GnRasterizationStateDesc*)copy(src->rasterization, sizeof(GnRasterizationStateDesc));
+        dst->multisample = (const GnMultisampleStateDesc*)copy(src->multisample, sizeof(GnMultisampleStateDesc));
+
+        GnFragmentInterfaceStateDesc fragment_interface = *src->fragment_interface;
+        fragment_interface.color_target_formats = (GnFormat*)copy(fragment_interface.color_target_formats, fragment_interface.num_color_targets * sizeof(GnFormat));
+        dst->fragment_interface = (const GnFragmentInterfaceStateDesc*)copy(&fragment_interface, sizeof(fragment_interface));
+
+        if (src->depth_stencil != nullptr)
+            dst->depth_stencil = (const GnDepthStencilStateDesc*)copy(src->depth_stencil, sizeof(GnDepthStencilStateDesc));
+
+        GnBlendStateDesc blend = *src->blend;
+        blend.blend_states = (const GnColorTargetBlendStateDesc*)copy(blend.blend_states, blend.num_blend_states * sizeof(GnColorTargetBlendStateDesc));
+        dst->blend = (const GnBlendStateDesc*)copy(&blend, sizeof(blend));
+
+        // Too many subpasses fails validation later, before the subpasses are read.
+        if (src->num_subpasses > 0 && src->num_subpasses <= GN_MAX_SUBPASSES) {
+            GnRenderPassSubpassDesc subpasses[GN_MAX_SUBPASSES];
+
+            for (uint32_t i = 0; i < src->num_subpasses; i++) {
+                subpasses[i] = src->subpasses[i];
+                subpasses[i].color_targets = (const uint32_t*)copy(subpasses[i].color_targets, subpasses[i].num_color_targets * sizeof(uint32_t));
+                subpasses[i].input_targets = (const uint32_t*)copy(subpasses[i].input_targets, subpasses[i].num_input_targets * sizeof(uint32_t));
+            }
+
+            dst->subpasses = (const GnRenderPassSubpassDesc*)copy(subpasses, src->num_subpasses * sizeof(GnRenderPassSubpassDesc));
+        }
+        else {
+            dst->subpasses = nullptr;
+        }
+
+        if (pass == 0) {
+            if (!storage.resize(offset))
+                return false;
+
+            base = storage.data();
+            offset = 0;
+        }
+    }
+
+    return true;
 }
 
-GnResult GnCreateGraphicsPipeline(GnDevice device, const GnGraphicsPipelineDesc* desc, GnPipeline* graphics_pipeline)
+GnResult GnCreateGraphicsPipelineAsync(GnDevice device, const GnGraphicsPipelineDesc* desc, GnPipeline fallback_pipeline, GnPipeline* graphics_pipeline)
 {
+    if (desc == nullptr || graphics_pipeline == nullptr) return GnError_InvalidArgs;
+
     GnGraphicsPipelineDesc tmp_desc = *desc;
-    GnMultisampleStateDesc default_multisample_desc;
+    GnApplyDefaultGraphicsPipelineStates(&tmp_desc);
 
-    if (tmp_desc.multisample == nullptr) {
-        default_multisample_desc.num_samples = GnSampleCount_X1;
-        default_multisample_desc.sample_mask = 0;
-        default_multisample_desc.alpha_to_coverage = GN_FALSE;
+    GnPipelineCompileJob job;
 
-        tmp_desc.multisample = &default_multisample_desc;
-    }
+    if (!GnCopyGraphicsPipelineDesc(&tmp_desc, &job.desc, job.storage)) return GnError_OutOfHostMemory;
 
-    GnColorTargetBlendStateDesc default_color_blend_state;
-    GnBlendStateDesc default_blend_state;
+    GnPipeline pipeline;
+    GnResult result = device->CreatePendingPipeline(GnPipelineType_Graphics, &pipeline);
+    if (GN_FAILED(result)) return result;
 
-    // When blend is NULL, we provide the default values for the color blend state
-    if (tmp_desc.blend == nullptr) {
-        default_color_blend_state.blend_enable = GN_FALSE;
-        default_color_blend_state.src_color_blend_factor = GnBlendFactor_One;
-        default_color_blend_state.dst_color_blend_factor = GnBlendFactor_Zero;
-        default_color_blend_state.color_blend_op = GnBlendOp_Add;
-        default_color_blend_state.src_alpha_blend_factor = GnBlendFactor_One;
-        default_color_blend_state.dst_alpha_blend_factor = GnBlendFactor_Zero;
-        default_color_blend_state.alpha_blend_op = GnBlendOp_Add;
-        default_color_blend_state.color_write_mask = GnColorComponent_All;
+    pipeline->fallback_pipeline = fallback_pipeline;
+    job.pipeline = pipeline;
 
-        default_blend_state.independent_blend = false;
-        default_blend_state.num_blend_states = 1;
-        default_blend_state.blend_states = &default_color_blend_state;
+    result = device->pipeline_compiler.Enqueue(device, std::move(job));
 
-        tmp_desc.blend = &default_blend_state;
+    if (GN_FAILED(result)) {
+        device->DestroyPipeline(pipeline);
+        return result;
     }
 
-    return device->CreateGraphicsPipeline(&tmp_desc, graphics_pipeline);
+    *graphics_pipeline = pipeline;
+
+    return GnSuccess;
+}
+
+GnResult GnGetPipelineStatus(GnPipeline pipeline)
+{
+    return pipeline->status.load(std::memory_order_acquire);
 }
 
 GnResult GnCreateComputePipeline(GnDevice device, const GnComputePipelineDesc* desc, GnPipeline* compute_pipeline)
@@ -1072,16 +4469,25 @@ GnResult GnCreateComputePipeline(GnDevice device, const GnComputePipelineDesc* d
 
 GnResult GnCreateGraphicsPipelineFromStream(GnDevice device, const GnPipelineStreamDesc* desc, GnPipeline* graphics_pipeline)
 {
-    return GnResult();
+    if (desc->stream_size > 0 && desc->stream_data == nullptr) return GnError_InvalidArgs;
+    return device->CreateGraphicsPipelineFromStream(desc, graphics_pipeline);
 }
 
 GnResult GnCreateComputePipelineFromStream(GnDevice device, const GnPipelineStreamDesc* desc, GnPipeline* compute_pipeline)
 {
-    return GnResult();
+    if (desc->stream_size > 0 && desc->stream_data == nullptr) return GnError_InvalidArgs;
+    return device->CreateComputePipelineFromStream(desc, compute_pipeline);
 }
 
 void GnDestroyPipeline(GnDevice device, GnPipeline pipeline)
 {
+    // Shared pipelines stay alive until their last reference is released.
+    if (!device->pipeline_dedup_table.Release(pipeline)) return;
+
+    if (pipeline->status.load(std::memory_order_acquire) == GnNotReady)
+        device->pipeline_compiler.Cancel(pipeline);
+
+    if (GnDeferDestroy(device, GnDeferredObjectType_Pipeline, pipeline)) return;
     device->DestroyPipeline(pipeline);
 }
 
@@ -1090,13 +4496,80 @@ GnPipelineType GnGetPipelineType(GnPipeline pipeline)
     return pipeline->type;
 }
 
+void GnSetDevicePipelineDeduplication(GnDevice device, GnBool enable)
+{
+    device->pipeline_deduplication = enable;
+}
+
+void GnGetPipelineDeduplicationStats(GnDevice device, GnPipelineDeduplicationStats* stats)
+{
+    GnPipelineDedupTable& dedup_table = device->pipeline_dedup_table;
+    std::scoped_lock lock(dedup_table.mutex);
+
+    stats->num_hits = dedup_table.num_hits;
+    stats->num_misses = dedup_table.num_misses;
+    stats->num_pipelines = (uint32_t)dedup_table.entries.size();
+}
+
+void GnGetShaderModuleCacheStats(GnDevice device, GnShaderModuleCacheStats* stats)
+{
+    device->GetShaderModuleCacheStats(stats);
+}
+
 GnResult GnCreateDescriptorPool(GnDevice device, const GnDescriptorPoolDesc* desc, GnDescriptorPool* descriptor_pool)
 {
-    return GnResult();
+    if (desc == nullptr || descriptor_pool == nullptr || desc->max_descriptor_tables == 0)
+        return GnError_InvalidArgs;
+
+    return device->CreateDescriptorPool(desc, descriptor_pool);
 }
 
 void GnDestroyDescriptorPool(GnDevice device, GnDescriptorPool descriptor_pool)
 {
+    device->DestroyDescriptorPool(descriptor_pool);
+}
+
+GnResult GnResetDescriptorPool(GnDevice device, GnDescriptorPool descriptor_pool)
+{
+    return device->ResetDescriptorPool(descriptor_pool);
+}
+
+GnResult GnAllocateDescriptorTables(GnDevice device, GnDescriptorPool descriptor_pool, uint32_t num_descriptor_tables, const GnDescriptorTableLayout* layouts, GnDescriptorTable* descriptor_tables)
+{
+    if (num_descriptor_tables == 0)
+        return GnSuccess;
+
+    if (layouts == nullptr || descriptor_tables == nullptr)
+        return GnError_InvalidArgs;
+
+    return device->AllocateDescriptorTables(descriptor_pool, num_descriptor_tables, layouts, descriptor_tables);
+}
+
+void GnFreeDescriptorTables(GnDevice device, GnDescriptorPool descriptor_pool, uint32_t num_descriptor_tables, const GnDescriptorTable* descriptor_tables)
+{
+    if (descriptor_pool->mode == GnDescriptorPoolMode_Linear || num_descriptor_tables == 0)
+        return;
+
+    device->FreeDescriptorTables(descriptor_pool, num_descriptor_tables, descriptor_tables);
+}
+
+GnResult GnUpdateDescriptorTables(GnDevice device, uint32_t num_writes, const GnDescriptorTableWrite* writes)
+{
+    if (num_writes == 0)
+        return GnSuccess;
+
+    if (writes == nullptr)
+        return GnError_InvalidArgs;
+
+    return device->UpdateDescriptorTables(num_writes, writes);
+}
+
+GnResult GnWriteDescriptorTable(GnDevice device, GnDescriptorTable descriptor_table, const GnDescriptorInfo* descriptors)
+{
+    if (descriptor_table == nullptr || descriptors == nullptr)
+        return GnError_InvalidArgs;
+
+    return device->WriteDescriptorTable(descriptor_table, descriptors);
 }
 
 GnResult GnCreateCommandPool(GnDevice device, const GnCommandPoolDesc* desc, GnCommandPool* command_pool)
@@ -1139,8 +4612,27 @@ GnResult GnBeginCommandList(GnCommandList command_list, const GnCommandListBegin
         implicit_desc.inheritance = nullptr;
     }
 
+    if (desc == nullptr)
+        desc = &implicit_desc;
+
+    command_list->track_resource_state = GnHasBit(desc->flags, GnCommandListBegin_TrackResourceState);
+
+    if (command_list->track_resource_state) {
+        if (command_list->state_tracker == nullptr) {
+            command_list->state_tracker = new(std::nothrow) GnResourceStateTracker();
+
+            if (command_list->state_tracker == nullptr) {
+                command_list->track_resource_state = false;
+                return GnError_OutOfHostMemory;
+            }
+        }
+
+        command_list->state_tracker->Reset();
+    }
+
     command_list->recording = true;
-    return command_list->Begin(desc != nullptr ? desc : &implicit_desc);
+    command_list->skip_draws = false;
+    return command_list->Begin(desc);
 }
 
 GnResult GnEndCommandList(GnCommandList command_list)
@@ -1165,6 +4657,19 @@ void GnCmdSetDescriptorPool(GnCommandList command_list, uint32_t num_descriptor_
 
 void GnCmdSetGraphicsPipeline(GnCommandList command_list, GnPipeline graphics_pipeline)
 {
+    // A pipeline still compiling is replaced by its fallback. Without a usable fallback, draws are skipped until a
+    // ready pipeline is set.
+    if (graphics_pipeline != nullptr && graphics_pipeline->status.load(std::memory_order_acquire) != GnSuccess) {
+        graphics_pipeline = graphics_pipeline->fallback_pipeline;
+
+        if (graphics_pipeline == nullptr || graphics_pipeline->status.load(std::memory_order_acquire) != GnSuccess) {
+            command_list->skip_draws = true;
+            return;
+        }
+    }
+
+    command_list->skip_draws = false;
+
     if (graphics_pipeline == command_list->state.graphics.pipeline) return;
     command_list->state.graphics.pipeline = graphics_pipeline;
     command_list->state.update_flags.graphics_pipeline = true;
@@ -1181,6 +4686,7 @@ void GnCmdSetGraphicsDescriptorTable(GnCommandList command_list, uint32_t slot,
 {
     if (descriptor_table == command_list->state.graphics.descriptor_tables[slot]) return;
     command_list->state.graphics.descriptor_tables[slot] = descriptor_table;
+    command_list->state.graphics.descriptor_tables_upd_range.Update(slot);
     command_list->state.update_flags.graphics_resource_binding = true;
 }
 
@@ -1356,6 +4862,11 @@ void GnCmdBeginRenderPass(GnCommandList command_list, const GnRenderPassBeginDes
     command_list->inside_render_pass = true;
 }
 
+void GnCmdNextSubpass(GnCommandList command_list)
+{
+    command_list->NextSubpass();
+}
+
 void GnCmdEndRenderPass(GnCommandList command_list)
 {
     command_list->EndRenderPass();
@@ -1364,12 +4875,16 @@ void GnCmdEndRenderPass(GnCommandList command_list)
 
 void GnCmdDraw(GnCommandList command_list, uint32_t num_vertices, uint32_t first_vertex)
 {
+    if (command_list->skip_draws) return;
+    if (command_list->track_resource_state) GnTrackDrawResources(command_list, false);
     if (command_list->state.graphics_state_updated()) command_list->flush_gfx_state_fn(command_list);
     command_list->draw_cmd_fn(command_list->cmd_private_data, num_vertices, 1, first_vertex, 0);
 }
 
 void GnCmdDrawInstanced(GnCommandList command_list, uint32_t num_vertices, uint32_t num_instances, uint32_t first_vertex, uint32_t first_instance)
 {
+    if (command_list->skip_draws) return;
+    if (command_list->track_resource_state) GnTrackDrawResources(command_list, false);
     if (command_list->state.graphics_state_updated()) command_list->flush_gfx_state_fn(command_list);
     command_list->draw_cmd_fn(command_list->cmd_private_data, num_vertices, num_instances, first_vertex, first_instance);
 }
@@ -1381,12 +4896,16 @@ void GnCmdDrawIndirect(GnCommandList command_list, GnBuffer indirect_buffer, GnD
 
 void GnCmdDrawIndexed(GnCommandList command_list, uint32_t num_indices, uint32_t first_index, int32_t vertex_offset)
 {
+    if (command_list->skip_draws) return;
+    if (command_list->track_resource_state) GnTrackDrawResources(command_list, true);
     if (command_list->state.graphics_state_updated()) command_list->flush_gfx_state_fn(command_list);
     command_list->draw_indexed_cmd_fn(command_list->cmd_private_data, num_indices, 1, first_index, vertex_offset, 0);
 }
 
 void GnCmdDrawIndexedInstanced(GnCommandList command_list, uint32_t num_indices, uint32_t first_index, uint32_t num_instances, int32_t vertex_offset, uint32_t first_instance)
 {
+    if (command_list->skip_draws) return;
+    if (command_list->track_resource_state) GnTrackDrawResources(command_list, true);
     if (command_list->state.graphics_state_updated()) command_list->flush_gfx_state_fn(command_list);
     command_list->draw_indexed_cmd_fn(command_list->cmd_private_data, num_indices, first_index, num_instances, vertex_offset, first_instance);
 }
@@ -1414,6 +4933,7 @@ void GnCmdSetComputeDescriptorTable(GnCommandList command_list, uint32_t slot, G
 {
     if (descriptor_table == command_list->state.compute.descriptor_tables[slot]) return;
     command_list->state.compute.descriptor_tables[slot] = descriptor_table;
+    command_list->state.compute.descriptor_tables_upd_range.Update(slot);
     command_list->state.update_flags.compute_resource_binding = true;
 }
 
@@ -1437,6 +4957,9 @@ void GnCmdSetComputeShaderConstants(GnCommandList command_list, uint32_t offset,
 
 void GnCmdDispatch(GnCommandList command_list, uint32_t num_thread_group_x, uint32_t num_thread_group_y, uint32_t num_thread_group_z)
 {
+    if (command_list->track_resource_state)
+        GnTrackBoundBuffers(command_list, command_list->state.compute, GnResourceAccess_CSUniformBuffer, GnResourceAccess_CSRead | GnResourceAccess_CSWrite);
+
     if (command_list->state.compute_state_updated()) command_list->flush_compute_state_fn(command_list);
     command_list->dispatch_cmd_fn(command_list->cmd_private_data, num_thread_group_x, num_thread_group_y, num_thread_group_z);
 }
@@ -1448,41 +4971,113 @@ void GnCmdDispatchIndirect(GnCommandList command_list, GnBuffer indirect_buffer,
 
 void GnCmdCopyBuffer(GnCommandList command_list, GnBuffer src_buffer, GnDeviceSize src_offset, GnBuffer dst_buffer, GnDeviceSize dst_offset, GnDeviceSize size)
 {
+    if (command_list->track_resource_state) {
+        GnTrackBufferAccess(command_list, src_buffer, GnResourceAccess_Undefined, GnResourceAccess_CopySrc, true);
+        GnTrackBufferAccess(command_list, dst_buffer, GnResourceAccess_Undefined, GnResourceAccess_CopyDst, true);
+    }
+
     command_list->CopyBuffer(src_buffer, src_offset, dst_buffer, dst_offset, size);
 }
 
-void GnCmdCopyTexture(GnCommandList command_list, GnTexture src_texture, GnTexture dst_texture)
+void GnCmdCopyTexture(GnCommandList command_list, GnTexture src_texture, GnResourceAccessFlags src_texture_access, GnOffset3 src_offset, GnTexture dst_texture, GnResourceAccessFlags dst_texture_access, GnOffset3 dst_offset, GnExtent3 extent)
 {
+    if (command_list->track_resource_state) {
+        GnTextureSubresourceRange subresource_range;
+        subresource_range.base_mip_level = 0;
+        subresource_range.num_mip_levels = 1;
+        subresource_range.base_array_layer = 0;
+        subresource_range.num_array_layers = 1;
+
+        subresource_range.aspect = GnIsColorFormat(src_texture->desc.format) ? GnTextureAspect_Color : GnTextureAspect_Depth;
+        GnTrackTextureAccess(command_list, src_texture, subresource_range, src_texture_access, GnResourceAccess_CopySrc, true);
+
+        subresource_range.aspect = GnIsColorFormat(dst_texture->desc.format) ? GnTextureAspect_Color : GnTextureAspect_Depth;
+        GnTrackTextureAccess(command_list, dst_texture, subresource_range, dst_texture_access, GnResourceAccess_CopyDst, true);
+
+        src_texture_access = GnResourceAccess_CopySrc;
+        dst_texture_access = GnResourceAccess_CopyDst;
+    }
+
+    command_list->CopyTexture(src_texture, src_offset, src_texture_access, dst_texture, dst_offset, dst_texture_access, extent);
 }
 
 void GnCmdCopyBufferToTexture(GnCommandList command_list, GnBuffer src_buffer, GnTexture dst_texture)
 {
 }
 
-void GnCmdCopyTextureToBuffer(GnCommandList command_list, GnTexture src_texture, GnBuffer dst_buffer)
+void GnCmdCopyTextureToBuffer(GnCommandList command_list, GnTexture src_texture, GnResourceAccessFlags src_texture_access, GnBuffer dst_buffer)
 {
+    if (command_list->track_resource_state) {
+        GnTextureSubresourceRange subresource_range;
+        subresource_range.aspect = GnIsColorFormat(src_texture->desc.format) ? GnTextureAspect_Color : GnTextureAspect_Depth;
+        subresource_range.base_mip_level = 0;
+        subresource_range.num_mip_levels = 1;
+        subresource_range.base_array_layer = 0;
+        subresource_range.num_array_layers = src_texture->desc.array_layers;
+
+        GnTrackTextureAccess(command_list, src_texture, subresource_range, src_texture_access, GnResourceAccess_CopySrc, true);
+        GnTrackBufferAccess(command_list, dst_buffer, GnResourceAccess_Undefined, GnResourceAccess_CopyDst, true);
+        src_texture_access = GnResourceAccess_CopySrc;
+    }
+
+    command_list->CopyTextureToBuffer(src_texture, src_texture_access, dst_buffer);
 }
 
 void GnCmdBlitTexture(GnCommandList command_list, GnTexture src_texture, GnTexture dst_texture)
 {
 }
 
+// Keeps the tracked state in sync when explicit barriers are recorded into a tracked command list.
+static void GnTrackExplicitBarriers(GnCommandList command_list, uint32_t num_buffer_barriers, const GnBufferBarrier* buffer_barriers, uint32_t num_texture_barriers, const GnTextureBarrier* texture_barriers) noexcept
+{
+    for (uint32_t i = 0; i < num_buffer_barriers; i++) {
+        const GnBufferBarrier& barrier = buffer_barriers[i];
+        GnTrackBufferAccess(command_list, barrier.buffer, barrier.prev_access, barrier.next_access, false);
+    }
+
+    for (uint32_t i = 0; i < num_texture_barriers; i++) {
+        const GnTextureBarrier& barrier = texture_barriers[i];
+        GnTrackTextureAccess(command_list, barrier.texture, barrier.subresource_range, barrier.prev_access, barrier.next_access, false);
+    }
+}
+
 void GnCmdBarrier(GnCommandList command_list, uint32_t num_buffer_barriers, const GnBufferBarrier* buffer_barriers, uint32_t num_texture_barriers, const GnTextureBarrier* texture_barriers)
 {
+    if (command_list->track_resource_state)
+        GnTrackExplicitBarriers(command_list, num_buffer_barriers, buffer_barriers, num_texture_barriers, texture_barriers);
+
     if (num_buffer_barriers > 0 || num_texture_barriers > 0)
         command_list->Barrier(num_buffer_barriers, buffer_barriers, num_texture_barriers, texture_barriers);
 }
 
 void GnCmdBufferBarrier(GnCommandList command_list, uint32_t num_barriers, const GnBufferBarrier* barriers)
 {
+    if (command_list->track_resource_state)
+        GnTrackExplicitBarriers(command_list, num_barriers, barriers, 0, nullptr);
+
     if (num_barriers > 0) command_list->Barrier(num_barriers, barriers, 0, nullptr);
 }
 
 void GnCmdTextureBarrier(GnCommandList command_list, uint32_t num_barriers, const GnTextureBarrier* barriers)
 {
+    if (command_list->track_resource_state)
+        GnTrackExplicitBarriers(command_list, 0, nullptr, num_barriers, barriers);
+
     if (num_barriers > 0) command_list->Barrier(0, nullptr, num_barriers, barriers);
 }
 
+void GnCmdTransitionBuffer(GnCommandList command_list, GnBuffer buffer, GnResourceAccessFlags next_access)
+{
+    if (command_list->track_resource_state)
+        GnTrackBufferAccess(command_list, buffer, GnResourceAccess_Undefined, next_access, true);
+}
+
+void GnCmdTransitionTexture(GnCommandList command_list, GnTexture texture, const GnTextureSubresourceRange* subresource_range, GnResourceAccessFlags next_access)
+{
+    if (command_list->track_resource_state)
+        GnTrackTextureAccess(command_list, texture, *subresource_range, GnResourceAccess_Undefined, next_access, true);
+}
+
 void GnCmdExecuteBundles(GnCommandList command_list, uint32_t num_bundles, const GnCommandList* bundles)
 {
 }
@@ -1539,6 +5134,11 @@ void GnCommandListFallback::BeginRenderPass(const GnRenderPassBeginDesc* desc) n
     
 }
 
+void GnCommandListFallback::NextSubpass() noexcept
+{
+
+}
+
 void GnCommandListFallback::EndRenderPass() noexcept
 {
 
@@ -91,7 +91,7 @@ struct GnQueueD3D12 : public GnQueue_t
     ID3D12CommandQueue* cmd_queue;
 
     virtual ~GnQueueD3D12();
-    GnResult EnqueueWaitSemaphore(uint32_t num_wait_semaphores, const GnSemaphore* wait_semaphores) noexcept override;
+    GnResult EnqueueWaitSemaphore(uint32_t num_wait_semaphores, const GnSemaphore* wait_semaphores, const GnPipelineStageFlags* wait_stages) noexcept override;
     GnResult EnqueueCommandLists(uint32_t num_command_lists, const GnCommandList* command_lists) noexcept override;
     GnResult EnqueueSignalSemaphore(uint32_t num_signal_semaphores, const GnSemaphore* signal_semaphores) noexcept override;
     GnResult Flush(GnFence fence, bool wait) noexcept override;
@@ -162,6 +162,7 @@ struct GnCommandListD3D12 : public GnCommandList_t
     
     void BeginRenderPass(const GnRenderPassBeginDesc* desc) noexcept override;
     
+    void NextSubpass() noexcept override;
     void EndRenderPass() noexcept override;
 
     void Barrier(uint32_t num_buffer_barriers, const GnBufferBarrier* buffer_barriers, uint32_t num_texture_barriers, const GnTextureBarrier* texture_barriers) noexcept override;
@@ -176,6 +177,8 @@ struct GnCommandListD3D12 : public GnCommandList_t
                      GnResourceAccessFlags dst_texture_access,
                      GnExtent3 extent) noexcept override;
 
+    void CopyTextureToBuffer(GnTexture src_texture, GnResourceAccessFlags src_texture_access, GnBuffer dst_buffer) noexcept override;
+
     GnResult End() noexcept override;
 };
 
@@ -191,6 +194,7 @@ struct GnObjectTypesD3D12
     using DescriptorTableLayout = GnUnimplementedType;
     using PipelineLayout        = GnPipelineLayoutD3D12;
     using Pipeline              = GnPipelineD3D12;
+    using PipelineCache         = GnUnimplementedType;
     using DescriptorPool        = GnUnimplementedType;
     using DescriptorTable       = GnUnimplementedType;
     using CommandPool           = GnCommandPoolD3D12;
@@ -248,6 +252,7 @@ struct GnDeviceD3D12 : public GnDevice_t
     void DestroyCommandPool(GnCommandPool command_pool) noexcept override;
     void GetBufferMemoryRequirements(GnBuffer buffer, GnMemoryRequirements* memory_requirements) noexcept override;
     GnResult BindBufferMemory(GnBuffer buffer, GnMemory memory, GnDeviceSize aligned_offset) noexcept override;
+    GnResult BindTextureMemory(GnTexture texture, GnMemory memory, GnDeviceSize aligned_offset) noexcept override;
     GnResult MapBuffer(GnBuffer buffer, const GnMemoryRange* memory_range, void** mapped_memory) noexcept override;
     void UnmapBuffer(GnBuffer buffer, const GnMemoryRange* memory_range) noexcept override;
     GnResult WriteBufferRange(GnBuffer buffer, const GnMemoryRange* memory_range, const void* data) noexcept override;
@@ -936,6 +941,7 @@ void GnAdapterD3D12::GetSurfaceProperties(GnSurface surface, GnSurfaceProperties
     properties->max_buffers = 4;
     properties->min_buffers = 1;
     properties->immediate_presentable = true;
+    properties->mailbox_presentable = false;
 }
 
 static constexpr uint32_t d3d12_surface_format_support = D3D12_FORMAT_SUPPORT1_DISPLAY | D3D12_FORMAT_SUPPORT1_RENDER_TARGET;
@@ -1159,6 +1165,7 @@ GnResult GnDeviceD3D12::CreateBuffer(const GnBufferDesc* desc, GnBuffer* buffer)
 
     impl_buffer->desc = *desc;
     impl_buffer->buffer = nullptr;
+    impl_buffer->bindless_index = GN_INVALID; // Bindless mode is Vulkan only for now
 
     D3D12_RESOURCE_DESC& resource_desc = impl_buffer->resource_desc;
     resource_desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
@@ -1361,6 +1368,7 @@ GnResult GnDeviceD3D12::CreateTextureView(const GnTextureViewDesc* desc, GnTextu
         return GnError_OutOfHostMemory;
 
     view->rtv_or_dsv_heap = is_render_target ? rtv_or_dsv_heap : nullptr;
+    view->bindless_index = GN_INVALID;
 
     return GnError_Unimplemented;
 }
@@ -1569,6 +1577,8 @@ GnResult GnDeviceD3D12::CreateGraphicsPipeline(const GnGraphicsPipelineDesc* des
 
     impl_pipeline->type = GnPipelineType_Compute;
     impl_pipeline->num_viewports = 0;
+    impl_pipeline->status = GnSuccess;
+    impl_pipeline->fallback_pipeline = nullptr;
     impl_pipeline->pipeline_state = pipeline_state;
 
     *pipeline = impl_pipeline;
@@ -1599,6 +1609,8 @@ GnResult GnDeviceD3D12::CreateComputePipeline(const GnComputePipelineDesc* desc,
 
     impl_pipeline->type = GnPipelineType_Compute;
     impl_pipeline->num_viewports = 0;
+    impl_pipeline->status = GnSuccess;
+    impl_pipeline->fallback_pipeline = nullptr;
     impl_pipeline->pipeline_state = pipeline_state;
 
     *pipeline = impl_pipeline;
@@ -1731,6 +1743,11 @@ GnResult GnDeviceD3D12::BindBufferMemory(GnBuffer buffer, GnMemory memory, GnDev
     return GnError_Unimplemented;
 }
 
+GnResult GnDeviceD3D12::BindTextureMemory(GnTexture texture, GnMemory memory, GnDeviceSize aligned_offset) noexcept
+{
+    return GnError_Unimplemented;
+}
+
 GnResult GnDeviceD3D12::MapBuffer(GnBuffer buffer, const GnMemoryRange* memory_range, void** mapped_memory) noexcept
 {
     GnBufferD3D12* impl_buffer = GN_TO_D3D12(GnBuffer, buffer);
@@ -1799,7 +1816,7 @@ GnQueueD3D12::~GnQueueD3D12()
     GnSafeComRelease(cmd_queue);
 }
 
-GnResult GnQueueD3D12::EnqueueWaitSemaphore(uint32_t num_wait_semaphores, const GnSemaphore* wait_semaphores) noexcept
+GnResult GnQueueD3D12::EnqueueWaitSemaphore(uint32_t num_wait_semaphores, const GnSemaphore* wait_semaphores, const GnPipelineStageFlags* wait_stages) noexcept
 {
     return GnResult();
 }
@@ -1934,6 +1951,10 @@ void GnCommandListD3D12::BeginRenderPass(const GnRenderPassBeginDesc* desc) noex
 {
 }
 
+void GnCommandListD3D12::NextSubpass() noexcept
+{
+}
+
 void GnCommandListD3D12::EndRenderPass() noexcept
 {
 }
@@ -1956,6 +1977,10 @@ void GnCommandListD3D12::CopyTexture(GnTexture src_texture,
 {
 }
 
+void GnCommandListD3D12::CopyTextureToBuffer(GnTexture src_texture, GnResourceAccessFlags src_texture_access, GnBuffer dst_buffer) noexcept
+{
+}
+
 GnResult GnCommandListD3D12::End() noexcept
 {
     return GnResult();
@@ -25,6 +25,9 @@
 #define GN_LOAD_DEVICE_FN(x) \
     fn.x = (PFN_##x)vkGetDeviceProcAddr(device, #x); \
     if (fn.x == nullptr) return false
+#define GN_LOAD_DEVICE_KHR_FN(x, core_version) \
+    fn.x##KHR = (PFN_##x##KHR)vkGetDeviceProcAddr(device, ver_info.api_version >= core_version ? #x : #x"KHR"); \
+    if (fn.x##KHR == nullptr) return false
 
 struct GnInstanceVK;
 struct GnAdapterVK;
@@ -36,6 +39,7 @@ struct GnSemaphoreVK;
 struct GnMemoryVK;
 struct GnBufferVK;
 struct GnTextureVK;
+struct GnShaderModuleVK;
 struct GnTextureViewVK;
 struct GnRenderGraphVK;
 struct GnDescriptorTableLayoutVK;
@@ -59,6 +63,7 @@ struct GnVulkanInstanceFunctions
 #ifdef _WIN32
     PFN_vkCreateWin32SurfaceKHR vkCreateWin32SurfaceKHR;
 #endif
+    PFN_vkCreateHeadlessSurfaceEXT vkCreateHeadlessSurfaceEXT;
     PFN_vkDestroySurfaceKHR vkDestroySurfaceKHR;
     PFN_vkGetPhysicalDeviceSurfaceSupportKHR vkGetPhysicalDeviceSurfaceSupportKHR;
     PFN_vkGetPhysicalDeviceSurfaceCapabilitiesKHR vkGetPhysicalDeviceSurfaceCapabilitiesKHR;
@@ -69,6 +74,7 @@ struct GnVulkanInstanceFunctions
 
     // Vulkan 1.1 functions
     PFN_vkGetPhysicalDeviceFeatures2 vkGetPhysicalDeviceFeatures2;
+    PFN_vkGetPhysicalDeviceProperties2 vkGetPhysicalDeviceProperties2;
 };
 
 struct GnVulkanDeviceFunctions
@@ -106,6 +112,10 @@ struct GnVulkanDeviceFunctions
     PFN_vkCreateGraphicsPipelines vkCreateGraphicsPipelines;
     PFN_vkCreateComputePipelines vkCreateComputePipelines;
     PFN_vkDestroyPipeline vkDestroyPipeline;
+    PFN_vkCreatePipelineCache vkCreatePipelineCache;
+    PFN_vkDestroyPipelineCache vkDestroyPipelineCache;
+    PFN_vkGetPipelineCacheData vkGetPipelineCacheData;
+    PFN_vkMergePipelineCaches vkMergePipelineCaches;
     PFN_vkCreatePipelineLayout vkCreatePipelineLayout;
     PFN_vkDestroyPipelineLayout vkDestroyPipelineLayout;
     PFN_vkCreateDescriptorSetLayout vkCreateDescriptorSetLayout;
@@ -140,6 +150,7 @@ struct GnVulkanDeviceFunctions
     PFN_vkCmdDispatch vkCmdDispatch;
     PFN_vkCmdCopyBuffer vkCmdCopyBuffer;
     PFN_vkCmdCopyImage vkCmdCopyImage;
+    PFN_vkCmdCopyImageToBuffer vkCmdCopyImageToBuffer;
     PFN_vkCmdBlitImage vkCmdBlitImage;
     PFN_vkCmdClearColorImage vkCmdClearColorImage;
     PFN_vkCmdPipelineBarrier vkCmdPipelineBarrier;
@@ -152,6 +163,18 @@ struct GnVulkanDeviceFunctions
     PFN_vkGetSwapchainImagesKHR vkGetSwapchainImagesKHR;
     PFN_vkAcquireNextImageKHR vkAcquireNextImageKHR;
     PFN_vkQueuePresentKHR vkQueuePresentKHR;
+
+    // VK_KHR_synchronization2 (core in Vulkan 1.3)
+    PFN_vkCmdPipelineBarrier2KHR vkCmdPipelineBarrier2KHR;
+
+    // VK_KHR_timeline_semaphore (core in Vulkan 1.2)
+    PFN_vkGetSemaphoreCounterValueKHR vkGetSemaphoreCounterValueKHR;
+    PFN_vkWaitSemaphoresKHR vkWaitSemaphoresKHR;
+
+    // VK_KHR_descriptor_update_template (core in Vulkan 1.1)
+    PFN_vkCreateDescriptorUpdateTemplateKHR vkCreateDescriptorUpdateTemplateKHR;
+    PFN_vkDestroyDescriptorUpdateTemplateKHR vkDestroyDescriptorUpdateTemplateKHR;
+    PFN_vkUpdateDescriptorSetWithTemplateKHR vkUpdateDescriptorSetWithTemplateKHR;
 };
 
 struct GnInstanceVersionInfoVK
@@ -159,6 +182,7 @@ struct GnInstanceVersionInfoVK
     uint32_t    api_version;
     bool        has_khr_surface_extension;
     bool        has_khr_win32_surface_extension;
+    bool        has_ext_headless_surface_extension;
     bool        has_khr_get_physical_device_properties2_extension;
 
     bool HasKHRSurface() { return has_khr_surface_extension; }
@@ -185,6 +209,15 @@ struct GnDeviceVersionInfoVK
 {
     uint32_t    api_version;
     bool        has_ext_depth_clip_enable_extension;
+    bool        synchronization2_enabled;
+    bool        timeline_semaphore_enabled;
+    bool        maintenance5_enabled;
+    bool        descriptor_update_template_enabled;
+
+    bool HasSynchronization2() const { return synchronization2_enabled; }
+    bool HasTimelineSemaphore() const { return timeline_semaphore_enabled; }
+    bool HasMaintenance5() const { return maintenance5_enabled; }
+    bool HasDescriptorUpdateTemplate() const { return descriptor_update_template_enabled; }
 };
 
 struct GnVulkanFunctionDispatcher
@@ -200,7 +233,7 @@ struct GnVulkanFunctionDispatcher
 
     bool LoadFunctions() noexcept;
     bool LoadInstanceFunctions(VkInstance instance, const GnInstanceVersionInfoVK& ver_info, GnVulkanInstanceFunctions& fn) noexcept;
-    bool LoadDeviceFunctions(VkInstance instance, VkDevice device, uint32_t api_version, GnVulkanDeviceFunctions& fn) noexcept;
+    bool LoadDeviceFunctions(VkInstance instance, VkDevice device, const GnDeviceVersionInfoVK& ver_info, GnVulkanDeviceFunctions& fn) noexcept;
 
     static bool Init() noexcept;
 };
@@ -231,17 +264,27 @@ struct GnAdapterVK : public GnAdapter_t
     uint32_t                                    api_version = 0;
     GnVector<VkExtensionProperties>             extensions;
     VkPhysicalDeviceDepthClipEnableFeaturesEXT  depth_clip_enable_feature{};
+    VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2_feature{};
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_semaphore_feature{};
+    VkPhysicalDeviceMaintenance5FeaturesKHR     maintenance5_feature{};
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT   descriptor_indexing_feature{};
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT descriptor_indexing_properties{};
     VkPhysicalDeviceFeatures2                   supported_features{};
     VkPhysicalDeviceMemoryProperties            vk_memory_properties{};
     VkDeviceSize                                non_coherent_atom_size = 0;
-
-    GnAdapterVK(GnInstanceVK*                       instance,
-                const GnVulkanInstanceFunctions&    fn,
-                VkPhysicalDevice                    physical_device,
-                GnVector<VkExtensionProperties>&&   supported_extensions) noexcept;
-
+    uint32_t                                    device_id = 0;
+    uint8_t                                     pipeline_cache_uuid[VK_UUID_SIZE]{};
+    uint8_t                                     driver_uuid[VK_UUID_SIZE]{};    // Zero if VkPhysicalDeviceIDProperties is not available
+    mutable std::mutex                          format_lock;
+    mutable std::bitset<GnFormat_Count>         queried_formats;
+    mutable VkFormatProperties                  format_properties[GnFormat_Count]{};
+
+    GnAdapterVK(GnInstanceVK* instance, VkPhysicalDevice physical_device) noexcept;
     ~GnAdapterVK() {}
 
+    void Query() noexcept override;
+    bool IsExtensionSupported(const char* name) const noexcept;
+    const VkFormatProperties& GetFormatProperties(GnFormat format) const noexcept;
     GnTextureFormatFeatureFlags GetTextureFormatFeatureSupport(GnFormat format) const noexcept override;
     GnSampleCountFlags GetTextureFormatMultisampleSupport(GnFormat format) const noexcept override;
     GnBool IsVertexFormatSupported(GnFormat format) const noexcept override;
@@ -266,26 +309,71 @@ struct GnSurfaceVK : public GnSurface_t
     }
 };
 
+// Command buffers holding the barriers inserted before tracked command lists.
+struct GnStateFixupFrameVK
+{
+    VkCommandPool               cmd_pool = VK_NULL_HANDLE;
+    VkFence                     fence = VK_NULL_HANDLE;
+    GnVector<VkCommandBuffer>   cmd_buffers;
+    uint32_t                    num_used_cmd_buffers = 0;
+    bool                        submitted = false;
+};
+
+// Offsets into the queue item storage. Pointers are only resolved at submission since the storage may move as it grows.
+struct GnSubmissionPacketVK
+{
+    uint32_t first_wait_semaphore;
+    uint32_t num_wait_semaphores;
+    uint32_t first_command_buffer;
+    uint32_t num_command_buffers;
+    uint32_t first_signal_semaphore;
+    uint32_t num_signal_semaphores;
+};
+
 struct GnQueueVK : public GnQueue_t
 {
+    static constexpr uint32_t num_state_fixup_frames = 3;
+
     GnDeviceVK*                             parent_device = nullptr;
     VkQueue                                 queue = VK_NULL_HANDLE;
+    uint32_t                                queue_family_index = 0;
+    VkPipelineStageFlags                    supported_stages = 0;
     VkFence                                 wait_fence = VK_NULL_HANDLE;
+    GnFence                                 progress_fence = nullptr;
+    GnStateFixupFrameVK                     state_fixup_frames[num_state_fixup_frames];
+    uint32_t                                current_state_fixup_frame = 0;
     GnSmallQueue<VkCommandBuffer, 128>      command_buffer_queue;
     GnSmallQueue<VkSemaphore, 32>           wait_semaphore_queue;
     GnSmallQueue<VkPipelineStageFlags, 32>  wait_dst_stage_queue;
+    GnSmallQueue<uint64_t, 32>              wait_value_queue;   // Parallel to wait_semaphore_queue, 0 for binary semaphores
     GnSmallQueue<VkSemaphore, 32>           signal_semaphore_queue;
-    GnSmallQueue<VkSubmitInfo, 32>          submission_queue;
-
-    VkResult Init(GnDeviceVK* impl_device, VkQueue queue) noexcept;
+    GnSmallQueue<uint64_t, 32>              signal_value_queue; // Parallel to signal_semaphore_queue, 0 for binary semaphores
+    GnVector<GnSubmissionPacketVK>          submission_packets;
+    GnVector<VkSubmitInfo>                  submit_infos;
+    GnVector<VkTimelineSemaphoreSubmitInfoKHR> timeline_submit_infos;
+    GnVector<VkBufferMemoryBarrier>         state_fixup_buffer_barriers;    // Scratch storage reused by EnqueueStateFixup
+    GnVector<VkImageMemoryBarrier>          state_fixup_image_barriers;     // Scratch storage reused by EnqueueStateFixup
+
+    VkResult Init(GnDeviceVK* impl_device, VkQueue queue, uint32_t queue_family_index) noexcept;
     void Destroy() noexcept;
-    GnResult EnqueueWaitSemaphore(uint32_t num_wait_semaphores, const GnSemaphore* wait_semaphores) noexcept override;
+    GnResult EnqueueStateFixup(uint32_t num_buffer_barriers, const GnBufferBarrier* buffer_barriers, uint32_t num_texture_barriers, const GnTextureBarrier* texture_barriers) noexcept override;
+    GnResult GetProgressFence(GnFence* fence) noexcept override;
+    GnResult Reserve(uint32_t num_waits, uint32_t num_command_lists, uint32_t num_signals) noexcept override;
+    GnResult EnqueueWaitSemaphore(uint32_t num_wait_semaphores, const GnSemaphore* wait_semaphores, const GnPipelineStageFlags* wait_stages) noexcept override;
     GnResult EnqueueCommandLists(uint32_t num_command_lists, const GnCommandList* command_lists) noexcept override;
     GnResult EnqueueSignalSemaphore(uint32_t num_signal_semaphores, const GnSemaphore* signal_semaphores) noexcept override;
+    GnResult EnqueueWaitFence(GnFence fence, uint64_t value, GnPipelineStageFlags wait_stages) noexcept override;
+    GnResult EnqueueSignalFence(GnFence fence, uint64_t value) noexcept override;
     GnResult Flush(GnFence fence, bool wait) noexcept override;
+    GnResult Commit(GnFence fence) noexcept override;
     GnResult PresentSwapchain(GnSwapchain swapchain) noexcept override;
 
+    GnResult EnqueueWaitSemaphoreVK(VkSemaphore semaphore, VkPipelineStageFlags wait_stage, uint64_t value) noexcept;
+    GnResult EnqueueSignalSemaphoreVK(VkSemaphore semaphore, uint64_t value) noexcept;
     bool GroupSubmissionPacket() noexcept;
+    GnResult SubmitPackets(VkFence fence, bool wait, bool reset_fence = false) noexcept;
+    void ClearPendingSubmissions() noexcept;
+    VkCommandBuffer AllocateStateFixupCommandBuffer() noexcept;
 };
 
 struct GnSwapchainFramePresenterVK
@@ -293,8 +381,6 @@ struct GnSwapchainFramePresenterVK
     VkSemaphore     acquire_image_semaphore;
     VkSemaphore     blit_finished_semaphore;
     VkFence         submit_fence;
-    VkCommandPool   cmd_pool;
-    VkCommandBuffer cmd_buffer;
 
     void Destroy(GnDeviceVK* impl_device);
 };
@@ -311,6 +397,11 @@ struct GnSwapchainBlitImageVK : public GnTextureBaseVK
     void Destroy(GnDeviceVK* impl_device);
 };
 
+// Wraps a presentable image in direct present mode. The image is owned by the swapchain.
+struct GnSwapchainBackBufferVK : public GnTextureBaseVK
+{
+};
+
 struct GnSwapchainVK : public GnSwapchain_t
 {
     GnDeviceVK*                                                             impl_device;
@@ -319,17 +410,36 @@ struct GnSwapchainVK : public GnSwapchain_t
     VkImageBlit                                                             blit_param{};
     int32_t                                                                 swapchain_memtype_index = -1;
     uint32_t                                                                current_acquired_image = 0;
+    uint32_t                                                                current_present_slot = 0;   // Index to frame_presenters, one slot per frame in flight
     bool                                                                    should_update = true;
+    bool                                                                    direct_present = false;
+    bool                                                                    image_acquired = false;     // Direct present only
+    GnQueueVK*                                                              present_queue = nullptr;    // Direct present only
     GnSmallVector<GnSwapchainBlitImageVK, GN_MAX_SWAPCHAIN_BUFFERS>         blit_images;
     GnSmallVector<VkImage, GN_MAX_SWAPCHAIN_BUFFERS>                        swapchain_images;
+    GnSwapchainBackBufferVK                                                 back_buffers[GN_MAX_SWAPCHAIN_BUFFERS]{}; // Direct present only, fixed so handles survive recreation
+    uint32_t                                                                num_back_buffers = 0;       // Direct present only, one per swapchain image
+    GnSmallVector<VkSemaphore, GN_MAX_SWAPCHAIN_BUFFERS>                    render_finished_semaphores; // Direct present only, one per swapchain image
     GnSmallVector<GnSwapchainFramePresenterVK, GN_MAX_SWAPCHAIN_BUFFERS>    frame_presenters;
+    VkCommandPool                                                           blit_cmd_pool = VK_NULL_HANDLE;
+    GnVector<VkCommandBuffer>                                               blit_cmd_buffers;           // One per (blit image, swapchain image) pair
+    bool                                                                    blit_cmd_buffers_dirty = true;
 
     GnSwapchainVK(GnDeviceVK* impl_device) noexcept;
     GnTexture GetBackBuffer(uint32_t index) noexcept override;
+    uint32_t GetBackBufferCount() noexcept override;
+    uint32_t GetCurrentBackBufferIndex() noexcept override;
+    GnResult AcquireNextBackBuffer(uint32_t* index) noexcept override;
+    GnResult WaitForPresentSlot(uint64_t timeout) noexcept override;
     GnResult Update(GnFormat format, uint32_t width, uint32_t height, uint32_t num_buffers, GnBool vsync) noexcept override;
 
     GnResult Init(const GnSwapchainDesc* desc, VkSwapchainKHR old_swapchain) noexcept;
     std::pair<VkResult, VkImage> AcquireNextImage() noexcept;
+    GnResult PresentDirect(GnQueueVK* queue) noexcept;
+    GnResult RecordBlitCommandBuffers() noexcept;
+    VkCommandBuffer GetBlitCommandBuffer(uint32_t blit_image_index, uint32_t swapchain_image_index) const noexcept;
+    GnResult Recreate() noexcept;
+    uint32_t GetNumFramesInFlight(uint32_t num_buffers) const noexcept;
     void Destroy(GnDeviceVK* impl_device) noexcept;
 };
 
@@ -341,11 +451,16 @@ struct GnSemaphoreVK : public GnSemaphore_t
 
 struct GnFenceVK : public GnFence_t
 {
-    GnDeviceVK* parent_device;
-    VkFence     fence;
+    GnDeviceVK*             parent_device;
+    VkFence                 fence;              // Binary fence only
+    VkSemaphore             timeline_semaphore; // Timeline fence only
+    std::atomic<uint64_t>   last_signal_value;  // Highest value enqueued for signaling
 
+    GnResult GetStatus() noexcept override;
     GnResult Wait(uint64_t timeout) noexcept override;
     GnResult Reset() noexcept override;
+    GnResult GetValue(uint64_t* value) noexcept override;
+    GnResult WaitValue(uint64_t value, uint64_t timeout) noexcept override;
 };
 
 struct GnMemoryVK : public GnMemory_t
@@ -377,22 +492,47 @@ struct GnTextureViewVK : public GnTextureView_t
 
 struct GnRenderGraphVK : public GnRenderGraph_t
 {
-    VkRenderPass render_pass;
+    VkRenderPass render_pass = VK_NULL_HANDLE;
+};
+
+struct GnDescriptorTableBindingVK
+{
+    uint32_t        binding;
+    GnResourceType  type;
+    uint32_t        first_descriptor;   // Offset into the packed descriptor array
+    uint32_t        num_descriptors;
 };
 
 struct GnDescriptorTableLayoutVK : public GnDescriptorTableLayout_t
 {
-    VkDescriptorSetLayout set_layout;
+    VkDescriptorSetLayout           set_layout;
+    VkDescriptorUpdateTemplateKHR   update_template;    // VK_NULL_HANDLE if templates are not available
+    uint32_t                        num_bindings;
+    GnDescriptorTableBindingVK*     bindings;
+    uint32_t                        num_descriptors;
+};
+
+// Element of the packed array fed to descriptor update templates.
+union GnDescriptorInfoVK
+{
+    VkDescriptorImageInfo   image;
+    VkDescriptorBufferInfo  buffer;
 };
 
 struct GnPipelineLayoutVK : public GnPipelineLayout_t
 {
-    VkPipelineLayout        pipeline_layout;
-    VkShaderStageFlags      push_constants_stage_flags;
-    VkDescriptorSetLayout   global_resource_layout;
-    uint32_t                global_resource_binding_mask;
-    uint32_t                num_global_uniform_buffers;
-    uint32_t                num_global_storage_buffers;
+    VkPipelineLayout                pipeline_layout;
+    VkShaderStageFlags              push_constants_stage_flags;
+    VkDescriptorSetLayout           global_resource_layout;
+    VkDescriptorUpdateTemplateKHR   global_resource_template;   // Fed with one buffer info per binding, in binding order
+    uint32_t                        num_global_uniform_buffers;
+    uint32_t                        num_global_storage_buffers;
+    uint32_t                        bindless_set_index;         // GN_INVALID if the layout does not use the bindless heap
+};
+
+struct GnPipelineCacheVK : public GnPipelineCache_t
+{
+    VkPipelineCache pipeline_cache;
 };
 
 struct GnPipelineVK : public GnPipeline_t
@@ -400,16 +540,21 @@ struct GnPipelineVK : public GnPipeline_t
     VkPipeline pipeline;
     VkIndexType index_type;
     VkRenderPass render_pass;
+    uint32_t num_shader_modules;
+    GnShaderModuleVK* shader_modules[2];
 };
 
-struct GnDescriptorPoolVK : public GnDescriptorPool_t
+struct GnDescriptorTableVK : public GnDescriptorTable_t
 {
-    VkDescriptorPool descriptor_pool;
+    VkDescriptorSet             descriptor_set;
+    GnDescriptorTableLayoutVK*  layout;
 };
 
-struct GnDescriptorTableVK : public GnDescriptorTable_t
+struct GnDescriptorPoolVK : public GnDescriptorPool_t
 {
-    VkDescriptorSet descriptor_set;
+    VkDescriptorPool        descriptor_pool = VK_NULL_HANDLE;
+    GnDescriptorTableVK*    tables = nullptr;   // Storage for max_descriptor_tables tables
+    GnIndexAllocator        table_indices;      // Only bumped in linear mode, reset with the pool
 };
 
 struct GnDescriptorStreamChunkVK
@@ -456,15 +601,29 @@ struct GnCommandListVK : public GnCommandList_t
     uint32_t                        graphics_descriptor_write_mask = 0;
     uint32_t                        compute_descriptor_write_mask = 0;
 
+    // Barriers are accumulated here and emitted in one vkCmdPipelineBarrier call
+    // right before the next draw, dispatch, copy or render pass begin.
+    GnVector<VkBufferMemoryBarrier> pending_buffer_barriers;
+    GnVector<VkImageMemoryBarrier>  pending_image_barriers;
+    VkPipelineStageFlags            pending_src_stages = 0;
+    VkPipelineStageFlags            pending_dst_stages = 0;
+
+    // Used instead of the above when synchronization2 is enabled. Each barrier carries its own stage masks.
+    bool                                use_synchronization2 = false;
+    GnVector<VkBufferMemoryBarrier2KHR> pending_buffer_barriers2;
+    GnVector<VkImageMemoryBarrier2KHR>  pending_image_barriers2;
+
     GnCommandListVK(GnCommandPoolVK* parent_cmd_pool) noexcept;
     ~GnCommandListVK();
 
     GnResult Begin(const GnCommandListBeginDesc* desc) noexcept override;
     void BeginRenderPass(const GnRenderPassBeginDesc* desc) noexcept override;
     
+    void NextSubpass() noexcept override;
     void EndRenderPass() noexcept override;
     
     void Barrier(uint32_t num_buffer_barriers, const GnBufferBarrier* buffer_barriers, uint32_t num_texture_barriers, const GnTextureBarrier* texture_barriers) noexcept override;
+    void FlushBarriers() noexcept;
 
     void CopyBuffer(GnBuffer src_buffer, GnDeviceSize src_offset, GnBuffer dst_buffer, GnDeviceSize dst_offset, GnDeviceSize size) noexcept override;
 
@@ -476,6 +635,8 @@ struct GnCommandListVK : public GnCommandList_t
                      GnResourceAccessFlags dst_texture_access,
                      GnExtent3 extent) noexcept override;
 
+    void CopyTextureToBuffer(GnTexture src_texture, GnResourceAccessFlags src_texture_access, GnBuffer dst_buffer) noexcept override;
+
     GnResult End() noexcept override;
 };
 
@@ -487,8 +648,7 @@ struct GnCommandPoolVK : public GnCommandPool_t
     VkCommandPool                   cmd_pool;
     VkCommandBufferLevel            level;
     GnCommandListVK*                command_list_pool = nullptr;
-    GnVector<VkBufferMemoryBarrier> pending_buffer_barriers;
-    GnVector<VkImageMemoryBarrier>  pending_image_barriers;
+    uint32_t                        max_command_lists;
     GnStackAllocator                valloc;
 
     // Descriptor stream to provide global resource descriptors.
@@ -511,12 +671,47 @@ struct GnObjectTypesVK
     using DescriptorTableLayout = GnDescriptorTableLayoutVK;
     using PipelineLayout = GnPipelineLayoutVK;
     using Pipeline = GnPipelineVK;
+    using PipelineCache = GnPipelineCacheVK;
     using DescriptorPool = GnDescriptorPoolVK;
-    using DescriptorTable = GnUnimplementedType;
+    using DescriptorTable = GnDescriptorTableVK;
     using CommandPool = GnCommandPoolVK;
     using CommandList = GnCommandListVK;
 };
 
+// Subpasses of a render pass that has any, empty for the implicit single subpass.
+struct GnSubpassLayoutVK
+{
+    struct Subpass
+    {
+        uint8_t num_color_targets;
+        uint8_t num_input_targets;
+        bool    use_depth_stencil_target;
+        uint8_t color_targets[GN_MAX_COLOR_TARGETS];
+        uint8_t input_targets[GN_MAX_COLOR_TARGETS + 1];
+    };
+
+    uint32_t    num_subpasses;
+    Subpass     subpasses[GN_MAX_SUBPASSES];
+
+    bool Init(uint32_t num_subpasses, const GnRenderPassSubpassDesc* subpasses, uint32_t num_color_targets) noexcept;
+    void CombineHash(size_t& hash) const noexcept;
+    bool operator==(const GnSubpassLayoutVK& other) const noexcept;
+};
+
+// Subpass descriptions and dependencies of a render pass with a GnSubpassLayoutVK.
+struct GnSubpassBuilderVK
+{
+    VkSubpassDescription    subpasses[GN_MAX_SUBPASSES];
+    VkAttachmentReference   color_refs[GN_MAX_SUBPASSES][GN_MAX_COLOR_TARGETS];
+    VkAttachmentReference   input_refs[GN_MAX_SUBPASSES][GN_MAX_COLOR_TARGETS + 1];
+    VkAttachmentReference   depth_stencil_refs[GN_MAX_SUBPASSES];
+    uint32_t                preserve_attachments[GN_MAX_SUBPASSES][GN_MAX_COLOR_TARGETS + 1];
+    VkSubpassDependency     dependencies[GN_MAX_SUBPASSES * (GN_MAX_SUBPASSES - 1) / 2];
+    uint32_t                num_dependencies;
+
+    void Build(const GnSubpassLayoutVK& layout, const uint32_t* color_attachments, uint32_t depth_stencil_attachment) noexcept;
+};
+
 struct GnRenderPassCacheKey
 {
     GnSampleCount           sample_count;
@@ -540,9 +735,10 @@ struct GnRenderPassCacheKey
     GnRenderPassOp          depth_store_op;
     GnRenderPassOp          stencil_load_op;
     GnRenderPassOp          stencil_store_op;
+    GnSubpassLayoutVK       subpass_layout;
     size_t                  calculated_hash;
 
-    void Init(const GnRenderPassBeginDesc* desc);
+    bool Init(const GnRenderPassBeginDesc* desc);
     inline static size_t GetHash(const GnRenderPassCacheKey& key) noexcept;
     inline static bool CompareKey(const GnRenderPassCacheKey& a, const GnRenderPassCacheKey& b) noexcept;
 };
@@ -551,29 +747,164 @@ struct GnFramebufferCacheKey
 {
     static constexpr size_t max_render_target_views = GN_MAX_COLOR_TARGETS * 2 + 1;
 
+    VkRenderPass    render_pass;    // Framebuffers are only compatible with render passes of the same subpasses
     uint32_t        num_render_targets;
     GnTextureView   render_target_views[max_render_target_views];
     size_t          calculated_hash;
 
-    void Init(const GnRenderPassBeginDesc* desc);
+    void Init(const GnRenderPassBeginDesc* desc, VkRenderPass render_pass);
     inline static size_t GetHash(const GnFramebufferCacheKey& key) noexcept;
     inline static bool CompareKey(const GnFramebufferCacheKey& a, const GnFramebufferCacheKey& b) noexcept;
 };
 
+struct GnShaderModuleCacheKeyVK
+{
+    uint64_t        hash;
+    size_t          size;
+    const uint8_t*  bytecode;
+
+    inline static size_t GetHash(const GnShaderModuleCacheKeyVK& key) noexcept;
+    inline static bool CompareKey(const GnShaderModuleCacheKeyVK& a, const GnShaderModuleCacheKeyVK& b) noexcept;
+};
+
+struct GnShaderModuleVK
+{
+    GnShaderModuleCacheKeyVK    key;        // Points into bytecode
+    VkShaderModule              module;
+    std::atomic<uint32_t>       ref_count;  // Only dropped under the exclusive lock of the cache
+    GnVector<uint8_t>           bytecode;   // Copy of the SPIR-V the module was created from
+};
+
+// Shader modules shared between pipelines, keyed by the bytecode. The hash only selects the bucket, hits are
+// confirmed by comparing the bytecode. Pipelines hold a reference to each module they were created from until they
+// are destroyed.
+struct GnShaderModuleCacheVK
+{
+    GnCacheTable<GnShaderModuleCacheKeyVK, GnShaderModuleVK*> modules;
+    std::atomic<uint64_t>                                     num_hits{};
+    std::atomic<uint64_t>                                     num_misses{};
+
+    GnResult Acquire(GnDeviceVK* impl_device, const GnShaderBytecode* bytecode, GnShaderModuleVK** shader_module) noexcept;
+    void Release(GnDeviceVK* impl_device, GnShaderModuleVK* shader_module) noexcept;
+    void Flush(GnDeviceVK* impl_device) noexcept;
+};
+
+// Owns everything vkCreateGraphicsPipelines reads through pointers so several pipelines can be passed to the
+// driver in one call. The create info points into the struct itself, so it must not be moved after Init.
+// Pipelines only need a render pass compatible with the one they are drawn in. Compatibility depends on the
+// attachment formats and sample counts, so load/store ops and layouts are not part of the key.
+struct GnCompatibleRenderPassCacheKey
+{
+    GnSampleCount       sample_count;
+    uint32_t            num_color_targets;
+    uint32_t            resolve_target_mask;
+    GnFormat            color_target_formats[GN_MAX_COLOR_TARGETS];
+    GnFormat            depth_stencil_target_format;
+    GnSubpassLayoutVK   subpass_layout;
+    size_t              calculated_hash;
+
+    void CalculateHash() noexcept;
+    inline static size_t GetHash(const GnCompatibleRenderPassCacheKey& key) noexcept;
+    inline static bool CompareKey(const GnCompatibleRenderPassCacheKey& a, const GnCompatibleRenderPassCacheKey& b) noexcept;
+};
+
+// Vulkan create infos of a graphics pipeline. States are applied one at a time, so the create infos can be built
+// directly from a GnGraphicsPipelineDesc or from a pipeline stream.
+struct GnGraphicsPipelineStateVK
+{
+    GnCompatibleRenderPassCacheKey                          rp_key;
+    VkRenderPass                                            compatible_rp = VK_NULL_HANDLE;
+    GnShaderBytecode                                        vs{};
+    GnShaderBytecode                                        fs{};
+    VkShaderModule                                          vs_module = VK_NULL_HANDLE;
+    VkShaderModule                                          fs_module = VK_NULL_HANDLE;
+    uint32_t                                                num_shader_modules = 0;
+    GnShaderModuleVK*                                       shader_modules[2];
+    VkShaderModuleCreateInfo                                module_infos[2];
+    VkPipelineShaderStageCreateInfo                         stages[2];
+    GnSmallVector<VkVertexInputBindingDescription, 32>      vertex_bindings;
+    GnSmallVector<VkVertexInputAttributeDescription, 32>    vertex_attributes;
+    VkPipelineVertexInputStateCreateInfo                    vertex_input;
+    VkPipelineInputAssemblyStateCreateInfo                  input_assembly;
+    VkPipelineViewportStateCreateInfo                       viewport;
+    VkPipelineRasterizationStateCreateInfo                  rasterization;
+    VkSampleMask                                            sample_mask;
+    VkPipelineMultisampleStateCreateInfo                    multisample;
+    bool                                                    has_depth_stencil_state = false;
+    VkPipelineDepthStencilStateCreateInfo                   depth_stencil;
+    bool                                                    independent_blend = false;
+    uint32_t                                                num_blend_states = 0;
+    VkPipelineColorBlendAttachmentState                     blend_attachments[GN_MAX_COLOR_TARGETS]{};
+    VkPipelineColorBlendStateCreateInfo                     blend;
+    VkPipelineDynamicStateCreateInfo                        dynamic_state;
+    GnPipelineLayout                                        layout = nullptr;
+    uint32_t                                                num_viewports = 1;
+    VkPipelineCache                                         cache = VK_NULL_HANDLE;
+    uint32_t                                                subpass = 0;
+    VkGraphicsPipelineCreateInfo                            pipeline_info;
+
+    GnResult Init(GnDeviceVK* impl_device, const GnGraphicsPipelineDesc* desc) noexcept;
+    GnResult InitFromStream(GnDeviceVK* impl_device, const GnPipelineStreamDesc* desc) noexcept;
+    void Reset() noexcept;
+    bool AddVertexInputSlot(const GnVertexInputSlotDesc& slot) noexcept;
+    bool AddVertexAttribute(const GnVertexInputAttributeDesc& attribute) noexcept;
+    bool SetInputAssembly(const GnInputAssemblyStateDesc& desc) noexcept;
+    bool SetRasterization(const GnRasterizationStateDesc& desc) noexcept;
+    void SetMultisample(const GnMultisampleStateDesc& desc) noexcept;
+    void SetDepthStencil(const GnDepthStencilStateDesc& desc) noexcept;
+    bool AddColorTargetBlend(const GnColorTargetBlendStateDesc& target) noexcept;
+    bool SetFragmentInterface(const GnFragmentInterfaceStateDesc& desc) noexcept;
+    bool SetSubpasses(uint32_t num_subpasses, const GnRenderPassSubpassDesc* subpasses, uint32_t subpass_index) noexcept;
+    GnResult Finish(GnDeviceVK* impl_device) noexcept;
+    void Destroy(GnDeviceVK* impl_device) noexcept;
+};
+
+// Device-wide descriptor set of the bindless mode. Textures and buffers each get their own index space, shared by the
+// bindings of the same resource kind.
+struct GnBindlessHeapVK
+{
+    static constexpr uint32_t sampled_texture_binding = 0;
+    static constexpr uint32_t storage_texture_binding = 1;
+    static constexpr uint32_t storage_buffer_binding = 2;
+    static constexpr uint32_t uniform_buffer_binding = 3;
+    static constexpr uint32_t default_capacity = 16384;
+
+    VkDescriptorSetLayout   set_layout = VK_NULL_HANDLE;
+    VkDescriptorPool        descriptor_pool = VK_NULL_HANDLE;
+    VkDescriptorSet         descriptor_set = VK_NULL_HANDLE;
+    GnIndexAllocator        texture_indices;
+    GnIndexAllocator        buffer_indices;
+    bool                    has_uniform_buffers = false;
+    VkDeviceSize            max_uniform_buffer_range = 0;
+    std::mutex              write_mutex; // Writes to the set must be externally synchronized
+
+    GnResult Init(GnDeviceVK* impl_device, const GnAdapterVK* adapter, const GnDeviceDesc* desc) noexcept;
+    void Destroy(GnDeviceVK* impl_device) noexcept;
+    void AllocateTextureView(GnDeviceVK* impl_device, const GnTextureVK* texture, GnTextureViewVK* texture_view, GnTextureAspectFlags aspect) noexcept;
+    void AllocateBuffer(GnBufferVK* buffer) noexcept;
+    void WriteBuffer(GnDeviceVK* impl_device, const GnBufferVK* buffer) noexcept;
+    inline bool IsEnabled() const noexcept { return descriptor_set != VK_NULL_HANDLE; }
+};
+
 struct GnDeviceVK : public GnDevice_t
 {
-    GnVulkanDeviceFunctions                             fn{};
-    VkDevice                                            device = VK_NULL_HANDLE;
-    GnQueueVK*                                          enabled_queues = nullptr;
-    GnObjectPool<GnObjectTypesVK>                       pool;
-    VkPipelineLayout                                    empty_pipeline_layout = VK_NULL_HANDLE;
-    VkDeviceSize                                        non_coherent_atom_size = 0;
-    GnCacheTable<GnRenderPassCacheKey, VkRenderPass>    render_pass_cache;
-    GnCacheTable<GnFramebufferCacheKey, VkFramebuffer>  framebuffer_cache;
+    GnVulkanDeviceFunctions                                    fn{};
+    VkDevice                                                   device = VK_NULL_HANDLE;
+    GnQueueVK*                                                 enabled_queues = nullptr;
+    GnObjectPool<GnObjectTypesVK>                              pool;
+    VkPipelineLayout                                           empty_pipeline_layout = VK_NULL_HANDLE;
+    VkDeviceSize                                               non_coherent_atom_size = 0;
+    GnDeviceVersionInfoVK                                      ver_info{};
+    GnCacheTable<GnRenderPassCacheKey, VkRenderPass>           render_pass_cache;
+    GnCacheTable<GnFramebufferCacheKey, VkFramebuffer>         framebuffer_cache;
+    GnCacheTable<GnCompatibleRenderPassCacheKey, VkRenderPass> compatible_render_pass_cache;
+    GnShaderModuleCacheVK                                      shader_module_cache;
+    GnBindlessHeapVK                                           bindless_heap;
 
     ~GnDeviceVK();
     GnResult CreateSwapchain(const GnSwapchainDesc* desc, GnSwapchain* swapchain) noexcept override;
     GnResult CreateFence(GnBool signaled, GnFence* fence) noexcept override;
+    GnResult CreateTimelineFence(uint64_t initial_value, GnFence* fence) noexcept override;
     GnResult CreateMemory(const GnMemoryDesc* desc, GnMemory* memory) noexcept override;
     GnResult CreateBuffer(const GnBufferDesc* desc, GnBuffer* buffer) noexcept override;
     GnResult CreateTexture(const GnTextureDesc* desc, GnTexture* texture) noexcept override;
@@ -582,8 +913,24 @@ struct GnDeviceVK : public GnDevice_t
     GnResult CreateDescriptorTableLayout(const GnDescriptorTableLayoutDesc* desc, GnDescriptorTableLayout* resource_table_layout) noexcept override;
     GnResult CreatePipelineLayout(const GnPipelineLayoutDesc* desc, GnPipelineLayout* pipeline_layout) noexcept override;
     GnResult CreateGraphicsPipeline(const GnGraphicsPipelineDesc* desc, GnPipeline* pipeline) noexcept override;
+    GnResult CreateGraphicsPipelines(uint32_t num_pipelines, const GnGraphicsPipelineDesc* descs, GnPipeline* pipelines, GnResult* results) noexcept override;
+    GnResult GetCompatibleRenderPass(const GnCompatibleRenderPassCacheKey& key, VkRenderPass* render_pass) noexcept;
+    GnResult CreateGraphicsPipelineFromStream(const GnPipelineStreamDesc* desc, GnPipeline* pipeline) noexcept override;
+    GnResult CreateGraphicsPipelinesFromStates(uint32_t num_pipelines, GnGraphicsPipelineStateVK* states, GnPipeline* pipelines, GnResult* results, bool into_pending = false) noexcept;
     GnResult CreateComputePipeline(const GnComputePipelineDesc* desc, GnPipeline* pipeline) noexcept override;
+    GnResult CreateComputePipelineFromStream(const GnPipelineStreamDesc* desc, GnPipeline* pipeline) noexcept override;
+    GnResult CreateComputePipelineFromShader(const GnShaderBytecode* cs, GnPipelineLayout layout, VkPipelineCache cache, GnPipeline* pipeline) noexcept;
+    GnResult CreatePendingPipeline(GnPipelineType type, GnPipeline* pipeline) noexcept override;
+    GnResult CompilePendingGraphicsPipeline(GnPipeline pipeline, const GnGraphicsPipelineDesc* desc) noexcept override;
+    GnResult CreatePipelineCache(const GnPipelineCacheDesc* desc, GnPipelineCache* pipeline_cache) noexcept override;
+    GnResult GetPipelineCacheData(GnPipelineCache pipeline_cache, size_t* data_size, void* data) noexcept override;
+    GnResult MergePipelineCaches(GnPipelineCache dst_cache, uint32_t num_src_caches, const GnPipelineCache* src_caches) noexcept override;
     GnResult CreateDescriptorPool(const GnDescriptorPoolDesc* desc, GnDescriptorPool* descriptor_pool) noexcept override;
+    GnResult ResetDescriptorPool(GnDescriptorPool descriptor_pool) noexcept override;
+    GnResult AllocateDescriptorTables(GnDescriptorPool descriptor_pool, uint32_t num_descriptor_tables, const GnDescriptorTableLayout* layouts, GnDescriptorTable* descriptor_tables) noexcept override;
+    void FreeDescriptorTables(GnDescriptorPool descriptor_pool, uint32_t num_descriptor_tables, const GnDescriptorTable* descriptor_tables) noexcept override;
+    GnResult UpdateDescriptorTables(uint32_t num_writes, const GnDescriptorTableWrite* writes) noexcept override;
+    GnResult WriteDescriptorTable(GnDescriptorTable descriptor_table, const GnDescriptorInfo* descriptors) noexcept override;
     GnResult CreateCommandPool(const GnCommandPoolDesc* desc, GnCommandPool* command_pool) noexcept override;
     GnResult CreateCommandLists(const GnCommandListDesc* desc, GnCommandList* command_lists) noexcept override;
     void DestroySwapchain(GnSwapchain swapchain) noexcept override;
@@ -595,12 +942,15 @@ struct GnDeviceVK : public GnDevice_t
     void DestroyRenderGraph(GnRenderGraph render_graph) noexcept override;
     void DestroyDescriptorTableLayout(GnDescriptorTableLayout resource_table_layout) noexcept override;
     void DestroyPipeline(GnPipeline pipeline) noexcept override;
+    void DestroyPipelineCache(GnPipelineCache pipeline_cache) noexcept override;
+    void GetShaderModuleCacheStats(GnShaderModuleCacheStats* stats) noexcept override;
     void DestroyPipelineLayout(GnPipelineLayout pipeline_layout) noexcept override;
     void DestroyDescriptorPool(GnDescriptorPool descriptor_pool) noexcept override;
     void DestroyCommandPool(GnCommandPool command_pool) noexcept override;
     void DestroyCommandLists(GnCommandPool command_pool, uint32_t num_command_lists, const GnCommandList* command_lists) noexcept override;
     void GetBufferMemoryRequirements(GnBuffer buffer, GnMemoryRequirements* memory_requirements) noexcept override;
     GnResult BindBufferMemory(GnBuffer buffer, GnMemory memory, GnDeviceSize aligned_offset) noexcept override;
+    GnResult BindTextureMemory(GnTexture texture, GnMemory memory, GnDeviceSize aligned_offset) noexcept override;
     GnResult MapBuffer(GnBuffer buffer, const GnMemoryRange* memory_range, void** mapped_memory) noexcept override;
     void UnmapBuffer(GnBuffer buffer, const GnMemoryRange* memory_range) noexcept override;
     GnResult WriteBufferRange(GnBuffer buffer, const GnMemoryRange* memory_range, const void* data) noexcept override;
@@ -609,8 +959,14 @@ struct GnDeviceVK : public GnDevice_t
     GnResult ResetCommandPool(GnCommandPool command_pool) noexcept override;
 
     GnResult CreateRenderPass(const GnRenderPassCacheKey* desc, VkRenderPass* render_pass) noexcept;
+    void GetPipelineCacheHeader(GnPipelineCacheHeader* header) const noexcept;
 };
 
+inline static VkPipelineCache GnGetPipelineCacheVK(GnPipelineCache pipeline_cache) noexcept
+{
+    return pipeline_cache != nullptr ? GN_TO_VULKAN(GnPipelineCache, pipeline_cache)->pipeline_cache : VK_NULL_HANDLE;
+}
+
 // -------------------------------------------------------
 //                    IMPLEMENTATION
 // -------------------------------------------------------
@@ -635,6 +991,7 @@ inline static GnResult GnConvertFromVkResult(VkResult result) noexcept
 {
     switch (result) {
         case VK_TIMEOUT:                    return GnTimeout;
+        case VK_NOT_READY:                  return GnNotReady;
         case VK_SUCCESS:                    return GnSuccess;
         case VK_ERROR_OUT_OF_HOST_MEMORY:   return GnError_OutOfHostMemory;
         case VK_ERROR_OUT_OF_DEVICE_MEMORY: return GnError_OutOfDeviceMemory;
@@ -768,6 +1125,8 @@ static bool GnConvertAndCheckDeviceFeatures(const uint32_t num_requested_feature
             case GnFeature_LinePolygonMode:
             case GnFeature_PointPolygonMode:            ret = enabled_features.features.fillModeNonSolid = supported_features[GnFeature_LinePolygonMode]; break;
             case GnFeature_ColorTargetLogicOp:          ret = enabled_features.features.logicOp = supported_features[GnFeature_ColorTargetLogicOp]; break;
+            case GnFeature_TimelineFence:               ret = supported_features[GnFeature_TimelineFence]; break; // Enabled in CreateDevice
+            case GnFeature_Bindless:                    ret = supported_features[GnFeature_Bindless]; break; // Enabled in CreateDevice
             case GnFeature_UnclippedDepth:
                 GnVisitStructChainVK<VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLIP_ENABLE_FEATURES_EXT>(
                     &enabled_features,
@@ -819,6 +1178,8 @@ inline static VkImageUsageFlags GnConvertToVkImageUsageFlags(GnTextureUsageFlags
     if (GnContainsBit(usage, GnTextureUsage_Storage)) ret |= VK_IMAGE_USAGE_STORAGE_BIT;
     if (GnContainsBit(usage, GnTextureUsage_ColorTarget)) ret |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
     if (GnContainsBit(usage, GnTextureUsage_DepthStencilTarget)) ret |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    if (GnContainsBit(usage, GnTextureUsage_InputAttachment)) ret |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+    if (GnContainsBit(usage, GnTextureUsage_Transient)) ret |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
 
     return ret;
 }
@@ -827,12 +1188,13 @@ template<bool Dynamic>
 inline static VkDescriptorType GnConvertToVkDescriptorType(GnResourceType type) noexcept
 {
     switch (type) {
-        case GnResourceType_Sampler:        return VK_DESCRIPTOR_TYPE_SAMPLER;
-        case GnResourceType_UniformBuffer:  return Dynamic ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        case GnResourceType_StorageBuffer:  return Dynamic ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        case GnResourceType_SampledTexture: return VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-        case GnResourceType_StorageTexture: return VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-        default:                            GN_UNREACHABLE();
+        case GnResourceType_Sampler:         return VK_DESCRIPTOR_TYPE_SAMPLER;
+        case GnResourceType_UniformBuffer:   return Dynamic ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        case GnResourceType_StorageBuffer:   return Dynamic ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        case GnResourceType_SampledTexture:  return VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        case GnResourceType_StorageTexture:  return VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        case GnResourceType_InputAttachment: return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+        default:                             GN_UNREACHABLE();
     }
 
     return VK_DESCRIPTOR_TYPE_MAX_ENUM;
@@ -942,164 +1304,404 @@ inline static VkBlendOp GnConvertToVkBlendOp(GnBlendOp blend_op) noexcept
     return {};
 }
 
-template<bool AfterAccess>
-inline VkPipelineStageFlags GnGetPipelineStageFromAccessVK(GnResourceAccessFlags access) noexcept
+// Per-bit access conversion tables, indexed by the bit position of GnResourceAccess.
+// Bits past GnResourceAccess_HostWrite do not map to anything.
+static constexpr VkPipelineStageFlags gn_access_bit_to_stage_vk[32] = {
+    0,                                                                              // GeneralLayout
+    0,                                                                              // IndirectBuffer
+    VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,                                             // IndexBuffer
+    VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,                                             // VertexBuffer
+    VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,                                            // VSUniformBuffer
+    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,                                          // FSUniformBuffer
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,                                           // CSUniformBuffer
+    VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,                                            // VSRead
+    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,                                          // FSRead
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,                                           // CSRead
+    VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,                                            // VSWrite
+    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,                                          // FSWrite
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,                                           // CSWrite
+    VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,                                  // ColorTargetRead
+    VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,                                  // ColorTargetWrite
+    VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,  // DepthStencilTargetRead
+    VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,  // DepthStencilTargetWrite
+    VK_PIPELINE_STAGE_TRANSFER_BIT,                                                 // CopySrc
+    VK_PIPELINE_STAGE_TRANSFER_BIT,                                                 // CopyDst
+    VK_PIPELINE_STAGE_TRANSFER_BIT,                                                 // BlitSrc
+    VK_PIPELINE_STAGE_TRANSFER_BIT,                                                 // BlitDst
+    VK_PIPELINE_STAGE_TRANSFER_BIT,                                                 // ClearSrc
+    VK_PIPELINE_STAGE_TRANSFER_BIT,                                                 // ClearDst
+    VK_PIPELINE_STAGE_TRANSFER_BIT,                                                 // Present
+    VK_PIPELINE_STAGE_HOST_BIT,                                                     // HostRead
+    VK_PIPELINE_STAGE_HOST_BIT,                                                     // HostWrite
+};
+
+static constexpr VkAccessFlags gn_access_bit_to_access_vk[32] = {
+    0,                                              // GeneralLayout
+    VK_ACCESS_INDIRECT_COMMAND_READ_BIT,            // IndirectBuffer
+    VK_ACCESS_INDEX_READ_BIT,                       // IndexBuffer
+    VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,            // VertexBuffer
+    VK_ACCESS_UNIFORM_READ_BIT,                     // VSUniformBuffer
+    VK_ACCESS_UNIFORM_READ_BIT,                     // FSUniformBuffer
+    VK_ACCESS_UNIFORM_READ_BIT,                     // CSUniformBuffer
+    VK_ACCESS_SHADER_READ_BIT,                      // VSRead
+    VK_ACCESS_SHADER_READ_BIT,                      // FSRead
+    VK_ACCESS_SHADER_READ_BIT,                      // CSRead
+    VK_ACCESS_SHADER_WRITE_BIT,                     // VSWrite
+    VK_ACCESS_SHADER_WRITE_BIT,                     // FSWrite
+    VK_ACCESS_SHADER_WRITE_BIT,                     // CSWrite
+    VK_ACCESS_COLOR_ATTACHMENT_READ_BIT,            // ColorTargetRead
+    VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,           // ColorTargetWrite
+    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,    // DepthStencilTargetRead
+    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,   // DepthStencilTargetWrite
+    VK_ACCESS_TRANSFER_READ_BIT,                    // CopySrc
+    VK_ACCESS_TRANSFER_WRITE_BIT,                   // CopyDst
+    VK_ACCESS_TRANSFER_READ_BIT,                    // BlitSrc
+    VK_ACCESS_TRANSFER_WRITE_BIT,                   // BlitDst
+    VK_ACCESS_TRANSFER_READ_BIT,                    // ClearSrc
+    VK_ACCESS_TRANSFER_WRITE_BIT,                   // ClearDst
+    VK_ACCESS_TRANSFER_READ_BIT,                    // Present
+    VK_ACCESS_HOST_READ_BIT,                        // HostRead
+    VK_ACCESS_HOST_WRITE_BIT,                       // HostWrite
+};
+
+// An image can only be in one layout, so each bit is given a priority instead (lower wins).
+static constexpr VkImageLayout gn_layout_priority_vk[] = {
+    VK_IMAGE_LAYOUT_GENERAL,
+    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+    VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, // Present, the swapchain image is blitted from
+    VK_IMAGE_LAYOUT_UNDEFINED,
+};
+
+static constexpr uint8_t gn_layout_priority_none_vk = 7;
+
+static constexpr uint8_t gn_access_bit_to_layout_priority_vk[32] = {
+    0,                                              // GeneralLayout
+    7, 7, 7, 7, 7, 7,                               // IndirectBuffer, IndexBuffer, VertexBuffer, *UniformBuffer
+    1, 1, 1,                                        // VSRead, FSRead, CSRead
+    0, 0, 0,                                        // VSWrite, FSWrite, CSWrite
+    2, 2,                                           // ColorTarget*
+    3, 3,                                           // DepthStencilTarget*
+    4, 5, 4, 5, 4, 5,                               // CopySrc, CopyDst, BlitSrc, BlitDst, ClearSrc, ClearDst
+    6,                                              // Present
+    7, 7,                                           // HostRead, HostWrite
+    7,                                              // Discard, handled by GnGetImageLayoutFromAccessVK
+    7, 7, 7, 7, 7,
+};
+
+// Expands a per-bit table into one 256-entry table for each byte of GnResourceAccessFlags, so every conversion
+// becomes four lookups combined with Combine.
+template<typename T>
+struct GnAccessLUTVK
 {
-    static constexpr GnResourceAccessFlags vs_access =
-        GnResourceAccess_VSUniformBuffer |
-        GnResourceAccess_VSRead |
-        GnResourceAccess_VSWrite;
+    T table[4][256];
+};
 
-    static constexpr GnResourceAccessFlags fs_access =
-        GnResourceAccess_FSUniformBuffer |
-        GnResourceAccess_FSRead |
-        GnResourceAccess_FSWrite;
+template<typename T, typename CombineFn>
+constexpr GnAccessLUTVK<T> GnMakeAccessLUTVK(const T (&per_bit)[32], T empty, CombineFn combine) noexcept
+{
+    GnAccessLUTVK<T> lut{};
 
-    static constexpr GnResourceAccessFlags cs_access =
-        GnResourceAccess_CSUniformBuffer |
-        GnResourceAccess_CSRead |
-        GnResourceAccess_CSWrite;
+    for (uint32_t byte = 0; byte < 4; byte++) {
+        for (uint32_t value = 0; value < 256; value++) {
+            T result = empty;
 
-    static constexpr GnResourceAccessFlags transfer_access =
-        GnResourceAccess_CopySrc |
-        GnResourceAccess_BlitSrc |
-        GnResourceAccess_ClearSrc |
-        GnResourceAccess_CopyDst |
-        GnResourceAccess_BlitDst |
-        GnResourceAccess_ClearDst |
-        GnResourceAccess_Present;
+            for (uint32_t bit = 0; bit < 8; bit++)
+                if (value & (1u << bit))
+                    result = combine(result, per_bit[byte * 8 + bit]);
 
-    VkPipelineStageFlags stage = 0;
+            lut.table[byte][value] = result;
+        }
+    }
 
-    if (access & (GnResourceAccess_VertexBuffer | GnResourceAccess_IndexBuffer))
-        stage |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    return lut;
+}
 
-    if (access & vs_access)
-        stage |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+template<typename T>
+constexpr T GnCombineOrVK(T a, T b) noexcept
+{
+    return a | b;
+}
 
-    if (access & fs_access)
-        stage |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+template<typename T>
+constexpr T GnCombineMinVK(T a, T b) noexcept
+{
+    return a < b ? a : b;
+}
 
-    if (access & cs_access)
-        stage |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+static constexpr GnAccessLUTVK<VkPipelineStageFlags> gn_access_to_stage_lut_vk =
+    GnMakeAccessLUTVK<VkPipelineStageFlags>(gn_access_bit_to_stage_vk, 0, GnCombineOrVK<VkPipelineStageFlags>);
 
-    if (access & (GnResourceAccess_ColorTargetRead | GnResourceAccess_ColorTargetWrite))
-        stage |= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+static constexpr GnAccessLUTVK<VkAccessFlags> gn_access_to_access_lut_vk =
+    GnMakeAccessLUTVK<VkAccessFlags>(gn_access_bit_to_access_vk, 0, GnCombineOrVK<VkAccessFlags>);
 
-    if (access & (GnResourceAccess_DepthStencilTargetRead | GnResourceAccess_DepthStencilTargetWrite))
-        stage |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+static constexpr GnAccessLUTVK<uint8_t> gn_access_to_layout_priority_lut_vk =
+    GnMakeAccessLUTVK<uint8_t>(gn_access_bit_to_layout_priority_vk, gn_layout_priority_none_vk, GnCombineMinVK<uint8_t>);
 
-    if (access & transfer_access)
-        stage |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+template<bool AfterAccess>
+inline VkPipelineStageFlags GnGetPipelineStageFromAccessVK(GnResourceAccessFlags access) noexcept
+{
+    const auto& lut = gn_access_to_stage_lut_vk.table;
 
-    if (access & (GnResourceAccess_HostRead | GnResourceAccess_HostWrite))
-        stage |= VK_PIPELINE_STAGE_HOST_BIT;
+    VkPipelineStageFlags stage =
+        lut[0][access & 0xFF] |
+        lut[1][(access >> 8) & 0xFF] |
+        lut[2][(access >> 16) & 0xFF] |
+        lut[3][(access >> 24) & 0xFF];
 
     if (stage == 0)
-        stage |= AfterAccess ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        stage = AfterAccess ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
 
     return stage;
 }
 
 inline VkAccessFlags GnGetAccessVK(GnResourceAccessFlags access) noexcept
 {
-    static constexpr GnResourceAccessFlags uniform_read_access =
-        GnResourceAccess_VSUniformBuffer |
-        GnResourceAccess_FSUniformBuffer |
-        GnResourceAccess_CSUniformBuffer;
-
-    static constexpr GnResourceAccessFlags read_access =
-        GnResourceAccess_VSRead |
-        GnResourceAccess_FSRead |
-        GnResourceAccess_CSRead;
-
-    static constexpr GnResourceAccessFlags write_access =
-        GnResourceAccess_VSWrite |
-        GnResourceAccess_FSWrite |
-        GnResourceAccess_CSWrite;
-
-    static constexpr GnResourceAccessFlags src_transfer_access =
-        GnResourceAccess_CopySrc |
-        GnResourceAccess_BlitSrc |
-        GnResourceAccess_ClearSrc |
-        GnResourceAccess_Present;
-
-    static constexpr GnResourceAccessFlags dst_transfer_access =
-        GnResourceAccess_CopyDst |
-        GnResourceAccess_BlitDst |
-        GnResourceAccess_ClearDst;
-
-    static constexpr VkAccessFlags vk_indirect_index_vertex_access =
-        VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
-        VK_ACCESS_INDEX_READ_BIT |
-        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
-
-    static constexpr VkAccessFlags vk_attachment_access =
-        VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
-        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
-        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
-        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    const auto& lut = gn_access_to_access_lut_vk.table;
+
+    return lut[0][access & 0xFF] |
+           lut[1][(access >> 8) & 0xFF] |
+           lut[2][(access >> 16) & 0xFF] |
+           lut[3][(access >> 24) & 0xFF];
+}
 
-    VkAccessFlags vk_access = 0;
+inline VkImageLayout GnGetImageLayoutFromAccessVK(GnResourceAccessFlags access) noexcept
+{
+    if (GnHasBit(access, GnResourceAccess_Discard))
+        return VK_IMAGE_LAYOUT_UNDEFINED;
 
-    // Convert indirect buffer, index buffer, or vertex buffer access flags to VkAccessFlagBits equivalent
-    vk_access |= (access >> 1) & vk_indirect_index_vertex_access;
+    const auto& lut = gn_access_to_layout_priority_lut_vk.table;
 
-    // Convert attachments access to VkAccessFlagBits equivalent
-    vk_access |= (access >> 6) & vk_attachment_access;
+    uint8_t priority = GnMin(GnMin(lut[0][access & 0xFF], lut[1][(access >> 8) & 0xFF]),
+                             GnMin(lut[2][(access >> 16) & 0xFF], lut[3][(access >> 24) & 0xFF]));
 
-    // Convert hosts access to VkAccessFlagBits equivalent
-    vk_access |= (access >> 11) & (VK_ACCESS_HOST_READ_BIT | VK_ACCESS_HOST_WRITE_BIT);
+    return gn_layout_priority_vk[priority];
+}
 
-    if (access & uniform_read_access) vk_access |= VK_ACCESS_UNIFORM_READ_BIT;
-    if (access & read_access) vk_access |= VK_ACCESS_SHADER_READ_BIT;
-    if (access & write_access) vk_access |= VK_ACCESS_SHADER_WRITE_BIT;
-    if (access & src_transfer_access) vk_access |= VK_ACCESS_TRANSFER_READ_BIT;
-    if (access & dst_transfer_access) vk_access |= VK_ACCESS_TRANSFER_WRITE_BIT;
+// Same as GnGetImageLayoutFromAccessVK, except that textures presented directly use the presentation layout.
+inline VkImageLayout GnGetTextureLayoutFromAccessVK(GnTexture texture, GnResourceAccessFlags access) noexcept
+{
+    if (texture->direct_present && access == GnResourceAccess_Present)
+        return VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
-    return vk_access;
+    return GnGetImageLayoutFromAccessVK(access);
 }
 
-inline VkImageLayout GnGetImageLayoutFromAccessVK(GnResourceAccessFlags access) noexcept
+// Indexed by the bit position of GnPipelineStage.
+static constexpr VkPipelineStageFlags gn_pipeline_stage_bit_to_stage_vk[8] = {
+    VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,                                            // DrawIndirect
+    VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,                                             // VertexInput
+    VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,                                            // VertexShader
+    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,                                          // FragmentShader
+    VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,  // DepthStencilTarget
+    VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,                                  // ColorTarget
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,                                           // ComputeShader
+    VK_PIPELINE_STAGE_TRANSFER_BIT,                                                 // Transfer
+};
+
+inline VkPipelineStageFlags GnConvertPipelineStagesVK(GnPipelineStageFlags stages, VkPipelineStageFlags supported_stages) noexcept
+{
+    if (stages == GnPipelineStage_AllCommands)
+        return VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+    VkPipelineStageFlags vk_stages = 0;
+
+    for (uint32_t i = 0; i < GN_ARRAY_SIZE(gn_pipeline_stage_bit_to_stage_vk); i++)
+        if (GnContainsBit(stages, 1u << i))
+            vk_stages |= gn_pipeline_stage_bit_to_stage_vk[i];
+
+    // Stages the queue cannot execute are dropped. If nothing is left, fall back to waiting on everything.
+    vk_stages &= supported_stages;
+
+    return vk_stages != 0 ? vk_stages : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+}
+
+inline static bool GnBufferRangesOverlapVK(VkDeviceSize offset_a, VkDeviceSize size_a, VkDeviceSize offset_b, VkDeviceSize size_b) noexcept
+{
+    VkDeviceSize end_a = size_a == VK_WHOLE_SIZE ? VK_WHOLE_SIZE : offset_a + size_a;
+    VkDeviceSize end_b = size_b == VK_WHOLE_SIZE ? VK_WHOLE_SIZE : offset_b + size_b;
+    return offset_a < end_b && offset_b < end_a;
+}
+
+inline static bool GnSubresourceRangesOverlapVK(const VkImageSubresourceRange& a, const GnTextureSubresourceRange& b) noexcept
 {
-    static constexpr GnResourceAccessFlags read_access =
-        GnResourceAccess_VSRead |
-        GnResourceAccess_FSRead |
-        GnResourceAccess_CSRead;
+    return (a.aspectMask & (VkImageAspectFlags)b.aspect) != 0 &&
+           a.baseMipLevel < b.base_mip_level + b.num_mip_levels && b.base_mip_level < a.baseMipLevel + a.levelCount &&
+           a.baseArrayLayer < b.base_array_layer + b.num_array_layers && b.base_array_layer < a.baseArrayLayer + a.layerCount;
+}
+
+// Appends buffer barriers to the pending list. A barrier on a range that is already pending is folded
+// into it (A->B->C becomes A->C). Works on both legacy and synchronization2 barrier structs, legacy barriers
+// accumulate their stages into src_stages and dst_stages.
+// Barriers recorded by the same command are not ordered against each other, so a barrier that overlaps a pending
+// range without matching it calls flush first, which records the pending barriers and clears them with the stages.
+template<bool Sync2, typename VkBufferBarrierType, typename FlushFn>
+inline static bool GnAppendBufferBarriersVK(GnVector<VkBufferBarrierType>&  pending_barriers,
+                                            VkPipelineStageFlags&           src_stages,
+                                            VkPipelineStageFlags&           dst_stages,
+                                            uint32_t                        num_barriers,
+                                            const GnBufferBarrier*          barriers,
+                                            FlushFn&&                       flush) noexcept
+{
+    if (!pending_barriers.reserve(pending_barriers.size() + num_barriers))
+        return false;
+
+    for (uint32_t i = 0; i < num_barriers; i++) {
+        const GnBufferBarrier& buffer_barrier = barriers[i];
+        VkBuffer vk_buffer = GN_TO_VULKAN(GnBuffer, buffer_barrier.buffer)->buffer;
+        VkAccessFlags next_access = GnGetAccessVK(buffer_barrier.next_access);
+        VkBufferBarrierType* merged_barrier = nullptr;
+
+        // Pending barriers never overlap each other, so there is at most one overlapping barrier.
+        for (size_t j = pending_barriers.size(); j > 0; j--) {
+            VkBufferBarrierType& pending_barrier = pending_barriers[j - 1];
+
+            if (pending_barrier.buffer != vk_buffer ||
+                !GnBufferRangesOverlapVK(pending_barrier.offset, pending_barrier.size, buffer_barrier.offset, buffer_barrier.size))
+            {
+                continue;
+            }
+
+            if (pending_barrier.offset == buffer_barrier.offset && pending_barrier.size == buffer_barrier.size)
+                merged_barrier = &pending_barrier;
+            else
+                flush();
 
-    static constexpr GnResourceAccessFlags write_access =
-        GnResourceAccess_VSWrite |
-        GnResourceAccess_FSWrite |
-        GnResourceAccess_CSWrite;
+            break;
+        }
+
+        if constexpr (!Sync2) {
+            src_stages |= GnGetPipelineStageFromAccessVK<false>(buffer_barrier.prev_access);
+            dst_stages |= GnGetPipelineStageFromAccessVK<true>(buffer_barrier.next_access);
+        }
+
+        if (merged_barrier != nullptr) {
+            merged_barrier->dstAccessMask = next_access;
+
+            if constexpr (Sync2)
+                merged_barrier->dstStageMask = GnGetPipelineStageFromAccessVK<true>(buffer_barrier.next_access);
+
+            continue;
+        }
+
+        VkBufferBarrierType vk_buffer_barrier;
+
+        if constexpr (Sync2) {
+            vk_buffer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR;
+            vk_buffer_barrier.srcStageMask = GnGetPipelineStageFromAccessVK<false>(buffer_barrier.prev_access);
+            vk_buffer_barrier.dstStageMask = GnGetPipelineStageFromAccessVK<true>(buffer_barrier.next_access);
+        }
+        else {
+            vk_buffer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        }
+
+        vk_buffer_barrier.pNext = nullptr;
+        vk_buffer_barrier.srcAccessMask = GnGetAccessVK(buffer_barrier.prev_access);
+        vk_buffer_barrier.dstAccessMask = next_access;
+        vk_buffer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        vk_buffer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        vk_buffer_barrier.buffer = vk_buffer;
+        vk_buffer_barrier.offset = buffer_barrier.offset;
+        vk_buffer_barrier.size = buffer_barrier.size;
+
+        pending_barriers.push_back(vk_buffer_barrier);
+    }
+
+    return true;
+}
+
+// Same as GnAppendBufferBarriersVK for images. A barrier is only folded into a pending barrier on the same
+// subresources if it starts from the layout the pending barrier transitions to, otherwise it is flushed too.
+template<bool Sync2, typename VkImageBarrierType, typename FlushFn>
+inline static bool GnAppendImageBarriersVK(GnVector<VkImageBarrierType>&   pending_barriers,
+                                           VkPipelineStageFlags&           src_stages,
+                                           VkPipelineStageFlags&           dst_stages,
+                                           uint32_t                        num_barriers,
+                                           const GnTextureBarrier*         barriers,
+                                           FlushFn&&                       flush) noexcept
+{
+    if (!pending_barriers.reserve(pending_barriers.size() + num_barriers))
+        return false;
+
+    for (uint32_t i = 0; i < num_barriers; i++) {
+        const GnTextureBarrier& texture_barrier = barriers[i];
+        const GnTextureSubresourceRange& subresource_range = texture_barrier.subresource_range;
+        VkImage vk_image = GN_TO_VULKAN(GnTexture, texture_barrier.texture)->image;
+        VkAccessFlags next_access = GnGetAccessVK(texture_barrier.next_access);
+        VkImageLayout prev_layout = GnGetTextureLayoutFromAccessVK(texture_barrier.texture, texture_barrier.prev_access);
+        VkImageLayout next_layout = GnGetTextureLayoutFromAccessVK(texture_barrier.texture, texture_barrier.next_access);
+        VkImageBarrierType* merged_barrier = nullptr;
+
+        for (size_t j = pending_barriers.size(); j > 0; j--) {
+            VkImageBarrierType& pending_barrier = pending_barriers[j - 1];
+            const VkImageSubresourceRange& pending_range = pending_barrier.subresourceRange;
+
+            if (pending_barrier.image != vk_image || !GnSubresourceRangesOverlapVK(pending_range, subresource_range))
+                continue;
+
+            if (pending_range.aspectMask == (VkImageAspectFlags)subresource_range.aspect &&
+                pending_range.baseMipLevel == subresource_range.base_mip_level &&
+                pending_range.levelCount == subresource_range.num_mip_levels &&
+                pending_range.baseArrayLayer == subresource_range.base_array_layer &&
+                pending_range.layerCount == subresource_range.num_array_layers &&
+                pending_barrier.newLayout == prev_layout)
+            {
+                merged_barrier = &pending_barrier;
+            }
+            else {
+                flush();
+            }
+
+            break;
+        }
 
-    static constexpr GnResourceAccessFlags color_attachment_access =
-        GnResourceAccess_ColorTargetRead |
-        GnResourceAccess_ColorTargetWrite;
+        if constexpr (!Sync2) {
+            src_stages |= GnGetPipelineStageFromAccessVK<false>(texture_barrier.prev_access);
+            dst_stages |= GnGetPipelineStageFromAccessVK<true>(texture_barrier.next_access);
+        }
+
+        if (merged_barrier != nullptr) {
+            merged_barrier->dstAccessMask = next_access;
+            merged_barrier->newLayout = next_layout;
 
-    static constexpr GnResourceAccessFlags depth_stencil_attachment_access =
-        GnResourceAccess_DepthStencilTargetRead |
-        GnResourceAccess_DepthStencilTargetWrite;
+            if constexpr (Sync2)
+                merged_barrier->dstStageMask = GnGetPipelineStageFromAccessVK<true>(texture_barrier.next_access);
+
+            continue;
+        }
 
-    static constexpr GnResourceAccessFlags src_transfer_access =
-        GnResourceAccess_CopySrc |
-        GnResourceAccess_BlitSrc |
-        GnResourceAccess_ClearSrc;
+        VkImageBarrierType vk_image_barrier;
 
-    static constexpr GnResourceAccessFlags dst_transfer_access =
-        GnResourceAccess_CopyDst |
-        GnResourceAccess_BlitDst |
-        GnResourceAccess_ClearDst;
+        if constexpr (Sync2) {
+            vk_image_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
+            vk_image_barrier.srcStageMask = GnGetPipelineStageFromAccessVK<false>(texture_barrier.prev_access);
+            vk_image_barrier.dstStageMask = GnGetPipelineStageFromAccessVK<true>(texture_barrier.next_access);
+        }
+        else {
+            vk_image_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        }
 
-    if (access & GnResourceAccess_GeneralLayout || access & write_access) return VK_IMAGE_LAYOUT_GENERAL;
+        vk_image_barrier.pNext = nullptr;
+        vk_image_barrier.srcAccessMask = GnGetAccessVK(texture_barrier.prev_access);
+        vk_image_barrier.dstAccessMask = next_access;
+        vk_image_barrier.oldLayout = prev_layout;
+        vk_image_barrier.newLayout = next_layout;
+        vk_image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        vk_image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        vk_image_barrier.image = vk_image;
+        vk_image_barrier.subresourceRange.aspectMask = subresource_range.aspect;
+        vk_image_barrier.subresourceRange.baseMipLevel = subresource_range.base_mip_level;
+        vk_image_barrier.subresourceRange.levelCount = subresource_range.num_mip_levels;
+        vk_image_barrier.subresourceRange.baseArrayLayer = subresource_range.base_array_layer;
+        vk_image_barrier.subresourceRange.layerCount = subresource_range.num_array_layers;
 
-    if (access & read_access) return VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    else if (access & color_attachment_access) return VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    else if (access & depth_stencil_attachment_access) return VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-    else if (access & src_transfer_access) return VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-    else if (access & dst_transfer_access) return VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    else if (access & GnResourceAccess_Present) return VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        pending_barriers.push_back(vk_image_barrier);
+    }
 
-    return VK_IMAGE_LAYOUT_UNDEFINED;
+    return true;
 }
 
 // Taken from https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPhysicalDeviceMemoryProperties.html
@@ -1207,6 +1809,9 @@ bool GnVulkanFunctionDispatcher::LoadInstanceFunctions(VkInstance instance, cons
 #ifdef _WIN32
     GN_LOAD_INSTANCE_FN(vkCreateWin32SurfaceKHR);
 #endif
+    if (ver_info.has_ext_headless_surface_extension) {
+        GN_LOAD_INSTANCE_FN(vkCreateHeadlessSurfaceEXT);
+    }
     GN_LOAD_INSTANCE_FN(vkDestroySurfaceKHR);
     GN_LOAD_INSTANCE_FN(vkGetPhysicalDeviceSurfaceSupportKHR);
     GN_LOAD_INSTANCE_FN(vkGetPhysicalDeviceSurfaceCapabilitiesKHR);
@@ -1222,10 +1827,16 @@ bool GnVulkanFunctionDispatcher::LoadInstanceFunctions(VkInstance instance, cons
         GN_LOAD_INSTANCE_EXT_FN(vkGetPhysicalDeviceFeatures2);
     }
 
+    // Only used to identify the driver for pipeline cache data, not required.
+    if (ver_info.api_version >= VK_API_VERSION_1_1)
+        fn.vkGetPhysicalDeviceProperties2 = (PFN_vkGetPhysicalDeviceProperties2)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceProperties2");
+    else if (ver_info.has_khr_get_physical_device_properties2_extension)
+        fn.vkGetPhysicalDeviceProperties2 = (PFN_vkGetPhysicalDeviceProperties2)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceProperties2KHR");
+
     return true;
 }
 
-bool GnVulkanFunctionDispatcher::LoadDeviceFunctions(VkInstance instance, VkDevice device, uint32_t api_version, GnVulkanDeviceFunctions& fn) noexcept
+bool GnVulkanFunctionDispatcher::LoadDeviceFunctions(VkInstance instance, VkDevice device, const GnDeviceVersionInfoVK& ver_info, GnVulkanDeviceFunctions& fn) noexcept
 {
     PFN_vkGetDeviceProcAddr vkGetDeviceProcAddr = (PFN_vkGetDeviceProcAddr)vkGetInstanceProcAddr(instance, "vkGetDeviceProcAddr");
     GN_LOAD_DEVICE_FN(vkDestroyDevice);
@@ -1261,6 +1872,10 @@ bool GnVulkanFunctionDispatcher::LoadDeviceFunctions(VkInstance instance, VkDevi
     GN_LOAD_DEVICE_FN(vkCreateGraphicsPipelines);
     GN_LOAD_DEVICE_FN(vkCreateComputePipelines);
     GN_LOAD_DEVICE_FN(vkDestroyPipeline);
+    GN_LOAD_DEVICE_FN(vkCreatePipelineCache);
+    GN_LOAD_DEVICE_FN(vkDestroyPipelineCache);
+    GN_LOAD_DEVICE_FN(vkGetPipelineCacheData);
+    GN_LOAD_DEVICE_FN(vkMergePipelineCaches);
     GN_LOAD_DEVICE_FN(vkCreatePipelineLayout);
     GN_LOAD_DEVICE_FN(vkDestroyPipelineLayout);
     GN_LOAD_DEVICE_FN(vkCreateDescriptorSetLayout);
@@ -1295,6 +1910,7 @@ bool GnVulkanFunctionDispatcher::LoadDeviceFunctions(VkInstance instance, VkDevi
     GN_LOAD_DEVICE_FN(vkCmdDispatch);
     GN_LOAD_DEVICE_FN(vkCmdCopyBuffer);
     GN_LOAD_DEVICE_FN(vkCmdCopyImage);
+    GN_LOAD_DEVICE_FN(vkCmdCopyImageToBuffer);
     GN_LOAD_DEVICE_FN(vkCmdBlitImage);
     GN_LOAD_DEVICE_FN(vkCmdClearColorImage);
     GN_LOAD_DEVICE_FN(vkCmdPipelineBarrier);
@@ -1307,6 +1923,22 @@ bool GnVulkanFunctionDispatcher::LoadDeviceFunctions(VkInstance instance, VkDevi
     GN_LOAD_DEVICE_FN(vkGetSwapchainImagesKHR);
     GN_LOAD_DEVICE_FN(vkAcquireNextImageKHR);
     GN_LOAD_DEVICE_FN(vkQueuePresentKHR);
+
+    if (ver_info.HasSynchronization2()) {
+        GN_LOAD_DEVICE_KHR_FN(vkCmdPipelineBarrier2, VK_API_VERSION_1_3);
+    }
+
+    if (ver_info.HasTimelineSemaphore()) {
+        GN_LOAD_DEVICE_KHR_FN(vkGetSemaphoreCounterValue, VK_API_VERSION_1_2);
+        GN_LOAD_DEVICE_KHR_FN(vkWaitSemaphores, VK_API_VERSION_1_2);
+    }
+
+    if (ver_info.HasDescriptorUpdateTemplate()) {
+        GN_LOAD_DEVICE_KHR_FN(vkCreateDescriptorUpdateTemplate, VK_API_VERSION_1_1);
+        GN_LOAD_DEVICE_KHR_FN(vkDestroyDescriptorUpdateTemplate, VK_API_VERSION_1_1);
+        GN_LOAD_DEVICE_KHR_FN(vkUpdateDescriptorSetWithTemplate, VK_API_VERSION_1_1);
+    }
+
     return true;
 }
 
@@ -1341,9 +1973,14 @@ bool GnVulkanFunctionDispatcher::Init() noexcept
 
 GnResult GnCreateInstanceVulkan(const GnInstanceDesc* desc, GnInstance* instance) noexcept
 {
+    uint64_t time_point = GnGetTimeNs();
+
     if (!GnVulkanFunctionDispatcher::Init())
         return GnError_BackendNotAvailable;
 
+    const uint64_t load_backend_ns = GnGetTimeNs() - time_point;
+    time_point = GnGetTimeNs();
+
     uint32_t api_version = VK_VERSION_1_0;
 
     if (g_vk_dispatcher->vkEnumerateInstanceVersion != nullptr)
@@ -1380,6 +2017,10 @@ GnResult GnCreateInstanceVulkan(const GnInstanceDesc* desc, GnInstance* instance
             ver_info.has_khr_win32_surface_extension = true;
             extensions.push_back("VK_KHR_win32_surface");
         }
+        else if (strncmp(ext_properties.extensionName, "VK_EXT_headless_surface", VK_MAX_EXTENSION_NAME_SIZE) == 0) {
+            ver_info.has_ext_headless_surface_extension = true;
+            extensions.push_back("VK_EXT_headless_surface");
+        }
         else if (VK_API_VERSION_MAJOR(api_version) == 1 && VK_API_VERSION_MINOR(api_version) == 0) {
             if (strncmp(ext_properties.extensionName, "VK_KHR_get_physical_device_properties2", VK_MAX_EXTENSION_NAME_SIZE) == 0) {
                 ver_info.has_khr_get_physical_device_properties2_extension = true;
@@ -1417,6 +2058,9 @@ GnResult GnCreateInstanceVulkan(const GnInstanceDesc* desc, GnInstance* instance
         return GnError_BackendNotAvailable;
     }
 
+    const uint64_t create_instance_ns = GnGetTimeNs() - time_point;
+    time_point = GnGetTimeNs();
+
     // Allocate memory for the new instance
     GnInstanceVK* new_instance = (GnInstanceVK*)std::malloc(sizeof(GnInstanceVK));
 
@@ -1455,30 +2099,16 @@ GnResult GnCreateInstanceVulkan(const GnInstanceDesc* desc, GnInstance* instance
         fn.vkEnumeratePhysicalDevices(vk_instance, &num_physical_devices, physical_devices);
 
         GnAdapterVK* predecessor = nullptr;
-        GnVector<VkExtensionProperties> available_extensions;
 
+        // Adapters are queried on first use, see GnAdapterVK::Query.
         for (uint32_t i = 0; i < num_physical_devices; i++) {
             GnAdapterVK* adapter = &adapters[i];
-            VkPhysicalDevice physical_device = physical_devices[i];
+
+            new(adapter) GnAdapterVK(new_instance, physical_devices[i]);
 
             if (predecessor != nullptr)
                 predecessor->next_adapter = static_cast<GnAdapter>(adapter); // construct linked list
 
-            uint32_t num_extensions;
-            fn.vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &num_extensions, nullptr);
-
-            if (!available_extensions.resize(num_extensions)) {
-                std::free(physical_devices);
-                std::free(adapters);
-                std::free(new_instance);
-                fn.vkDestroyInstance(vk_instance, nullptr);
-                return GnError_OutOfHostMemory;
-            }
-
-            fn.vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &num_extensions, available_extensions.data());
-
-            new(adapter) GnAdapterVK(new_instance, fn, physical_device, std::move(available_extensions));
-
             predecessor = adapter;
         }
 
@@ -1492,6 +2122,9 @@ GnResult GnCreateInstanceVulkan(const GnInstanceDesc* desc, GnInstance* instance
     new_instance->vk_adapters = adapters;
     new_instance->adapters = static_cast<GnAdapter>(new_instance->vk_adapters);
     new_instance->ver_info = ver_info;
+    new_instance->load_backend_ns = load_backend_ns;
+    new_instance->create_instance_ns = create_instance_ns;
+    new_instance->enumerate_adapters_ns = GnGetTimeNs() - time_point;
 
     *instance = new_instance;
 
@@ -1519,21 +2152,34 @@ GnResult GnInstanceVK::CreateSurface(const GnSurfaceDesc* desc, GnSurface* surfa
     if (!ver_info.has_khr_surface_extension)
         return GnError_UnsupportedFeature;
 
-    VkSurfaceKHR vk_surface;
+    VkSurfaceKHR vk_surface = VK_NULL_HANDLE;
+    GnResult result = GnError_UnsupportedFeature;
+
+    if (desc->type == GnSurfaceType_Headless) {
+        if (!ver_info.has_ext_headless_surface_extension)
+            return GnError_UnsupportedFeature;
+
+        VkHeadlessSurfaceCreateInfoEXT surface_info{};
+        surface_info.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
 
+        result = GnConvertFromVkResult(fn.vkCreateHeadlessSurfaceEXT(instance, &surface_info, nullptr, &vk_surface));
+    }
 #ifdef _WIN32
-    if (!ver_info.has_khr_win32_surface_extension)
-        return GnError_UnsupportedFeature;
+    else {
+        if (!ver_info.has_khr_win32_surface_extension)
+            return GnError_UnsupportedFeature;
+
+        VkWin32SurfaceCreateInfoKHR surface_info{};
+        surface_info.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
+        surface_info.hinstance = GetModuleHandle(nullptr);
+        surface_info.hwnd = desc->hwnd;
 
-    VkWin32SurfaceCreateInfoKHR surface_info{};
-    surface_info.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
-    surface_info.hinstance = GetModuleHandle(nullptr);
-    surface_info.hwnd = desc->hwnd;
+        result = GnConvertFromVkResult(fn.vkCreateWin32SurfaceKHR(instance, &surface_info, nullptr, &vk_surface));
+    }
+#endif
 
-    GnResult result = GnConvertFromVkResult(fn.vkCreateWin32SurfaceKHR(instance, &surface_info, nullptr, &vk_surface));
     if (GN_FAILED(result))
         return result;
-#endif
 
     GnSurfaceVK* impl_surface = new(std::nothrow) GnSurfaceVK;
 
@@ -1545,7 +2191,7 @@ GnResult GnInstanceVK::CreateSurface(const GnSurfaceDesc* desc, GnSurface* surfa
     impl_surface->parent_instance = this;
     impl_surface->surface = vk_surface;
 #ifdef _WIN32
-    impl_surface->hwnd = desc->hwnd;
+    impl_surface->hwnd = desc->type == GnSurfaceType_Headless ? nullptr : desc->hwnd;
 #endif
 
     *surface = impl_surface;
@@ -1555,14 +2201,23 @@ GnResult GnInstanceVK::CreateSurface(const GnSurfaceDesc* desc, GnSurface* surfa
 
 // -- [GnAdapterVK] --
 
-GnAdapterVK::GnAdapterVK(GnInstanceVK*                      instance,
-                         const GnVulkanInstanceFunctions&   fn,
-                         VkPhysicalDevice                   physical_device,
-                         GnVector<VkExtensionProperties>&&  supported_extensions) noexcept
-    : physical_device(physical_device),
-      extensions(std::move(supported_extensions))
+GnAdapterVK::GnAdapterVK(GnInstanceVK* instance, VkPhysicalDevice physical_device) noexcept
+    : parent_instance(instance),
+      physical_device(physical_device)
+{
+}
+
+void GnAdapterVK::Query() noexcept
 {
-    parent_instance = instance;
+    const GnVulkanInstanceFunctions& fn = parent_instance->fn;
+
+    // The extension list decides which structures get chained into the property and feature queries below. Without
+    // memory for it, the adapter is reported with core Vulkan 1.0 support only.
+    uint32_t num_extensions = 0;
+    fn.vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &num_extensions, nullptr);
+
+    if (extensions.resize(num_extensions))
+        fn.vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &num_extensions, extensions.data());
 
     VkPhysicalDeviceProperties vk_properties;
     fn.vkGetPhysicalDeviceProperties(physical_device, &vk_properties);
@@ -1571,6 +2226,29 @@ GnAdapterVK::GnAdapterVK(GnInstanceVK*                      instance,
     std::memcpy(properties.name, vk_properties.deviceName, GN_MAX_CHARS);
     properties.vendor_id = vk_properties.vendorID;
     api_version = vk_properties.apiVersion;
+    device_id = vk_properties.deviceID;
+    std::memcpy(pipeline_cache_uuid, vk_properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+    const bool descriptor_indexing_supported =
+        api_version >= VK_API_VERSION_1_2 || IsExtensionSupported(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+
+    descriptor_indexing_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+    descriptor_indexing_properties.pNext = nullptr;
+
+    if (fn.vkGetPhysicalDeviceProperties2 != nullptr) {
+        VkPhysicalDeviceIDProperties id_properties{};
+        id_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+
+        if (descriptor_indexing_supported)
+            id_properties.pNext = &descriptor_indexing_properties;
+
+        VkPhysicalDeviceProperties2 vk_properties2{};
+        vk_properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        vk_properties2.pNext = &id_properties;
+
+        fn.vkGetPhysicalDeviceProperties2(physical_device, &vk_properties2);
+        std::memcpy(driver_uuid, id_properties.driverUUID, VK_UUID_SIZE);
+    }
 
     // Sets adapter type
     switch (vk_properties.deviceType) {
@@ -1621,8 +2299,32 @@ GnAdapterVK::GnAdapterVK(GnInstanceVK*                      instance,
 
     depth_clip_enable_feature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLIP_ENABLE_FEATURES_EXT;
     depth_clip_enable_feature.pNext = nullptr;
+    synchronization2_feature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+    synchronization2_feature.pNext = nullptr;
+    timeline_semaphore_feature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+    timeline_semaphore_feature.pNext = nullptr;
+    maintenance5_feature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_5_FEATURES_KHR;
+    maintenance5_feature.pNext = nullptr;
+    descriptor_indexing_feature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    descriptor_indexing_feature.pNext = nullptr;
     supported_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
-    supported_features.pNext = &depth_clip_enable_feature;
+    supported_features.pNext = nullptr;
+
+    GnStructChainBuilderVK feature_chain(&supported_features);
+    feature_chain.push(&depth_clip_enable_feature);
+
+    if (api_version >= VK_API_VERSION_1_3 || IsExtensionSupported(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME))
+        feature_chain.push(&synchronization2_feature);
+
+    if (api_version >= VK_API_VERSION_1_2 || IsExtensionSupported(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME))
+        feature_chain.push(&timeline_semaphore_feature);
+
+    // maintenance5 depends on dynamic rendering, only use it where that is core.
+    if (api_version >= VK_API_VERSION_1_3 && IsExtensionSupported(VK_KHR_MAINTENANCE_5_EXTENSION_NAME))
+        feature_chain.push(&maintenance5_feature);
+
+    if (descriptor_indexing_supported && fn.vkGetPhysicalDeviceProperties2 != nullptr)
+        feature_chain.push(&descriptor_indexing_feature);
 
     fn.vkGetPhysicalDeviceFeatures2(physical_device, &supported_features);
 
@@ -1640,6 +2342,14 @@ GnAdapterVK::GnAdapterVK(GnInstanceVK*                      instance,
     features[GnFeature_PointPolygonMode] = vk_features_1.fillModeNonSolid;
     features[GnFeature_ColorTargetLogicOp] = vk_features_1.logicOp;
     features[GnFeature_UnclippedDepth] = depth_clip_enable_feature.depthClipEnable;
+    features[GnFeature_TimelineFence] = timeline_semaphore_feature.timelineSemaphore;
+    features[GnFeature_Bindless] =
+        descriptor_indexing_feature.runtimeDescriptorArray &&
+        descriptor_indexing_feature.descriptorBindingPartiallyBound &&
+        descriptor_indexing_feature.descriptorBindingUpdateUnusedWhilePending &&
+        descriptor_indexing_feature.descriptorBindingSampledImageUpdateAfterBind &&
+        descriptor_indexing_feature.descriptorBindingStorageImageUpdateAfterBind &&
+        descriptor_indexing_feature.descriptorBindingStorageBufferUpdateAfterBind;
 
     // Get the available queues
     VkQueueFamilyProperties queue_families[4]{};
@@ -1682,7 +2392,8 @@ GnAdapterVK::GnAdapterVK(GnInstanceVK*                      instance,
                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
                       VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                      VK_MEMORY_PROPERTY_HOST_CACHED_BIT))
+                      VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+                      VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT))
         {
             continue;
         }
@@ -1691,7 +2402,8 @@ GnAdapterVK::GnAdapterVK(GnInstanceVK*                      instance,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
-            VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+            VK_MEMORY_PROPERTY_HOST_CACHED_BIT |
+            VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
 
         memory_properties.memory_types[i].pool_index = type.heapIndex;
         memory_properties.memory_types[i].attribute = type.propertyFlags & required_property;
@@ -1699,11 +2411,33 @@ GnAdapterVK::GnAdapterVK(GnInstanceVK*                      instance,
     }
 }
 
-GnTextureFormatFeatureFlags GnAdapterVK::GetTextureFormatFeatureSupport(GnFormat format) const noexcept
+bool GnAdapterVK::IsExtensionSupported(const char* name) const noexcept
+{
+    for (size_t i = 0; i < extensions.size(); i++)
+        if (strncmp(extensions[i].extensionName, name, VK_MAX_EXTENSION_NAME_SIZE) == 0)
+            return true;
+
+    return false;
+}
+
+const VkFormatProperties& GnAdapterVK::GetFormatProperties(GnFormat format) const noexcept
 {
-    VkFormatProperties fmt;
-    parent_instance->fn.vkGetPhysicalDeviceFormatProperties(physical_device, GnConvertToVkFormat(format), &fmt);
+    std::scoped_lock lock(format_lock);
 
+    if (!queried_formats[format]) {
+        uint64_t start = GnGetTimeNs();
+        parent_instance->fn.vkGetPhysicalDeviceFormatProperties(physical_device, GnConvertToVkFormat(format), &format_properties[format]);
+        queried_formats[format] = true;
+        query_ns += GnGetTimeNs() - start;
+    }
+
+    // Entries are never written again once queried
+    return format_properties[format];
+}
+
+GnTextureFormatFeatureFlags GnAdapterVK::GetTextureFormatFeatureSupport(GnFormat format) const noexcept
+{
+    const VkFormatProperties& fmt = GetFormatProperties(format);
     VkFormatFeatureFlags features = fmt.optimalTilingFeatures & fmt.linearTilingFeatures; // intersect
     GnTextureFormatFeatureFlags ret = 0;
     
@@ -1743,8 +2477,7 @@ GnSampleCountFlags GnAdapterVK::GetTextureFormatMultisampleSupport(GnFormat form
 
 GnBool GnAdapterVK::IsVertexFormatSupported(GnFormat format) const noexcept
 {
-    VkFormatProperties fmt;
-    parent_instance->fn.vkGetPhysicalDeviceFormatProperties(physical_device, GnConvertToVkFormat(format), &fmt);
+    const VkFormatProperties& fmt = GetFormatProperties(format);
     return GnContainsBit(fmt.bufferFeatures, VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT);
 }
 
@@ -1769,6 +2502,7 @@ void GnAdapterVK::GetSurfaceProperties(GnSurface surface, GnSurfaceProperties* p
     properties->max_buffers = std::min(surf_caps.maxImageCount, (uint32_t)GN_MAX_SWAPCHAIN_BUFFERS);
     properties->min_buffers = surf_caps.minImageCount;
     properties->immediate_presentable = false;
+    properties->mailbox_presentable = false;
 
     VkPresentModeKHR present_modes[6];
     uint32_t num_present_modes = 0;
@@ -1779,10 +2513,10 @@ void GnAdapterVK::GetSurfaceProperties(GnSurface surface, GnSurfaceProperties* p
 
     for (uint32_t i = 0; i < num_present_modes; i++) {
         // Check if we can present a swapchain without vsync.
-        if (present_modes[i] == VK_PRESENT_MODE_IMMEDIATE_KHR) {
+        if (present_modes[i] == VK_PRESENT_MODE_IMMEDIATE_KHR)
             properties->immediate_presentable = true;
-            break;
-        }
+        else if (present_modes[i] == VK_PRESENT_MODE_MAILBOX_KHR)
+            properties->mailbox_presentable = true;
     }
 }
 
@@ -1875,6 +2609,72 @@ GnResult GnAdapterVK::CreateDevice(const GnDeviceDesc* desc, GnDevice* device) n
         chain_builder.push(&depth_clip_enable_feature);
     }
 
+    // Use precise per-barrier stage masks whenever the implementation allows it.
+    VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2_enable_feature{};
+    synchronization2_enable_feature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+
+    GnDeviceVersionInfoVK device_ver_info{};
+    device_ver_info.api_version = api_version;
+
+    if (synchronization2_feature.synchronization2) {
+        if (api_version < VK_API_VERSION_1_3)
+            device_extensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+
+        synchronization2_enable_feature.synchronization2 = VK_TRUE;
+        chain_builder.push(&synchronization2_enable_feature);
+        device_ver_info.synchronization2_enabled = true;
+    }
+
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_semaphore_enable_feature{};
+    timeline_semaphore_enable_feature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+
+    if (timeline_semaphore_feature.timelineSemaphore) {
+        if (api_version < VK_API_VERSION_1_2)
+            device_extensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+
+        timeline_semaphore_enable_feature.timelineSemaphore = VK_TRUE;
+        chain_builder.push(&timeline_semaphore_enable_feature);
+        device_ver_info.timeline_semaphore_enabled = true;
+    }
+
+    // Lets pipelines take SPIR-V directly instead of going through shader modules.
+    VkPhysicalDeviceMaintenance5FeaturesKHR maintenance5_enable_feature{};
+    maintenance5_enable_feature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_5_FEATURES_KHR;
+
+    if (maintenance5_feature.maintenance5) {
+        device_extensions.push_back(VK_KHR_MAINTENANCE_5_EXTENSION_NAME);
+        maintenance5_enable_feature.maintenance5 = VK_TRUE;
+        chain_builder.push(&maintenance5_enable_feature);
+        device_ver_info.maintenance5_enabled = true;
+    }
+
+    // Lets descriptor sets be written from packed descriptor arrays.
+    if (api_version >= VK_API_VERSION_1_1) {
+        device_ver_info.descriptor_update_template_enabled = true;
+    }
+    else if (IsExtensionSupported(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME)) {
+        device_extensions.push_back(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME);
+        device_ver_info.descriptor_update_template_enabled = true;
+    }
+
+    // Every supported descriptor indexing feature is enabled so shaders may also index the heap non-uniformly.
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptor_indexing_enable_feature = descriptor_indexing_feature;
+    descriptor_indexing_enable_feature.pNext = nullptr;
+
+    const GnFeature* enabled_features_end = desc->enabled_features + desc->num_enabled_features;
+    const bool bindless_enabled = features[GnFeature_Bindless] &&
+        std::find(desc->enabled_features, enabled_features_end, GnFeature_Bindless) != enabled_features_end;
+
+    if (bindless_enabled) {
+        if (api_version < VK_API_VERSION_1_1)
+            device_extensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+
+        if (api_version < VK_API_VERSION_1_2)
+            device_extensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+
+        chain_builder.push(&descriptor_indexing_enable_feature);
+    }
+
     if (!GnConvertAndCheckDeviceFeatures(desc->num_enabled_features, desc->enabled_features, features, enabled_features))
         return GnError_UnsupportedFeature;
 
@@ -1930,7 +2730,7 @@ GnResult GnAdapterVK::CreateDevice(const GnDeviceDesc* desc, GnDevice* device) n
         return GnConvertFromVkResult(result);
     }
 
-    if (!g_vk_dispatcher->LoadDeviceFunctions(parent_instance->instance, vk_device, api_version, new_device->fn)) {
+    if (!g_vk_dispatcher->LoadDeviceFunctions(parent_instance->instance, vk_device, device_ver_info, new_device->fn)) {
         std::free(queues);
         delete new_device;
         return GnError_InternalError;
@@ -1958,6 +2758,7 @@ GnResult GnAdapterVK::CreateDevice(const GnDeviceDesc* desc, GnDevice* device) n
     new_device->num_enabled_queue_groups = desc->num_enabled_queue_groups;
     new_device->enabled_queues = queues;
     new_device->non_coherent_atom_size = non_coherent_atom_size;
+    new_device->ver_info = device_ver_info;
 
     // Initialize queues
     for (uint32_t i = 0; i < desc->num_enabled_queue_groups; ++i) {
@@ -1968,7 +2769,7 @@ GnResult GnAdapterVK::CreateDevice(const GnDeviceDesc* desc, GnDevice* device) n
 
             auto queue = new(&queues[new_device->total_enabled_queues]) GnQueueVK();
 
-            if (GN_VULKAN_FAILED(queue->Init(new_device, vk_queue))) {
+            if (GN_VULKAN_FAILED(queue->Init(new_device, vk_queue, group_desc.index))) {
                 delete new_device;
                 return GnError_InternalError;
             }
@@ -1977,12 +2778,213 @@ GnResult GnAdapterVK::CreateDevice(const GnDeviceDesc* desc, GnDevice* device) n
         }
     }
 
-    *device = new_device;
+    if (bindless_enabled) {
+        GnResult heap_result = new_device->bindless_heap.Init(new_device, this, desc);
 
-    return GnSuccess;
-}
+        if (GN_FAILED(heap_result)) {
+            delete new_device;
+            return heap_result;
+        }
+    }
+
+    *device = new_device;
+
+    return GnSuccess;
+}
+
+inline bool GnSubpassLayoutVK::Init(uint32_t num_subpasses, const GnRenderPassSubpassDesc* subpasses, uint32_t num_color_targets) noexcept
+{
+    this->num_subpasses = 0;
+
+    if (num_subpasses > GN_MAX_SUBPASSES)
+        return false;
+
+    for (uint32_t i = 0; i < num_subpasses; i++) {
+        const GnRenderPassSubpassDesc& subpass_desc = subpasses[i];
+        Subpass& subpass = this->subpasses[i];
+
+        if (subpass_desc.num_color_targets > GN_MAX_COLOR_TARGETS || subpass_desc.num_input_targets > GN_MAX_COLOR_TARGETS + 1)
+            return false;
+
+        subpass.num_color_targets = (uint8_t)subpass_desc.num_color_targets;
+        subpass.num_input_targets = (uint8_t)subpass_desc.num_input_targets;
+        subpass.use_depth_stencil_target = subpass_desc.use_depth_stencil_target;
+
+        for (uint32_t j = 0; j < subpass_desc.num_color_targets; j++) {
+            if (subpass_desc.color_targets[j] >= num_color_targets)
+                return false;
+
+            subpass.color_targets[j] = (uint8_t)subpass_desc.color_targets[j];
+        }
+
+        for (uint32_t j = 0; j < subpass_desc.num_input_targets; j++) {
+            uint32_t target = subpass_desc.input_targets[j];
+
+            if (target >= num_color_targets && target != GN_DEPTH_STENCIL_TARGET)
+                return false;
+
+            subpass.input_targets[j] = (uint8_t)target;
+        }
+    }
+
+    this->num_subpasses = num_subpasses;
+
+    return true;
+}
+
+inline void GnSubpassLayoutVK::CombineHash(size_t& hash) const noexcept
+{
+    GnCombineHash(hash, num_subpasses);
+
+    for (uint32_t i = 0; i < num_subpasses; i++) {
+        const Subpass& subpass = subpasses[i];
+
+        GnCombineHash(hash, subpass.num_color_targets, subpass.num_input_targets, subpass.use_depth_stencil_target);
+
+        for (uint32_t j = 0; j < subpass.num_color_targets; j++)
+            GnCombineHash(hash, subpass.color_targets[j]);
+
+        for (uint32_t j = 0; j < subpass.num_input_targets; j++)
+            GnCombineHash(hash, subpass.input_targets[j]);
+    }
+}
+
+inline bool GnSubpassLayoutVK::operator==(const GnSubpassLayoutVK& other) const noexcept
+{
+    if (num_subpasses != other.num_subpasses)
+        return false;
+
+    for (uint32_t i = 0; i < num_subpasses; i++) {
+        const Subpass& a = subpasses[i];
+        const Subpass& b = other.subpasses[i];
+
+        if (a.num_color_targets != b.num_color_targets ||
+            a.num_input_targets != b.num_input_targets ||
+            a.use_depth_stencil_target != b.use_depth_stencil_target ||
+            std::memcmp(a.color_targets, b.color_targets, a.num_color_targets) != 0 ||
+            std::memcmp(a.input_targets, b.input_targets, a.num_input_targets) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+inline void GnSubpassBuilderVK::Build(const GnSubpassLayoutVK& layout, const uint32_t* color_attachments, uint32_t depth_stencil_attachment) noexcept
+{
+    // Subpasses only depend on each other through their targets, every access happens in the fragment stages.
+    static constexpr VkPipelineStageFlags fragment_stages =
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+        VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+
+    static constexpr VkAccessFlags target_write_access =
+        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    static constexpr VkAccessFlags target_access =
+        target_write_access |
+        VK_ACCESS_INPUT_ATTACHMENT_READ_BIT |
+        VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+
+    // Subpasses using each target, the depth-stencil target is at GN_DEPTH_STENCIL_TARGET.
+    uint32_t target_usage[GN_MAX_COLOR_TARGETS + 1]{};
+
+    for (uint32_t i = 0; i < layout.num_subpasses; i++) {
+        const GnSubpassLayoutVK::Subpass& subpass = layout.subpasses[i];
+
+        for (uint32_t j = 0; j < subpass.num_color_targets; j++)
+            target_usage[subpass.color_targets[j]] |= 1 << i;
+
+        for (uint32_t j = 0; j < subpass.num_input_targets; j++)
+            target_usage[subpass.input_targets[j]] |= 1 << i;
+
+        if (subpass.use_depth_stencil_target)
+            target_usage[GN_DEPTH_STENCIL_TARGET] |= 1 << i;
+    }
+
+    num_dependencies = 0;
+
+    for (uint32_t i = 0; i < layout.num_subpasses; i++) {
+        const GnSubpassLayoutVK::Subpass& subpass = layout.subpasses[i];
+        uint32_t read_targets = 0;
+
+        for (uint32_t j = 0; j < subpass.num_input_targets; j++)
+            read_targets |= 1 << subpass.input_targets[j];
+
+        // Targets that are read and written by the same subpass have to stay in the general layout.
+        for (uint32_t j = 0; j < subpass.num_color_targets; j++) {
+            uint32_t target = subpass.color_targets[j];
+            color_refs[i][j].attachment = color_attachments[target];
+            color_refs[i][j].layout = GnHasBit(read_targets, 1 << target) ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        }
+
+        // Input attachments are always read in the general layout, which is the layout their descriptors are written
+        // with, whether or not the subpass also writes them.
+        for (uint32_t j = 0; j < subpass.num_input_targets; j++) {
+            uint32_t target = subpass.input_targets[j];
+            input_refs[i][j].attachment = target == GN_DEPTH_STENCIL_TARGET ? depth_stencil_attachment : color_attachments[target];
+            input_refs[i][j].layout = VK_IMAGE_LAYOUT_GENERAL;
+        }
+
+        depth_stencil_refs[i].attachment = depth_stencil_attachment;
+        depth_stencil_refs[i].layout = GnHasBit(read_targets, 1 << GN_DEPTH_STENCIL_TARGET) ?
+            VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        // Targets used before and after this subpass must keep their contents.
+        uint32_t num_preserve_attachments = 0;
+
+        for (uint32_t target = 0; target <= GN_DEPTH_STENCIL_TARGET; target++) {
+            uint32_t usage = target_usage[target];
+            uint32_t attachment = target == GN_DEPTH_STENCIL_TARGET ? depth_stencil_attachment : color_attachments[target];
+
+            if (attachment == VK_ATTACHMENT_UNUSED || GnHasBit(usage, 1 << i) ||
+                (usage & ((1 << i) - 1)) == 0 || (usage >> (i + 1)) == 0)
+            {
+                continue;
+            }
+
+            preserve_attachments[i][num_preserve_attachments++] = attachment;
+        }
+
+        VkSubpassDescription& vk_subpass = subpasses[i];
+        vk_subpass.flags = 0;
+        vk_subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        vk_subpass.inputAttachmentCount = subpass.num_input_targets;
+        vk_subpass.pInputAttachments = input_refs[i];
+        vk_subpass.colorAttachmentCount = subpass.num_color_targets;
+        vk_subpass.pColorAttachments = color_refs[i];
+        vk_subpass.pResolveAttachments = nullptr;
+        vk_subpass.pDepthStencilAttachment = subpass.use_depth_stencil_target ? &depth_stencil_refs[i] : nullptr;
+        vk_subpass.preserveAttachmentCount = num_preserve_attachments;
+        vk_subpass.pPreserveAttachments = preserve_attachments[i];
+
+        for (uint32_t j = 0; j < i; j++) {
+            bool shares_target = false;
+
+            for (uint32_t target = 0; target <= GN_DEPTH_STENCIL_TARGET; target++)
+                if (GnHasBit(target_usage[target], 1 << i) && GnHasBit(target_usage[target], 1 << j))
+                    shares_target = true;
+
+            if (!shares_target)
+                continue;
+
+            VkSubpassDependency& dependency = dependencies[num_dependencies++];
+            dependency.srcSubpass = j;
+            dependency.dstSubpass = i;
+            dependency.srcStageMask = fragment_stages;
+            dependency.dstStageMask = fragment_stages;
+            dependency.srcAccessMask = target_write_access;
+            dependency.dstAccessMask = target_access;
+            dependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+        }
+    }
+}
 
-inline void GnRenderPassCacheKey::Init(const GnRenderPassBeginDesc* desc)
+inline bool GnRenderPassCacheKey::Init(const GnRenderPassBeginDesc* desc)
 {
     sample_count = desc->sample_count;
     num_color_targets = desc->num_color_targets;
@@ -2020,6 +3022,7 @@ inline void GnRenderPassCacheKey::Init(const GnRenderPassBeginDesc* desc)
 
     if (has_depth_stencil_target) {
         depth_stencil_target_format = desc->depth_stencil_target->view->format;
+        depth_stencil_target_access = desc->depth_stencil_target->access;
         depth_load_op = desc->depth_stencil_target->depth_load_op;
         depth_store_op = desc->depth_stencil_target->depth_store_op;
         stencil_load_op = desc->depth_stencil_target->stencil_load_op;
@@ -2027,13 +3030,23 @@ inline void GnRenderPassCacheKey::Init(const GnRenderPassBeginDesc* desc)
 
         GnCombineHash(hash, has_depth_stencil_target,
                       depth_stencil_target_format,
+                      depth_stencil_target_access,
                       depth_load_op,
                       depth_store_op,
                       stencil_load_op,
                       stencil_store_op);
     }
 
+    if (desc->num_subpasses > 0 && resolve_target_mask != 0)
+        return false;
+
+    if (!subpass_layout.Init(desc->num_subpasses, desc->subpasses, num_color_targets))
+        return false;
+
+    subpass_layout.CombineHash(hash);
     calculated_hash = hash;
+
+    return true;
 }
 
 inline size_t GnRenderPassCacheKey::GetHash(const GnRenderPassCacheKey& key) noexcept
@@ -2047,7 +3060,8 @@ inline bool GnRenderPassCacheKey::CompareKey(const GnRenderPassCacheKey& a, cons
         a.num_color_targets != b.num_color_targets ||
         a.color_target_mask != b.color_target_mask ||
         a.resolve_target_mask != b.resolve_target_mask ||
-        a.has_depth_stencil_target != b.has_depth_stencil_target)
+        a.has_depth_stencil_target != b.has_depth_stencil_target ||
+        !(a.subpass_layout == b.subpass_layout))
     {
         return false;
     }
@@ -2065,7 +3079,7 @@ inline bool GnRenderPassCacheKey::CompareKey(const GnRenderPassCacheKey& a, cons
     }
 
     for (uint32_t i = 0; i < a.num_color_targets; i++) {
-        if (!GnContainsBit(a.color_target_mask, i << 1))
+        if (!GnContainsBit(a.color_target_mask, 1 << i))
             continue;
 
         const auto& a_color_target = a.color_targets[i];
@@ -2084,9 +3098,9 @@ inline bool GnRenderPassCacheKey::CompareKey(const GnRenderPassCacheKey& a, cons
     return true;
 }
 
-inline void GnFramebufferCacheKey::Init(const GnRenderPassBeginDesc* desc)
+inline void GnFramebufferCacheKey::Init(const GnRenderPassBeginDesc* desc, VkRenderPass render_pass)
 {
-    size_t hash = 0;
+    size_t hash = GnCalcHash(render_pass);
     uint32_t current_view = 0;
 
     for (uint32_t i = 0; i < desc->num_color_targets; i++) {
@@ -2108,6 +3122,7 @@ inline void GnFramebufferCacheKey::Init(const GnRenderPassBeginDesc* desc)
         }
     }
 
+    this->render_pass = render_pass;
     num_render_targets = current_view;
     GnCombineHash(hash, num_render_targets);
     calculated_hash = hash;
@@ -2120,7 +3135,7 @@ inline size_t GnFramebufferCacheKey::GetHash(const GnFramebufferCacheKey& key) n
 
 inline bool GnFramebufferCacheKey::CompareKey(const GnFramebufferCacheKey& a, const GnFramebufferCacheKey& b) noexcept
 {
-    if (a.num_render_targets != b.num_render_targets)
+    if (a.render_pass != b.render_pass || a.num_render_targets != b.num_render_targets)
         return false;
 
     for (uint32_t i = 0; i < a.num_render_targets; i++)
@@ -2130,6 +3145,42 @@ inline bool GnFramebufferCacheKey::CompareKey(const GnFramebufferCacheKey& a, co
     return true;
 }
 
+inline void GnCompatibleRenderPassCacheKey::CalculateHash() noexcept
+{
+    size_t hash = GnCalcHash(num_color_targets);
+
+    for (uint32_t i = 0; i < num_color_targets; i++)
+        GnCombineHash(hash, color_target_formats[i]);
+
+    GnCombineHash(hash, sample_count, resolve_target_mask, depth_stencil_target_format);
+    subpass_layout.CombineHash(hash);
+
+    calculated_hash = hash;
+}
+
+inline size_t GnCompatibleRenderPassCacheKey::GetHash(const GnCompatibleRenderPassCacheKey& key) noexcept
+{
+    return key.calculated_hash;
+}
+
+inline bool GnCompatibleRenderPassCacheKey::CompareKey(const GnCompatibleRenderPassCacheKey& a, const GnCompatibleRenderPassCacheKey& b) noexcept
+{
+    if (a.sample_count != b.sample_count ||
+        a.num_color_targets != b.num_color_targets ||
+        a.resolve_target_mask != b.resolve_target_mask ||
+        a.depth_stencil_target_format != b.depth_stencil_target_format ||
+        !(a.subpass_layout == b.subpass_layout))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < a.num_color_targets; i++)
+        if (a.color_target_formats[i] != b.color_target_formats[i])
+            return false;
+
+    return true;
+}
+
 // -- [GnDeviceVK] --
 
 GnDeviceVK::~GnDeviceVK()
@@ -2144,12 +3195,23 @@ GnDeviceVK::~GnDeviceVK()
             fn.vkDestroyRenderPass(device, render_pass, nullptr);
         });
 
+    compatible_render_pass_cache.Flush(
+        [this](VkRenderPass render_pass) {
+            fn.vkDestroyRenderPass(device, render_pass, nullptr);
+        });
+
+    shader_module_cache.Flush(this);
+
     if (enabled_queues) {
-        for (uint32_t i = 0; i < total_enabled_queues; i++)
+        for (uint32_t i = 0; i < total_enabled_queues; i++) {
             enabled_queues[i].Destroy();
+            enabled_queues[i].~GnQueueVK();
+        }
         std::free(enabled_queues);
     }
 
+    bindless_heap.Destroy(this);
+
     if (empty_pipeline_layout) fn.vkDestroyPipelineLayout(device, empty_pipeline_layout, nullptr);
     if (device)
         GN_UNLIKELY if (fn.vkDestroyDevice)
@@ -2206,6 +3268,50 @@ GnResult GnDeviceVK::CreateFence(GnBool signaled, GnFence* fence) noexcept
     new(new_fence) GnFenceVK();
     new_fence->parent_device = this;
     new_fence->fence = vk_fence;
+    new_fence->timeline_semaphore = VK_NULL_HANDLE;
+
+    *fence = new_fence;
+
+    return GnSuccess;
+}
+
+GnResult GnDeviceVK::CreateTimelineFence(uint64_t initial_value, GnFence* fence) noexcept
+{
+    if (!ver_info.HasTimelineSemaphore())
+        return GnError_UnsupportedFeature;
+
+    VkSemaphoreTypeCreateInfoKHR semaphore_type_info;
+    semaphore_type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+    semaphore_type_info.pNext = nullptr;
+    semaphore_type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+    semaphore_type_info.initialValue = initial_value;
+
+    VkSemaphoreCreateInfo semaphore_info;
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphore_info.pNext = &semaphore_type_info;
+    semaphore_info.flags = 0;
+
+    VkSemaphore semaphore;
+    VkResult result = fn.vkCreateSemaphore(device, &semaphore_info, nullptr, &semaphore);
+    if (GN_VULKAN_FAILED(result))
+        return GnConvertFromVkResult(result);
+
+    if (!pool.fence)
+        pool.fence.emplace(64);
+
+    GnFenceVK* new_fence = (GnFenceVK*)pool.fence->allocate();
+
+    if (new_fence == nullptr) {
+        fn.vkDestroySemaphore(device, semaphore, nullptr);
+        return GnError_OutOfHostMemory;
+    }
+
+    new(new_fence) GnFenceVK();
+    new_fence->timeline = true;
+    new_fence->parent_device = this;
+    new_fence->fence = VK_NULL_HANDLE;
+    new_fence->timeline_semaphore = semaphore;
+    new_fence->last_signal_value = initial_value;
 
     *fence = new_fence;
 
@@ -2279,6 +3385,7 @@ GnResult GnDeviceVK::CreateBuffer(const GnBufferDesc* desc, GnBuffer* buffer) no
     impl_buffer->memory_requirements.size = requirements.size;
     impl_buffer->memory_requirements.alignment = requirements.alignment;
     impl_buffer->memory_requirements.supported_memory_type_bits = requirements.memoryTypeBits;
+    bindless_heap.AllocateBuffer(impl_buffer);
 
     *buffer = impl_buffer;
 
@@ -2394,6 +3501,7 @@ GnResult GnDeviceVK::CreateTextureView(const GnTextureViewDesc* desc, GnTextureV
 
     impl_texture_view->view = view;
     impl_texture_view->format = desc->format;
+    bindless_heap.AllocateTextureView(this, GN_TO_VULKAN(GnTexture, desc->texture), impl_texture_view, desc->subresource_range.aspect);
 
     *texture_view = impl_texture_view;
 
@@ -2424,6 +3532,14 @@ GnResult GnDeviceVK::CreateRenderGraph(const GnRenderGraphDesc* desc, GnRenderGr
     if (impl_render_graph == nullptr)
         return GnError_OutOfHostMemory;
 
+    new(impl_render_graph) GnRenderGraphVK();
+
+    // Frame graphs only schedule passes and do not need a render pass object.
+    if (desc == nullptr) {
+        *render_graph = impl_render_graph;
+        return GnSuccess;
+    }
+
     GnSmallVector<VkAttachmentDescription, 32> attachments;
     GnSmallVector<VkSubpassDescription, 16> subpasses;
     GnSmallVector<VkAttachmentReference, 32> color_att_refs;
@@ -2633,6 +3749,7 @@ GnResult GnDeviceVK::CreateRenderGraph(const GnRenderGraphDesc* desc, GnRenderGr
     VkResult result = fn.vkCreateRenderPass(device, &rp_info, nullptr, &vk_render_pass);
 
     if (GN_VULKAN_FAILED(result)) {
+        impl_render_graph->~GnRenderGraphVK();
         pool.render_graph->free(impl_render_graph);
         return GnConvertFromVkResult(result);
     }
@@ -2641,16 +3758,25 @@ GnResult GnDeviceVK::CreateRenderGraph(const GnRenderGraphDesc* desc, GnRenderGr
 
     *render_graph = impl_render_graph;
 
-    return GnError_Unimplemented;
+    return GnSuccess;
 }
 
 GnResult GnDeviceVK::CreateDescriptorTableLayout(const GnDescriptorTableLayoutDesc* desc, GnDescriptorTableLayout* resource_table_layout) noexcept
 {
     GnSmallVector<VkDescriptorSetLayoutBinding, 64> vk_bindings;
+    GnSmallVector<VkDescriptorUpdateTemplateEntryKHR, 64> template_entries;
+
+    if (!vk_bindings.resize(desc->num_bindings) || !template_entries.resize(desc->num_bindings))
+        return GnError_OutOfHostMemory;
+
+    GnDescriptorTableBindingVK* bindings = GnAllocate<GnDescriptorTableBindingVK>(GnMax(desc->num_bindings, 1u));
 
-    if (!vk_bindings.resize(desc->num_bindings))
+    if (bindings == nullptr)
         return GnError_OutOfHostMemory;
 
+    uint32_t num_descriptors = 0;
+    bool use_template = ver_info.HasDescriptorUpdateTemplate() && desc->num_bindings > 0;
+
     for (uint32_t i = 0; i < desc->num_bindings; i++) {
         const GnDescriptorTableBinding& binding = desc->bindings[i];
         VkDescriptorSetLayoutBinding& vk_binding = vk_bindings[i];
@@ -2658,6 +3784,25 @@ GnResult GnDeviceVK::CreateDescriptorTableLayout(const GnDescriptorTableLayoutDe
         vk_binding.descriptorType = GnConvertToVkDescriptorType<false>(binding.type);
         vk_binding.descriptorCount = binding.num_resources;
         vk_binding.stageFlags = GnConvertToVkShaderStageFlags(binding.shader_visibility);
+        vk_binding.pImmutableSamplers = nullptr;
+
+        VkDescriptorUpdateTemplateEntryKHR& entry = template_entries[i];
+        entry.dstBinding = binding.binding;
+        entry.dstArrayElement = 0;
+        entry.descriptorCount = binding.num_resources;
+        entry.descriptorType = vk_binding.descriptorType;
+        entry.offset = sizeof(GnDescriptorInfoVK) * num_descriptors;
+        entry.stride = sizeof(GnDescriptorInfoVK);
+
+        bindings[i].binding = binding.binding;
+        bindings[i].type = binding.type;
+        bindings[i].first_descriptor = num_descriptors;
+        bindings[i].num_descriptors = binding.num_resources;
+        num_descriptors += binding.num_resources;
+
+        // Sampler descriptors can't be written yet
+        if (binding.type == GnResourceType_Sampler)
+            use_template = false;
     }
 
     VkDescriptorSetLayoutCreateInfo set_layout_info;
@@ -2669,8 +3814,31 @@ GnResult GnDeviceVK::CreateDescriptorTableLayout(const GnDescriptorTableLayoutDe
 
     VkDescriptorSetLayout set_layout;
     VkResult result = fn.vkCreateDescriptorSetLayout(device, &set_layout_info, nullptr, &set_layout);
-    if (GN_VULKAN_FAILED(result))
+
+    if (GN_VULKAN_FAILED(result)) {
+        GnFree(bindings);
         return GnConvertFromVkResult(result);
+    }
+
+    VkDescriptorUpdateTemplateKHR update_template = VK_NULL_HANDLE;
+
+    if (use_template) {
+        VkDescriptorUpdateTemplateCreateInfoKHR template_info;
+        template_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR;
+        template_info.pNext = nullptr;
+        template_info.flags = 0;
+        template_info.descriptorUpdateEntryCount = desc->num_bindings;
+        template_info.pDescriptorUpdateEntries = template_entries.storage;
+        template_info.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR;
+        template_info.descriptorSetLayout = set_layout;
+        template_info.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS; // Ignored
+        template_info.pipelineLayout = VK_NULL_HANDLE;
+        template_info.set = 0;
+
+        // Writes fall back to plain descriptor writes without a template.
+        if (GN_VULKAN_FAILED(fn.vkCreateDescriptorUpdateTemplateKHR(device, &template_info, nullptr, &update_template)))
+            update_template = VK_NULL_HANDLE;
+    }
 
     if (!pool.resource_table_layout)
         pool.resource_table_layout.emplace(128);
@@ -2678,11 +3846,21 @@ GnResult GnDeviceVK::CreateDescriptorTableLayout(const GnDescriptorTableLayoutDe
     GnDescriptorTableLayoutVK* impl_resource_table_layout = (GnDescriptorTableLayoutVK*)pool.resource_table_layout->allocate();
 
     if (impl_resource_table_layout == nullptr) {
+        if (update_template != VK_NULL_HANDLE)
+            fn.vkDestroyDescriptorUpdateTemplateKHR(device, update_template, nullptr);
         fn.vkDestroyDescriptorSetLayout(device, set_layout, nullptr);
+        GnFree(bindings);
         return GnError_OutOfHostMemory;
     }
 
     impl_resource_table_layout->set_layout = set_layout;
+    impl_resource_table_layout->update_template = update_template;
+    impl_resource_table_layout->num_bindings = desc->num_bindings;
+    impl_resource_table_layout->bindings = bindings;
+    impl_resource_table_layout->num_descriptors = num_descriptors;
+    impl_resource_table_layout->content_hash = GnHashDescriptorTableLayoutDesc(desc);
+
+    *resource_table_layout = impl_resource_table_layout;
 
     return GnSuccess;
 }
@@ -2715,12 +3893,14 @@ GnResult GnDeviceVK::CreatePipelineLayout(const GnPipelineLayoutDesc* desc, GnPi
     }
 
     VkDescriptorSetLayout global_resource_layout = VK_NULL_HANDLE;
+    VkDescriptorUpdateTemplateKHR global_resource_template = VK_NULL_HANDLE;
     uint32_t global_resource_binding_mask = 0;
     uint32_t num_global_uniform_buffers = 0;
     uint32_t num_global_storage_buffers = 0;
 
     if (desc->num_resources > 0 && desc->resources != nullptr) {
         GnSmallVector<VkDescriptorSetLayoutBinding, 32> global_resource_bindings;
+        VkDescriptorType global_resource_types[32];
 
         if (!global_resource_bindings.resize(desc->num_resources))
             return GnError_OutOfHostMemory;
@@ -2735,6 +3915,7 @@ GnResult GnDeviceVK::CreatePipelineLayout(const GnPipelineLayoutDesc* desc, GnPi
             binding.pImmutableSamplers = nullptr;
 
             global_resource_binding_mask |= 1 << global_resource.binding;
+            global_resource_types[global_resource.binding] = binding.descriptorType;
 
             if (binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
                 num_global_uniform_buffers++;
@@ -2754,8 +3935,69 @@ GnResult GnDeviceVK::CreatePipelineLayout(const GnPipelineLayoutDesc* desc, GnPi
         if (GN_VULKAN_FAILED(result))
             return GnConvertFromVkResult(result);
 
-        if (!set_layouts.push_back(global_resource_layout))
+        if (ver_info.HasDescriptorUpdateTemplate()) {
+            // The command list feeds this template with one buffer info per binding, in ascending binding order.
+            VkDescriptorUpdateTemplateEntryKHR template_entries[32];
+            uint32_t num_template_entries = 0;
+
+            for (uint32_t i = 0; i < 32; i++) {
+                if (!GnContainsBit(global_resource_binding_mask, 1u << i))
+                    continue;
+
+                VkDescriptorUpdateTemplateEntryKHR& entry = template_entries[num_template_entries];
+                entry.dstBinding = i;
+                entry.dstArrayElement = 0;
+                entry.descriptorCount = 1;
+                entry.descriptorType = global_resource_types[i];
+                entry.offset = sizeof(VkDescriptorBufferInfo) * num_template_entries;
+                entry.stride = sizeof(VkDescriptorBufferInfo);
+                num_template_entries++;
+            }
+
+            VkDescriptorUpdateTemplateCreateInfoKHR template_info;
+            template_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR;
+            template_info.pNext = nullptr;
+            template_info.flags = 0;
+            template_info.descriptorUpdateEntryCount = num_template_entries;
+            template_info.pDescriptorUpdateEntries = template_entries;
+            template_info.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR;
+            template_info.descriptorSetLayout = global_resource_layout;
+            template_info.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS; // Ignored
+            template_info.pipelineLayout = VK_NULL_HANDLE;
+            template_info.set = 0;
+
+            if (GN_VULKAN_FAILED(fn.vkCreateDescriptorUpdateTemplateKHR(device, &template_info, nullptr, &global_resource_template)))
+                global_resource_template = VK_NULL_HANDLE;
+        }
+
+        if (!set_layouts.push_back(global_resource_layout)) {
+            if (global_resource_template != VK_NULL_HANDLE)
+                fn.vkDestroyDescriptorUpdateTemplateKHR(device, global_resource_template, nullptr);
+            fn.vkDestroyDescriptorSetLayout(device, global_resource_layout, nullptr);
+            return GnError_OutOfHostMemory;
+        }
+    }
+
+    uint32_t bindless_set_index = GN_INVALID;
+
+    if (desc->use_bindless_resources) {
+        if (!bindless_heap.IsEnabled()) {
+            if (global_resource_template != VK_NULL_HANDLE)
+                fn.vkDestroyDescriptorUpdateTemplateKHR(device, global_resource_template, nullptr);
+            if (global_resource_layout != VK_NULL_HANDLE)
+                fn.vkDestroyDescriptorSetLayout(device, global_resource_layout, nullptr);
+            return GnError_UnsupportedFeature;
+        }
+
+        bindless_set_index = (uint32_t)set_layouts.size;
+
+        if (!set_layouts.push_back(bindless_heap.set_layout)) {
+            if (global_resource_template != VK_NULL_HANDLE)
+                fn.vkDestroyDescriptorUpdateTemplateKHR(device, global_resource_template, nullptr);
+            if (global_resource_layout != VK_NULL_HANDLE)
+                fn.vkDestroyDescriptorSetLayout(device, global_resource_layout, nullptr);
             return GnError_OutOfHostMemory;
+        }
     }
 
     VkPipelineLayoutCreateInfo pipeline_layout_info;
@@ -2771,6 +4013,8 @@ GnResult GnDeviceVK::CreatePipelineLayout(const GnPipelineLayoutDesc* desc, GnPi
     VkResult result = fn.vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr, &layout);
 
     if (GN_VULKAN_FAILED(result)) {
+        if (global_resource_template != VK_NULL_HANDLE)
+            fn.vkDestroyDescriptorUpdateTemplateKHR(device, global_resource_template, nullptr);
         if (global_resource_layout != VK_NULL_HANDLE)
             fn.vkDestroyDescriptorSetLayout(device, global_resource_layout, nullptr);
         return GnConvertFromVkResult(result);
@@ -2783,6 +4027,8 @@ GnResult GnDeviceVK::CreatePipelineLayout(const GnPipelineLayoutDesc* desc, GnPi
 
     if (impl_pipeline_layout == nullptr) {
         fn.vkDestroyPipelineLayout(device, layout, nullptr);
+        if (global_resource_template != VK_NULL_HANDLE)
+            fn.vkDestroyDescriptorUpdateTemplateKHR(device, global_resource_template, nullptr);
         if (global_resource_layout != VK_NULL_HANDLE)
             fn.vkDestroyDescriptorSetLayout(device, global_resource_layout, nullptr);
         return GnError_OutOfHostMemory;
@@ -2793,39 +4039,41 @@ GnResult GnDeviceVK::CreatePipelineLayout(const GnPipelineLayoutDesc* desc, GnPi
     impl_pipeline_layout->num_shader_constants = desc->num_constant_ranges;
     impl_pipeline_layout->pipeline_layout = layout;
     impl_pipeline_layout->global_resource_layout = global_resource_layout;
+    impl_pipeline_layout->global_resource_template = global_resource_template;
     impl_pipeline_layout->global_resource_binding_mask = global_resource_binding_mask;
+    impl_pipeline_layout->content_hash = GnHashPipelineLayoutDesc(desc);
     impl_pipeline_layout->num_global_uniform_buffers = num_global_uniform_buffers;
     impl_pipeline_layout->num_global_storage_buffers = num_global_storage_buffers;
     impl_pipeline_layout->push_constants_stage_flags = push_constants_stage_flags;
+    impl_pipeline_layout->bindless_set_index = bindless_set_index;
 
     *pipeline_layout = impl_pipeline_layout;
 
     return GnSuccess;
 }
 
-GnResult GnDeviceVK::CreateGraphicsPipeline(const GnGraphicsPipelineDesc* desc, GnPipeline* pipeline) noexcept
+GnResult GnDeviceVK::GetCompatibleRenderPass(const GnCompatibleRenderPassCacheKey& key, VkRenderPass* render_pass) noexcept
 {
-    if (!pool.pipeline)
-        pool.pipeline.emplace(128);
+    auto cached_render_pass = compatible_render_pass_cache.Get(key);
 
-    const GnFragmentInterfaceStateDesc* fragment = desc->fragment_interface;
-    bool has_depth_stencil = desc->depth_stencil != nullptr && fragment->depth_stencil_target_format != GnFormat_Unknown;
-    bool has_color_target = fragment->num_color_targets > 0 && fragment->color_target_formats != nullptr;
-    VkSampleCountFlagBits sample_count = (VkSampleCountFlagBits)desc->multisample->num_samples;
+    if (cached_render_pass) {
+        *render_pass = *cached_render_pass;
+        return GnSuccess;
+    }
 
-    // Here we are going to create a temporary render pass so that the pipeline
-    // knows the information about its render target/attachment.
-    GnSmallVector<VkAttachmentDescription, 32> attachments;
-    VkAttachmentReference color_att_refs[32];
-    VkAttachmentReference resolve_att_refs[32];
+    VkSampleCountFlagBits sample_count = (VkSampleCountFlagBits)key.sample_count;
+    bool has_depth_stencil = key.depth_stencil_target_format != GnFormat_Unknown;
+    GnSmallVector<VkAttachmentDescription, GN_MAX_COLOR_TARGETS * 2 + 1> attachments;
+    VkAttachmentReference color_att_refs[GN_MAX_COLOR_TARGETS];
+    VkAttachmentReference resolve_att_refs[GN_MAX_COLOR_TARGETS];
     VkAttachmentReference depth_stencil_att_ref;
     uint32_t num_used_render_targets = 0;
 
-    for (uint32_t i = 0; i < fragment->num_color_targets; i++) {
+    for (uint32_t i = 0; i < key.num_color_targets; i++) {
         auto& color_att_ref = color_att_refs[i];
         color_att_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
-        if (fragment->color_target_formats[i] == GnFormat_Unknown) {
+        if (key.color_target_formats[i] == GnFormat_Unknown) {
             color_att_ref.attachment = VK_ATTACHMENT_UNUSED;
             continue;
         }
@@ -2834,7 +4082,7 @@ GnResult GnDeviceVK::CreateGraphicsPipeline(const GnGraphicsPipelineDesc* desc,
 
         auto color_att = attachments.emplace_back_ptr();
         color_att->flags = 0;
-        color_att->format = GnConvertToVkFormat(fragment->color_target_formats[i]);
+        color_att->format = GnConvertToVkFormat(key.color_target_formats[i]);
         color_att->samples = sample_count;
         color_att->loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
         color_att->storeOp = VK_ATTACHMENT_STORE_OP_STORE;
@@ -2843,14 +4091,14 @@ GnResult GnDeviceVK::CreateGraphicsPipeline(const GnGraphicsPipelineDesc* desc,
         color_att->initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
         color_att->finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     }
-    
+
     if (has_depth_stencil) {
         depth_stencil_att_ref.attachment = num_used_render_targets++;
         depth_stencil_att_ref.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
         auto ds_att = attachments.emplace_back_ptr();
         ds_att->flags = 0;
-        ds_att->format = GnConvertToVkFormat(fragment->depth_stencil_target_format);
+        ds_att->format = GnConvertToVkFormat(key.depth_stencil_target_format);
         ds_att->samples = sample_count;
         ds_att->loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
         ds_att->storeOp = VK_ATTACHMENT_STORE_OP_STORE;
@@ -2860,15 +4108,14 @@ GnResult GnDeviceVK::CreateGraphicsPipeline(const GnGraphicsPipelineDesc* desc,
         ds_att->finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
     }
 
-    if (fragment->resolve_target_mask != 0) {
+    if (key.resolve_target_mask != 0) {
         uint32_t current_resolve_attachment = num_used_render_targets;
-        uint32_t resolve_mask = fragment->resolve_target_mask;
 
-        for (uint32_t i = 0; i < fragment->num_color_targets; i++) {
+        for (uint32_t i = 0; i < key.num_color_targets; i++) {
             auto& resolve_att_ref = resolve_att_refs[i];
             resolve_att_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
-            if (!GnContainsBit(resolve_mask, 1 << i)) {
+            if (!GnContainsBit(key.resolve_target_mask, 1 << i)) {
                 resolve_att_ref.attachment = VK_ATTACHMENT_UNUSED;
                 continue;
             }
@@ -2877,7 +4124,7 @@ GnResult GnDeviceVK::CreateGraphicsPipeline(const GnGraphicsPipelineDesc* desc,
 
             auto resolve_att = attachments.emplace_back_ptr();
             resolve_att->flags = 0;
-            resolve_att->format = GnConvertToVkFormat(fragment->color_target_formats[i]);
+            resolve_att->format = GnConvertToVkFormat(key.color_target_formats[i]);
             resolve_att->samples = VK_SAMPLE_COUNT_1_BIT;
             resolve_att->loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
             resolve_att->storeOp = VK_ATTACHMENT_STORE_OP_STORE;
@@ -2893,9 +4140,9 @@ GnResult GnDeviceVK::CreateGraphicsPipeline(const GnGraphicsPipelineDesc* desc,
     subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     subpass.inputAttachmentCount = {};
     subpass.pInputAttachments = {};
-    subpass.colorAttachmentCount = fragment->num_color_targets;
+    subpass.colorAttachmentCount = key.num_color_targets;
     subpass.pColorAttachments = color_att_refs;
-    subpass.pResolveAttachments = fragment->resolve_target_mask ? resolve_att_refs : nullptr;
+    subpass.pResolveAttachments = key.resolve_target_mask ? resolve_att_refs : nullptr;
     subpass.pDepthStencilAttachment = has_depth_stencil ? &depth_stencil_att_ref : nullptr;
     subpass.preserveAttachmentCount = {};
     subpass.pPreserveAttachments = {};
@@ -2911,97 +4158,238 @@ GnResult GnDeviceVK::CreateGraphicsPipeline(const GnGraphicsPipelineDesc* desc,
     rp_info.dependencyCount = 0;
     rp_info.pDependencies = nullptr;
 
-    VkRenderPass compatible_rp;
-    VkResult result = fn.vkCreateRenderPass(device, &rp_info, nullptr, &compatible_rp);
+    // Render passes with subpasses must match the one the pipeline is drawn in subpass by subpass.
+    GnSubpassBuilderVK subpass_builder;
+
+    if (key.subpass_layout.num_subpasses > 0) {
+        uint32_t color_attachments[GN_MAX_COLOR_TARGETS];
+
+        for (uint32_t i = 0; i < key.num_color_targets; i++)
+            color_attachments[i] = color_att_refs[i].attachment;
+
+        subpass_builder.Build(key.subpass_layout, color_attachments, has_depth_stencil ? depth_stencil_att_ref.attachment : VK_ATTACHMENT_UNUSED);
+
+        rp_info.subpassCount = key.subpass_layout.num_subpasses;
+        rp_info.pSubpasses = subpass_builder.subpasses;
+        rp_info.dependencyCount = subpass_builder.num_dependencies;
+        rp_info.pDependencies = subpass_builder.dependencies;
+    }
+
+    VkRenderPass new_render_pass;
+    VkResult result = fn.vkCreateRenderPass(device, &rp_info, nullptr, &new_render_pass);
 
     if (GN_VULKAN_FAILED(result))
         return GnConvertFromVkResult(result);
 
-    VkShaderModuleCreateInfo module_infos[2];
-    module_infos[0].sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    module_infos[0].pNext = nullptr;
-    module_infos[0].flags = 0;
-    module_infos[0].codeSize = desc->vs->size;
-    module_infos[0].pCode = (const uint32_t*)desc->vs->bytecode;
-    module_infos[1].sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    module_infos[1].pNext = nullptr;
-    module_infos[1].flags = 0;
-    module_infos[1].codeSize = desc->fs->size;
-    module_infos[1].pCode = (const uint32_t*)desc->fs->bytecode;
+    // Another thread may have inserted the same key first, in which case ours is redundant.
+    cached_render_pass = compatible_render_pass_cache.Insert(key, new_render_pass);
 
-    VkShaderModule vs_module = VK_NULL_HANDLE;
-    if (GN_VULKAN_FAILED(result = fn.vkCreateShaderModule(device, &module_infos[0], nullptr, &vs_module))) {
-        fn.vkDestroyRenderPass(device, compatible_rp, nullptr);
-        return GnConvertFromVkResult(result);
+    if (!cached_render_pass) {
+        fn.vkDestroyRenderPass(device, new_render_pass, nullptr);
+        return GnError_OutOfHostMemory;
     }
 
-    VkShaderModule fs_module = VK_NULL_HANDLE;
-    if (GN_VULKAN_FAILED(result = fn.vkCreateShaderModule(device, &module_infos[1], nullptr, &fs_module))) {
-        fn.vkDestroyRenderPass(device, compatible_rp, nullptr);
-        fn.vkDestroyShaderModule(device, vs_module, nullptr);
-        return GnConvertFromVkResult(result);
+    if (*cached_render_pass != new_render_pass)
+        fn.vkDestroyRenderPass(device, new_render_pass, nullptr);
+
+    *render_pass = *cached_render_pass;
+
+    return GnSuccess;
+}
+
+inline size_t GnShaderModuleCacheKeyVK::GetHash(const GnShaderModuleCacheKeyVK& key) noexcept
+{
+    return (size_t)key.hash;
+}
+
+inline bool GnShaderModuleCacheKeyVK::CompareKey(const GnShaderModuleCacheKeyVK& a, const GnShaderModuleCacheKeyVK& b) noexcept
+{
+    return a.hash == b.hash && a.size == b.size && std::memcmp(a.bytecode, b.bytecode, a.size) == 0;
+}
+
+GnResult GnShaderModuleCacheVK::Acquire(GnDeviceVK* impl_device, const GnShaderBytecode* bytecode, GnShaderModuleVK** shader_module) noexcept
+{
+    GnShaderModuleCacheKeyVK key;
+    key.hash = GnHashBytes64(bytecode->bytecode, bytecode->size);
+    key.size = bytecode->size;
+    key.bytecode = (const uint8_t*)bytecode->bytecode;
+
+    {
+        // References are dropped under the exclusive lock, a module found here stays alive until it is referenced.
+        std::shared_lock<std::shared_mutex> lock(modules.mutex);
+        auto item = modules.cache_table.find(key);
+
+        if (item != modules.cache_table.end()) {
+            item->second->ref_count++;
+            num_hits++;
+            *shader_module = item->second;
+            return GnSuccess;
+        }
     }
 
-    VkPipelineShaderStageCreateInfo stages[2];
-    stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    stages[0].pNext = nullptr;
-    stages[0].flags = 0;
-    stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-    stages[0].module = vs_module;
-    stages[0].pName = desc->vs->entry_point;
-    stages[0].pSpecializationInfo = nullptr;
-    stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    stages[1].pNext = nullptr;
-    stages[1].flags = 0;
-    stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    stages[1].module = fs_module;
-    stages[1].pName = desc->fs->entry_point;
-    stages[1].pSpecializationInfo = nullptr;
+    GnShaderModuleVK* new_shader_module = new(std::nothrow) GnShaderModuleVK;
 
-    uint32_t num_input_slots = desc->vertex_input->num_input_slots;
-    uint32_t num_attributes = desc->vertex_input->num_attributes;
-    GnSmallVector<VkVertexInputBindingDescription, 32> vertex_bindings;
-    GnSmallVector<VkVertexInputAttributeDescription, 32> vertex_attributes;
+    if (new_shader_module == nullptr)
+        return GnError_OutOfHostMemory;
 
-    if (!(vertex_bindings.resize(num_input_slots) || vertex_attributes.resize(num_attributes))) {
-        fn.vkDestroyRenderPass(device, compatible_rp, nullptr);
-        fn.vkDestroyShaderModule(device, vs_module, nullptr);
-        fn.vkDestroyShaderModule(device, fs_module, nullptr);
+    if (!new_shader_module->bytecode.resize(bytecode->size)) {
+        delete new_shader_module;
         return GnError_OutOfHostMemory;
     }
 
-    for (uint32_t i = 0; i < num_input_slots; i++) {
-        VkVertexInputBindingDescription& vk_binding = vertex_bindings[i];
-        const GnVertexInputSlotDesc& slot = desc->vertex_input->input_slots[i];
-        vk_binding.binding = slot.binding;
-        vk_binding.stride = slot.stride;
-        vk_binding.inputRate = (VkVertexInputRate)slot.input_rate;
-    }
+    std::memcpy(new_shader_module->bytecode.data(), bytecode->bytecode, bytecode->size);
+    new_shader_module->key = key;
+    new_shader_module->key.bytecode = new_shader_module->bytecode.data();
+    new_shader_module->ref_count = 1;
+
+    VkShaderModuleCreateInfo module_info;
+    module_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    module_info.pNext = nullptr;
+    module_info.flags = 0;
+    module_info.codeSize = bytecode->size;
+    module_info.pCode = (const uint32_t*)bytecode->bytecode;
+
+    VkResult result = impl_device->fn.vkCreateShaderModule(impl_device->device, &module_info, nullptr, &new_shader_module->module);
 
-    for (uint32_t i = 0; i < num_attributes; i++) {
-        VkVertexInputAttributeDescription& vk_attribute = vertex_attributes[i];
-        const GnVertexInputAttributeDesc& attribute = desc->vertex_input->attributes[i];
-        vk_attribute.location = attribute.location;
-        vk_attribute.binding = attribute.slot_binding;
-        vk_attribute.format = GnConvertToVkFormat(attribute.format);
-        vk_attribute.offset = attribute.offset;
+    if (GN_VULKAN_FAILED(result)) {
+        delete new_shader_module;
+        return GnConvertFromVkResult(result);
     }
 
-    VkPipelineVertexInputStateCreateInfo vertex_input;
-    vertex_input.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertex_input.pNext = nullptr;
-    vertex_input.flags = 0;
-    vertex_input.vertexBindingDescriptionCount = num_input_slots;
-    vertex_input.pVertexBindingDescriptions = num_input_slots > 0 ? vertex_bindings.storage : nullptr;
-    vertex_input.vertexAttributeDescriptionCount = num_attributes;
-    vertex_input.pVertexAttributeDescriptions = num_attributes > 0 ? vertex_attributes.storage : nullptr;
+    std::unique_lock<std::shared_mutex> lock(modules.mutex);
+    auto [item, inserted] = modules.cache_table.emplace(new_shader_module->key, new_shader_module);
 
-    VkPrimitiveTopology prim_topo = VK_PRIMITIVE_TOPOLOGY_MAX_ENUM;
-    bool primitive_restart_enable = desc->input_assembly->primitive_restart != GnPrimitiveRestart_Disable;
+    if (!inserted) {
+        // Another thread created the same module in the meantime.
+        item->second->ref_count++;
+        num_hits++;
+        *shader_module = item->second;
+        lock.unlock();
 
-    switch (desc->input_assembly->topology) {
-        case GnPrimitiveTopology_PointList:
-            prim_topo = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+        impl_device->fn.vkDestroyShaderModule(impl_device->device, new_shader_module->module, nullptr);
+        delete new_shader_module;
+        return GnSuccess;
+    }
+
+    num_misses++;
+    *shader_module = new_shader_module;
+
+    return GnSuccess;
+}
+
+void GnShaderModuleCacheVK::Release(GnDeviceVK* impl_device, GnShaderModuleVK* shader_module) noexcept
+{
+    std::unique_lock<std::shared_mutex> lock(modules.mutex);
+
+    if (--shader_module->ref_count > 0)
+        return;
+
+    modules.cache_table.erase(shader_module->key);
+    lock.unlock();
+
+    impl_device->fn.vkDestroyShaderModule(impl_device->device, shader_module->module, nullptr);
+    delete shader_module;
+}
+
+void GnShaderModuleCacheVK::Flush(GnDeviceVK* impl_device) noexcept
+{
+    modules.Flush([impl_device](GnShaderModuleVK* shader_module) {
+        impl_device->fn.vkDestroyShaderModule(impl_device->device, shader_module->module, nullptr);
+        delete shader_module;
+    });
+
+    modules.cache_table.clear();
+}
+
+void GnGraphicsPipelineStateVK::Reset() noexcept
+{
+    rp_key.sample_count = GnSampleCount_X1;
+    rp_key.num_color_targets = 0;
+    rp_key.resolve_target_mask = 0;
+    rp_key.depth_stencil_target_format = GnFormat_Unknown;
+    rp_key.subpass_layout.num_subpasses = 0;
+    compatible_rp = VK_NULL_HANDLE;
+    vs = {};
+    fs = {};
+    vs_module = VK_NULL_HANDLE;
+    fs_module = VK_NULL_HANDLE;
+    num_shader_modules = 0;
+    vertex_bindings.resize(0);
+    vertex_attributes.resize(0);
+
+    GnInputAssemblyStateDesc default_input_assembly{};
+    default_input_assembly.topology = GnPrimitiveTopology_TriangleList;
+    default_input_assembly.primitive_restart = GnPrimitiveRestart_Disable;
+    SetInputAssembly(default_input_assembly);
+
+    GnRasterizationStateDesc default_rasterization{};
+    default_rasterization.polygon_mode = GnPolygonMode_Fill;
+    default_rasterization.cull_mode = GnCullMode_None;
+    SetRasterization(default_rasterization);
+
+    GnMultisampleStateDesc default_multisample{};
+    default_multisample.num_samples = GnSampleCount_X1;
+    default_multisample.sample_mask = ~0u;
+    SetMultisample(default_multisample);
+
+    has_depth_stencil_state = false;
+    independent_blend = false;
+    num_blend_states = 0;
+
+    // Used for every color target when no blend state is given.
+    VkPipelineColorBlendAttachmentState& default_blend = blend_attachments[0];
+    default_blend.blendEnable = VK_FALSE;
+    default_blend.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    default_blend.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+    default_blend.colorBlendOp = VK_BLEND_OP_ADD;
+    default_blend.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    default_blend.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    default_blend.alphaBlendOp = VK_BLEND_OP_ADD;
+    default_blend.colorWriteMask = GnColorComponent_All;
+
+    layout = nullptr;
+    num_viewports = 1;
+    cache = VK_NULL_HANDLE;
+    subpass = 0;
+}
+
+bool GnGraphicsPipelineStateVK::AddVertexInputSlot(const GnVertexInputSlotDesc& slot) noexcept
+{
+    VkVertexInputBindingDescription* vk_binding = vertex_bindings.emplace_back_ptr();
+
+    if (vk_binding == nullptr)
+        return false;
+
+    vk_binding->binding = slot.binding;
+    vk_binding->stride = slot.stride;
+    vk_binding->inputRate = (VkVertexInputRate)slot.input_rate;
+
+    return true;
+}
+
+bool GnGraphicsPipelineStateVK::AddVertexAttribute(const GnVertexInputAttributeDesc& attribute) noexcept
+{
+    VkVertexInputAttributeDescription* vk_attribute = vertex_attributes.emplace_back_ptr();
+
+    if (vk_attribute == nullptr)
+        return false;
+
+    vk_attribute->location = attribute.location;
+    vk_attribute->binding = attribute.slot_binding;
+    vk_attribute->format = GnConvertToVkFormat(attribute.format);
+    vk_attribute->offset = attribute.offset;
+
+    return true;
+}
+
+bool GnGraphicsPipelineStateVK::SetInputAssembly(const GnInputAssemblyStateDesc& desc) noexcept
+{
+    VkPrimitiveTopology prim_topo = VK_PRIMITIVE_TOPOLOGY_MAX_ENUM;
+    bool primitive_restart_enable = desc.primitive_restart != GnPrimitiveRestart_Disable;
+
+    switch (desc.topology) {
+        case GnPrimitiveTopology_PointList:
+            prim_topo = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
             primitive_restart_enable = false;
             break;
         case GnPrimitiveTopology_LineList:
@@ -3033,29 +4421,24 @@ GnResult GnDeviceVK::CreateGraphicsPipeline(const GnGraphicsPipelineDesc* desc,
             prim_topo = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP_WITH_ADJACENCY;
             break;
         default:
-            GN_UNREACHABLE();
+            return false;
     }
 
-    VkPipelineInputAssemblyStateCreateInfo input_assembly;
     input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
     input_assembly.pNext = nullptr;
     input_assembly.flags = 0;
     input_assembly.topology = prim_topo;
     input_assembly.primitiveRestartEnable = primitive_restart_enable;
 
-    VkPipelineViewportStateCreateInfo viewport;
-    viewport.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewport.pNext = nullptr;
-    viewport.flags = 0;
-    viewport.viewportCount = desc->num_viewports;
-    viewport.pViewports = nullptr;
-    viewport.scissorCount = desc->num_viewports;
-    viewport.pScissors = nullptr;
+    return true;
+}
 
+bool GnGraphicsPipelineStateVK::SetRasterization(const GnRasterizationStateDesc& desc) noexcept
+{
     VkPolygonMode polygon_mode = VK_POLYGON_MODE_MAX_ENUM;
     VkCullModeFlags cull_mode = 0;
 
-    switch (desc->rasterization->cull_mode) {
+    switch (desc.cull_mode) {
         case GnCullMode_None:
             cull_mode = VK_CULL_MODE_NONE;
             break;
@@ -3066,10 +4449,10 @@ GnResult GnDeviceVK::CreateGraphicsPipeline(const GnGraphicsPipelineDesc* desc,
             cull_mode = VK_CULL_MODE_BACK_BIT;
             break;
         default:
-            GN_UNREACHABLE();
+            return false;
     }
 
-    switch (desc->rasterization->polygon_mode) {
+    switch (desc.polygon_mode) {
         case GnPolygonMode_Fill:
             polygon_mode = VK_POLYGON_MODE_FILL;
             break;
@@ -3080,10 +4463,9 @@ GnResult GnDeviceVK::CreateGraphicsPipeline(const GnGraphicsPipelineDesc* desc,
             polygon_mode = VK_POLYGON_MODE_POINT;
             break;
         default:
-            GN_UNREACHABLE();
+            return false;
     }
 
-    VkPipelineRasterizationStateCreateInfo rasterization;
     rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
     rasterization.pNext = nullptr;
     rasterization.flags = 0;
@@ -3091,94 +4473,323 @@ GnResult GnDeviceVK::CreateGraphicsPipeline(const GnGraphicsPipelineDesc* desc,
     rasterization.rasterizerDiscardEnable = VK_FALSE;
     rasterization.polygonMode = polygon_mode;
     rasterization.cullMode = cull_mode;
-    rasterization.frontFace = desc->rasterization->frontface_ccw ? VK_FRONT_FACE_COUNTER_CLOCKWISE : VK_FRONT_FACE_CLOCKWISE;
-    rasterization.depthBiasEnable = desc->rasterization->depth_bias != 0 || desc->rasterization->depth_bias_slope_scale != 0.0f;
-    rasterization.depthBiasConstantFactor = (float)desc->rasterization->depth_bias;
-    rasterization.depthBiasClamp = desc->rasterization->depth_bias_clamp;
-    rasterization.depthBiasSlopeFactor = desc->rasterization->depth_bias_slope_scale;
+    rasterization.frontFace = desc.frontface_ccw ? VK_FRONT_FACE_COUNTER_CLOCKWISE : VK_FRONT_FACE_CLOCKWISE;
+    rasterization.depthBiasEnable = desc.depth_bias != 0 || desc.depth_bias_slope_scale != 0.0f;
+    rasterization.depthBiasConstantFactor = (float)desc.depth_bias;
+    rasterization.depthBiasClamp = desc.depth_bias_clamp;
+    rasterization.depthBiasSlopeFactor = desc.depth_bias_slope_scale;
     rasterization.lineWidth = 1.0f;
 
-    VkPipelineMultisampleStateCreateInfo multisample;
+    return true;
+}
+
+void GnGraphicsPipelineStateVK::SetMultisample(const GnMultisampleStateDesc& desc) noexcept
+{
+    rp_key.sample_count = desc.num_samples;
+    sample_mask = desc.sample_mask;
+
     multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
     multisample.pNext = nullptr;
     multisample.flags = 0;
-    multisample.rasterizationSamples = (VkSampleCountFlagBits)desc->multisample->num_samples;
+    multisample.rasterizationSamples = (VkSampleCountFlagBits)desc.num_samples;
     multisample.sampleShadingEnable = VK_FALSE;
     multisample.minSampleShading = 1.0f;
-    multisample.pSampleMask = desc->multisample->num_samples != GnSampleCount_X1 ? &desc->multisample->sample_mask : nullptr;
-    multisample.alphaToCoverageEnable = desc->multisample->alpha_to_coverage;
+    multisample.pSampleMask = desc.num_samples != GnSampleCount_X1 ? &sample_mask : nullptr;
+    multisample.alphaToCoverageEnable = desc.alpha_to_coverage;
     multisample.alphaToOneEnable = VK_FALSE;
+}
 
-    VkPipelineDepthStencilStateCreateInfo depth_stencil_state;
+void GnGraphicsPipelineStateVK::SetDepthStencil(const GnDepthStencilStateDesc& desc) noexcept
+{
+    has_depth_stencil_state = true;
+
+    depth_stencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depth_stencil.pNext = nullptr;
+    depth_stencil.flags = 0;
+    depth_stencil.depthTestEnable = desc.depth_test;
+    depth_stencil.depthWriteEnable = desc.depth_write;
+    depth_stencil.depthCompareOp = GnConvertToVkCompareOp(desc.depth_compare_op);
+    depth_stencil.depthBoundsTestEnable = VK_FALSE;
+    depth_stencil.stencilTestEnable = desc.stencil_test;
+    depth_stencil.front.failOp = GnConvertToVkStencilOp(desc.front.fail_op);
+    depth_stencil.front.passOp = GnConvertToVkStencilOp(desc.front.pass_op);
+    depth_stencil.front.depthFailOp = GnConvertToVkStencilOp(desc.front.depth_fail_op);
+    depth_stencil.front.compareOp = GnConvertToVkCompareOp(desc.front.compare_op);
+    depth_stencil.front.compareMask = desc.stencil_read_mask;
+    depth_stencil.front.writeMask = desc.stencil_write_mask;
+    depth_stencil.front.reference = 0;
+    depth_stencil.back.failOp = GnConvertToVkStencilOp(desc.back.fail_op);
+    depth_stencil.back.passOp = GnConvertToVkStencilOp(desc.back.pass_op);
+    depth_stencil.back.depthFailOp = GnConvertToVkStencilOp(desc.back.depth_fail_op);
+    depth_stencil.back.compareOp = GnConvertToVkCompareOp(desc.back.compare_op);
+    depth_stencil.back.compareMask = desc.stencil_read_mask;
+    depth_stencil.back.writeMask = desc.stencil_write_mask;
+    depth_stencil.back.reference = 0;
+    depth_stencil.minDepthBounds = 0.0f;
+    depth_stencil.maxDepthBounds = 1.0f;
+}
 
-    if (has_depth_stencil) {
-        depth_stencil_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-        depth_stencil_state.pNext = nullptr;
-        depth_stencil_state.flags = 0;
-        depth_stencil_state.depthTestEnable = desc->depth_stencil->depth_test;
-        depth_stencil_state.depthWriteEnable = desc->depth_stencil->depth_write;
-        depth_stencil_state.depthCompareOp = GnConvertToVkCompareOp(desc->depth_stencil->depth_compare_op);
-        depth_stencil_state.depthBoundsTestEnable = VK_FALSE;
-        depth_stencil_state.stencilTestEnable = desc->depth_stencil->stencil_test;
-        depth_stencil_state.front.failOp = GnConvertToVkStencilOp(desc->depth_stencil->front.fail_op);
-        depth_stencil_state.front.passOp = GnConvertToVkStencilOp(desc->depth_stencil->front.pass_op);
-        depth_stencil_state.front.depthFailOp = GnConvertToVkStencilOp(desc->depth_stencil->front.depth_fail_op);
-        depth_stencil_state.front.compareOp = GnConvertToVkCompareOp(desc->depth_stencil->front.compare_op);
-        depth_stencil_state.front.compareMask = desc->depth_stencil->stencil_read_mask;
-        depth_stencil_state.front.writeMask = desc->depth_stencil->stencil_write_mask;
-        depth_stencil_state.front.reference = 0;
-        depth_stencil_state.back.failOp = GnConvertToVkStencilOp(desc->depth_stencil->back.fail_op);
-        depth_stencil_state.back.passOp = GnConvertToVkStencilOp(desc->depth_stencil->back.pass_op);
-        depth_stencil_state.back.depthFailOp = GnConvertToVkStencilOp(desc->depth_stencil->back.depth_fail_op);
-        depth_stencil_state.back.compareOp = GnConvertToVkCompareOp(desc->depth_stencil->back.compare_op);
-        depth_stencil_state.back.compareMask = desc->depth_stencil->stencil_read_mask;
-        depth_stencil_state.back.writeMask = desc->depth_stencil->stencil_write_mask;
-        depth_stencil_state.back.reference = 0;
-        depth_stencil_state.minDepthBounds = 0.0f;
-        depth_stencil_state.maxDepthBounds = 1.0f;
-    }
-
-    uint32_t num_blend_states = desc->blend->num_blend_states;
-    bool independent_blend = desc->blend->independent_blend && GnIsAdapterFeaturePresent(parent_adapter, GnFeature_IndependentBlend);
-    VkPipelineColorBlendAttachmentState vk_attachments[8]{};
-
-    if (independent_blend) {
-        for (uint32_t i = 0; i < num_blend_states; i++) {
-            const GnColorTargetBlendStateDesc& target = desc->blend->blend_states[i];
-            VkPipelineColorBlendAttachmentState& vk_attachment = vk_attachments[i];
-            vk_attachment.blendEnable = target.blend_enable;
-            vk_attachment.srcColorBlendFactor = GnConvertToVkBlendFactor(target.src_color_blend_factor);
-            vk_attachment.dstColorBlendFactor = GnConvertToVkBlendFactor(target.dst_color_blend_factor);
-            vk_attachment.colorBlendOp = GnConvertToVkBlendOp(target.color_blend_op);
-            vk_attachment.srcAlphaBlendFactor = GnConvertToVkBlendFactor(target.src_alpha_blend_factor);
-            vk_attachment.dstAlphaBlendFactor = GnConvertToVkBlendFactor(target.dst_alpha_blend_factor);
-            vk_attachment.alphaBlendOp = GnConvertToVkBlendOp(target.alpha_blend_op);
-            vk_attachment.colorWriteMask = target.color_write_mask;
+bool GnGraphicsPipelineStateVK::AddColorTargetBlend(const GnColorTargetBlendStateDesc& target) noexcept
+{
+    if (num_blend_states >= GN_MAX_COLOR_TARGETS)
+        return false;
+
+    VkPipelineColorBlendAttachmentState& vk_attachment = blend_attachments[num_blend_states++];
+    vk_attachment.blendEnable = target.blend_enable;
+    vk_attachment.srcColorBlendFactor = GnConvertToVkBlendFactor(target.src_color_blend_factor);
+    vk_attachment.dstColorBlendFactor = GnConvertToVkBlendFactor(target.dst_color_blend_factor);
+    vk_attachment.colorBlendOp = GnConvertToVkBlendOp(target.color_blend_op);
+    vk_attachment.srcAlphaBlendFactor = GnConvertToVkBlendFactor(target.src_alpha_blend_factor);
+    vk_attachment.dstAlphaBlendFactor = GnConvertToVkBlendFactor(target.dst_alpha_blend_factor);
+    vk_attachment.alphaBlendOp = GnConvertToVkBlendOp(target.alpha_blend_op);
+    vk_attachment.colorWriteMask = target.color_write_mask;
+
+    return true;
+}
+
+bool GnGraphicsPipelineStateVK::SetFragmentInterface(const GnFragmentInterfaceStateDesc& desc) noexcept
+{
+    if (desc.num_color_targets > GN_MAX_COLOR_TARGETS || (desc.num_color_targets > 0 && desc.color_target_formats == nullptr))
+        return false;
+
+    rp_key.num_color_targets = desc.num_color_targets;
+    rp_key.resolve_target_mask = desc.resolve_target_mask;
+    rp_key.depth_stencil_target_format = desc.depth_stencil_target_format;
+
+    for (uint32_t i = 0; i < desc.num_color_targets; i++)
+        rp_key.color_target_formats[i] = desc.color_target_formats[i];
+
+    return true;
+}
+
+bool GnGraphicsPipelineStateVK::SetSubpasses(uint32_t num_subpasses, const GnRenderPassSubpassDesc* subpasses, uint32_t subpass_index) noexcept
+{
+    // Resolve targets are only supported by render passes with a single subpass.
+    if (num_subpasses > 0 && (subpass_index >= num_subpasses || rp_key.resolve_target_mask != 0))
+        return false;
+
+    subpass = subpass_index;
+
+    return rp_key.subpass_layout.Init(num_subpasses, subpasses, rp_key.num_color_targets);
+}
+
+GnResult GnGraphicsPipelineStateVK::Init(GnDeviceVK* impl_device, const GnGraphicsPipelineDesc* desc) noexcept
+{
+    Reset();
+
+    vs = *desc->vs;
+    fs = *desc->fs;
+
+    for (uint32_t i = 0; i < desc->vertex_input->num_input_slots; i++)
+        if (!AddVertexInputSlot(desc->vertex_input->input_slots[i]))
+            return GnError_OutOfHostMemory;
+
+    for (uint32_t i = 0; i < desc->vertex_input->num_attributes; i++)
+        if (!AddVertexAttribute(desc->vertex_input->attributes[i]))
+            return GnError_OutOfHostMemory;
+
+    if (!SetInputAssembly(*desc->input_assembly) || !SetRasterization(*desc->rasterization))
+        return GnError_InvalidArgs;
+
+    SetMultisample(*desc->multisample);
+
+    if (desc->depth_stencil != nullptr)
+        SetDepthStencil(*desc->depth_stencil);
+
+    const GnBlendStateDesc* blend_desc = desc->blend;
+    uint32_t num_blend_descs = blend_desc->independent_blend ? blend_desc->num_blend_states : GnMin(blend_desc->num_blend_states, 1u);
+
+    for (uint32_t i = 0; i < num_blend_descs; i++)
+        if (!AddColorTargetBlend(blend_desc->blend_states[i]))
+            return GnError_InvalidArgs;
+
+    independent_blend = blend_desc->independent_blend;
+
+    if (!SetFragmentInterface(*desc->fragment_interface) || !SetSubpasses(desc->num_subpasses, desc->subpasses, desc->subpass))
+        return GnError_InvalidArgs;
+
+    layout = desc->layout;
+    num_viewports = desc->num_viewports;
+    cache = GnGetPipelineCacheVK(desc->cache);
+
+    return Finish(impl_device);
+}
+
+GnResult GnGraphicsPipelineStateVK::InitFromStream(GnDeviceVK* impl_device, const GnPipelineStreamDesc* desc) noexcept
+{
+    Reset();
+
+    bool has_fragment_interface = false;
+
+    // Each token is applied to the Vulkan state as it is decoded.
+    GnResult result = GnParsePipelineStream(desc, [this, &has_fragment_interface](const GnPipelineStreamToken& token) -> GnResult {
+        switch (token.type) {
+            case GnPipelineStreamTokenType_VS:
+                vs = token.token.shader;
+                return GnSuccess;
+            case GnPipelineStreamTokenType_FS:
+                fs = token.token.shader;
+                return GnSuccess;
+            case GnPipelineStreamTokenType_VertexInputSlot:
+                return AddVertexInputSlot(token.token.vertex_input_slot) ? GnSuccess : GnError_OutOfHostMemory;
+            case GnPipelineStreamTokenType_VertexAttribute:
+                return AddVertexAttribute(token.token.vertex_attribute) ? GnSuccess : GnError_OutOfHostMemory;
+            case GnPipelineStreamTokenType_InputAssembly:
+                return SetInputAssembly(token.token.input_assembly) ? GnSuccess : GnError_InvalidArgs;
+            case GnPipelineStreamTokenType_RasterizationState:
+                return SetRasterization(token.token.rasterization) ? GnSuccess : GnError_InvalidArgs;
+            case GnPipelineStreamTokenType_DepthStencilState:
+                SetDepthStencil(token.token.depth_stencil);
+                return GnSuccess;
+            case GnPipelineStreamTokenType_MultisampleState:
+                SetMultisample(token.token.multisample);
+                return GnSuccess;
+            case GnPipelineStreamTokenType_AttachmentBlendState:
+                return AddColorTargetBlend(token.token.color_target_blend) ? GnSuccess : GnError_InvalidArgs;
+            case GnPipelineStreamTokenType_EnableIndependentBlend:
+                independent_blend = true;
+                return GnSuccess;
+            case GnPipelineStreamTokenType_Layout:
+                layout = token.token.layout;
+                return GnSuccess;
+            case GnPipelineStreamTokenType_FragmentInterface:
+                has_fragment_interface = true;
+                return SetFragmentInterface(token.token.fragment_interface) ? GnSuccess : GnError_InvalidArgs;
+            case GnPipelineStreamTokenType_NumViewports:
+                num_viewports = token.token.num_viewports;
+                return GnSuccess;
+            default:
+                return GnError_InvalidArgs;
         }
+    });
+
+    if (GN_FAILED(result))
+        return result;
+
+    if (vs.bytecode == nullptr || fs.bytecode == nullptr || !has_fragment_interface)
+        return GnError_InvalidArgs;
+
+    cache = GnGetPipelineCacheVK(desc->cache);
+
+    return Finish(impl_device);
+}
+
+GnResult GnGraphicsPipelineStateVK::Finish(GnDeviceVK* impl_device) noexcept
+{
+    bool has_subpasses = rp_key.subpass_layout.num_subpasses > 0;
+    uint32_t num_subpass_color_targets = rp_key.num_color_targets;
+    bool has_depth_stencil;
+
+    if (has_subpasses) {
+        // The key describes every subpass of the render pass, so the depth-stencil target stays in it even when
+        // this subpass does not use it.
+        const GnSubpassLayoutVK::Subpass& current_subpass = rp_key.subpass_layout.subpasses[subpass];
+        num_subpass_color_targets = current_subpass.num_color_targets;
+        has_depth_stencil = current_subpass.use_depth_stencil_target;
+
+        if (has_depth_stencil && !has_depth_stencil_state)
+            SetDepthStencil(GnDepthStencilStateDesc{});
     }
     else {
-        for (uint32_t i = 0; i < fragment->num_color_targets; i++) {
-            const GnColorTargetBlendStateDesc& target = desc->blend->blend_states[0];
-            VkPipelineColorBlendAttachmentState& vk_attachment = vk_attachments[i];
-            vk_attachment.blendEnable = target.blend_enable;
-            vk_attachment.srcColorBlendFactor = GnConvertToVkBlendFactor(target.src_color_blend_factor);
-            vk_attachment.dstColorBlendFactor = GnConvertToVkBlendFactor(target.dst_color_blend_factor);
-            vk_attachment.colorBlendOp = GnConvertToVkBlendOp(target.color_blend_op);
-            vk_attachment.srcAlphaBlendFactor = GnConvertToVkBlendFactor(target.src_alpha_blend_factor);
-            vk_attachment.dstAlphaBlendFactor = GnConvertToVkBlendFactor(target.dst_alpha_blend_factor);
-            vk_attachment.alphaBlendOp = GnConvertToVkBlendOp(target.alpha_blend_op);
-            vk_attachment.colorWriteMask = target.color_write_mask;
+        // Depth/stencil only takes part when both the state and the target format are given.
+        has_depth_stencil = has_depth_stencil_state && rp_key.depth_stencil_target_format != GnFormat_Unknown;
+
+        if (!has_depth_stencil)
+            rp_key.depth_stencil_target_format = GnFormat_Unknown;
+    }
+
+    // The pipeline only needs a render pass compatible with the ones it is used with, which is shared between
+    // every pipeline with the same fragment interface.
+    rp_key.CalculateHash();
+
+    GnResult rp_result = impl_device->GetCompatibleRenderPass(rp_key, &compatible_rp);
+
+    if (GN_FAILED(rp_result))
+        return rp_result;
+
+    module_infos[0].sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    module_infos[0].pNext = nullptr;
+    module_infos[0].flags = 0;
+    module_infos[0].codeSize = vs.size;
+    module_infos[0].pCode = (const uint32_t*)vs.bytecode;
+    module_infos[1].sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    module_infos[1].pNext = nullptr;
+    module_infos[1].flags = 0;
+    module_infos[1].codeSize = fs.size;
+    module_infos[1].pCode = (const uint32_t*)fs.bytecode;
+
+    // With maintenance5 the create infos are chained into the stages directly and no module is created.
+    if (!impl_device->ver_info.HasMaintenance5()) {
+        GnShaderModuleCacheVK& module_cache = impl_device->shader_module_cache;
+        GnResult module_result = module_cache.Acquire(impl_device, &vs, &shader_modules[0]);
+
+        if (GN_FAILED(module_result)) {
+            Destroy(impl_device);
+            return module_result;
         }
+
+        num_shader_modules = 1;
+        vs_module = shader_modules[0]->module;
+        module_result = module_cache.Acquire(impl_device, &fs, &shader_modules[1]);
+
+        if (GN_FAILED(module_result)) {
+            Destroy(impl_device);
+            return module_result;
+        }
+
+        num_shader_modules = 2;
+        fs_module = shader_modules[1]->module;
     }
 
-    VkPipelineColorBlendStateCreateInfo blend;
+    stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[0].pNext = vs_module == VK_NULL_HANDLE ? &module_infos[0] : nullptr;
+    stages[0].flags = 0;
+    stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    stages[0].module = vs_module;
+    stages[0].pName = vs.entry_point;
+    stages[0].pSpecializationInfo = nullptr;
+    stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[1].pNext = fs_module == VK_NULL_HANDLE ? &module_infos[1] : nullptr;
+    stages[1].flags = 0;
+    stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    stages[1].module = fs_module;
+    stages[1].pName = fs.entry_point;
+    stages[1].pSpecializationInfo = nullptr;
+
+    uint32_t num_input_slots = (uint32_t)vertex_bindings.size;
+    uint32_t num_attributes = (uint32_t)vertex_attributes.size;
+
+    vertex_input.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertex_input.pNext = nullptr;
+    vertex_input.flags = 0;
+    vertex_input.vertexBindingDescriptionCount = num_input_slots;
+    vertex_input.pVertexBindingDescriptions = num_input_slots > 0 ? vertex_bindings.storage : nullptr;
+    vertex_input.vertexAttributeDescriptionCount = num_attributes;
+    vertex_input.pVertexAttributeDescriptions = num_attributes > 0 ? vertex_attributes.storage : nullptr;
+
+    viewport.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewport.pNext = nullptr;
+    viewport.flags = 0;
+    viewport.viewportCount = num_viewports;
+    viewport.pViewports = nullptr;
+    viewport.scissorCount = num_viewports;
+    viewport.pScissors = nullptr;
+
+    // Without independent blending, the first blend state applies to every color target.
+    bool use_independent_blend = independent_blend && num_blend_states > 0 &&
+                                 GnIsAdapterFeaturePresent(impl_device->parent_adapter, GnFeature_IndependentBlend);
+
+    if (!use_independent_blend)
+        for (uint32_t i = 1; i < num_subpass_color_targets; i++)
+            blend_attachments[i] = blend_attachments[0];
+
     blend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
     blend.pNext = nullptr;
     blend.flags = 0;
     blend.logicOpEnable = VK_FALSE;
     blend.logicOp = VK_LOGIC_OP_CLEAR;
-    blend.attachmentCount = independent_blend ? num_blend_states : fragment->num_color_targets;
-    blend.pAttachments = vk_attachments;
+    blend.attachmentCount = use_independent_blend ? num_blend_states : num_subpass_color_targets;
+    blend.pAttachments = blend_attachments;
     blend.blendConstants[0] = 0.0f;
     blend.blendConstants[1] = 0.0f;
     blend.blendConstants[2] = 0.0f;
@@ -3191,166 +4802,739 @@ GnResult GnDeviceVK::CreateGraphicsPipeline(const GnGraphicsPipelineDesc* desc,
         VK_DYNAMIC_STATE_STENCIL_REFERENCE,
     };
 
-    VkPipelineDynamicStateCreateInfo dynamic_state;
-    dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-    dynamic_state.pNext = nullptr;
-    dynamic_state.flags = 0;
-    dynamic_state.dynamicStateCount = GN_ARRAY_SIZE(dynamic_states);
-    dynamic_state.pDynamicStates = dynamic_states;
+    dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamic_state.pNext = nullptr;
+    dynamic_state.flags = 0;
+    dynamic_state.dynamicStateCount = GN_ARRAY_SIZE(dynamic_states);
+    dynamic_state.pDynamicStates = dynamic_states;
+
+    pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipeline_info.pNext = nullptr;
+    pipeline_info.flags = 0;
+    pipeline_info.stageCount = 2;
+    pipeline_info.pStages = stages;
+    pipeline_info.pVertexInputState = &vertex_input;
+    pipeline_info.pInputAssemblyState = &input_assembly;
+    pipeline_info.pTessellationState = nullptr;
+    pipeline_info.pViewportState = &viewport;
+    pipeline_info.pRasterizationState = &rasterization;
+    pipeline_info.pMultisampleState = &multisample;
+    pipeline_info.pDepthStencilState = has_depth_stencil ? &depth_stencil : nullptr;
+    pipeline_info.pColorBlendState = &blend;
+    pipeline_info.pDynamicState = &dynamic_state;
+    pipeline_info.layout = layout != nullptr ? GN_TO_VULKAN(GnPipelineLayout, layout)->pipeline_layout : impl_device->empty_pipeline_layout;
+    pipeline_info.renderPass = compatible_rp;
+    pipeline_info.subpass = subpass;
+    pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
+    pipeline_info.basePipelineIndex = 0;
+
+    return GnSuccess;
+}
+
+void GnGraphicsPipelineStateVK::Destroy(GnDeviceVK* impl_device) noexcept
+{
+    for (uint32_t i = 0; i < num_shader_modules; i++)
+        impl_device->shader_module_cache.Release(impl_device, shader_modules[i]);
+
+    num_shader_modules = 0;
+    vs_module = VK_NULL_HANDLE;
+    fs_module = VK_NULL_HANDLE;
+
+    // Owned by the compatible render pass cache.
+    compatible_rp = VK_NULL_HANDLE;
+}
+
+GnResult GnDeviceVK::CreateGraphicsPipeline(const GnGraphicsPipelineDesc* desc, GnPipeline* pipeline) noexcept
+{
+    GnGraphicsPipelineStateVK state;
+    GnResult result = state.Init(this, desc);
+    CreateGraphicsPipelinesFromStates(1, &state, pipeline, &result);
+    return result;
+}
+
+GnResult GnDeviceVK::CreateGraphicsPipelines(uint32_t num_pipelines, const GnGraphicsPipelineDesc* descs, GnPipeline* pipelines, GnResult* results) noexcept
+{
+    GnSmallVector<GnResult, 16> scratch_results;
+
+    if (results == nullptr) {
+        if (!scratch_results.resize(num_pipelines))
+            return GnError_OutOfHostMemory;
+
+        results = scratch_results.storage;
+    }
+
+    // Pipeline states are not trivial and can't be stored in GnSmallVector, so they are built in fixed-size batches on
+    // the stack. Each batch still reaches the driver in a single call.
+    static constexpr uint32_t max_batch_size = 8;
+    GnGraphicsPipelineStateVK states[max_batch_size];
+    GnResult first_error = GnSuccess;
+
+    for (uint32_t batch_start = 0; batch_start < num_pipelines; batch_start += max_batch_size) {
+        uint32_t batch_size = std::min(num_pipelines - batch_start, max_batch_size);
+
+        for (uint32_t i = 0; i < batch_size; i++)
+            results[batch_start + i] = states[i].Init(this, &descs[batch_start + i]);
+
+        GnResult result = CreateGraphicsPipelinesFromStates(batch_size, states, &pipelines[batch_start], &results[batch_start]);
+
+        if (GN_FAILED(result) && first_error == GnSuccess)
+            first_error = result;
+    }
+
+    return first_error;
+}
+
+GnResult GnDeviceVK::CreateGraphicsPipelineFromStream(const GnPipelineStreamDesc* desc, GnPipeline* pipeline) noexcept
+{
+    GnGraphicsPipelineStateVK state;
+    GnResult result = state.InitFromStream(this, desc);
+    CreateGraphicsPipelinesFromStates(1, &state, pipeline, &result);
+    return result;
+}
+
+// results holds the result of initializing each state on input and receives the creation result on output.
+// With into_pending, pipelines holds pending pipelines that are filled in place and left untouched on failure. Their
+// status is not changed, the caller publishes it.
+GnResult GnDeviceVK::CreateGraphicsPipelinesFromStates(uint32_t num_pipelines, GnGraphicsPipelineStateVK* states, GnPipeline* pipelines, GnResult* results, bool into_pending) noexcept
+{
+    if (!pool.pipeline)
+        pool.pipeline.emplace(128);
+
+    GnSmallVector<VkGraphicsPipelineCreateInfo, 16> pipeline_infos;
+    GnSmallVector<VkPipeline, 16> vk_pipelines;
+    GnSmallVector<uint32_t, 16> pipeline_indices;
+    GnResult first_error = GnSuccess;
+
+    auto set_result = [&](uint32_t index, GnResult result) {
+        results[index] = result;
+
+        if (GN_FAILED(result) && first_error == GnSuccess)
+            first_error = result;
+    };
+
+    for (uint32_t i = 0; i < num_pipelines; i++) {
+        if (!into_pending)
+            pipelines[i] = nullptr;
+
+        if (GN_FAILED(results[i])) {
+            set_result(i, results[i]);
+            continue;
+        }
+
+        if (!(pipeline_infos.push_back(states[i].pipeline_info) && pipeline_indices.push_back(i))) {
+            states[i].Destroy(this);
+            set_result(i, GnError_OutOfHostMemory);
+        }
+    }
+
+    if (!vk_pipelines.resize(pipeline_infos.size)) {
+        for (uint32_t i = 0; i < pipeline_indices.size; i++) {
+            states[pipeline_indices[i]].Destroy(this);
+            set_result(pipeline_indices[i], GnError_OutOfHostMemory);
+        }
+
+        return first_error;
+    }
+
+    // Every run of pipelines sharing the same cache goes to the driver in a single call, which leaves the driver
+    // free to compile them in parallel.
+    uint32_t run_start = 0;
+
+    while (run_start < pipeline_infos.size) {
+        VkPipelineCache cache = states[pipeline_indices[run_start]].cache;
+        uint32_t run_end = run_start + 1;
+
+        while (run_end < pipeline_infos.size && states[pipeline_indices[run_end]].cache == cache)
+            run_end++;
+
+        uint32_t run_size = run_end - run_start;
+
+        // Pipelines that fail to compile are set to VK_NULL_HANDLE while the rest remain valid.
+        for (uint32_t i = run_start; i < run_end; i++)
+            vk_pipelines[i] = VK_NULL_HANDLE;
+
+        VkResult vk_result = fn.vkCreateGraphicsPipelines(device, cache, run_size, &pipeline_infos[run_start], nullptr, &vk_pipelines[run_start]);
+        GnResult run_error = GN_VULKAN_FAILED(vk_result) ? GnConvertFromVkResult(vk_result) : GnError_InternalError;
+
+        for (uint32_t i = run_start; i < run_end; i++) {
+            uint32_t index = pipeline_indices[i];
+            GnGraphicsPipelineStateVK& state = states[index];
+            VkPipeline vk_pipeline = vk_pipelines[i];
+
+            if (vk_pipeline == VK_NULL_HANDLE) {
+                state.Destroy(this);
+                set_result(index, run_error);
+                continue;
+            }
+
+            GnPipelineVK* impl_pipeline = into_pending ? GN_TO_VULKAN(GnPipeline, pipelines[index]) : (GnPipelineVK*)pool.pipeline->allocate();
+
+            if (impl_pipeline == nullptr) {
+                fn.vkDestroyPipeline(device, vk_pipeline, nullptr);
+                state.Destroy(this);
+                set_result(index, GnError_OutOfHostMemory);
+                continue;
+            }
+
+            if (!into_pending) {
+                impl_pipeline->type = GnPipelineType_Graphics;
+                impl_pipeline->status = GnSuccess;
+                impl_pipeline->fallback_pipeline = nullptr;
+            }
+
+            impl_pipeline->num_viewports = state.num_viewports;
+            impl_pipeline->pipeline = vk_pipeline;
+
+            // Shader module references move to the pipeline so that later pipelines can reuse the modules.
+            impl_pipeline->num_shader_modules = state.num_shader_modules;
+            std::memcpy(impl_pipeline->shader_modules, state.shader_modules, sizeof(state.shader_modules));
+            state.num_shader_modules = 0;
+            state.Destroy(this);
+
+            pipelines[index] = impl_pipeline;
+            set_result(index, GnSuccess);
+        }
+
+        run_start = run_end;
+    }
+
+    return first_error;
+}
+
+GnResult GnDeviceVK::CreatePendingPipeline(GnPipelineType type, GnPipeline* pipeline) noexcept
+{
+    if (!pool.pipeline)
+        pool.pipeline.emplace(128);
+
+    GnPipelineVK* impl_pipeline = (GnPipelineVK*)pool.pipeline->allocate();
+
+    if (impl_pipeline == nullptr)
+        return GnError_OutOfHostMemory;
+
+    impl_pipeline->type = type;
+    impl_pipeline->num_viewports = 0;
+    impl_pipeline->status = GnNotReady;
+    impl_pipeline->fallback_pipeline = nullptr;
+    impl_pipeline->pipeline = VK_NULL_HANDLE;
+    impl_pipeline->num_shader_modules = 0;
+
+    *pipeline = impl_pipeline;
+
+    return GnSuccess;
+}
+
+// Called from the pipeline compile thread. The pipeline is compiled straight into the pending one.
+GnResult GnDeviceVK::CompilePendingGraphicsPipeline(GnPipeline pipeline, const GnGraphicsPipelineDesc* desc) noexcept
+{
+    GnGraphicsPipelineStateVK state;
+    GnResult result = state.Init(this, desc);
+    CreateGraphicsPipelinesFromStates(1, &state, &pipeline, &result, true);
+    return result;
+}
+
+GnResult GnDeviceVK::CreateComputePipeline(const GnComputePipelineDesc* desc, GnPipeline* pipeline) noexcept
+{
+    return CreateComputePipelineFromShader(&desc->cs, desc->layout, GnGetPipelineCacheVK(desc->cache), pipeline);
+}
+
+GnResult GnDeviceVK::CreateComputePipelineFromStream(const GnPipelineStreamDesc* desc, GnPipeline* pipeline) noexcept
+{
+    GnShaderBytecode cs{};
+    GnPipelineLayout layout = nullptr;
+
+    GnResult result = GnParsePipelineStream(desc, [&cs, &layout](const GnPipelineStreamToken& token) -> GnResult {
+        switch (token.type) {
+            case GnPipelineStreamTokenType_CS:
+                cs = token.token.shader;
+                return GnSuccess;
+            case GnPipelineStreamTokenType_Layout:
+                layout = token.token.layout;
+                return GnSuccess;
+            default:
+                return GnError_InvalidArgs;
+        }
+    });
+
+    if (GN_FAILED(result))
+        return result;
+
+    if (cs.bytecode == nullptr || layout == nullptr)
+        return GnError_InvalidArgs;
+
+    return CreateComputePipelineFromShader(&cs, layout, GnGetPipelineCacheVK(desc->cache), pipeline);
+}
+
+GnResult GnDeviceVK::CreateComputePipelineFromShader(const GnShaderBytecode* cs, GnPipelineLayout layout, VkPipelineCache cache, GnPipeline* pipeline) noexcept
+{
+    VkShaderModuleCreateInfo shader_module_info;
+    shader_module_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shader_module_info.pNext = nullptr;
+    shader_module_info.flags = 0;
+    shader_module_info.codeSize = cs->size;
+    shader_module_info.pCode = (const uint32_t*)cs->bytecode;
+
+    VkShaderModule module = VK_NULL_HANDLE;
+    GnShaderModuleVK* shader_module = nullptr;
+
+    if (!ver_info.HasMaintenance5()) {
+        GnResult module_result = shader_module_cache.Acquire(this, cs, &shader_module);
+
+        if (GN_FAILED(module_result))
+            return module_result;
+
+        module = shader_module->module;
+    }
+
+    VkComputePipelineCreateInfo pipeline_info;
+    pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipeline_info.pNext = nullptr;
+    pipeline_info.flags = 0;
+    pipeline_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipeline_info.stage.pNext = module == VK_NULL_HANDLE ? &shader_module_info : nullptr;
+    pipeline_info.stage.flags = 0;
+    pipeline_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipeline_info.stage.module = module;
+    pipeline_info.stage.pName = cs->entry_point;
+    pipeline_info.stage.pSpecializationInfo = nullptr;
+    pipeline_info.layout = GN_TO_VULKAN(GnPipelineLayout, layout)->pipeline_layout;
+    pipeline_info.basePipelineHandle = nullptr;
+    pipeline_info.basePipelineIndex = 0;
+
+    VkPipeline vk_pipeline;
+    VkResult result = fn.vkCreateComputePipelines(device, cache, 1, &pipeline_info, nullptr, &vk_pipeline);
+
+    if (GN_VULKAN_FAILED(result)) {
+        if (shader_module != nullptr)
+            shader_module_cache.Release(this, shader_module);
+
+        return GnConvertFromVkResult(result);
+    }
+
+    if (!pool.pipeline)
+        pool.pipeline.emplace(128);
+
+    GnPipelineVK* impl_pipeline = (GnPipelineVK*)pool.pipeline->allocate();
+
+    if (impl_pipeline == nullptr) {
+        if (shader_module != nullptr)
+            shader_module_cache.Release(this, shader_module);
+
+        fn.vkDestroyPipeline(device, vk_pipeline, nullptr);
+        return GnError_OutOfHostMemory;
+    }
+
+    impl_pipeline->type = GnPipelineType_Compute;
+    impl_pipeline->num_viewports = 0;
+    impl_pipeline->status = GnSuccess;
+    impl_pipeline->fallback_pipeline = nullptr;
+    impl_pipeline->pipeline = vk_pipeline;
+    impl_pipeline->num_shader_modules = shader_module != nullptr ? 1 : 0;
+    impl_pipeline->shader_modules[0] = shader_module;
+
+    *pipeline = impl_pipeline;
+
+    return GnSuccess;
+}
+
+GnResult GnDeviceVK::CreatePipelineCache(const GnPipelineCacheDesc* desc, GnPipelineCache* pipeline_cache) noexcept
+{
+    GnPipelineCacheHeader expected_header;
+    GetPipelineCacheHeader(&expected_header);
+
+    // Data from another adapter or driver is dropped rather than handed to the driver.
+    size_t initial_data_size = 0;
+    const void* initial_data = GnPipelineCacheHeader::Validate(expected_header, desc->initial_data_size, desc->initial_data, &initial_data_size);
+
+    VkPipelineCacheCreateInfo cache_info;
+    cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cache_info.pNext = nullptr;
+    cache_info.flags = 0;
+    cache_info.initialDataSize = initial_data != nullptr ? initial_data_size : 0;
+    cache_info.pInitialData = initial_data;
+
+    VkPipelineCache vk_pipeline_cache;
+    VkResult result = fn.vkCreatePipelineCache(device, &cache_info, nullptr, &vk_pipeline_cache);
+
+    if (GN_VULKAN_FAILED(result))
+        return GnConvertFromVkResult(result);
+
+    if (!pool.pipeline_cache)
+        pool.pipeline_cache.emplace(16);
+
+    GnPipelineCacheVK* impl_pipeline_cache = (GnPipelineCacheVK*)pool.pipeline_cache->allocate();
+
+    if (impl_pipeline_cache == nullptr) {
+        fn.vkDestroyPipelineCache(device, vk_pipeline_cache, nullptr);
+        return GnError_OutOfHostMemory;
+    }
+
+    impl_pipeline_cache->pipeline_cache = vk_pipeline_cache;
+    *pipeline_cache = impl_pipeline_cache;
+
+    return GnSuccess;
+}
+
+GnResult GnDeviceVK::GetPipelineCacheData(GnPipelineCache pipeline_cache, size_t* data_size, void* data) noexcept
+{
+    VkPipelineCache vk_pipeline_cache = GN_TO_VULKAN(GnPipelineCache, pipeline_cache)->pipeline_cache;
+    size_t vk_data_size = 0;
+    VkResult result = fn.vkGetPipelineCacheData(device, vk_pipeline_cache, &vk_data_size, nullptr);
+
+    if (GN_VULKAN_FAILED(result))
+        return GnConvertFromVkResult(result);
+
+    if (data == nullptr) {
+        *data_size = sizeof(GnPipelineCacheHeader) + vk_data_size;
+        return GnSuccess;
+    }
+
+    if (*data_size < sizeof(GnPipelineCacheHeader) + vk_data_size)
+        return GnError_InvalidArgs;
+
+    // The cache may have grown since the size query, only write what fits.
+    vk_data_size = *data_size - sizeof(GnPipelineCacheHeader);
+    result = fn.vkGetPipelineCacheData(device, vk_pipeline_cache, &vk_data_size, (uint8_t*)data + sizeof(GnPipelineCacheHeader));
+
+    if (GN_VULKAN_FAILED(result))
+        return GnConvertFromVkResult(result);
+
+    if (result == VK_INCOMPLETE)
+        return GnError_InvalidArgs;
+
+    GnPipelineCacheHeader header;
+    GetPipelineCacheHeader(&header);
+    header.data_size = vk_data_size;
+    std::memcpy(data, &header, sizeof(GnPipelineCacheHeader));
+
+    *data_size = sizeof(GnPipelineCacheHeader) + vk_data_size;
+
+    return GnSuccess;
+}
+
+GnResult GnDeviceVK::MergePipelineCaches(GnPipelineCache dst_cache, uint32_t num_src_caches, const GnPipelineCache* src_caches) noexcept
+{
+    GnSmallVector<VkPipelineCache, 16> vk_src_caches;
+
+    if (!vk_src_caches.resize(num_src_caches))
+        return GnError_OutOfHostMemory;
+
+    for (uint32_t i = 0; i < num_src_caches; i++)
+        vk_src_caches[i] = GN_TO_VULKAN(GnPipelineCache, src_caches[i])->pipeline_cache;
+
+    return GnConvertFromVkResult(fn.vkMergePipelineCaches(device, GN_TO_VULKAN(GnPipelineCache, dst_cache)->pipeline_cache, num_src_caches, vk_src_caches.storage));
+}
+
+void GnDeviceVK::GetPipelineCacheHeader(GnPipelineCacheHeader* header) const noexcept
+{
+    const GnAdapterVK* impl_adapter = GN_TO_VULKAN(GnAdapter, parent_adapter);
+
+    static_assert(sizeof(header->driver_uuid) == VK_UUID_SIZE && sizeof(header->cache_uuid) == VK_UUID_SIZE);
+
+    header->magic = GnPipelineCacheHeader::magic_value;
+    header->version = GnPipelineCacheHeader::current_version;
+    header->vendor_id = impl_adapter->properties.vendor_id;
+    header->device_id = impl_adapter->device_id;
+    std::memcpy(header->driver_uuid, impl_adapter->driver_uuid, VK_UUID_SIZE);
+    std::memcpy(header->cache_uuid, impl_adapter->pipeline_cache_uuid, VK_UUID_SIZE);
+    header->data_size = 0;
+}
+
+GnResult GnDeviceVK::CreateDescriptorPool(const GnDescriptorPoolDesc* desc, GnDescriptorPool* descriptor_pool) noexcept
+{
+    VkDescriptorPoolSize sizes[5]{};
+    uint32_t num_sizes = 0;
+
+    auto add_pool_size = [&sizes, &num_sizes](VkDescriptorType type, uint32_t count) {
+        // Zero-sized entries are not allowed
+        if (count == 0)
+            return;
+
+        sizes[num_sizes].type = type;
+        sizes[num_sizes].descriptorCount = count;
+        num_sizes++;
+    };
+
+    switch (desc->type) {
+        case GnDescriptorTableType_Resource:
+            add_pool_size(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, desc->pool_limits.max_uniform_buffers);
+            add_pool_size(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, desc->pool_limits.max_storage_buffers);
+            add_pool_size(VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, desc->pool_limits.max_sampled_textures);
+            add_pool_size(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, desc->pool_limits.max_storage_textures);
+            add_pool_size(VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, desc->pool_limits.max_input_attachments);
+            break;
+        case GnDescriptorTableType_Sampler:
+            add_pool_size(VK_DESCRIPTOR_TYPE_SAMPLER, desc->pool_limits.max_samplers);
+            break;
+        default:
+            GN_UNREACHABLE();
+    }
+
+    if (num_sizes == 0)
+        return GnError_InvalidArgs;
+
+    VkDescriptorPoolCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    info.pNext = nullptr;
+    // Linear pools never free sets individually, which lets the driver allocate them linearly.
+    info.flags = desc->mode == GnDescriptorPoolMode_Persistent ? VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT : 0;
+    info.maxSets = desc->max_descriptor_tables;
+    info.poolSizeCount = num_sizes;
+    info.pPoolSizes = sizes;
+
+    if (!pool.descriptor_pool)
+        pool.descriptor_pool.emplace(32);
+
+    GnDescriptorPoolVK* impl_descriptor_pool = (GnDescriptorPoolVK*)pool.descriptor_pool->allocate();
+
+    if (impl_descriptor_pool == nullptr)
+        return GnError_OutOfHostMemory;
 
-    VkGraphicsPipelineCreateInfo graphics_pipeline_info;
-    graphics_pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    graphics_pipeline_info.pNext = nullptr;
-    graphics_pipeline_info.flags = 0;
-    graphics_pipeline_info.stageCount = 2;
-    graphics_pipeline_info.pStages = stages;
-    graphics_pipeline_info.pVertexInputState = &vertex_input;
-    graphics_pipeline_info.pInputAssemblyState = &input_assembly;
-    graphics_pipeline_info.pTessellationState = nullptr;
-    graphics_pipeline_info.pViewportState = &viewport;
-    graphics_pipeline_info.pRasterizationState = &rasterization;
-    graphics_pipeline_info.pMultisampleState = &multisample;
-    graphics_pipeline_info.pDepthStencilState = has_depth_stencil ? &depth_stencil_state : nullptr;
-    graphics_pipeline_info.pColorBlendState = &blend;
-    graphics_pipeline_info.pDynamicState = &dynamic_state;
-    graphics_pipeline_info.layout = empty_pipeline_layout;
-    graphics_pipeline_info.renderPass = compatible_rp;
-    graphics_pipeline_info.subpass = 0;
-    graphics_pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
-    graphics_pipeline_info.basePipelineIndex = 0;
-
-    VkPipeline vk_pipeline = VK_NULL_HANDLE;
-    if (GN_VULKAN_FAILED(result = fn.vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &graphics_pipeline_info, nullptr, &vk_pipeline))) {
-        fn.vkDestroyRenderPass(device, compatible_rp, nullptr);
-        fn.vkDestroyShaderModule(device, fs_module, nullptr);
-        fn.vkDestroyShaderModule(device, vs_module, nullptr);
-        return GnConvertFromVkResult(result);
-    }
+    // The index allocator holds atomics which must be constructed before use.
+    new(impl_descriptor_pool) GnDescriptorPoolVK();
+    impl_descriptor_pool->descriptor_pool = VK_NULL_HANDLE;
+    impl_descriptor_pool->type = desc->type;
+    impl_descriptor_pool->mode = desc->mode;
+    impl_descriptor_pool->max_descriptor_tables = desc->max_descriptor_tables;
+    impl_descriptor_pool->tables = GnAllocate<GnDescriptorTableVK>(desc->max_descriptor_tables);
 
-    GnPipelineVK* impl_pipeline = (GnPipelineVK*)pool.pipeline->allocate();
-    if (impl_pipeline == nullptr) {
-        fn.vkDestroyRenderPass(device, compatible_rp, nullptr);
-        fn.vkDestroyShaderModule(device, fs_module, nullptr);
-        fn.vkDestroyShaderModule(device, vs_module, nullptr);
-        fn.vkDestroyPipeline(device, vk_pipeline, nullptr);
+    if (impl_descriptor_pool->tables == nullptr || !impl_descriptor_pool->table_indices.Init(desc->max_descriptor_tables)) {
+        DestroyDescriptorPool(impl_descriptor_pool);
         return GnError_OutOfHostMemory;
     }
 
-    fn.vkDestroyShaderModule(device, vs_module, nullptr);
-    fn.vkDestroyShaderModule(device, fs_module, nullptr);
-    fn.vkDestroyRenderPass(device, compatible_rp, nullptr);
+    VkResult result = fn.vkCreateDescriptorPool(device, &info, nullptr, &impl_descriptor_pool->descriptor_pool);
 
-    impl_pipeline->type = GnPipelineType_Graphics;
-    impl_pipeline->num_viewports = desc->num_viewports;
-    impl_pipeline->pipeline = vk_pipeline;
+    if (GN_VULKAN_FAILED(result)) {
+        DestroyDescriptorPool(impl_descriptor_pool);
+        return GnConvertFromVkResult(result);
+    }
+
+    *descriptor_pool = impl_descriptor_pool;
 
-    *pipeline = impl_pipeline;
-    
     return GnSuccess;
 }
 
-GnResult GnDeviceVK::CreateComputePipeline(const GnComputePipelineDesc* desc, GnPipeline* pipeline) noexcept
+GnResult GnDeviceVK::ResetDescriptorPool(GnDescriptorPool descriptor_pool) noexcept
 {
-    VkShaderModuleCreateInfo shader_module_info;
-    shader_module_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    shader_module_info.pNext = nullptr;
-    shader_module_info.flags = 0;
-    shader_module_info.codeSize = desc->cs.size;
-    shader_module_info.pCode = (const uint32_t*)desc->cs.bytecode;
-
-    VkShaderModule module;
-    VkResult result = fn.vkCreateShaderModule(device, &shader_module_info, nullptr, &module);
+    GnDescriptorPoolVK* impl_descriptor_pool = GN_TO_VULKAN(GnDescriptorPool, descriptor_pool);
+    VkResult result = fn.vkResetDescriptorPool(device, impl_descriptor_pool->descriptor_pool, 0);
 
     if (GN_VULKAN_FAILED(result))
         return GnConvertFromVkResult(result);
 
-    VkComputePipelineCreateInfo pipeline_info;
-    pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-    pipeline_info.pNext = nullptr;
-    pipeline_info.flags = 0;
-    pipeline_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    pipeline_info.stage.pNext = nullptr;
-    pipeline_info.stage.flags = 0;
-    pipeline_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
-    pipeline_info.stage.module = module;
-    pipeline_info.stage.pName = desc->cs.entry_point;
-    pipeline_info.stage.pSpecializationInfo = nullptr;
-    pipeline_info.layout = GN_TO_VULKAN(GnPipelineLayout, desc->layout)->pipeline_layout;
-    pipeline_info.basePipelineHandle = nullptr;
-    pipeline_info.basePipelineIndex = 0;
+    impl_descriptor_pool->table_indices.Reset();
 
-    VkPipeline vk_pipeline;
+    return GnSuccess;
+}
+
+GnResult GnDeviceVK::AllocateDescriptorTables(GnDescriptorPool descriptor_pool, uint32_t num_descriptor_tables, const GnDescriptorTableLayout* layouts, GnDescriptorTable* descriptor_tables) noexcept
+{
+    GnDescriptorPoolVK* impl_descriptor_pool = GN_TO_VULKAN(GnDescriptorPool, descriptor_pool);
+    GnSmallVector<VkDescriptorSetLayout, 32> set_layouts;
+    GnSmallVector<VkDescriptorSet, 32> descriptor_sets;
+
+    if (!set_layouts.resize(num_descriptor_tables) || !descriptor_sets.resize(num_descriptor_tables))
+        return GnError_OutOfHostMemory;
+
+    for (uint32_t i = 0; i < num_descriptor_tables; i++)
+        set_layouts[i] = GN_TO_VULKAN(GnDescriptorTableLayout, layouts[i])->set_layout;
+
+    VkDescriptorSetAllocateInfo alloc_info;
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.pNext = nullptr;
+    alloc_info.descriptorPool = impl_descriptor_pool->descriptor_pool;
+    alloc_info.descriptorSetCount = num_descriptor_tables;
+    alloc_info.pSetLayouts = set_layouts.storage;
 
-    if (GN_VULKAN_FAILED(result = fn.vkCreateComputePipelines(device, nullptr, 1, &pipeline_info, nullptr, &vk_pipeline))) {
-        fn.vkDestroyShaderModule(device, module, nullptr);
+    VkResult result = fn.vkAllocateDescriptorSets(device, &alloc_info, descriptor_sets.storage);
+
+    if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL)
+        return GnError_OutOfDeviceMemory;
+
+    if (GN_VULKAN_FAILED(result))
         return GnConvertFromVkResult(result);
+
+    // maxSets bounds the number of live sets, so there is always a free slot for each new set.
+    for (uint32_t i = 0; i < num_descriptor_tables; i++) {
+        uint32_t index = impl_descriptor_pool->table_indices.Allocate();
+        GN_ASSERT(index != GnIndexAllocator::invalid_index);
+
+        GnDescriptorTableVK* impl_descriptor_table = &impl_descriptor_pool->tables[index];
+        impl_descriptor_table->descriptor_set = descriptor_sets[i];
+        impl_descriptor_table->layout = GN_TO_VULKAN(GnDescriptorTableLayout, layouts[i]);
+        descriptor_tables[i] = impl_descriptor_table;
     }
 
-    if (!pool.pipeline)
-        pool.pipeline.emplace(128);
+    return GnSuccess;
+}
 
-    GnPipelineVK* impl_pipeline = (GnPipelineVK*)pool.pipeline->allocate();
+void GnDeviceVK::FreeDescriptorTables(GnDescriptorPool descriptor_pool, uint32_t num_descriptor_tables, const GnDescriptorTable* descriptor_tables) noexcept
+{
+    GnDescriptorPoolVK* impl_descriptor_pool = GN_TO_VULKAN(GnDescriptorPool, descriptor_pool);
+    GnSmallVector<VkDescriptorSet, 32> descriptor_sets;
 
-    if (impl_pipeline == nullptr) {
-        fn.vkDestroyShaderModule(device, module, nullptr);
-        fn.vkDestroyPipeline(device, vk_pipeline, nullptr);
-        return GnError_OutOfHostMemory;
+    if (!descriptor_sets.resize(num_descriptor_tables))
+        return;
+
+    for (uint32_t i = 0; i < num_descriptor_tables; i++) {
+        GnDescriptorTableVK* impl_descriptor_table = GN_TO_VULKAN(GnDescriptorTable, descriptor_tables[i]);
+        descriptor_sets[i] = impl_descriptor_table->descriptor_set;
+        impl_descriptor_pool->table_indices.Free((uint32_t)(impl_descriptor_table - impl_descriptor_pool->tables));
     }
 
-    impl_pipeline->type = GnPipelineType_Compute;
-    impl_pipeline->pipeline = vk_pipeline;
+    fn.vkFreeDescriptorSets(device, impl_descriptor_pool->descriptor_pool, num_descriptor_tables, descriptor_sets.storage);
+}
 
-    fn.vkDestroyShaderModule(device, module, nullptr);
+GnResult GnDeviceVK::UpdateDescriptorTables(uint32_t num_writes, const GnDescriptorTableWrite* writes) noexcept
+{
+    uint32_t num_buffer_infos = 0;
+    uint32_t num_image_infos = 0;
 
-    *pipeline = impl_pipeline;
+    for (uint32_t i = 0; i < num_writes; i++) {
+        switch (writes[i].resource_type) {
+            case GnResourceType_UniformBuffer:
+            case GnResourceType_StorageBuffer:
+                num_buffer_infos += writes[i].num_descriptors;
+                break;
+            case GnResourceType_SampledTexture:
+            case GnResourceType_StorageTexture:
+            case GnResourceType_InputAttachment:
+                num_image_infos += writes[i].num_descriptors;
+                break;
+            default:
+                return GnError_Unimplemented; // There is no sampler object yet
+        }
+    }
+
+    GnSmallVector<VkWriteDescriptorSet, 32> vk_writes;
+    GnSmallVector<VkDescriptorBufferInfo, 64> buffer_infos;
+    GnSmallVector<VkDescriptorImageInfo, 64> image_infos;
+
+    if (!vk_writes.resize(num_writes) || !buffer_infos.resize(num_buffer_infos) || !image_infos.resize(num_image_infos))
+        return GnError_OutOfHostMemory;
+
+    VkDescriptorBufferInfo* buffer_info = buffer_infos.storage;
+    VkDescriptorImageInfo* image_info = image_infos.storage;
+
+    for (uint32_t i = 0; i < num_writes; i++) {
+        const GnDescriptorTableWrite& write = writes[i];
+        VkWriteDescriptorSet& vk_write = vk_writes[i];
+        vk_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        vk_write.pNext = nullptr;
+        vk_write.dstSet = GN_TO_VULKAN(GnDescriptorTable, write.descriptor_table)->descriptor_set;
+        vk_write.dstBinding = write.binding;
+        vk_write.dstArrayElement = write.first_array_element;
+        vk_write.descriptorCount = write.num_descriptors;
+        vk_write.descriptorType = GnConvertToVkDescriptorType<false>(write.resource_type);
+        vk_write.pImageInfo = nullptr;
+        vk_write.pBufferInfo = nullptr;
+        vk_write.pTexelBufferView = nullptr;
+
+        if (write.resource_type == GnResourceType_UniformBuffer || write.resource_type == GnResourceType_StorageBuffer) {
+            vk_write.pBufferInfo = buffer_info;
+
+            for (uint32_t j = 0; j < write.num_descriptors; j++, buffer_info++) {
+                const GnDescriptorBufferInfo& info = write.buffers[j];
+                buffer_info->buffer = GN_TO_VULKAN(GnBuffer, info.buffer)->buffer;
+                buffer_info->offset = info.offset;
+                buffer_info->range = info.size == GN_WHOLE_SIZE ? VK_WHOLE_SIZE : info.size;
+            }
+        }
+        else {
+            const VkImageLayout layout = write.resource_type == GnResourceType_SampledTexture ?
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+
+            vk_write.pImageInfo = image_info;
+
+            for (uint32_t j = 0; j < write.num_descriptors; j++, image_info++) {
+                image_info->sampler = VK_NULL_HANDLE;
+                image_info->imageView = GN_TO_VULKAN(GnTextureView, write.texture_views[j])->view;
+                image_info->imageLayout = layout;
+            }
+        }
+    }
+
+    fn.vkUpdateDescriptorSets(device, num_writes, vk_writes.storage, 0, nullptr);
 
     return GnSuccess;
 }
 
-GnResult GnDeviceVK::CreateDescriptorPool(const GnDescriptorPoolDesc* desc, GnDescriptorPool* descriptor_pool) noexcept
+GnResult GnDeviceVK::WriteDescriptorTable(GnDescriptorTable descriptor_table, const GnDescriptorInfo* descriptors) noexcept
 {
-    VkDescriptorPoolSize sizes[4]{};
+    GnDescriptorTableVK* impl_descriptor_table = GN_TO_VULKAN(GnDescriptorTable, descriptor_table);
+    const GnDescriptorTableLayoutVK* layout = impl_descriptor_table->layout;
+    GnSmallVector<GnDescriptorInfoVK, 64> packed_infos;
 
-    VkDescriptorPoolCreateInfo info{};
-    info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    info.pNext = nullptr;
-    info.flags = 0;
-    info.maxSets = desc->max_descriptor_tables;
-    info.pPoolSizes = sizes;
+    if (!packed_infos.resize(layout->num_descriptors))
+        return GnError_OutOfHostMemory;
 
-    switch (desc->type) {
-        case GnDescriptorTableType_Resource:
-        {
-            info.poolSizeCount = 4;
-            sizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            sizes[0].descriptorCount = desc->pool_limits.max_uniform_buffers;
-            sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-            sizes[1].descriptorCount = desc->pool_limits.max_storage_buffers;
-            sizes[2].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-            sizes[2].descriptorCount = desc->pool_limits.max_sampled_textures;
-            sizes[3].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-            sizes[3].descriptorCount = desc->pool_limits.max_storage_textures;
-            break;
+    for (uint32_t i = 0; i < layout->num_bindings; i++) {
+        const GnDescriptorTableBindingVK& binding = layout->bindings[i];
+        GnDescriptorInfoVK* info = &packed_infos[binding.first_descriptor];
+        const GnDescriptorInfo* descriptor = &descriptors[binding.first_descriptor];
+
+        switch (binding.type) {
+            case GnResourceType_UniformBuffer:
+            case GnResourceType_StorageBuffer:
+                for (uint32_t j = 0; j < binding.num_descriptors; j++, info++, descriptor++) {
+                    info->buffer.buffer = GN_TO_VULKAN(GnBuffer, descriptor->buffer.buffer)->buffer;
+                    info->buffer.offset = descriptor->buffer.offset;
+                    info->buffer.range = descriptor->buffer.size == GN_WHOLE_SIZE ? VK_WHOLE_SIZE : descriptor->buffer.size;
+                }
+                break;
+            case GnResourceType_SampledTexture:
+            case GnResourceType_StorageTexture:
+            case GnResourceType_InputAttachment: {
+                const VkImageLayout image_layout = binding.type == GnResourceType_SampledTexture ?
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+
+                for (uint32_t j = 0; j < binding.num_descriptors; j++, info++, descriptor++) {
+                    info->image.sampler = VK_NULL_HANDLE;
+                    info->image.imageView = GN_TO_VULKAN(GnTextureView, descriptor->texture_view)->view;
+                    info->image.imageLayout = image_layout;
+                }
+                break;
+            }
+            default:
+                return GnError_Unimplemented; // There is no sampler object yet
         }
+    }
 
-        case GnDescriptorTableType_Sampler:
-        {
-            info.poolSizeCount = 1;
-            sizes[0].type = VK_DESCRIPTOR_TYPE_SAMPLER;
-            sizes[0].descriptorCount = desc->pool_limits.max_samplers;
-            break;
-        }
+    if (layout->update_template != VK_NULL_HANDLE) {
+        fn.vkUpdateDescriptorSetWithTemplateKHR(device, impl_descriptor_table->descriptor_set, layout->update_template, packed_infos.storage);
+        return GnSuccess;
+    }
 
-        default:
-            GN_UNREACHABLE();
+    // No template, write each descriptor separately.
+    GnSmallVector<VkWriteDescriptorSet, 64> vk_writes;
+
+    if (!vk_writes.resize(layout->num_descriptors))
+        return GnError_OutOfHostMemory;
+
+    for (uint32_t i = 0; i < layout->num_bindings; i++) {
+        const GnDescriptorTableBindingVK& binding = layout->bindings[i];
+        const VkDescriptorType descriptor_type = GnConvertToVkDescriptorType<false>(binding.type);
+        const bool is_buffer = binding.type == GnResourceType_UniformBuffer || binding.type == GnResourceType_StorageBuffer;
+
+        for (uint32_t j = 0; j < binding.num_descriptors; j++) {
+            GnDescriptorInfoVK& info = packed_infos[binding.first_descriptor + j];
+            VkWriteDescriptorSet& vk_write = vk_writes[binding.first_descriptor + j];
+            vk_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            vk_write.pNext = nullptr;
+            vk_write.dstSet = impl_descriptor_table->descriptor_set;
+            vk_write.dstBinding = binding.binding;
+            vk_write.dstArrayElement = j;
+            vk_write.descriptorCount = 1;
+            vk_write.descriptorType = descriptor_type;
+            vk_write.pImageInfo = is_buffer ? nullptr : &info.image;
+            vk_write.pBufferInfo = is_buffer ? &info.buffer : nullptr;
+            vk_write.pTexelBufferView = nullptr;
+        }
     }
-    
-    VkDescriptorPool vk_descriptor_pool;
-    VkResult result = fn.vkCreateDescriptorPool(device, &info, nullptr, &vk_descriptor_pool);
-    if (GN_VULKAN_FAILED(result))
-        return GnConvertFromVkResult(result);
 
-    return GnError_Unimplemented;
+    fn.vkUpdateDescriptorSets(device, layout->num_descriptors, vk_writes.storage, 0, nullptr);
+
+    return GnSuccess;
 }
 
 GnResult GnDeviceVK::CreateCommandPool(const GnCommandPoolDesc* desc, GnCommandPool* command_pool) noexcept
@@ -3452,7 +5636,14 @@ void GnDeviceVK::DestroySwapchain(GnSwapchain swapchain) noexcept
 
 void GnDeviceVK::DestroyFence(GnFence fence) noexcept
 {
-    fn.vkDestroyFence(device, GN_TO_VULKAN(GnFence, fence)->fence, nullptr);
+    GnFenceVK* impl_fence = GN_TO_VULKAN(GnFence, fence);
+
+    if (impl_fence->timeline)
+        fn.vkDestroySemaphore(device, impl_fence->timeline_semaphore, nullptr);
+    else
+        fn.vkDestroyFence(device, impl_fence->fence, nullptr);
+
+    impl_fence->~GnFenceVK();
     pool.fence->free(fence);
 }
 
@@ -3465,6 +5656,10 @@ void GnDeviceVK::DestroyMemory(GnMemory memory) noexcept
 void GnDeviceVK::DestroyBuffer(GnBuffer buffer) noexcept
 {
     GnBufferVK* impl_buffer = GN_TO_VULKAN(GnBuffer, buffer);
+
+    if (impl_buffer->bindless_index != GN_INVALID)
+        bindless_heap.buffer_indices.Free(impl_buffer->bindless_index);
+
     fn.vkDestroyBuffer(device, impl_buffer->buffer, nullptr);
     impl_buffer->memory = nullptr;
     pool.buffer->free(buffer);
@@ -3478,19 +5673,35 @@ void GnDeviceVK::DestroyTexture(GnTexture texture) noexcept
 
 void GnDeviceVK::DestroyTextureView(GnTextureView texture_view) noexcept
 {
-    fn.vkDestroyImageView(device, GN_TO_VULKAN(GnTextureView, texture_view)->view, nullptr);
+    GnTextureViewVK* impl_texture_view = GN_TO_VULKAN(GnTextureView, texture_view);
+
+    if (impl_texture_view->bindless_index != GN_INVALID)
+        bindless_heap.texture_indices.Free(impl_texture_view->bindless_index);
+
+    fn.vkDestroyImageView(device, impl_texture_view->view, nullptr);
     pool.texture_view->free(texture_view);
 }
 
 void GnDeviceVK::DestroyRenderGraph(GnRenderGraph render_graph) noexcept
 {
-    fn.vkDestroyRenderPass(device, GN_TO_VULKAN(GnRenderGraph, render_graph)->render_pass, nullptr);
+    GnRenderGraphVK* impl_render_graph = GN_TO_VULKAN(GnRenderGraph, render_graph);
+
+    if (impl_render_graph->render_pass != VK_NULL_HANDLE)
+        fn.vkDestroyRenderPass(device, impl_render_graph->render_pass, nullptr);
+
+    impl_render_graph->~GnRenderGraphVK();
     pool.render_graph->free(render_graph);
 }
 
 void GnDeviceVK::DestroyDescriptorTableLayout(GnDescriptorTableLayout resource_table_layout) noexcept
 {
-    fn.vkDestroyDescriptorSetLayout(device, GN_TO_VULKAN(GnDescriptorTableLayout, resource_table_layout)->set_layout, nullptr);
+    GnDescriptorTableLayoutVK* impl_resource_table_layout = GN_TO_VULKAN(GnDescriptorTableLayout, resource_table_layout);
+
+    if (impl_resource_table_layout->update_template != VK_NULL_HANDLE)
+        fn.vkDestroyDescriptorUpdateTemplateKHR(device, impl_resource_table_layout->update_template, nullptr);
+
+    fn.vkDestroyDescriptorSetLayout(device, impl_resource_table_layout->set_layout, nullptr);
+    GnFree(impl_resource_table_layout->bindings);
     pool.resource_table_layout->free(resource_table_layout);
 }
 
@@ -3498,19 +5709,53 @@ void GnDeviceVK::DestroyPipelineLayout(GnPipelineLayout pipeline_layout) noexcep
 {
     GnPipelineLayoutVK* impl_pipeline_layout = GN_TO_VULKAN(GnPipelineLayout, pipeline_layout);
     fn.vkDestroyPipelineLayout(device, impl_pipeline_layout->pipeline_layout, nullptr);
+
+    if (impl_pipeline_layout->global_resource_template != VK_NULL_HANDLE)
+        fn.vkDestroyDescriptorUpdateTemplateKHR(device, impl_pipeline_layout->global_resource_template, nullptr);
+
     fn.vkDestroyDescriptorSetLayout(device, impl_pipeline_layout->global_resource_layout, nullptr);
     pool.pipeline_layout->free(pipeline_layout);
 }
 
 void GnDeviceVK::DestroyPipeline(GnPipeline pipeline) noexcept
 {
-    fn.vkDestroyPipeline(device, GN_TO_VULKAN(GnPipeline, pipeline)->pipeline, nullptr);
+    GnPipelineVK* impl_pipeline = GN_TO_VULKAN(GnPipeline, pipeline);
+    fn.vkDestroyPipeline(device, impl_pipeline->pipeline, nullptr);
+
+    for (uint32_t i = 0; i < impl_pipeline->num_shader_modules; i++)
+        shader_module_cache.Release(this, impl_pipeline->shader_modules[i]);
+
     pool.pipeline->free(pipeline);
 }
 
+void GnDeviceVK::DestroyPipelineCache(GnPipelineCache pipeline_cache) noexcept
+{
+    GnPipelineCacheVK* impl_pipeline_cache = GN_TO_VULKAN(GnPipelineCache, pipeline_cache);
+    fn.vkDestroyPipelineCache(device, impl_pipeline_cache->pipeline_cache, nullptr);
+    pool.pipeline_cache->free(impl_pipeline_cache);
+}
+
+void GnDeviceVK::GetShaderModuleCacheStats(GnShaderModuleCacheStats* stats) noexcept
+{
+    std::shared_lock<std::shared_mutex> lock(shader_module_cache.modules.mutex);
+
+    stats->num_hits = shader_module_cache.num_hits;
+    stats->num_misses = shader_module_cache.num_misses;
+    stats->num_modules = (uint32_t)shader_module_cache.modules.cache_table.size();
+}
+
 void GnDeviceVK::DestroyDescriptorPool(GnDescriptorPool descriptor_pool) noexcept
 {
-    fn.vkDestroyDescriptorPool(device, GN_TO_VULKAN(GnDescriptorPool, descriptor_pool)->descriptor_pool, nullptr);
+    GnDescriptorPoolVK* impl_descriptor_pool = GN_TO_VULKAN(GnDescriptorPool, descriptor_pool);
+
+    if (impl_descriptor_pool->descriptor_pool != VK_NULL_HANDLE)
+        fn.vkDestroyDescriptorPool(device, impl_descriptor_pool->descriptor_pool, nullptr);
+
+    if (impl_descriptor_pool->tables != nullptr)
+        GnFree(impl_descriptor_pool->tables);
+
+    impl_descriptor_pool->table_indices.Destroy();
+    impl_descriptor_pool->~GnDescriptorPoolVK();
     pool.descriptor_pool->free(descriptor_pool);
 }
 
@@ -3518,6 +5763,10 @@ void GnDeviceVK::DestroyCommandPool(GnCommandPool command_pool) noexcept
 {
     GnCommandPoolVK* impl_command_pool = GN_TO_VULKAN(GnCommandPool, command_pool);
     fn.vkDestroyCommandPool(device, impl_command_pool->cmd_pool, nullptr);
+
+    for (uint32_t i = 0; i < impl_command_pool->max_command_lists; i++)
+        impl_command_pool->command_list_pool[i].~GnCommandListVK();
+
     GnFree(impl_command_pool->command_list_pool);
     impl_command_pool->~GnCommandPoolVK();
     pool.command_pool->free(command_pool);
@@ -3551,6 +5800,22 @@ GnResult GnDeviceVK::BindBufferMemory(GnBuffer buffer, GnMemory memory, GnDevice
 
     impl_buffer->memory = (GnMemoryVK*)memory;
     impl_buffer->aligned_offset = aligned_offset;
+    bindless_heap.WriteBuffer(this, impl_buffer);
+
+    return GnSuccess;
+}
+
+GnResult GnDeviceVK::BindTextureMemory(GnTexture texture, GnMemory memory, GnDeviceSize aligned_offset) noexcept
+{
+    GnTextureVK* impl_texture = GN_TO_VULKAN(GnTexture, texture);
+    GnMemoryVK* impl_memory = GN_TO_VULKAN(GnMemory, memory);
+    GnResult result = GnConvertFromVkResult(fn.vkBindImageMemory(device, impl_texture->image, impl_memory->memory, aligned_offset));
+
+    if (GN_FAILED(result))
+        return result;
+
+    impl_texture->memory = impl_memory;
+    impl_texture->aligned_offset = aligned_offset;
 
     return GnSuccess;
 }
@@ -3700,9 +5965,12 @@ GnResult GnDeviceVK::CreateRenderPass(const GnRenderPassCacheKey* desc, VkRender
     VkAttachmentReference color_att_refs[GN_MAX_COLOR_TARGETS];
     VkAttachmentReference resolve_att_refs[GN_MAX_COLOR_TARGETS];
     VkAttachmentReference depth_stencil_att_ref;
+    uint32_t color_attachments[GN_MAX_COLOR_TARGETS];
     VkSampleCountFlagBits sample_count = (VkSampleCountFlagBits)desc->sample_count;
 
     for (uint32_t i = 0; i < desc->num_color_targets; i++) {
+        color_attachments[i] = VK_ATTACHMENT_UNUSED;
+
         if (!GnContainsBit(desc->color_target_mask, 1 << i)) {
             auto& color_att_ref = color_att_refs[i];
             color_att_ref.attachment = VK_ATTACHMENT_UNUSED;
@@ -3712,6 +5980,7 @@ GnResult GnDeviceVK::CreateRenderPass(const GnRenderPassCacheKey* desc, VkRender
 
         const auto& color_target = desc->color_targets[i];
         VkImageLayout layout = GnGetImageLayoutFromAccessVK(color_target.access);
+        color_attachments[i] = (uint32_t)attachments.size;
 
         auto color_att = attachments.emplace_back_ptr();
         color_att->flags = 0;
@@ -3725,7 +5994,7 @@ GnResult GnDeviceVK::CreateRenderPass(const GnRenderPassCacheKey* desc, VkRender
         color_att->finalLayout = layout;
 
         auto& color_att_ref = color_att_refs[i];
-        color_att_ref.attachment = i;
+        color_att_ref.attachment = color_attachments[i];
         color_att_ref.layout = layout;
     }
 
@@ -3789,26 +6058,290 @@ GnResult GnDeviceVK::CreateRenderPass(const GnRenderPassCacheKey* desc, VkRender
     subpass.preserveAttachmentCount = {};
     subpass.pPreserveAttachments = {};
 
-    VkRenderPassCreateInfo rp_info;
-    rp_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    rp_info.pNext = nullptr;
-    rp_info.flags = 0;
-    rp_info.attachmentCount = (uint32_t)attachments.size;
-    rp_info.pAttachments = attachments.storage;
-    rp_info.subpassCount = 1;
-    rp_info.pSubpasses = &subpass;
-    rp_info.dependencyCount = 0;
-    rp_info.pDependencies = nullptr;
+    VkRenderPassCreateInfo rp_info;
+    rp_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    rp_info.pNext = nullptr;
+    rp_info.flags = 0;
+    rp_info.attachmentCount = (uint32_t)attachments.size;
+    rp_info.pAttachments = attachments.storage;
+    rp_info.subpassCount = 1;
+    rp_info.pSubpasses = &subpass;
+    rp_info.dependencyCount = 0;
+    rp_info.pDependencies = nullptr;
+
+    // Each attachment starts and ends in the layout of its access, subpasses transition it in between.
+    GnSubpassBuilderVK subpass_builder;
+
+    if (desc->subpass_layout.num_subpasses > 0) {
+        subpass_builder.Build(desc->subpass_layout, color_attachments,
+                              desc->has_depth_stencil_target ? depth_stencil_att_ref.attachment : VK_ATTACHMENT_UNUSED);
+
+        rp_info.subpassCount = desc->subpass_layout.num_subpasses;
+        rp_info.pSubpasses = subpass_builder.subpasses;
+        rp_info.dependencyCount = subpass_builder.num_dependencies;
+        rp_info.pDependencies = subpass_builder.dependencies;
+    }
+
+    return GnConvertFromVkResult(fn.vkCreateRenderPass(device, &rp_info, nullptr, render_pass));
+}
+
+// -- [GnBindlessHeapVK] --
+
+GnResult GnBindlessHeapVK::Init(GnDeviceVK* impl_device, const GnAdapterVK* adapter, const GnDeviceDesc* desc) noexcept
+{
+    const GnVulkanDeviceFunctions& fn = impl_device->fn;
+    const VkPhysicalDeviceDescriptorIndexingPropertiesEXT& props = adapter->descriptor_indexing_properties;
+
+    // Every descriptor of the heap counts against the pool-wide limit, keep some room for the other bindings.
+    const uint32_t max_descriptors_per_binding = props.maxUpdateAfterBindDescriptorsInAllPools / 4;
+
+    uint32_t num_textures = desc->max_bindless_textures != 0 ? desc->max_bindless_textures : default_capacity;
+    num_textures = GnMin(num_textures, max_descriptors_per_binding);
+    num_textures = GnMin(num_textures, props.maxDescriptorSetUpdateAfterBindSampledImages);
+    num_textures = GnMin(num_textures, props.maxDescriptorSetUpdateAfterBindStorageImages);
+    num_textures = GnMin(num_textures, props.maxPerStageDescriptorUpdateAfterBindSampledImages);
+    num_textures = GnMin(num_textures, props.maxPerStageDescriptorUpdateAfterBindStorageImages);
+
+    uint32_t num_buffers = desc->max_bindless_buffers != 0 ? desc->max_bindless_buffers : default_capacity;
+    num_buffers = GnMin(num_buffers, max_descriptors_per_binding);
+    num_buffers = GnMin(num_buffers, props.maxDescriptorSetUpdateAfterBindStorageBuffers);
+    num_buffers = GnMin(num_buffers, props.maxPerStageDescriptorUpdateAfterBindStorageBuffers);
+
+    // Uniform buffers share the buffer indices, only give them a binding if every index fits.
+    has_uniform_buffers =
+        adapter->descriptor_indexing_feature.descriptorBindingUniformBufferUpdateAfterBind &&
+        props.maxDescriptorSetUpdateAfterBindUniformBuffers >= num_buffers &&
+        props.maxPerStageDescriptorUpdateAfterBindUniformBuffers >= num_buffers;
+
+    max_uniform_buffer_range = adapter->limits.max_uniform_buffer_range;
+
+    if (num_textures == 0 || num_buffers == 0)
+        return GnError_UnsupportedFeature;
+
+    const uint32_t num_bindings = has_uniform_buffers ? 4 : 3;
+    VkDescriptorSetLayoutBinding bindings[4];
+    VkDescriptorBindingFlagsEXT binding_flags[4];
+    VkDescriptorPoolSize pool_sizes[4];
+
+    static constexpr VkDescriptorType descriptor_types[4] = {
+        VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+        VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+    };
+
+    for (uint32_t i = 0; i < num_bindings; i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = descriptor_types[i];
+        bindings[i].descriptorCount = i < storage_buffer_binding ? num_textures : num_buffers;
+        bindings[i].stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[i].pImmutableSamplers = nullptr;
+        binding_flags[i] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+                           VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+                           VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+        pool_sizes[i].type = descriptor_types[i];
+        pool_sizes[i].descriptorCount = bindings[i].descriptorCount;
+    }
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT binding_flags_info;
+    binding_flags_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    binding_flags_info.pNext = nullptr;
+    binding_flags_info.bindingCount = num_bindings;
+    binding_flags_info.pBindingFlags = binding_flags;
+
+    VkDescriptorSetLayoutCreateInfo set_layout_info;
+    set_layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    set_layout_info.pNext = &binding_flags_info;
+    set_layout_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+    set_layout_info.bindingCount = num_bindings;
+    set_layout_info.pBindings = bindings;
+
+    VkResult result = fn.vkCreateDescriptorSetLayout(impl_device->device, &set_layout_info, nullptr, &set_layout);
+
+    if (GN_VULKAN_FAILED(result)) {
+        set_layout = VK_NULL_HANDLE;
+        return GnConvertFromVkResult(result);
+    }
+
+    VkDescriptorPoolCreateInfo pool_info;
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.pNext = nullptr;
+    pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+    pool_info.maxSets = 1;
+    pool_info.poolSizeCount = num_bindings;
+    pool_info.pPoolSizes = pool_sizes;
+
+    result = fn.vkCreateDescriptorPool(impl_device->device, &pool_info, nullptr, &descriptor_pool);
+
+    // Objects created so far are destroyed on every failure below, the heap is left as if Init was never called.
+    if (GN_VULKAN_FAILED(result)) {
+        descriptor_pool = VK_NULL_HANDLE;
+        Destroy(impl_device);
+        return GnConvertFromVkResult(result);
+    }
+
+    VkDescriptorSetAllocateInfo alloc_info;
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.pNext = nullptr;
+    alloc_info.descriptorPool = descriptor_pool;
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.pSetLayouts = &set_layout;
+
+    VkDescriptorSet new_descriptor_set;
+    result = fn.vkAllocateDescriptorSets(impl_device->device, &alloc_info, &new_descriptor_set);
+
+    if (GN_VULKAN_FAILED(result)) {
+        Destroy(impl_device);
+        return GnConvertFromVkResult(result);
+    }
+
+    if (!texture_indices.Init(num_textures) || !buffer_indices.Init(num_buffers)) {
+        Destroy(impl_device);
+        return GnError_OutOfHostMemory;
+    }
+
+    descriptor_set = new_descriptor_set;
+
+    return GnSuccess;
+}
+
+void GnBindlessHeapVK::Destroy(GnDeviceVK* impl_device) noexcept
+{
+    if (descriptor_pool != VK_NULL_HANDLE)
+        impl_device->fn.vkDestroyDescriptorPool(impl_device->device, descriptor_pool, nullptr);
+
+    if (set_layout != VK_NULL_HANDLE)
+        impl_device->fn.vkDestroyDescriptorSetLayout(impl_device->device, set_layout, nullptr);
+
+    texture_indices.Destroy();
+    buffer_indices.Destroy();
+    descriptor_pool = VK_NULL_HANDLE;
+    set_layout = VK_NULL_HANDLE;
+    descriptor_set = VK_NULL_HANDLE;
+}
+
+void GnBindlessHeapVK::AllocateTextureView(GnDeviceVK* impl_device, const GnTextureVK* texture, GnTextureViewVK* texture_view, GnTextureAspectFlags aspect) noexcept
+{
+    texture_view->bindless_index = GN_INVALID;
+
+    const bool sampled = GnHasBit(texture->desc.usage, GnTextureUsage_Sampled);
+    const bool storage = GnHasBit(texture->desc.usage, GnTextureUsage_Storage);
+
+    // Image descriptors can only refer to one aspect.
+    if (!IsEnabled() || (!sampled && !storage) || GnContainsBit(aspect, GnTextureAspect_Depth, GnTextureAspect_Stencil))
+        return;
+
+    uint32_t index = texture_indices.Allocate();
+
+    if (index == GnIndexAllocator::invalid_index)
+        return;
+
+    VkDescriptorImageInfo image_infos[2];
+    VkWriteDescriptorSet writes[2];
+    uint32_t num_writes = 0;
+
+    for (uint32_t binding = sampled_texture_binding; binding <= storage_texture_binding; binding++) {
+        if (binding == sampled_texture_binding ? !sampled : !storage)
+            continue;
+
+        VkDescriptorImageInfo& image_info = image_infos[num_writes];
+        image_info.sampler = VK_NULL_HANDLE;
+        image_info.imageView = texture_view->view;
+        image_info.imageLayout = binding == sampled_texture_binding ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+
+        VkWriteDescriptorSet& write = writes[num_writes++];
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.pNext = nullptr;
+        write.dstSet = descriptor_set;
+        write.dstBinding = binding;
+        write.dstArrayElement = index;
+        write.descriptorCount = 1;
+        write.descriptorType = binding == sampled_texture_binding ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        write.pImageInfo = &image_info;
+        write.pBufferInfo = nullptr;
+        write.pTexelBufferView = nullptr;
+    }
+
+    {
+        std::scoped_lock lock(write_mutex);
+        impl_device->fn.vkUpdateDescriptorSets(impl_device->device, num_writes, writes, 0, nullptr);
+    }
+
+    texture_view->bindless_index = index;
+}
+
+void GnBindlessHeapVK::AllocateBuffer(GnBufferVK* buffer) noexcept
+{
+    buffer->bindless_index = GN_INVALID;
+
+    if (!IsEnabled())
+        return;
+
+    if (GnHasBit(buffer->desc.usage, GnBufferUsage_Storage) || (has_uniform_buffers && GnHasBit(buffer->desc.usage, GnBufferUsage_Uniform)))
+        buffer->bindless_index = buffer_indices.Allocate();
+}
+
+void GnBindlessHeapVK::WriteBuffer(GnDeviceVK* impl_device, const GnBufferVK* buffer) noexcept
+{
+    if (buffer->bindless_index == GN_INVALID)
+        return;
+
+    VkDescriptorBufferInfo buffer_infos[2];
+    VkWriteDescriptorSet writes[2];
+    uint32_t num_writes = 0;
 
-    return GnConvertFromVkResult(fn.vkCreateRenderPass(device, &rp_info, nullptr, render_pass));
+    for (uint32_t binding = storage_buffer_binding; binding <= uniform_buffer_binding; binding++) {
+        const bool is_storage = binding == storage_buffer_binding;
+
+        if (!GnHasBit(buffer->desc.usage, is_storage ? GnBufferUsage_Storage : GnBufferUsage_Uniform))
+            continue;
+
+        if (!is_storage && !has_uniform_buffers)
+            continue;
+
+        VkDescriptorBufferInfo& buffer_info = buffer_infos[num_writes];
+        buffer_info.buffer = buffer->buffer;
+        buffer_info.offset = 0;
+        buffer_info.range = is_storage ? VK_WHOLE_SIZE : GnMin(buffer->desc.size, max_uniform_buffer_range);
+
+        VkWriteDescriptorSet& write = writes[num_writes++];
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.pNext = nullptr;
+        write.dstSet = descriptor_set;
+        write.dstBinding = binding;
+        write.dstArrayElement = buffer->bindless_index;
+        write.descriptorCount = 1;
+        write.descriptorType = is_storage ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        write.pImageInfo = nullptr;
+        write.pBufferInfo = &buffer_info;
+        write.pTexelBufferView = nullptr;
+    }
+
+    std::scoped_lock lock(write_mutex);
+    impl_device->fn.vkUpdateDescriptorSets(impl_device->device, num_writes, writes, 0, nullptr);
 }
 
 // -- [GnQueueVK] --
 
-VkResult GnQueueVK::Init(GnDeviceVK* impl_device, VkQueue vk_queue) noexcept
+VkResult GnQueueVK::Init(GnDeviceVK* impl_device, VkQueue vk_queue, uint32_t family_index) noexcept
 {
     parent_device = impl_device;
     queue = vk_queue;
+    queue_family_index = family_index;
+    supported_stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+    for (uint32_t i = 0; i < impl_device->parent_adapter->num_queue_groups; i++) {
+        const GnQueueGroupProperties& queue_group = impl_device->parent_adapter->queue_group_properties[i];
+
+        if (queue_group.index != family_index)
+            continue;
+
+        if (queue_group.type == GnQueueType_Direct)
+            for (VkPipelineStageFlags stage : gn_pipeline_stage_bit_to_stage_vk)
+                supported_stages |= stage;
+        else if (queue_group.type == GnQueueType_Compute)
+            supported_stages |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    }
 
     VkFenceCreateInfo fence_info;
     fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
@@ -3820,10 +6353,195 @@ VkResult GnQueueVK::Init(GnDeviceVK* impl_device, VkQueue vk_queue) noexcept
 
 void GnQueueVK::Destroy() noexcept
 {
-    parent_device->fn.vkDestroyFence(parent_device->device, wait_fence, nullptr);
+    const auto& fn = parent_device->fn;
+
+    for (GnStateFixupFrameVK& frame : state_fixup_frames) {
+        if (frame.cmd_pool == VK_NULL_HANDLE)
+            continue;
+
+        if (frame.submitted)
+            fn.vkWaitForFences(parent_device->device, 1, &frame.fence, VK_TRUE, UINT64_MAX);
+
+        fn.vkDestroyFence(parent_device->device, frame.fence, nullptr);
+        fn.vkDestroyCommandPool(parent_device->device, frame.cmd_pool, nullptr);
+    }
+
+    if (progress_fence != nullptr)
+        parent_device->DestroyFence(progress_fence);
+
+    fn.vkDestroyFence(parent_device->device, wait_fence, nullptr);
+}
+
+GnResult GnQueueVK::GetProgressFence(GnFence* fence) noexcept
+{
+    if (progress_fence == nullptr) {
+        GnResult result = parent_device->CreateTimelineFence(0, &progress_fence);
+        if (GN_FAILED(result))
+            return result;
+    }
+
+    *fence = progress_fence;
+
+    return GnSuccess;
+}
+
+GnResult GnQueueVK::Reserve(uint32_t num_waits, uint32_t num_command_lists, uint32_t num_signals) noexcept
+{
+    const size_t wait_reserve_size = wait_semaphore_queue.num_items_written() + num_waits;
+    const size_t signal_reserve_size = signal_semaphore_queue.num_items_written() + num_signals;
+
+    // Each enqueue may close the current submission packet
+    const size_t packet_reserve_size = submission_packets.size() + num_waits + num_command_lists + num_signals + 1;
+
+    if (!(wait_semaphore_queue.reserve(wait_reserve_size) &&
+          wait_dst_stage_queue.reserve(wait_reserve_size) &&
+          wait_value_queue.reserve(wait_reserve_size) &&
+          command_buffer_queue.reserve(command_buffer_queue.num_items_written() + num_command_lists) &&
+          signal_semaphore_queue.reserve(signal_reserve_size) &&
+          signal_value_queue.reserve(signal_reserve_size) &&
+          submission_packets.reserve(packet_reserve_size)))
+    {
+        return GnError_OutOfHostMemory;
+    }
+
+    return GnSuccess;
+}
+
+VkCommandBuffer GnQueueVK::AllocateStateFixupCommandBuffer() noexcept
+{
+    const auto& fn = parent_device->fn;
+    GnStateFixupFrameVK& frame = state_fixup_frames[current_state_fixup_frame];
+
+    if (frame.cmd_pool == VK_NULL_HANDLE) {
+        VkCommandPoolCreateInfo cmd_pool_info;
+        cmd_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        cmd_pool_info.pNext = nullptr;
+        cmd_pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        cmd_pool_info.queueFamilyIndex = queue_family_index;
+
+        if (GN_VULKAN_FAILED(fn.vkCreateCommandPool(parent_device->device, &cmd_pool_info, nullptr, &frame.cmd_pool)))
+            return VK_NULL_HANDLE;
+
+        VkFenceCreateInfo fence_info;
+        fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fence_info.pNext = nullptr;
+        fence_info.flags = 0;
+
+        if (GN_VULKAN_FAILED(fn.vkCreateFence(parent_device->device, &fence_info, nullptr, &frame.fence))) {
+            fn.vkDestroyCommandPool(parent_device->device, frame.cmd_pool, nullptr);
+            frame.cmd_pool = VK_NULL_HANDLE;
+            return VK_NULL_HANDLE;
+        }
+    }
+    else if (frame.submitted) {
+        // The frame is being reused, wait until the GPU is done with its command buffers.
+        fn.vkWaitForFences(parent_device->device, 1, &frame.fence, VK_TRUE, UINT64_MAX);
+        fn.vkResetFences(parent_device->device, 1, &frame.fence);
+        fn.vkResetCommandPool(parent_device->device, frame.cmd_pool, 0);
+        frame.num_used_cmd_buffers = 0;
+        frame.submitted = false;
+    }
+
+    if (frame.num_used_cmd_buffers == frame.cmd_buffers.size()) {
+        VkCommandBufferAllocateInfo alloc_info;
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.pNext = nullptr;
+        alloc_info.commandPool = frame.cmd_pool;
+        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandBufferCount = 1;
+
+        VkCommandBuffer cmd_buffer;
+
+        if (GN_VULKAN_FAILED(fn.vkAllocateCommandBuffers(parent_device->device, &alloc_info, &cmd_buffer)))
+            return VK_NULL_HANDLE;
+
+        if (!frame.cmd_buffers.push_back(cmd_buffer)) {
+            fn.vkFreeCommandBuffers(parent_device->device, frame.cmd_pool, 1, &cmd_buffer);
+            return VK_NULL_HANDLE;
+        }
+    }
+
+    return frame.cmd_buffers[frame.num_used_cmd_buffers++];
+}
+
+GnResult GnQueueVK::EnqueueStateFixup(uint32_t                  num_buffer_barriers,
+                                      const GnBufferBarrier*    buffer_barriers,
+                                      uint32_t                  num_texture_barriers,
+                                      const GnTextureBarrier*   texture_barriers) noexcept
+{
+    if (signal_semaphore_queue.size() > 0)
+        if (!GroupSubmissionPacket())
+            return GnError_OutOfHostMemory;
+
+    // Fixups are rare, so they always go through the legacy barrier path. Everything is reserved before the command
+    // buffer is allocated so that appending the barriers cannot fail.
+    GnVector<VkBufferMemoryBarrier>& vk_buffer_barriers = state_fixup_buffer_barriers;
+    GnVector<VkImageMemoryBarrier>& vk_image_barriers = state_fixup_image_barriers;
+    VkPipelineStageFlags src_stages = 0;
+    VkPipelineStageFlags dst_stages = 0;
+
+    if (!command_buffer_queue.reserve(command_buffer_queue.num_items_written() + 1) ||
+        !vk_buffer_barriers.reserve(num_buffer_barriers) ||
+        !vk_image_barriers.reserve(num_texture_barriers))
+    {
+        return GnError_OutOfHostMemory;
+    }
+
+    vk_buffer_barriers.resize(0);
+    vk_image_barriers.resize(0);
+
+    VkCommandBuffer cmd_buffer = AllocateStateFixupCommandBuffer();
+
+    if (cmd_buffer == VK_NULL_HANDLE)
+        return GnError_OutOfDeviceMemory;
+
+    const auto& fn = parent_device->fn;
+
+    VkCommandBufferBeginInfo begin_info;
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.pNext = nullptr;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    begin_info.pInheritanceInfo = nullptr;
+
+    fn.vkBeginCommandBuffer(cmd_buffer, &begin_info);
+
+    auto flush = [&]() {
+        if (vk_buffer_barriers.size() == 0 && vk_image_barriers.size() == 0)
+            return;
+
+        fn.vkCmdPipelineBarrier(cmd_buffer,
+                                src_stages != 0 ? src_stages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                dst_stages != 0 ? dst_stages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                0, 0, nullptr,
+                                (uint32_t)vk_buffer_barriers.size(), vk_buffer_barriers.data(),
+                                (uint32_t)vk_image_barriers.size(), vk_image_barriers.data());
+
+        vk_buffer_barriers.resize(0);
+        vk_image_barriers.resize(0);
+        src_stages = 0;
+        dst_stages = 0;
+    };
+
+    if (!(GnAppendBufferBarriersVK<false>(vk_buffer_barriers, src_stages, dst_stages, num_buffer_barriers, buffer_barriers, flush) &&
+          GnAppendImageBarriersVK<false>(vk_image_barriers, src_stages, dst_stages, num_texture_barriers, texture_barriers, flush)))
+    {
+        fn.vkEndCommandBuffer(cmd_buffer);
+        return GnError_OutOfHostMemory;
+    }
+
+    flush();
+
+    GnResult result = GnConvertFromVkResult(fn.vkEndCommandBuffer(cmd_buffer));
+
+    if (GN_FAILED(result))
+        return result;
+
+    command_buffer_queue.push(cmd_buffer);
+
+    return GnSuccess;
 }
 
-GnResult GnQueueVK::EnqueueWaitSemaphore(uint32_t num_wait_semaphores, const GnSemaphore* wait_semaphores) noexcept
+GnResult GnQueueVK::EnqueueWaitSemaphore(uint32_t num_wait_semaphores, const GnSemaphore* wait_semaphores, const GnPipelineStageFlags* wait_stages) noexcept
 {
     if (command_buffer_queue.size() > 0 || signal_semaphore_queue.size() > 0)
         if (!GroupSubmissionPacket())
@@ -3831,17 +6549,41 @@ GnResult GnQueueVK::EnqueueWaitSemaphore(uint32_t num_wait_semaphores, const GnS
 
     uint32_t reserve_size = (uint32_t)wait_semaphore_queue.num_items_written() + num_wait_semaphores;
 
-    if (!(wait_semaphore_queue.reserve(reserve_size) && wait_dst_stage_queue.reserve(reserve_size)))
+    if (!(wait_semaphore_queue.reserve(reserve_size) && wait_dst_stage_queue.reserve(reserve_size) && wait_value_queue.reserve(reserve_size)))
         return GnError_OutOfHostMemory;
 
     for (uint32_t i = 0; i < num_wait_semaphores; i++) {
         wait_semaphore_queue.push(GN_TO_VULKAN(GnSemaphore, wait_semaphores[i])->semaphore);
-        wait_dst_stage_queue.push(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+        wait_dst_stage_queue.push(wait_stages ? GnConvertPipelineStagesVK(wait_stages[i], supported_stages) : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+        wait_value_queue.push(0);
     }
 
     return GnSuccess;
 }
 
+GnResult GnQueueVK::EnqueueWaitFence(GnFence fence, uint64_t value, GnPipelineStageFlags wait_stages) noexcept
+{
+    return EnqueueWaitSemaphoreVK(GN_TO_VULKAN(GnFence, fence)->timeline_semaphore, GnConvertPipelineStagesVK(wait_stages, supported_stages), value);
+}
+
+GnResult GnQueueVK::EnqueueWaitSemaphoreVK(VkSemaphore semaphore, VkPipelineStageFlags wait_stage, uint64_t value) noexcept
+{
+    if (command_buffer_queue.size() > 0 || signal_semaphore_queue.size() > 0)
+        if (!GroupSubmissionPacket())
+            return GnError_OutOfHostMemory;
+
+    uint32_t reserve_size = (uint32_t)wait_semaphore_queue.num_items_written() + 1;
+
+    if (!(wait_semaphore_queue.reserve(reserve_size) && wait_dst_stage_queue.reserve(reserve_size) && wait_value_queue.reserve(reserve_size)))
+        return GnError_OutOfHostMemory;
+
+    wait_semaphore_queue.push(semaphore);
+    wait_dst_stage_queue.push(wait_stage);
+    wait_value_queue.push(value);
+
+    return GnSuccess;
+}
+
 GnResult GnQueueVK::EnqueueCommandLists(uint32_t num_command_lists, const GnCommandList* command_lists) noexcept
 {
     if (signal_semaphore_queue.size() > 0)
@@ -3860,11 +6602,43 @@ GnResult GnQueueVK::EnqueueCommandLists(uint32_t num_command_lists, const GnComm
 
 GnResult GnQueueVK::EnqueueSignalSemaphore(uint32_t num_signal_semaphores, const GnSemaphore* signal_semaphores) noexcept
 {
-    if (!signal_semaphore_queue.reserve(signal_semaphore_queue.num_items_written() + num_signal_semaphores))
+    uint32_t reserve_size = (uint32_t)signal_semaphore_queue.num_items_written() + num_signal_semaphores;
+
+    if (!(signal_semaphore_queue.reserve(reserve_size) && signal_value_queue.reserve(reserve_size)))
         return GnError_OutOfHostMemory;
 
-    for (uint32_t i = 0; i < num_signal_semaphores; i++)
+    for (uint32_t i = 0; i < num_signal_semaphores; i++) {
         signal_semaphore_queue.push(GN_TO_VULKAN(GnSemaphore, signal_semaphores[i])->semaphore);
+        signal_value_queue.push(0);
+    }
+
+    return GnSuccess;
+}
+
+GnResult GnQueueVK::EnqueueSignalFence(GnFence fence, uint64_t value) noexcept
+{
+    GnFenceVK* impl_fence = GN_TO_VULKAN(GnFence, fence);
+    GnResult result = EnqueueSignalSemaphoreVK(impl_fence->timeline_semaphore, value);
+
+    if (GN_FAILED(result))
+        return result;
+
+    // Remember the highest value so GnWaitFence can wait for everything signaled so far.
+    uint64_t last_value = impl_fence->last_signal_value.load(std::memory_order_relaxed);
+    while (last_value < value && !impl_fence->last_signal_value.compare_exchange_weak(last_value, value, std::memory_order_relaxed));
+
+    return GnSuccess;
+}
+
+GnResult GnQueueVK::EnqueueSignalSemaphoreVK(VkSemaphore semaphore, uint64_t value) noexcept
+{
+    uint32_t reserve_size = (uint32_t)signal_semaphore_queue.num_items_written() + 1;
+
+    if (!(signal_semaphore_queue.reserve(reserve_size) && signal_value_queue.reserve(reserve_size)))
+        return GnError_OutOfHostMemory;
+
+    signal_semaphore_queue.push(semaphore);
+    signal_value_queue.push(value);
 
     return GnSuccess;
 }
@@ -3874,53 +6648,132 @@ GnResult GnQueueVK::Flush(GnFence fence, bool wait) noexcept
     if (!GroupSubmissionPacket())
         return GnError_OutOfHostMemory;
 
+    // In deferred mode, packets are kept until something has to observe their completion.
+    if (deferred_submission && fence == nullptr && !wait)
+        return GnSuccess;
+
+    return SubmitPackets(fence ? GN_TO_VULKAN(GnFence, fence)->fence : VK_NULL_HANDLE, wait);
+}
+
+GnResult GnQueueVK::Commit(GnFence fence) noexcept
+{
+    if (!GroupSubmissionPacket())
+        return GnError_OutOfHostMemory;
+
+    return SubmitPackets(fence ? GN_TO_VULKAN(GnFence, fence)->fence : VK_NULL_HANDLE, false);
+}
+
+// With reset_fence, the fence is reset right before it is submitted, and signaled again if the submission fails so that
+// waiting on it cannot hang.
+GnResult GnQueueVK::SubmitPackets(VkFence vk_fence, bool wait, bool reset_fence) noexcept
+{
     const auto& fn = parent_device->fn;
-    VkFence vk_fence = fence ? GN_TO_VULKAN(GnFence, fence)->fence : VK_NULL_HANDLE;
-    GnResult result = GnConvertFromVkResult(fn.vkQueueSubmit(queue, (uint32_t)submission_queue.size(), submission_queue.data, vk_fence));
+    const uint32_t num_packets = (uint32_t)submission_packets.size();
+    GnResult result = GnSuccess;
 
-    if (GN_FAILED(result))
-        return result;
+    const bool has_timeline = parent_device->ver_info.HasTimelineSemaphore();
+
+    if (!submit_infos.resize(num_packets) || (has_timeline && !timeline_submit_infos.resize(num_packets))) {
+        ClearPendingSubmissions();
+        return GnError_OutOfHostMemory;
+    }
+
+    for (uint32_t i = 0; i < num_packets; i++) {
+        const GnSubmissionPacketVK& packet = submission_packets[i];
+        VkSubmitInfo& submit_info = submit_infos[i];
+
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.pNext = nullptr;
+
+        if (has_timeline) {
+            // Values for binary semaphores are ignored by the implementation.
+            VkTimelineSemaphoreSubmitInfoKHR& timeline_info = timeline_submit_infos[i];
+            timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+            timeline_info.pNext = nullptr;
+            timeline_info.waitSemaphoreValueCount = packet.num_wait_semaphores;
+            timeline_info.pWaitSemaphoreValues = wait_value_queue.data + packet.first_wait_semaphore;
+            timeline_info.signalSemaphoreValueCount = packet.num_signal_semaphores;
+            timeline_info.pSignalSemaphoreValues = signal_value_queue.data + packet.first_signal_semaphore;
+            submit_info.pNext = &timeline_info;
+        }
+
+        submit_info.waitSemaphoreCount = packet.num_wait_semaphores;
+        submit_info.pWaitSemaphores = wait_semaphore_queue.data + packet.first_wait_semaphore;
+        submit_info.pWaitDstStageMask = wait_dst_stage_queue.data + packet.first_wait_semaphore;
+        submit_info.commandBufferCount = packet.num_command_buffers;
+        submit_info.pCommandBuffers = command_buffer_queue.data + packet.first_command_buffer;
+        submit_info.signalSemaphoreCount = packet.num_signal_semaphores;
+        submit_info.pSignalSemaphores = signal_semaphore_queue.data + packet.first_signal_semaphore;
+    }
+
+    if (num_packets > 0 || vk_fence != VK_NULL_HANDLE) {
+        if (reset_fence)
+            fn.vkResetFences(parent_device->device, 1, &vk_fence);
+
+        result = GnConvertFromVkResult(fn.vkQueueSubmit(queue, num_packets, submit_infos.data(), vk_fence));
+
+        if (GN_FAILED(result)) {
+            if (reset_fence)
+                fn.vkQueueSubmit(queue, 0, nullptr, vk_fence);
+
+            ClearPendingSubmissions();
+            return result;
+        }
+    }
+
+    ClearPendingSubmissions();
+
+    GnStateFixupFrameVK& fixup_frame = state_fixup_frames[current_state_fixup_frame];
+
+    if (fixup_frame.num_used_cmd_buffers > 0) {
+        // Track completion of the fixup command buffers submitted above so the frame can be recycled later.
+        if (GN_FAILED(result = GnConvertFromVkResult(fn.vkQueueSubmit(queue, 0, nullptr, fixup_frame.fence))))
+            return result;
+
+        fixup_frame.submitted = true;
+        current_state_fixup_frame = (current_state_fixup_frame + 1) % num_state_fixup_frames;
+    }
 
     if (wait)
         if (GN_FAILED(result = GnConvertFromVkResult(fn.vkQueueWaitIdle(queue))))
             return result;
 
-    // Wipe all queued items.
+    return result;
+}
+
+// Drops every queued item. Called after a submission, whether or not it succeeded: work that failed to submit is
+// discarded rather than submitted again along with the next packets.
+void GnQueueVK::ClearPendingSubmissions() noexcept
+{
     wait_semaphore_queue.clear();
     wait_dst_stage_queue.clear();
+    wait_value_queue.clear();
     command_buffer_queue.clear();
     signal_semaphore_queue.clear();
-    submission_queue.clear();
-
-    return result;
+    signal_value_queue.clear();
+    submission_packets.resize(0);
 }
 
 GnResult GnQueueVK::PresentSwapchain(GnSwapchain swapchain) noexcept
 {
     GnSwapchainVK* impl_swapchain = GN_TO_VULKAN(GnSwapchain, swapchain);
+
+    if (impl_swapchain->direct_present)
+        return impl_swapchain->PresentDirect(this);
+
     uint32_t current_frame = impl_swapchain->current_frame;
-    const GnSwapchainFramePresenterVK& presenter = impl_swapchain->frame_presenters[current_frame];
-    const GnSwapchainBlitImageVK& blit_image = impl_swapchain->blit_images[current_frame];
+    const GnSwapchainFramePresenterVK& presenter = impl_swapchain->frame_presenters[impl_swapchain->current_present_slot];
     GnVulkanDeviceFunctions& fn = parent_device->fn;
 
-    VkCommandBufferBeginInfo begin_info{};
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    VkClearColorValue color_value;
-    color_value.float32[0] = 1.0f;
-    color_value.float32[1] = 0.0f;
-    color_value.float32[2] = 0.0f;
-    color_value.float32[3] = 0.0f;
+    // Work flushed before the present must reach the GPU before the blit that reads from it.
+    if (deferred_submission) {
+        GnResult commit_result = Commit(nullptr);
 
-    VkImageSubresourceRange subresource_range;
-    subresource_range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    subresource_range.baseMipLevel = 0;
-    subresource_range.levelCount = 1;
-    subresource_range.baseArrayLayer = 0;
-    subresource_range.layerCount = 1;
+        if (GN_FAILED(commit_result))
+            return commit_result;
+    }
 
-    auto [result, present_image] = impl_swapchain->AcquireNextImage();
+    VkResult result = impl_swapchain->AcquireNextImage().first;
 
     if (impl_swapchain->should_update || result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
         fn.vkQueueWaitIdle(queue);
@@ -3929,7 +6782,7 @@ GnResult GnQueueVK::PresentSwapchain(GnSwapchain swapchain) noexcept
             return GnError_InternalError;
         
         // Reacquire next image
-        std::tie(result, present_image) = impl_swapchain->AcquireNextImage();
+        result = impl_swapchain->AcquireNextImage().first;
         
         if (GN_VULKAN_FAILED(result))
             return GnError_InternalError;
@@ -3937,47 +6790,13 @@ GnResult GnQueueVK::PresentSwapchain(GnSwapchain swapchain) noexcept
     else if (result != VK_SUCCESS)
         return GnError_InternalError;
 
-    VkImageMemoryBarrier barrier;
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.pNext = nullptr;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = present_image;
-    barrier.subresourceRange = subresource_range;
-    fn.vkWaitForFences(parent_device->device, 1, &presenter.submit_fence, VK_FALSE, UINT64_MAX);
-
-    fn.vkResetCommandPool(parent_device->device, presenter.cmd_pool, 0);
-    fn.vkBeginCommandBuffer(presenter.cmd_buffer, &begin_info);
-
-    barrier.srcAccessMask = 0;
-    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-
-    fn.vkCmdPipelineBarrier(presenter.cmd_buffer,
-                            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                            VK_PIPELINE_STAGE_TRANSFER_BIT,
-                            0, 0, nullptr, 0, nullptr,
-                            1, &barrier);
-
-    fn.vkCmdBlitImage(presenter.cmd_buffer,
-                      blit_image.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                      present_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                      1, &impl_swapchain->blit_param, VK_FILTER_LINEAR);
-
-    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    barrier.dstAccessMask = 0;
-    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    fn.vkCmdPipelineBarrier(presenter.cmd_buffer,
-                            VK_PIPELINE_STAGE_TRANSFER_BIT,
-                            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-                            0, 0, nullptr, 0, nullptr,
-                            1, &barrier);
+    if (impl_swapchain->blit_cmd_buffers_dirty)
+        if (GN_FAILED(impl_swapchain->RecordBlitCommandBuffers()))
+            return GnError_InternalError;
 
-    fn.vkEndCommandBuffer(presenter.cmd_buffer);
+    fn.vkWaitForFences(parent_device->device, 1, &presenter.submit_fence, VK_FALSE, UINT64_MAX);
 
+    VkCommandBuffer blit_cmd_buffer = impl_swapchain->GetBlitCommandBuffer(current_frame, impl_swapchain->current_acquired_image);
     VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
 
     VkSubmitInfo submit_info{};
@@ -3987,7 +6806,7 @@ GnResult GnQueueVK::PresentSwapchain(GnSwapchain swapchain) noexcept
     submit_info.pWaitSemaphores = &presenter.acquire_image_semaphore;
     submit_info.pWaitDstStageMask = &wait_stage;
     submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &presenter.cmd_buffer;
+    submit_info.pCommandBuffers = &blit_cmd_buffer;
     submit_info.signalSemaphoreCount = 1;
     submit_info.pSignalSemaphores = &presenter.blit_finished_semaphore;
 
@@ -4014,6 +6833,7 @@ GnResult GnQueueVK::PresentSwapchain(GnSwapchain swapchain) noexcept
         return GnError_InternalError;
 
     impl_swapchain->current_frame = (current_frame + 1) % impl_swapchain->swapchain_desc.num_buffers;
+    impl_swapchain->current_present_slot = (impl_swapchain->current_present_slot + 1) % (uint32_t)impl_swapchain->frame_presenters.size;
 
     return GnSuccess;
 }
@@ -4023,28 +6843,24 @@ bool GnQueueVK::GroupSubmissionPacket() noexcept
     if (wait_semaphore_queue.empty() && command_buffer_queue.empty() && signal_semaphore_queue.empty())
         return true;
 
-    auto submission = submission_queue.emplace();
+    GnSubmissionPacketVK packet;
+    packet.first_wait_semaphore = (uint32_t)wait_semaphore_queue.num_items_read();
+    packet.num_wait_semaphores = (uint32_t)wait_semaphore_queue.size();
+    packet.first_command_buffer = (uint32_t)command_buffer_queue.num_items_read();
+    packet.num_command_buffers = (uint32_t)command_buffer_queue.size();
+    packet.first_signal_semaphore = (uint32_t)signal_semaphore_queue.num_items_read();
+    packet.num_signal_semaphores = (uint32_t)signal_semaphore_queue.size();
 
-    // Return if can't reserve space for submit info
-    if (!submission.has_value())
+    // Return if can't reserve space for the packet
+    if (!submission_packets.push_back(packet))
         return false;
 
-    auto& submit_info = submission->get();
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.waitSemaphoreCount = (uint32_t)wait_semaphore_queue.size();
-    submit_info.commandBufferCount = (uint32_t)command_buffer_queue.size();
-    submit_info.signalSemaphoreCount = (uint32_t)signal_semaphore_queue.size();
-    
-    if (submit_info.waitSemaphoreCount > 0) {
-        submit_info.pWaitSemaphores = wait_semaphore_queue.pop_all();
-        submit_info.pWaitDstStageMask = wait_dst_stage_queue.pop_all();
-    }
-
-    if (submit_info.commandBufferCount > 0)
-        submit_info.pCommandBuffers = command_buffer_queue.pop_all();
-
-    if (submit_info.signalSemaphoreCount > 0)
-        submit_info.pSignalSemaphores = signal_semaphore_queue.pop_all();
+    wait_semaphore_queue.pop_all();
+    wait_dst_stage_queue.pop_all();
+    wait_value_queue.pop_all();
+    command_buffer_queue.pop_all();
+    signal_semaphore_queue.pop_all();
+    signal_value_queue.pop_all();
 
     return true;
 }
@@ -4055,7 +6871,6 @@ void GnSwapchainFramePresenterVK::Destroy(GnDeviceVK* impl_device)
     if (acquire_image_semaphore) fn.vkDestroySemaphore(impl_device->device, acquire_image_semaphore, nullptr);
     if (blit_finished_semaphore) fn.vkDestroySemaphore(impl_device->device, blit_finished_semaphore, nullptr);
     if (submit_fence) fn.vkDestroyFence(impl_device->device, submit_fence, nullptr);
-    if (cmd_pool) fn.vkDestroyCommandPool(impl_device->device, cmd_pool, nullptr);
 }
 
 void GnSwapchainBlitImageVK::Destroy(GnDeviceVK* impl_device)
@@ -4063,26 +6878,98 @@ void GnSwapchainBlitImageVK::Destroy(GnDeviceVK* impl_device)
     const GnVulkanDeviceFunctions& fn = impl_device->fn;
     if (image) fn.vkDestroyImage(impl_device->device, image, nullptr);
     if (memory) fn.vkFreeMemory(impl_device->device, memory, nullptr);
+    if (tracked_subresource_access) GnFree(tracked_subresource_access);
+}
+
+// -- [GnSwapchainVK] --
+
+GnSwapchainVK::GnSwapchainVK(GnDeviceVK* impl_device) noexcept :
+    impl_device(impl_device)
+{
+    blit_param.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit_param.srcSubresource.mipLevel = 0;
+    blit_param.srcSubresource.baseArrayLayer = 0;
+    blit_param.srcSubresource.layerCount = 1;
+    blit_param.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit_param.dstSubresource.mipLevel = 0;
+    blit_param.dstSubresource.baseArrayLayer = 0;
+    blit_param.dstSubresource.layerCount = 1;
 }
 
-// -- [GnSwapchainVK] --
+GnTexture GnSwapchainVK::GetBackBuffer(uint32_t index) noexcept
+{
+    if (direct_present)
+        return &back_buffers[index];
+
+    return &blit_images[index];
+}
+
+uint32_t GnSwapchainVK::GetBackBufferCount() noexcept
+{
+    // The implementation may create more presentable images than requested.
+    if (direct_present)
+        return num_back_buffers;
+
+    return swapchain_desc.num_buffers;
+}
+
+uint32_t GnSwapchainVK::GetCurrentBackBufferIndex() noexcept
+{
+    if (direct_present)
+        return current_acquired_image;
+
+    return current_frame;
+}
+
+GnResult GnSwapchainVK::AcquireNextBackBuffer(uint32_t* index) noexcept
+{
+    if (!direct_present)
+        return GnSwapchain_t::AcquireNextBackBuffer(index);
+
+    if (image_acquired) {
+        *index = current_acquired_image;
+        return GnSuccess;
+    }
+
+    const GnVulkanDeviceFunctions& fn = impl_device->fn;
+    const GnSwapchainFramePresenterVK& presenter = frame_presenters[current_present_slot];
+    bool recreated = false;
+
+    // The acquire semaphore of this frame is free once the last present submission that used it has completed.
+    fn.vkWaitForFences(impl_device->device, 1, &presenter.submit_fence, VK_FALSE, UINT64_MAX);
+
+    if (should_update) {
+        if (GN_FAILED(Recreate()))
+            return GnError_InternalError;
+
+        recreated = true;
+    }
+
+    VkResult result = AcquireNextImage().first;
+
+    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+        if (GN_FAILED(Recreate()))
+            return GnError_InternalError;
+
+        recreated = true;
+        result = AcquireNextImage().first;
+    }
+
+    if (GN_VULKAN_FAILED(result))
+        return GnError_InternalError;
+
+    // Suboptimal images can still be rendered to and presented, the swapchain is recreated after presenting.
+    if (result == VK_SUBOPTIMAL_KHR)
+        should_update = true;
 
-GnSwapchainVK::GnSwapchainVK(GnDeviceVK* impl_device) noexcept :
-    impl_device(impl_device)
-{
-    blit_param.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    blit_param.srcSubresource.mipLevel = 0;
-    blit_param.srcSubresource.baseArrayLayer = 0;
-    blit_param.srcSubresource.layerCount = 1;
-    blit_param.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    blit_param.dstSubresource.mipLevel = 0;
-    blit_param.dstSubresource.baseArrayLayer = 0;
-    blit_param.dstSubresource.layerCount = 1;
-}
+    // The next submission on the present queue must not touch the image before the presentation engine releases it.
+    if (GN_FAILED(present_queue->EnqueueWaitSemaphoreVK(presenter.acquire_image_semaphore, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0)))
+        return GnError_OutOfHostMemory;
 
-GnTexture GnSwapchainVK::GetBackBuffer(uint32_t index) noexcept
-{
-    return &blit_images[index];
+    image_acquired = true;
+    *index = current_acquired_image;
+
+    return recreated ? GnOutOfDate : GnSuccess;
 }
 
 GnResult GnSwapchainVK::Update(GnFormat format, uint32_t width, uint32_t height, uint32_t num_buffers, GnBool vsync) noexcept
@@ -4097,9 +6984,11 @@ GnResult GnSwapchainVK::Update(GnFormat format, uint32_t width, uint32_t height,
     bool vsync_changed = vsync != swapchain_desc.vsync;
     bool config_changed = size_changed || num_buffers_changed || format_changed;
     GnFormat used_format = format_changed ? format : swapchain_desc.format;
+    uint32_t num_frames_in_flight = GetNumFramesInFlight(num_buffers);
+    bool frames_in_flight_changed = num_frames_in_flight != frame_presenters.size;
     GnSmallVector<GnSwapchainFramePresenterVK, 16> new_frame_presenters;
 
-    if (num_buffers_changed) {
+    if (frames_in_flight_changed) {
         VkSemaphoreCreateInfo semaphore_info;
         semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
         semaphore_info.pNext = nullptr;
@@ -4110,16 +6999,7 @@ GnResult GnSwapchainVK::Update(GnFormat format, uint32_t width, uint32_t height,
         fence_info.pNext = nullptr;
         fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-        VkCommandPoolCreateInfo pool_info{};
-        pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        pool_info.queueFamilyIndex = 0;
-
-        VkCommandBufferAllocateInfo cmd_buf_alloc_info{};
-        cmd_buf_alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        cmd_buf_alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        cmd_buf_alloc_info.commandBufferCount = 1;
-
-        for (uint32_t i = 0; i < num_buffers; i++) {
+        for (uint32_t i = 0; i < num_frames_in_flight; i++) {
             auto presenter = new_frame_presenters.emplace_back_ptr();
 
             if (!presenter) {
@@ -4129,27 +7009,20 @@ GnResult GnSwapchainVK::Update(GnFormat format, uint32_t width, uint32_t height,
 
             bool success = !GN_VULKAN_FAILED(fn.vkCreateSemaphore(device, &semaphore_info, nullptr, &presenter->acquire_image_semaphore)) &&
                 !GN_VULKAN_FAILED(fn.vkCreateSemaphore(device, &semaphore_info, nullptr, &presenter->blit_finished_semaphore)) &&
-                !GN_VULKAN_FAILED(fn.vkCreateFence(device, &fence_info, nullptr, &presenter->submit_fence)) &&
-                !GN_VULKAN_FAILED(fn.vkCreateCommandPool(device, &pool_info, nullptr, &presenter->cmd_pool));
+                !GN_VULKAN_FAILED(fn.vkCreateFence(device, &fence_info, nullptr, &presenter->submit_fence));
 
             if (!success) {
                 failed = true;
                 break;
             }
-
-            cmd_buf_alloc_info.commandPool = presenter->cmd_pool;
-
-            if (GN_VULKAN_FAILED(fn.vkAllocateCommandBuffers(device, &cmd_buf_alloc_info, &presenter->cmd_buffer))) {
-                failed = true;
-                break;
-            }
         }
     }
 
     GnSmallVector<GnSwapchainBlitImageVK, 16> new_blit_images;
     int32_t memtype_index = -1;
 
-    if (!failed && config_changed) {
+    // Direct present renders into the presentable images, no intermediate images needed.
+    if (!failed && config_changed && !direct_present) {
         VkImageCreateInfo image_info;
         image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
         image_info.pNext = nullptr;
@@ -4233,13 +7106,15 @@ GnResult GnSwapchainVK::Update(GnFormat format, uint32_t width, uint32_t height,
             blit_image->desc.samples = GnSampleCount_X1;
             blit_image->desc.tiling = GnTiling_Optimal;
             blit_image->swapchain_owned = true;
+            blit_image->direct_present = false;
+            blit_image->tracked_access = GnResourceAccess_Undefined;
+            blit_image->tracked_subresource_access = nullptr;
         }
     }
 
     if (failed) {
-        if (new_frame_presenters.size > 0)
-            for (uint32_t i = 0; i < num_buffers; i++)
-                new_frame_presenters[i].Destroy(impl_device);
+        for (uint32_t i = 0; i < new_frame_presenters.size; i++)
+            new_frame_presenters[i].Destroy(impl_device);
 
         if (new_blit_images.size > 0)
             for (uint32_t i = 0; i < num_buffers; i++)
@@ -4248,13 +7123,15 @@ GnResult GnSwapchainVK::Update(GnFormat format, uint32_t width, uint32_t height,
         return GnError_InternalError;
     }
 
-    if (num_buffers_changed) {
-        // TODO: Use delayed destroy
-        if (frame_presenters.size > 0)
-            for (uint32_t i = 0; i < swapchain_desc.num_buffers; i++)
-                frame_presenters[i].Destroy(impl_device);
+    if (frames_in_flight_changed) {
+        // The semaphores of the old presenters may still be in use.
+        for (uint32_t i = 0; i < frame_presenters.size; i++) {
+            fn.vkWaitForFences(device, 1, &frame_presenters[i].submit_fence, VK_FALSE, UINT64_MAX);
+            frame_presenters[i].Destroy(impl_device);
+        }
 
         frame_presenters = std::move(new_frame_presenters);
+        current_present_slot = 0;
     }
 
     if (config_changed) {
@@ -4264,6 +7141,7 @@ GnResult GnSwapchainVK::Update(GnFormat format, uint32_t width, uint32_t height,
                 blit_images[i].Destroy(impl_device);
 
         blit_images = std::move(new_blit_images);
+        blit_cmd_buffers_dirty = true;
     }
 
     blit_param.srcOffsets[0] = {};
@@ -4273,7 +7151,7 @@ GnResult GnSwapchainVK::Update(GnFormat format, uint32_t width, uint32_t height,
     swapchain_desc.height = height;
     swapchain_desc.num_buffers = num_buffers;
     swapchain_desc.vsync = vsync;
-    should_update = num_buffers_changed || format_changed || vsync_changed;
+    should_update = num_buffers_changed || format_changed || vsync_changed || (direct_present && size_changed);
 
     return GnSuccess;
 }
@@ -4285,51 +7163,158 @@ GnResult GnSwapchainVK::Init(const GnSwapchainDesc* desc, VkSwapchainKHR old_swa
     GnAdapterVK* impl_adapter = GN_TO_VULKAN(GnAdapter, impl_device->parent_adapter);
     VkDevice device = impl_device->device;
     bool format_changed = desc->format != swapchain_desc.format && desc->format != GnFormat_Unknown;
+    GnFormat used_format = format_changed ? desc->format : swapchain_desc.format;
 
     VkSurfaceCapabilitiesKHR surf_caps;
     impl_surface->parent_instance->fn.vkGetPhysicalDeviceSurfaceCapabilitiesKHR(impl_adapter->physical_device, impl_surface->surface, &surf_caps);
 
+    // Some surfaces (e.g. headless) let the swapchain decide the extent.
+    if (surf_caps.currentExtent.width == UINT32_MAX) {
+        surf_caps.currentExtent.width = GnMin(GnMax(desc->width, surf_caps.minImageExtent.width), surf_caps.maxImageExtent.width);
+        surf_caps.currentExtent.height = GnMin(GnMax(desc->height, surf_caps.minImageExtent.height), surf_caps.maxImageExtent.height);
+    }
+
     VkSwapchainCreateInfoKHR swapchain_info;
     swapchain_info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
     swapchain_info.pNext = nullptr;
     swapchain_info.flags = 0;
     swapchain_info.surface = impl_surface->surface;
     swapchain_info.minImageCount = desc->num_buffers;
-    swapchain_info.imageFormat = GnConvertToVkFormat(format_changed ? desc->format : swapchain_desc.format);
+    swapchain_info.imageFormat = GnConvertToVkFormat(used_format);
     swapchain_info.imageColorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
     swapchain_info.imageExtent = surf_caps.currentExtent;
     swapchain_info.imageArrayLayers = 1;
     swapchain_info.imageUsage = VK_IMAGE_USAGE_TRANSFER_DST_BIT; // 99.1% drivers & hardware supports this flag. No need to validate :)
+
+    if (desc->direct_present)
+        swapchain_info.imageUsage = GnConvertToVkImageUsageFlags(desc->usage);
     swapchain_info.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
     swapchain_info.queueFamilyIndexCount = 0;
     swapchain_info.pQueueFamilyIndices = nullptr;
     swapchain_info.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
     swapchain_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-    swapchain_info.presentMode = desc->vsync ? VK_PRESENT_MODE_FIFO_KHR : VK_PRESENT_MODE_IMMEDIATE_KHR;
+    swapchain_info.presentMode = VK_PRESENT_MODE_FIFO_KHR; // Always supported
     swapchain_info.clipped = VK_TRUE;
     swapchain_info.oldSwapchain = old_swapchain;
 
+    VkPresentModeKHR requested_present_mode = VK_PRESENT_MODE_FIFO_KHR;
+
+    switch (desc->present_mode) {
+        case GnPresentMode_Auto:
+            requested_present_mode = desc->vsync ? VK_PRESENT_MODE_FIFO_KHR : VK_PRESENT_MODE_IMMEDIATE_KHR;
+            break;
+        case GnPresentMode_Mailbox:
+            requested_present_mode = VK_PRESENT_MODE_MAILBOX_KHR;
+            break;
+        case GnPresentMode_Immediate:
+            requested_present_mode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+            break;
+        default:
+            break;
+    }
+
+    if (requested_present_mode != VK_PRESENT_MODE_FIFO_KHR) {
+        VkPresentModeKHR present_modes[8];
+        uint32_t num_present_modes = GN_ARRAY_SIZE(present_modes);
+
+        impl_surface->parent_instance->fn.vkGetPhysicalDeviceSurfacePresentModesKHR(impl_adapter->physical_device, impl_surface->surface, &num_present_modes, present_modes);
+
+        for (uint32_t i = 0; i < num_present_modes; i++) {
+            if (present_modes[i] == requested_present_mode) {
+                swapchain_info.presentMode = requested_present_mode;
+                break;
+            }
+        }
+    }
+
     VkSwapchainKHR new_swapchain = VK_NULL_HANDLE;
     if (GN_VULKAN_FAILED(fn.vkCreateSwapchainKHR(device, &swapchain_info, nullptr, &new_swapchain)))
         return GnError_InternalError;
 
     GnSmallVector<VkImage, 16> new_swapchain_images;
-    uint32_t num_images = desc->num_buffers;
+    uint32_t num_images = 0;
 
-    if (!(new_swapchain_images.resize(desc->num_buffers) &&
+    // The implementation may create more images than minImageCount.
+    if (!(!GN_VULKAN_FAILED(fn.vkGetSwapchainImagesKHR(device, new_swapchain, &num_images, nullptr)) &&
+          new_swapchain_images.resize(num_images) &&
           !GN_VULKAN_FAILED(fn.vkGetSwapchainImagesKHR(device, new_swapchain, &num_images, new_swapchain_images.storage))))
     {
         fn.vkDestroySwapchainKHR(device, new_swapchain, nullptr);
         return GnError_InternalError;
     }
 
+    // Back buffer wrappers live in fixed storage.
+    if (desc->direct_present && num_images > GN_MAX_SWAPCHAIN_BUFFERS) {
+        fn.vkDestroySwapchainKHR(device, new_swapchain, nullptr);
+        return GnError_InternalError;
+    }
+
+    if (desc->direct_present) {
+        VkSemaphoreCreateInfo semaphore_info;
+        semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphore_info.pNext = nullptr;
+        semaphore_info.flags = 0;
+
+        // Semaphores from the previous swapchain are reused, only create the missing ones.
+        for (uint32_t i = (uint32_t)render_finished_semaphores.size; i < num_images; i++) {
+            VkSemaphore semaphore;
+
+            if (GN_VULKAN_FAILED(fn.vkCreateSemaphore(device, &semaphore_info, nullptr, &semaphore))) {
+                fn.vkDestroySwapchainKHR(device, new_swapchain, nullptr);
+                return GnError_InternalError;
+            }
+
+            if (!render_finished_semaphores.push_back(semaphore)) {
+                fn.vkDestroySemaphore(device, semaphore, nullptr);
+                fn.vkDestroySwapchainKHR(device, new_swapchain, nullptr);
+                return GnError_OutOfHostMemory;
+            }
+        }
+    }
+
     if (old_swapchain && swapchain)
         impl_device->fn.vkDestroySwapchainKHR(impl_device->device, swapchain, nullptr);
 
     swapchain_desc.surface = desc->surface;
     swapchain_desc.usage = desc->usage;
+    swapchain_desc.direct_present = desc->direct_present;
+    swapchain_desc.present_queue = desc->present_queue;
+    swapchain_desc.present_mode = desc->present_mode;
+    swapchain_desc.max_frames_in_flight = desc->max_frames_in_flight;
+    direct_present = (bool)desc->direct_present;
+    present_queue = GN_TO_VULKAN(GnQueue, desc->present_queue);
     swapchain_images = std::move(new_swapchain_images);
+
+    if (direct_present) {
+        // Wrappers are updated in place so back buffer handles stay valid across recreation.
+        for (uint32_t i = 0; i < num_images; i++) {
+            GnSwapchainBackBufferVK* back_buffer = &back_buffers[i];
+            back_buffer->image = swapchain_images[i];
+            back_buffer->desc.usage = desc->usage;
+            back_buffer->desc.type = GnTextureType_2D;
+            back_buffer->desc.format = used_format;
+            back_buffer->desc.width = surf_caps.currentExtent.width;
+            back_buffer->desc.height = surf_caps.currentExtent.height;
+            back_buffer->desc.depth = 1;
+            back_buffer->desc.mip_levels = 1;
+            back_buffer->desc.array_layers = 1;
+            back_buffer->desc.samples = GnSampleCount_X1;
+            back_buffer->desc.tiling = GnTiling_Optimal;
+            back_buffer->swapchain_owned = true;
+            back_buffer->direct_present = true;
+            back_buffer->tracked_access = GnResourceAccess_Undefined;
+
+            if (back_buffer->tracked_subresource_access != nullptr) {
+                GnFree(back_buffer->tracked_subresource_access);
+                back_buffer->tracked_subresource_access = nullptr;
+            }
+        }
+
+        num_back_buffers = num_images;
+    }
+
     swapchain = new_swapchain;
+    blit_cmd_buffers_dirty = true;
     blit_param.dstOffsets[0] = {};
     blit_param.dstOffsets[1] = { (int32_t)surf_caps.currentExtent.width, (int32_t)surf_caps.currentExtent.height, 1 };
 
@@ -4338,7 +7323,7 @@ GnResult GnSwapchainVK::Init(const GnSwapchainDesc* desc, VkSwapchainKHR old_swa
 
 std::pair<VkResult, VkImage> GnSwapchainVK::AcquireNextImage() noexcept
 {
-    GnSwapchainFramePresenterVK& presenter = frame_presenters[current_frame];
+    GnSwapchainFramePresenterVK& presenter = frame_presenters[current_present_slot];
     VkResult result = impl_device->fn.vkAcquireNextImageKHR(impl_device->device, swapchain, UINT64_MAX,
                                                             presenter.acquire_image_semaphore,
                                                             VK_NULL_HANDLE,
@@ -4347,34 +7332,262 @@ std::pair<VkResult, VkImage> GnSwapchainVK::AcquireNextImage() noexcept
     return { result, swapchain_images[current_acquired_image] };
 }
 
+GnResult GnSwapchainVK::RecordBlitCommandBuffers() noexcept
+{
+    const GnVulkanDeviceFunctions& fn = impl_device->fn;
+    VkDevice device = impl_device->device;
+    uint32_t num_swapchain_images = (uint32_t)swapchain_images.size;
+    uint32_t num_cmd_buffers = (uint32_t)blit_images.size * num_swapchain_images;
+
+    // Previously recorded command buffers may still be pending.
+    for (uint32_t i = 0; i < frame_presenters.size; i++)
+        fn.vkWaitForFences(device, 1, &frame_presenters[i].submit_fence, VK_FALSE, UINT64_MAX);
+
+    if (blit_cmd_pool == VK_NULL_HANDLE) {
+        VkCommandPoolCreateInfo pool_info{};
+        pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        pool_info.queueFamilyIndex = 0;
+
+        if (GN_VULKAN_FAILED(fn.vkCreateCommandPool(device, &pool_info, nullptr, &blit_cmd_pool)))
+            return GnError_InternalError;
+    }
+    else
+        fn.vkResetCommandPool(device, blit_cmd_pool, 0);
+
+    if (blit_cmd_buffers.size() != num_cmd_buffers) {
+        if (blit_cmd_buffers.size() > 0)
+            fn.vkFreeCommandBuffers(device, blit_cmd_pool, (uint32_t)blit_cmd_buffers.size(), blit_cmd_buffers.data());
+
+        blit_cmd_buffers.resize(0);
+
+        if (!blit_cmd_buffers.resize(num_cmd_buffers))
+            return GnError_OutOfHostMemory;
+
+        VkCommandBufferAllocateInfo cmd_buf_alloc_info{};
+        cmd_buf_alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        cmd_buf_alloc_info.commandPool = blit_cmd_pool;
+        cmd_buf_alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        cmd_buf_alloc_info.commandBufferCount = num_cmd_buffers;
+
+        if (GN_VULKAN_FAILED(fn.vkAllocateCommandBuffers(device, &cmd_buf_alloc_info, blit_cmd_buffers.data()))) {
+            blit_cmd_buffers.resize(0);
+            return GnError_InternalError;
+        }
+    }
+
+    // Recorded once and resubmitted every frame, so no one-time-submit flag.
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+    VkImageMemoryBarrier barrier;
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.pNext = nullptr;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    for (uint32_t i = 0; i < blit_images.size; i++) {
+        for (uint32_t j = 0; j < num_swapchain_images; j++) {
+            VkCommandBuffer cmd_buffer = GetBlitCommandBuffer(i, j);
+
+            if (GN_VULKAN_FAILED(fn.vkBeginCommandBuffer(cmd_buffer, &begin_info)))
+                return GnError_InternalError;
+
+            barrier.image = swapchain_images[j];
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+
+            fn.vkCmdPipelineBarrier(cmd_buffer,
+                                    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                    VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                    0, 0, nullptr, 0, nullptr,
+                                    1, &barrier);
+
+            fn.vkCmdBlitImage(cmd_buffer,
+                              blit_images[i].image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                              swapchain_images[j], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              1, &blit_param, VK_FILTER_LINEAR);
+
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = 0;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+            fn.vkCmdPipelineBarrier(cmd_buffer,
+                                    VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                    VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                    0, 0, nullptr, 0, nullptr,
+                                    1, &barrier);
+
+            if (GN_VULKAN_FAILED(fn.vkEndCommandBuffer(cmd_buffer)))
+                return GnError_InternalError;
+        }
+    }
+
+    blit_cmd_buffers_dirty = false;
+
+    return GnSuccess;
+}
+
+VkCommandBuffer GnSwapchainVK::GetBlitCommandBuffer(uint32_t blit_image_index, uint32_t swapchain_image_index) const noexcept
+{
+    return blit_cmd_buffers[blit_image_index * swapchain_images.size + swapchain_image_index];
+}
+
+GnResult GnSwapchainVK::WaitForPresentSlot(uint64_t timeout) noexcept
+{
+    // A slot is free once the last present submission that used it has completed.
+    const GnSwapchainFramePresenterVK& presenter = frame_presenters[current_present_slot];
+    return GnConvertFromVkResult(impl_device->fn.vkWaitForFences(impl_device->device, 1, &presenter.submit_fence, VK_FALSE, timeout));
+}
+
+uint32_t GnSwapchainVK::GetNumFramesInFlight(uint32_t num_buffers) const noexcept
+{
+    uint32_t max_frames_in_flight = swapchain_desc.max_frames_in_flight;
+
+    if (max_frames_in_flight == 0 || max_frames_in_flight > num_buffers)
+        return num_buffers;
+
+    return max_frames_in_flight;
+}
+
+GnResult GnSwapchainVK::Recreate() noexcept
+{
+    // The old images may still be in use by the present queue.
+    impl_device->fn.vkQueueWaitIdle(present_queue->queue);
+    should_update = false;
+
+    return Init(&swapchain_desc, swapchain);
+}
+
+GnResult GnSwapchainVK::PresentDirect(GnQueueVK* queue) noexcept
+{
+    if (queue != present_queue || !image_acquired)
+        return GnError_InvalidArgs;
+
+    const GnVulkanDeviceFunctions& fn = impl_device->fn;
+    const GnSwapchainFramePresenterVK& presenter = frame_presenters[current_present_slot];
+    VkSemaphore render_finished_semaphore = render_finished_semaphores[current_acquired_image];
+    GnResult result = queue->EnqueueSignalSemaphoreVK(render_finished_semaphore, 0);
+
+    if (GN_FAILED(result))
+        return result;
+
+    if (!queue->GroupSubmissionPacket())
+        return GnError_OutOfHostMemory;
+
+    // All pending work goes out in one submission. The fence guards reuse of this frame's acquire semaphore.
+    if (GN_FAILED(result = queue->SubmitPackets(presenter.submit_fence, false, true)))
+        return result;
+
+    VkPresentInfoKHR present_info;
+    present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    present_info.pNext = nullptr;
+    present_info.waitSemaphoreCount = 1;
+    present_info.pWaitSemaphores = &render_finished_semaphore;
+    present_info.swapchainCount = 1;
+    present_info.pSwapchains = &swapchain;
+    present_info.pImageIndices = &current_acquired_image;
+    present_info.pResults = nullptr;
+
+    VkResult present_result = fn.vkQueuePresentKHR(queue->queue, &present_info);
+
+    image_acquired = false;
+    current_frame = (current_frame + 1) % swapchain_desc.num_buffers;
+    current_present_slot = (current_present_slot + 1) % (uint32_t)frame_presenters.size;
+
+    // Recreated on the next acquire.
+    if (present_result == VK_ERROR_OUT_OF_DATE_KHR || present_result == VK_SUBOPTIMAL_KHR)
+        should_update = true;
+    else if (present_result != VK_SUCCESS)
+        return GnError_InternalError;
+
+    return GnSuccess;
+}
+
 void GnSwapchainVK::Destroy(GnDeviceVK* impl_device) noexcept
 {
     GN_ASSERT(this->impl_device == impl_device);
 
-    if (frame_presenters.size > 0)
-        for (uint32_t i = 0; i < swapchain_desc.num_buffers; i++)
-            frame_presenters[i].Destroy(impl_device);
+    for (uint32_t i = 0; i < frame_presenters.size; i++)
+        frame_presenters[i].Destroy(impl_device);
 
     if (blit_images.size > 0)
         for (uint32_t i = 0; i < swapchain_desc.num_buffers; i++)
             blit_images[i].Destroy(impl_device);
 
+    for (uint32_t i = 0; i < render_finished_semaphores.size; i++)
+        impl_device->fn.vkDestroySemaphore(impl_device->device, render_finished_semaphores[i], nullptr);
+
+    for (uint32_t i = 0; i < num_back_buffers; i++)
+        if (back_buffers[i].tracked_subresource_access != nullptr)
+            GnFree(back_buffers[i].tracked_subresource_access);
+
+    if (blit_cmd_pool)
+        impl_device->fn.vkDestroyCommandPool(impl_device->device, blit_cmd_pool, nullptr);
+
     if (swapchain)
         impl_device->fn.vkDestroySwapchainKHR(impl_device->device, swapchain, nullptr);
 }
 
 // -- [GnFenceVK] --
 
+GnResult GnFenceVK::GetStatus() noexcept
+{
+    if (timeline) {
+        uint64_t value = 0;
+        GnResult result = GetValue(&value);
+
+        if (GN_FAILED(result))
+            return result;
+
+        return value >= last_signal_value ? GnSuccess : GnNotReady;
+    }
+
+    return GnConvertFromVkResult(parent_device->fn.vkGetFenceStatus(parent_device->device, fence));
+}
+
 GnResult GnFenceVK::Wait(uint64_t timeout) noexcept
 {
+    if (timeline)
+        return WaitValue(last_signal_value, timeout);
+
     return GnConvertFromVkResult(parent_device->fn.vkWaitForFences(parent_device->device, 1, &fence, VK_FALSE, timeout));
 }
 
 GnResult GnFenceVK::Reset() noexcept
 {
+    // Timeline fences only move forward, there is nothing to reset.
+    if (timeline)
+        return GnSuccess;
+
     return GnConvertFromVkResult(parent_device->fn.vkResetFences(parent_device->device, 1, &fence));
 }
 
+GnResult GnFenceVK::GetValue(uint64_t* value) noexcept
+{
+    return GnConvertFromVkResult(parent_device->fn.vkGetSemaphoreCounterValueKHR(parent_device->device, timeline_semaphore, value));
+}
+
+GnResult GnFenceVK::WaitValue(uint64_t value, uint64_t timeout) noexcept
+{
+    VkSemaphoreWaitInfoKHR wait_info;
+    wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+    wait_info.pNext = nullptr;
+    wait_info.flags = 0;
+    wait_info.semaphoreCount = 1;
+    wait_info.pSemaphores = &timeline_semaphore;
+    wait_info.pValues = &value;
+
+    return GnConvertFromVkResult(parent_device->fn.vkWaitSemaphoresKHR(parent_device->device, &wait_info, timeout));
+}
+
 // -- [GnDescriptorStreamVK] --
 
 GnDescriptorStreamVK::GnDescriptorStreamVK(GnDeviceVK* impl_device) :
@@ -4508,6 +7721,7 @@ GnCommandPoolVK::GnCommandPoolVK(GnDeviceVK* impl_device, uint32_t max_command_l
     parent_device(impl_device),
     cmd_pool(cmd_pool),
     level(level),
+    max_command_lists(max_command_lists),
     descriptor_stream(impl_device)
 {
 }
@@ -4541,6 +7755,7 @@ GN_SAFEBUFFERS void GnFlushResourceBindingVK(GnCommandListVK*       impl_cmd_lis
         }
 
         impl_cmd_list->cmd_bind_descriptor_sets(cmd_buf, bind_point, vk_pipeline_layout, first_rtable_index, num_rtable_updates, descriptor_sets.storage, 0, nullptr);
+        pipeline_state.descriptor_tables_upd_range.Flush();
     }
 
     // ---- Bind global resource ----
@@ -4566,37 +7781,60 @@ GN_SAFEBUFFERS void GnFlushResourceBindingVK(GnCommandListVK*       impl_cmd_lis
                 return;
             }
 
-            uint32_t num_write_descriptors = 0;
-            for (uint32_t i = 0; i < 32 && num_global_descriptors != 0; i++) {
-                const uint32_t write_mask = 1 << i;
+            // Once every binding has a buffer, the whole set can be written in one go with the layout's template
+            const bool write_with_template = pipeline_layout->global_resource_template != VK_NULL_HANDLE &&
+                (global_descriptor_write_mask & global_resource_binding_mask) == global_resource_binding_mask;
 
-                if (!GnContainsBit(global_descriptor_write_mask, write_mask))
-                    continue;
+            if (write_with_template) {
+                uint32_t num_buffer_descriptors = 0;
+
+                for (uint32_t i = 0; i < 32 && num_buffer_descriptors != num_global_descriptors; i++) {
+                    if (!GnContainsBit(global_resource_binding_mask, 1u << i))
+                        continue;
+
+                    auto& buffer_descriptor = buffer_descriptors[num_buffer_descriptors++];
+                    buffer_descriptor.buffer = GN_TO_VULKAN(GnBuffer, pipeline_state.global_buffers[i])->buffer;
+                    buffer_descriptor.offset = 0;
+                    buffer_descriptor.range = VK_WHOLE_SIZE;
+                }
 
-                auto& buffer_descriptor = buffer_descriptors[num_write_descriptors];
-                buffer_descriptor.buffer = GN_TO_VULKAN(GnBuffer, pipeline_state.global_buffers[i])->buffer;
-                buffer_descriptor.offset = 0;
-                buffer_descriptor.range = VK_WHOLE_SIZE;
-
-                auto& write_descriptor = write_descriptors[num_write_descriptors];
-                write_descriptor.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-                write_descriptor.pNext = nullptr;
-                write_descriptor.dstSet = descriptor_set;
-                write_descriptor.dstBinding = i;
-                write_descriptor.dstArrayElement = 0;
-                write_descriptor.descriptorCount = 1;
-                write_descriptor.pImageInfo = nullptr;
-                write_descriptor.pBufferInfo = &buffer_descriptor;
-                write_descriptor.pTexelBufferView = nullptr;
-                write_descriptor.descriptorType = GnContainsBit(pipeline_state.global_buffers_type_bits, write_mask) ?
-                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC :
-                    VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-
-                num_global_descriptors--;
-                num_write_descriptors++;
+                impl_cmd_list->fn.vkUpdateDescriptorSetWithTemplateKHR(impl_cmd_pool->parent_device->device, descriptor_set,
+                                                                       pipeline_layout->global_resource_template, buffer_descriptors);
+            }
+            else {
+                uint32_t num_write_descriptors = 0;
+                for (uint32_t i = 0; i < 32 && num_global_descriptors != 0; i++) {
+                    const uint32_t write_mask = 1 << i;
+
+                    if (!GnContainsBit(global_descriptor_write_mask, write_mask))
+                        continue;
+
+                    auto& buffer_descriptor = buffer_descriptors[num_write_descriptors];
+                    buffer_descriptor.buffer = GN_TO_VULKAN(GnBuffer, pipeline_state.global_buffers[i])->buffer;
+                    buffer_descriptor.offset = 0;
+                    buffer_descriptor.range = VK_WHOLE_SIZE;
+
+                    auto& write_descriptor = write_descriptors[num_write_descriptors];
+                    write_descriptor.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                    write_descriptor.pNext = nullptr;
+                    write_descriptor.dstSet = descriptor_set;
+                    write_descriptor.dstBinding = i;
+                    write_descriptor.dstArrayElement = 0;
+                    write_descriptor.descriptorCount = 1;
+                    write_descriptor.pImageInfo = nullptr;
+                    write_descriptor.pBufferInfo = &buffer_descriptor;
+                    write_descriptor.pTexelBufferView = nullptr;
+                    write_descriptor.descriptorType = GnContainsBit(pipeline_state.global_buffers_type_bits, write_mask) ?
+                        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC :
+                        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+
+                    num_global_descriptors--;
+                    num_write_descriptors++;
+                }
+
+                impl_cmd_list->fn.vkUpdateDescriptorSets(impl_cmd_pool->parent_device->device, num_write_descriptors, write_descriptors, 0, nullptr);
             }
 
-            impl_cmd_list->fn.vkUpdateDescriptorSets(impl_cmd_pool->parent_device->device, num_write_descriptors, write_descriptors, 0, nullptr);
             global_descriptor_set = descriptor_set;
         }
 
@@ -4611,16 +7849,42 @@ GN_SAFEBUFFERS void GnFlushResourceBindingVK(GnCommandListVK*       impl_cmd_lis
     }
 }
 
+inline static void GnBindBindlessHeapVK(GnCommandListVK*      impl_cmd_list,
+                                        VkCommandBuffer       cmd_buf,
+                                        GnPipelineLayout      pipeline_layout,
+                                        VkPipelineBindPoint   bind_point) noexcept
+{
+    if (pipeline_layout == nullptr)
+        return;
+
+    GnPipelineLayoutVK* impl_pipeline_layout = GN_TO_VULKAN(GnPipelineLayout, pipeline_layout);
+
+    if (impl_pipeline_layout->bindless_set_index == GN_INVALID)
+        return;
+
+    impl_cmd_list->cmd_bind_descriptor_sets(cmd_buf, bind_point, impl_pipeline_layout->pipeline_layout,
+                                            impl_pipeline_layout->bindless_set_index, 1,
+                                            &impl_cmd_list->parent_cmd_pool->parent_device->bindless_heap.descriptor_set,
+                                            0, nullptr);
+}
+
 GN_SAFEBUFFERS void GnFlushGraphicsStateVK(GnCommandList command_list) noexcept
 {
     GnCommandListVK* impl_cmd_list = GN_TO_VULKAN(GnCommandList, command_list);
     VkCommandBuffer cmd_buf = (VkCommandBuffer)impl_cmd_list->cmd_private_data;
     GnCommandListState& state = impl_cmd_list->state;
 
+    if (state.update_flags.pending_barriers)
+        impl_cmd_list->FlushBarriers();
+
     // Update graphics pipeline
     if (state.update_flags.graphics_pipeline)
         impl_cmd_list->cmd_bind_pipeline(cmd_buf, VK_PIPELINE_BIND_POINT_GRAPHICS, GN_TO_VULKAN(GnPipeline, state.graphics.pipeline)->pipeline);
 
+    // Bind the bindless heap, it stays valid until another layout disturbs its set
+    if (state.update_flags.graphics_pipeline_layout)
+        GnBindBindlessHeapVK(impl_cmd_list, cmd_buf, state.graphics.pipeline_layout, VK_PIPELINE_BIND_POINT_GRAPHICS);
+
     // Update graphics resource binding
     if (state.update_flags.graphics_resource_binding)
         GnFlushResourceBindingVK(impl_cmd_list, cmd_buf,
@@ -4715,9 +7979,15 @@ GN_SAFEBUFFERS void GnFlushComputeStateVK(GnCommandList command_list) noexcept
     VkCommandBuffer cmd_buf = (VkCommandBuffer)impl_cmd_list->cmd_private_data;
     GnCommandListState& state = impl_cmd_list->state;
 
+    if (state.update_flags.pending_barriers)
+        impl_cmd_list->FlushBarriers();
+
     if (state.update_flags.compute_pipeline)
         impl_cmd_list->cmd_bind_pipeline(cmd_buf, VK_PIPELINE_BIND_POINT_COMPUTE, GN_TO_VULKAN(GnPipeline, state.compute.pipeline)->pipeline);
 
+    if (state.update_flags.compute_pipeline_layout)
+        GnBindBindlessHeapVK(impl_cmd_list, cmd_buf, state.compute.pipeline_layout, VK_PIPELINE_BIND_POINT_COMPUTE);
+
     if (state.update_flags.compute_resource_binding)
         GnFlushResourceBindingVK(impl_cmd_list, cmd_buf,
                                  impl_cmd_list->compute_descriptor_write_mask,
@@ -4754,6 +8024,7 @@ GnCommandListVK::GnCommandListVK(GnCommandPoolVK* parent_cmd_pool) noexcept :
     cmd_set_scissor = fn.vkCmdSetScissor;
     cmd_set_stencil_reference = fn.vkCmdSetStencilReference;
     cmd_set_blend_constants = fn.vkCmdSetBlendConstants;
+    use_synchronization2 = parent_cmd_pool->parent_device->ver_info.HasSynchronization2();
 
     // Called in draw/dispatch calls.
     flush_gfx_state_fn = &GnFlushGraphicsStateVK;
@@ -4770,6 +8041,12 @@ GnCommandListVK::~GnCommandListVK()
 GnResult GnCommandListVK::Begin(const GnCommandListBeginDesc* desc) noexcept
 {
     state = {}; // Clear state
+    pending_buffer_barriers.resize(0);
+    pending_image_barriers.resize(0);
+    pending_buffer_barriers2.resize(0);
+    pending_image_barriers2.resize(0);
+    pending_src_stages = 0;
+    pending_dst_stages = 0;
 
     VkCommandBufferBeginInfo begin_info;
     begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -4794,7 +8071,11 @@ void GnCommandListVK::BeginRenderPass(const GnRenderPassBeginDesc* desc) noexcep
     */
     auto& render_pass_cache = parent_cmd_pool->parent_device->render_pass_cache;
     GnRenderPassCacheKey rp_cache_key{};
-    rp_cache_key.Init(desc);
+
+    if (!rp_cache_key.Init(desc)) {
+        last_error = GnError_InvalidArgs;
+        return;
+    }
 
     auto render_pass = render_pass_cache.Get(rp_cache_key);
     if (!render_pass) {
@@ -4807,13 +8088,21 @@ void GnCommandListVK::BeginRenderPass(const GnRenderPassBeginDesc* desc) noexcep
             return;
         }
 
-        render_pass_cache.Insert(rp_cache_key, new_render_pass);
-        render_pass.emplace(new_render_pass);
+        render_pass = render_pass_cache.Insert(rp_cache_key, new_render_pass);
+
+        if (!render_pass) {
+            fn.vkDestroyRenderPass(parent_cmd_pool->parent_device->device, new_render_pass, nullptr);
+            last_error = GnError_OutOfHostMemory;
+            return;
+        }
+
+        if (*render_pass != new_render_pass)
+            fn.vkDestroyRenderPass(parent_cmd_pool->parent_device->device, new_render_pass, nullptr);
     }
 
     auto& framebuffer_cache = parent_cmd_pool->parent_device->framebuffer_cache;
     GnFramebufferCacheKey fb_cache_key{};
-    fb_cache_key.Init(desc);
+    fb_cache_key.Init(desc, *render_pass);
     
     auto framebuffer = framebuffer_cache.Get(fb_cache_key);
     if (!framebuffer) {
@@ -4841,15 +8130,24 @@ void GnCommandListVK::BeginRenderPass(const GnRenderPassBeginDesc* desc) noexcep
             return;
         }
 
-        framebuffer_cache.Insert(fb_cache_key, new_framebuffer);
-        framebuffer.emplace(new_framebuffer);
+        framebuffer = framebuffer_cache.Insert(fb_cache_key, new_framebuffer);
+
+        if (!framebuffer) {
+            fn.vkDestroyFramebuffer(parent_cmd_pool->parent_device->device, new_framebuffer, nullptr);
+            last_error = GnError_OutOfHostMemory;
+            return;
+        }
+
+        if (*framebuffer != new_framebuffer)
+            fn.vkDestroyFramebuffer(parent_cmd_pool->parent_device->device, new_framebuffer, nullptr);
     }
 
     VkClearValue clear_values[GN_MAX_COLOR_TARGETS + 1];
     uint32_t num_render_targets = 0;
 
     for (uint32_t i = 0; i < desc->num_color_targets; i++)
-        std::memcpy(&clear_values[num_render_targets++].color, &desc->color_targets[i].clear_value, sizeof(GnColorValue));
+        if (desc->color_targets[i].view)
+            std::memcpy(&clear_values[num_render_targets++].color, &desc->color_targets[i].clear_value, sizeof(GnColorValue));
 
     if (desc->depth_stencil_target && desc->depth_stencil_target->view) {
         clear_values[num_render_targets].depthStencil.depth = desc->depth_stencil_target->clear_value.depth;
@@ -4866,9 +8164,17 @@ void GnCommandListVK::BeginRenderPass(const GnRenderPassBeginDesc* desc) noexcep
     rp_begin_info.clearValueCount = num_render_targets; // TODO
     rp_begin_info.pClearValues = clear_values;
 
+    if (state.update_flags.pending_barriers)
+        FlushBarriers();
+
     fn.vkCmdBeginRenderPass(static_cast<VkCommandBuffer>(cmd_private_data), &rp_begin_info, VK_SUBPASS_CONTENTS_INLINE);
 }
 
+void GnCommandListVK::NextSubpass() noexcept
+{
+    fn.vkCmdNextSubpass(static_cast<VkCommandBuffer>(cmd_private_data), VK_SUBPASS_CONTENTS_INLINE);
+}
+
 void GnCommandListVK::EndRenderPass() noexcept
 {
     fn.vkCmdEndRenderPass(static_cast<VkCommandBuffer>(cmd_private_data));
@@ -4879,79 +8185,85 @@ void GnCommandListVK::Barrier(uint32_t                  num_buffer_barriers,
                               uint32_t                  num_texture_barriers,
                               const GnTextureBarrier*   texture_barriers) noexcept
 {
-    VkPipelineStageFlags src_pipeline = 0;
-    VkPipelineStageFlags dst_pipeline = 0;
-    auto& pending_buffer_barriers = parent_cmd_pool->pending_buffer_barriers;
-    auto& pending_image_barriers = parent_cmd_pool->pending_image_barriers;
+    auto flush = [this]() { FlushBarriers(); };
+    bool success;
 
-    if (num_buffer_barriers > 0) {
-        if (!pending_buffer_barriers.resize(num_buffer_barriers)) {
-            last_error = GnError_OutOfHostMemory;
-            return;
-        }
+    if (use_synchronization2) {
+        success = GnAppendBufferBarriersVK<true>(pending_buffer_barriers2, pending_src_stages, pending_dst_stages,
+                                                 num_buffer_barriers, buffer_barriers, flush) &&
+                  GnAppendImageBarriersVK<true>(pending_image_barriers2, pending_src_stages, pending_dst_stages,
+                                                num_texture_barriers, texture_barriers, flush);
+    }
+    else {
+        // The legacy path only has one stage mask pair for the whole batch.
+        success = GnAppendBufferBarriersVK<false>(pending_buffer_barriers, pending_src_stages, pending_dst_stages,
+                                                  num_buffer_barriers, buffer_barriers, flush) &&
+                  GnAppendImageBarriersVK<false>(pending_image_barriers, pending_src_stages, pending_dst_stages,
+                                                 num_texture_barriers, texture_barriers, flush);
+    }
 
-        for (uint32_t i = 0; i < num_buffer_barriers; i++) {
-            const GnBufferBarrier& buffer_barrier = buffer_barriers[i];
-            VkBufferMemoryBarrier& vk_buffer_barrier = pending_buffer_barriers[i];
-            
-            vk_buffer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-            vk_buffer_barrier.pNext = nullptr;
-            vk_buffer_barrier.srcAccessMask = GnGetAccessVK(buffer_barrier.prev_access);
-            vk_buffer_barrier.dstAccessMask = GnGetAccessVK(buffer_barrier.next_access);
-            vk_buffer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            vk_buffer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            vk_buffer_barrier.buffer = GN_TO_VULKAN(GnBuffer, buffer_barrier.buffer)->buffer;
-            vk_buffer_barrier.offset = buffer_barrier.offset;
-            vk_buffer_barrier.size = buffer_barrier.size;
-
-            src_pipeline |= GnGetPipelineStageFromAccessVK<false>(buffer_barrier.prev_access);
-            dst_pipeline |= GnGetPipelineStageFromAccessVK<true>(buffer_barrier.next_access);
-        }
+    if (!success) {
+        last_error = GnError_OutOfHostMemory;
+        return;
     }
 
-    if (num_texture_barriers > 0) {
-        if (!pending_image_barriers.resize(num_texture_barriers)) {
-            last_error = GnError_OutOfHostMemory;
-            return;
-        }
+    state.update_flags.pending_barriers = true;
+
+    // Barriers inside a render pass cannot be moved past the next draw, emit them right away.
+    if (inside_render_pass)
+        FlushBarriers();
+}
 
-        for (uint32_t i = 0; i < num_texture_barriers; i++) {
-            const GnTextureBarrier& texture_barrier = texture_barriers[i];
-            VkImageMemoryBarrier& vk_image_barrier = pending_image_barriers[i];
+void GnCommandListVK::FlushBarriers() noexcept
+{
+    state.update_flags.pending_barriers = false;
 
-            vk_image_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-            vk_image_barrier.pNext = nullptr;
-            vk_image_barrier.srcAccessMask = GnGetAccessVK(texture_barrier.prev_access);
-            vk_image_barrier.dstAccessMask = GnGetAccessVK(texture_barrier.next_access);
-            vk_image_barrier.oldLayout = GnGetImageLayoutFromAccessVK(texture_barrier.prev_access);
-            vk_image_barrier.newLayout = GnGetImageLayoutFromAccessVK(texture_barrier.next_access);
-            vk_image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            vk_image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            vk_image_barrier.image = GN_TO_VULKAN(GnTexture, texture_barrier.texture)->image;
-            vk_image_barrier.subresourceRange.aspectMask = texture_barrier.subresource_range.aspect;
-            vk_image_barrier.subresourceRange.baseMipLevel = texture_barrier.subresource_range.base_mip_level;
-            vk_image_barrier.subresourceRange.levelCount = texture_barrier.subresource_range.num_mip_levels;
-            vk_image_barrier.subresourceRange.baseArrayLayer = texture_barrier.subresource_range.base_array_layer;
-            vk_image_barrier.subresourceRange.layerCount = texture_barrier.subresource_range.num_array_layers;
-
-            src_pipeline |= GnGetPipelineStageFromAccessVK<false>(texture_barrier.prev_access);
-            dst_pipeline |= GnGetPipelineStageFromAccessVK<true>(texture_barrier.next_access);
-        }
+    if (use_synchronization2) {
+        const uint32_t num_buffer_barriers = (uint32_t)pending_buffer_barriers2.size();
+        const uint32_t num_image_barriers = (uint32_t)pending_image_barriers2.size();
+
+        if (num_buffer_barriers == 0 && num_image_barriers == 0)
+            return;
+
+        VkDependencyInfoKHR dependency_info;
+        dependency_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
+        dependency_info.pNext = nullptr;
+        dependency_info.dependencyFlags = 0;
+        dependency_info.memoryBarrierCount = 0;
+        dependency_info.pMemoryBarriers = nullptr;
+        dependency_info.bufferMemoryBarrierCount = num_buffer_barriers;
+        dependency_info.pBufferMemoryBarriers = pending_buffer_barriers2.data();
+        dependency_info.imageMemoryBarrierCount = num_image_barriers;
+        dependency_info.pImageMemoryBarriers = pending_image_barriers2.data();
+
+        fn.vkCmdPipelineBarrier2KHR(static_cast<VkCommandBuffer>(cmd_private_data), &dependency_info);
+
+        pending_buffer_barriers2.resize(0);
+        pending_image_barriers2.resize(0);
+        return;
     }
 
-    if (src_pipeline == 0)
-        src_pipeline |= VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    const uint32_t num_buffer_barriers = (uint32_t)pending_buffer_barriers.size();
+    const uint32_t num_image_barriers = (uint32_t)pending_image_barriers.size();
 
-    if (dst_pipeline == 0)
-        dst_pipeline |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    if (num_buffer_barriers == 0 && num_image_barriers == 0)
+        return;
+
+    if (pending_src_stages == 0)
+        pending_src_stages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+
+    if (pending_dst_stages == 0)
+        pending_dst_stages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
 
     fn.vkCmdPipelineBarrier(static_cast<VkCommandBuffer>(cmd_private_data),
-                            src_pipeline, dst_pipeline, 0, 0, nullptr,
+                            pending_src_stages, pending_dst_stages, 0, 0, nullptr,
                             num_buffer_barriers, pending_buffer_barriers.data(),
-                            num_texture_barriers, pending_image_barriers.data());
+                            num_image_barriers, pending_image_barriers.data());
 
     pending_buffer_barriers.resize(0);
     pending_image_barriers.resize(0);
+    pending_src_stages = 0;
+    pending_dst_stages = 0;
 }
 
 void GnCommandListVK::CopyBuffer(GnBuffer src_buffer, GnDeviceSize src_offset, GnBuffer dst_buffer, GnDeviceSize dst_offset, GnDeviceSize size) noexcept
@@ -4961,6 +8273,9 @@ void GnCommandListVK::CopyBuffer(GnBuffer src_buffer, GnDeviceSize src_offset, G
     buffer_copy.dstOffset = dst_offset;
     buffer_copy.size = size;
 
+    if (state.update_flags.pending_barriers)
+        FlushBarriers();
+
     fn.vkCmdCopyBuffer(static_cast<VkCommandBuffer>(cmd_private_data),
                        GN_TO_VULKAN(GnBuffer, src_buffer)->buffer,
                        GN_TO_VULKAN(GnBuffer, dst_buffer)->buffer,
@@ -4975,12 +8290,19 @@ void GnCommandListVK::CopyTexture(GnTexture src_texture,
                                   GnResourceAccessFlags dst_texture_access,
                                   GnExtent3 extent) noexcept
 {
+    // Copies a region of the first mip level of the first array layer.
     VkImageCopy image_copy;
-    image_copy.srcSubresource = {};
+    image_copy.srcSubresource.aspectMask = GnIsColorFormat(src_texture->desc.format) ? VK_IMAGE_ASPECT_COLOR_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
+    image_copy.srcSubresource.mipLevel = 0;
+    image_copy.srcSubresource.baseArrayLayer = 0;
+    image_copy.srcSubresource.layerCount = 1;
     image_copy.srcOffset.x = src_offset.x;
     image_copy.srcOffset.y = src_offset.y;
     image_copy.srcOffset.z = src_offset.z;
-    image_copy.dstSubresource = {};
+    image_copy.dstSubresource.aspectMask = GnIsColorFormat(dst_texture->desc.format) ? VK_IMAGE_ASPECT_COLOR_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
+    image_copy.dstSubresource.mipLevel = 0;
+    image_copy.dstSubresource.baseArrayLayer = 0;
+    image_copy.dstSubresource.layerCount = 1;
     image_copy.dstOffset.x = dst_offset.x;
     image_copy.dstOffset.y = dst_offset.y;
     image_copy.dstOffset.z = dst_offset.z;
@@ -4988,6 +8310,9 @@ void GnCommandListVK::CopyTexture(GnTexture src_texture,
     image_copy.extent.height = extent.height;
     image_copy.extent.depth = extent.depth;
 
+    if (state.update_flags.pending_barriers)
+        FlushBarriers();
+
     fn.vkCmdCopyImage(static_cast<VkCommandBuffer>(cmd_private_data),
                       GN_TO_VULKAN(GnTexture, src_texture)->image,
                       GnGetImageLayoutFromAccessVK(src_texture_access),
@@ -4996,11 +8321,43 @@ void GnCommandListVK::CopyTexture(GnTexture src_texture,
                       1, &image_copy);
 }
 
+void GnCommandListVK::CopyTextureToBuffer(GnTexture src_texture, GnResourceAccessFlags src_texture_access, GnBuffer dst_buffer) noexcept
+{
+    const GnTextureDesc& desc = src_texture->desc;
+
+    // Copies the first mip level of every array layer, tightly packed. Only the depth of depth-stencil textures is copied.
+    VkBufferImageCopy region;
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = GnIsColorFormat(desc.format) ? VK_IMAGE_ASPECT_COLOR_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = desc.array_layers;
+    region.imageOffset = {};
+    region.imageExtent.width = desc.width;
+    region.imageExtent.height = desc.height;
+    region.imageExtent.depth = desc.depth;
+
+    if (state.update_flags.pending_barriers)
+        FlushBarriers();
+
+    fn.vkCmdCopyImageToBuffer(static_cast<VkCommandBuffer>(cmd_private_data),
+                              GN_TO_VULKAN(GnTexture, src_texture)->image,
+                              GnGetImageLayoutFromAccessVK(src_texture_access),
+                              GN_TO_VULKAN(GnBuffer, dst_buffer)->buffer,
+                              1, &region);
+}
+
 GnResult GnCommandListVK::End() noexcept
 {
     if (GN_FAILED(last_error))
         return last_error;
 
+    // Emit trailing barriers (e.g. the final transition before present)
+    if (state.update_flags.pending_barriers)
+        FlushBarriers();
+
     return GnConvertFromVkResult(fn.vkEndCommandBuffer(static_cast<VkCommandBuffer>(cmd_private_data)));
 }
 
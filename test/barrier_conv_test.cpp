@@ -1,25 +1,28 @@
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 
-#include <gn/gn.h>
-#include <vulkan/vulkan.h>
-#include <iostream>
+#include <gn/gn_impl_vulkan.h>
+#include <vector>
 #include "catch.hpp"
 
+static constexpr uint32_t num_access_combinations = 1u << 26; // Every combination of GnResourceAccess bits
+
+// Reference implementation, the lookup tables in gn_impl_vulkan.h must produce the same result.
 template<bool AfterAccess>
-inline VkPipelineStageFlags GnGetPipelineStageFromAccessVK(GnResourceAccessFlags access)
+inline VkPipelineStageFlags RefGetPipelineStageFromAccess(GnResourceAccessFlags access)
 {
     static constexpr GnResourceAccessFlags vs_access =
-        GnResourceAccess_VSUniformRead |
+        GnResourceAccess_VSUniformBuffer |
         GnResourceAccess_VSRead |
         GnResourceAccess_VSWrite;
 
     static constexpr GnResourceAccessFlags fs_access =
-        GnResourceAccess_FSUniformRead |
+        GnResourceAccess_FSUniformBuffer |
         GnResourceAccess_FSRead |
         GnResourceAccess_FSWrite;
 
     static constexpr GnResourceAccessFlags cs_access =
-        GnResourceAccess_CSUniformRead |
+        GnResourceAccess_CSUniformBuffer |
         GnResourceAccess_CSRead |
         GnResourceAccess_CSWrite;
 
@@ -29,7 +32,8 @@ inline VkPipelineStageFlags GnGetPipelineStageFromAccessVK(GnResourceAccessFlags
         GnResourceAccess_ClearSrc |
         GnResourceAccess_CopyDst |
         GnResourceAccess_BlitDst |
-        GnResourceAccess_ClearDst;
+        GnResourceAccess_ClearDst |
+        GnResourceAccess_Present;
 
     VkPipelineStageFlags stage = 0;
 
@@ -45,10 +49,10 @@ inline VkPipelineStageFlags GnGetPipelineStageFromAccessVK(GnResourceAccessFlags
     if (access & cs_access)
         stage |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
 
-    if (access & (GnResourceAccess_ColorAttachmentRead | GnResourceAccess_ColorAttachmentWrite))
+    if (access & (GnResourceAccess_ColorTargetRead | GnResourceAccess_ColorTargetWrite))
         stage |= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
-    if (access & (GnResourceAccess_DepthStencilAttachmentRead | GnResourceAccess_DepthStencilAttachmentWrite))
+    if (access & (GnResourceAccess_DepthStencilTargetRead | GnResourceAccess_DepthStencilTargetWrite))
         stage |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
 
     if (access & transfer_access)
@@ -63,12 +67,12 @@ inline VkPipelineStageFlags GnGetPipelineStageFromAccessVK(GnResourceAccessFlags
     return stage;
 }
 
-inline VkAccessFlags GnGetAccessVK(GnResourceAccessFlags access)
+inline VkAccessFlags RefGetAccess(GnResourceAccessFlags access)
 {
     static constexpr GnResourceAccessFlags uniform_read_access =
-        GnResourceAccess_VSUniformRead |
-        GnResourceAccess_FSUniformRead |
-        GnResourceAccess_CSUniformRead;
+        GnResourceAccess_VSUniformBuffer |
+        GnResourceAccess_FSUniformBuffer |
+        GnResourceAccess_CSUniformBuffer;
 
     static constexpr GnResourceAccessFlags read_access =
         GnResourceAccess_VSRead |
@@ -83,7 +87,8 @@ inline VkAccessFlags GnGetAccessVK(GnResourceAccessFlags access)
     static constexpr GnResourceAccessFlags src_transfer_access =
         GnResourceAccess_CopySrc |
         GnResourceAccess_BlitSrc |
-        GnResourceAccess_ClearSrc;
+        GnResourceAccess_ClearSrc |
+        GnResourceAccess_Present;
 
     static constexpr GnResourceAccessFlags dst_transfer_access =
         GnResourceAccess_CopyDst |
@@ -103,13 +108,13 @@ inline VkAccessFlags GnGetAccessVK(GnResourceAccessFlags access)
 
     VkAccessFlags vk_access = 0;
 
-    // Convert indirect buffer, index buffer, or vertex buffer access flags to VkAccessFlagBits
+    // Convert indirect buffer, index buffer, or vertex buffer access flags to VkAccessFlagBits equivalent
     vk_access |= (access >> 1) & vk_indirect_index_vertex_access;
 
-    // Convert attachments access to VkAccessFlagBits
+    // Convert attachments access to VkAccessFlagBits equivalent
     vk_access |= (access >> 6) & vk_attachment_access;
 
-    // Convert hosts access to VkAccessFlagBits
+    // Convert hosts access to VkAccessFlagBits equivalent
     vk_access |= (access >> 11) & (VK_ACCESS_HOST_READ_BIT | VK_ACCESS_HOST_WRITE_BIT);
 
     if (access & uniform_read_access) vk_access |= VK_ACCESS_UNIFORM_READ_BIT;
@@ -121,25 +126,25 @@ inline VkAccessFlags GnGetAccessVK(GnResourceAccessFlags access)
     return vk_access;
 }
 
-inline VkImageLayout GnGetImageLayoutFromAccessVK(GnResourceAccessFlags access)
+inline VkImageLayout RefGetImageLayoutFromAccess(GnResourceAccessFlags access)
 {
     static constexpr GnResourceAccessFlags read_access =
         GnResourceAccess_VSRead |
         GnResourceAccess_FSRead |
         GnResourceAccess_CSRead;
 
-    static constexpr GnResourceAccessFlags storage_access =
+    static constexpr GnResourceAccessFlags write_access =
         GnResourceAccess_VSWrite |
         GnResourceAccess_FSWrite |
         GnResourceAccess_CSWrite;
 
     static constexpr GnResourceAccessFlags color_attachment_access =
-        GnResourceAccess_ColorAttachmentRead |
-        GnResourceAccess_ColorAttachmentWrite;
+        GnResourceAccess_ColorTargetRead |
+        GnResourceAccess_ColorTargetWrite;
 
     static constexpr GnResourceAccessFlags depth_stencil_attachment_access =
-        GnResourceAccess_DepthStencilAttachmentRead |
-        GnResourceAccess_DepthStencilAttachmentWrite;
+        GnResourceAccess_DepthStencilTargetRead |
+        GnResourceAccess_DepthStencilTargetWrite;
 
     static constexpr GnResourceAccessFlags src_transfer_access =
         GnResourceAccess_CopySrc |
@@ -151,48 +156,176 @@ inline VkImageLayout GnGetImageLayoutFromAccessVK(GnResourceAccessFlags access)
         GnResourceAccess_BlitDst |
         GnResourceAccess_ClearDst;
 
-    if (access & GnResourceAccess_Common || access & storage_access) return VK_IMAGE_LAYOUT_GENERAL;
+    if (access & GnResourceAccess_GeneralLayout || access & write_access) return VK_IMAGE_LAYOUT_GENERAL;
 
     if (access & read_access) return VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
     else if (access & color_attachment_access) return VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     else if (access & depth_stencil_attachment_access) return VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
     else if (access & src_transfer_access) return VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
     else if (access & dst_transfer_access) return VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    else if (access & GnResourceAccess_Present) return VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    else if (access & GnResourceAccess_Present) return VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
 
     return VK_IMAGE_LAYOUT_UNDEFINED;
 }
 
-void ConvImageBarrier(const GnTextureBarrier& barrier, VkPipelineStageFlags& src_pipeline, VkPipelineStageFlags& dst_pipeline, VkImageMemoryBarrier& vk_barrier)
+TEST_CASE("Access conversion matches reference", "[barrier]")
+{
+    uint32_t num_mismatches = 0;
+    GnResourceAccessFlags first_mismatch = 0;
+
+    for (uint32_t access = 0; access < num_access_combinations; access++) {
+        bool match =
+            GnGetPipelineStageFromAccessVK<false>(access) == RefGetPipelineStageFromAccess<false>(access) &&
+            GnGetPipelineStageFromAccessVK<true>(access) == RefGetPipelineStageFromAccess<true>(access) &&
+            GnGetAccessVK(access) == RefGetAccess(access) &&
+            GnGetImageLayoutFromAccessVK(access) == RefGetImageLayoutFromAccess(access);
+
+        if (!match && num_mismatches++ == 0)
+            first_mismatch = access;
+    }
+
+    INFO("First mismatch: 0x" << std::hex << first_mismatch);
+    REQUIRE(num_mismatches == 0);
+}
+
+TEST_CASE("Overlapping buffer barriers are split into batches", "[barrier]")
+{
+    GnBufferVK buffer{};
+    buffer.buffer = (VkBuffer)0x1;
+
+    GnVector<VkBufferMemoryBarrier> pending_barriers;
+    std::vector<std::vector<VkBufferMemoryBarrier>> batches;
+    VkPipelineStageFlags src_stages = 0;
+    VkPipelineStageFlags dst_stages = 0;
+
+    auto flush = [&]() {
+        batches.emplace_back(pending_barriers.data(), pending_barriers.data() + pending_barriers.size());
+        pending_barriers.resize(0);
+        src_stages = 0;
+        dst_stages = 0;
+    };
+
+    // [0, 256) is written then read by compute, [128, 384) overlaps it and has to wait for the first barrier
+    GnBufferBarrier barriers[4]{};
+    barriers[0] = { &buffer, 0, 256, GnResourceAccess_CopyDst, GnResourceAccess_CSWrite };
+    barriers[1] = { &buffer, 0, 256, GnResourceAccess_CSWrite, GnResourceAccess_CSRead };
+    barriers[2] = { &buffer, 512, GN_WHOLE_SIZE, GnResourceAccess_CopyDst, GnResourceAccess_CSRead };
+    barriers[3] = { &buffer, 128, 256, GnResourceAccess_CSRead, GnResourceAccess_CopySrc };
+
+    REQUIRE(GnAppendBufferBarriersVK<false>(pending_barriers, src_stages, dst_stages, 4, barriers, flush));
+
+    // The first two barriers are folded, the third one does not overlap them
+    REQUIRE(batches.size() == 1);
+    REQUIRE(batches[0].size() == 2);
+    REQUIRE(batches[0][0].offset == 0);
+    REQUIRE(batches[0][0].size == 256);
+    REQUIRE(batches[0][0].srcAccessMask == VK_ACCESS_TRANSFER_WRITE_BIT);
+    REQUIRE(batches[0][0].dstAccessMask == VK_ACCESS_SHADER_READ_BIT);
+    REQUIRE(batches[0][1].offset == 512);
+    REQUIRE(batches[0][1].size == VK_WHOLE_SIZE);
+
+    // The overlapping barrier starts a new batch with its own stages
+    REQUIRE(pending_barriers.size() == 1);
+    REQUIRE(pending_barriers[0].offset == 128);
+    REQUIRE(pending_barriers[0].srcAccessMask == VK_ACCESS_SHADER_READ_BIT);
+    REQUIRE(src_stages == VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    REQUIRE(dst_stages == VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    // Starting past the end of a whole-size range still overlaps it
+    GnBufferBarrier tail_barrier = { &buffer, 1024, 16, GnResourceAccess_CopyDst, GnResourceAccess_CopySrc };
+    REQUIRE(GnAppendBufferBarriersVK<false>(pending_barriers, src_stages, dst_stages, 1, &barriers[2], flush));
+    REQUIRE(GnAppendBufferBarriersVK<false>(pending_barriers, src_stages, dst_stages, 1, &tail_barrier, flush));
+    REQUIRE(batches.size() == 2);
+    REQUIRE(pending_barriers.size() == 1);
+    REQUIRE(pending_barriers[0].offset == 1024);
+}
+
+TEST_CASE("Overlapping texture barriers are split into batches", "[barrier]")
 {
-    src_pipeline |= GnGetPipelineStageFromAccessVK<false>(barrier.access_before);
-    dst_pipeline |= GnGetPipelineStageFromAccessVK<true>(barrier.access_after);
-    vk_barrier.srcAccessMask = GnGetAccessVK(barrier.access_before);
-    vk_barrier.dstAccessMask = GnGetAccessVK(barrier.access_after);
-    vk_barrier.oldLayout = GnGetImageLayoutFromAccessVK(barrier.access_before);
-    vk_barrier.newLayout = GnGetImageLayoutFromAccessVK(barrier.access_after);
+    GnTextureVK texture{};
+    texture.image = (VkImage)0x1;
+
+    GnVector<VkImageMemoryBarrier> pending_barriers;
+    std::vector<std::vector<VkImageMemoryBarrier>> batches;
+    VkPipelineStageFlags src_stages = 0;
+    VkPipelineStageFlags dst_stages = 0;
+
+    auto flush = [&]() {
+        batches.emplace_back(pending_barriers.data(), pending_barriers.data() + pending_barriers.size());
+        pending_barriers.resize(0);
+        src_stages = 0;
+        dst_stages = 0;
+    };
+
+    GnTextureSubresourceRange all_mips = { GnTextureAspect_Color, 0, 2, 0, 1 };
+    GnTextureSubresourceRange second_mip = { GnTextureAspect_Color, 1, 1, 0, 1 };
+    GnTextureSubresourceRange depth = { GnTextureAspect_Depth, 0, 1, 0, 1 };
+
+    GnTextureBarrier barriers[5]{};
+    barriers[0] = { &texture, all_mips, GnResourceAccess_CopyDst, GnResourceAccess_CopySrc };
+    barriers[1] = { &texture, all_mips, GnResourceAccess_CopySrc, GnResourceAccess_FSRead };
+    barriers[2] = { &texture, depth, GnResourceAccess_Discard, GnResourceAccess_DepthStencilTargetWrite };
+    barriers[3] = { &texture, second_mip, GnResourceAccess_FSRead, GnResourceAccess_CopyDst };
+    barriers[4] = { &texture, second_mip, GnResourceAccess_CSWrite, GnResourceAccess_CSRead };
+
+    REQUIRE(GnAppendImageBarriersVK<false>(pending_barriers, src_stages, dst_stages, 5, barriers, flush));
+
+    // The first two barriers chain and are folded, the depth aspect does not overlap the color one
+    REQUIRE(batches.size() == 2);
+    REQUIRE(batches[0].size() == 2);
+    REQUIRE(batches[0][0].oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    REQUIRE(batches[0][0].newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    REQUIRE(batches[0][1].subresourceRange.aspectMask == VK_IMAGE_ASPECT_DEPTH_BIT);
+
+    // A barrier on part of the pending subresources starts a new batch
+    REQUIRE(batches[1].size() == 1);
+    REQUIRE(batches[1][0].oldLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    REQUIRE(batches[1][0].newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+    // Same subresources, but the layouts do not follow on, so the barriers are not folded
+    REQUIRE(pending_barriers.size() == 1);
+    REQUIRE(pending_barriers[0].oldLayout == VK_IMAGE_LAYOUT_GENERAL);
+    REQUIRE(src_stages == VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
 }
 
-TEST_CASE("Image Barrier")
+TEST_CASE("Barrier conversion throughput", "[.benchmark]")
 {
-    GnResourceAccess Access = GnResourceAccess_BlitDst;
-    GnTextureBarrier first_barrier{};
-    first_barrier.access_before = GnResourceAccess_Undefined;
-    first_barrier.access_after = GnResourceAccess_CopyDst;
-
-    VkPipelineStageFlags first_src_pipeline = 0;
-    VkPipelineStageFlags first_dst_pipeline = 0;
-    VkImageMemoryBarrier first_image_barrier{};
-    ConvImageBarrier(first_barrier, first_src_pipeline, first_dst_pipeline, first_image_barrier);
-
-    GnTextureBarrier second_barrier{};
-    second_barrier.access_before = GnResourceAccess_CopyDst;
-    second_barrier.access_after = GnResourceAccess_Present;
-
-    VkPipelineStageFlags second_src_pipeline = 0;
-    VkPipelineStageFlags second_dst_pipeline = 0;
-    VkImageMemoryBarrier second_image_barrier{};
-    ConvImageBarrier(second_barrier, second_src_pipeline, second_dst_pipeline, second_image_barrier);
-
-    std::cout << "test" << std::endl;
-}
\ No newline at end of file
+    // Mix of single-bit accesses, as found in most barriers, and arbitrary combinations.
+    std::vector<GnResourceAccessFlags> accesses;
+    uint32_t seed = 0x12345678;
+
+    for (uint32_t i = 0; i < 4096; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        accesses.push_back((i & 1) ? (1u << (seed % 26)) : (seed & (num_access_combinations - 1)));
+    }
+
+    BENCHMARK("Lookup table")
+    {
+        VkPipelineStageFlags stages = 0;
+        VkAccessFlags access_flags = 0;
+        uint32_t layouts = 0;
+
+        for (size_t i = 1; i < accesses.size(); i++) {
+            stages |= GnGetPipelineStageFromAccessVK<false>(accesses[i - 1]) | GnGetPipelineStageFromAccessVK<true>(accesses[i]);
+            access_flags ^= GnGetAccessVK(accesses[i - 1]) | GnGetAccessVK(accesses[i]);
+            layouts += GnGetImageLayoutFromAccessVK(accesses[i - 1]) + GnGetImageLayoutFromAccessVK(accesses[i]);
+        }
+
+        return stages + access_flags + layouts;
+    };
+
+    BENCHMARK("Reference")
+    {
+        VkPipelineStageFlags stages = 0;
+        VkAccessFlags access_flags = 0;
+        uint32_t layouts = 0;
+
+        for (size_t i = 1; i < accesses.size(); i++) {
+            stages |= RefGetPipelineStageFromAccess<false>(accesses[i - 1]) | RefGetPipelineStageFromAccess<true>(accesses[i]);
+            access_flags ^= RefGetAccess(accesses[i - 1]) | RefGetAccess(accesses[i]);
+            layouts += RefGetImageLayoutFromAccess(accesses[i - 1]) + RefGetImageLayoutFromAccess(accesses[i]);
+        }
+
+        return stages + access_flags + layouts;
+    };
+}
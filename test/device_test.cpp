@@ -1,6 +1,251 @@
 #include "catch.hpp"
 #include "test_common.h"
+#include "test_shaders.h"
 #include <vector>
+#include <numeric>
+#include <algorithm>
+#include <thread>
+#include <cstring>
+
+static uint32_t GetDirectQueueGroup(GnAdapter adapter)
+{
+    uint32_t queue_group = 0;
+
+    GnEnumerateAdapterQueueGroupProperties(adapter,
+                                           [&queue_group](const GnQueueGroupProperties& queue_properties) {
+                                               if (queue_properties.type == GnQueueType_Direct)
+                                                   queue_group = queue_properties.index;
+                                           });
+
+    return queue_group;
+}
+
+static GnResult CreateHostVisibleBuffer(GnAdapter adapter, GnDevice device, const GnBufferDesc* desc, GnBuffer* buffer, GnMemory* memory)
+{
+    GnResult result = GnCreateBuffer(device, desc, buffer);
+
+    if (GN_FAILED(result))
+        return result;
+
+    GnMemoryRequirements requirements{};
+    GnGetBufferMemoryRequirements(device, *buffer, &requirements);
+
+    GnMemoryDesc memory_desc{};
+    memory_desc.size = requirements.size;
+    memory_desc.memory_type_index = GnFindSupportedMemoryType(adapter, requirements.supported_memory_type_bits,
+                                                              GnMemoryAttribute_HostVisible | GnMemoryAttribute_HostCoherent,
+                                                              GnMemoryAttribute_HostVisible, 0);
+
+    result = GnCreateMemory(device, &memory_desc, memory);
+
+    if (GN_FAILED(result)) {
+        GnDestroyBuffer(device, *buffer);
+        return result;
+    }
+
+    return GnBindBufferMemory(device, *buffer, *memory, 0);
+}
+
+static GnResult CreateCommandList(GnDevice device, uint32_t queue_group, GnCommandPool* command_pool, GnCommandList* command_list)
+{
+    GnCommandPoolDesc command_pool_desc{};
+    command_pool_desc.usage = GnCommandPoolUsage_Transient;
+    command_pool_desc.command_list_usage = GnCommandListUsage_Primary;
+    command_pool_desc.queue_group_index = queue_group;
+    command_pool_desc.max_allocated_cmd_list = 1;
+
+    GnResult result = GnCreateCommandPool(device, &command_pool_desc, command_pool);
+
+    if (GN_FAILED(result))
+        return result;
+
+    GnCommandListDesc command_list_desc{};
+    command_list_desc.command_pool = *command_pool;
+    command_list_desc.usage = GnCommandListUsage_Primary;
+    command_list_desc.queue_group_index = queue_group;
+    command_list_desc.num_cmd_lists = 1;
+
+    return GnCreateCommandLists(device, &command_list_desc, command_list);
+}
+
+struct FullscreenPipelineStates
+{
+    GnShaderBytecode                vs;
+    GnShaderBytecode                fs;
+    GnVertexInputStateDesc          vertex_input;
+    GnInputAssemblyStateDesc        input_assembly;
+    GnRasterizationStateDesc        rasterization;
+    GnFormat                        color_format;
+    GnFragmentInterfaceStateDesc    fragment_interface;
+    GnGraphicsPipelineDesc          desc; // Points into the states above
+};
+
+// Describes a pipeline drawing g_fullscreen_vs with fs into a single color target. Shaders are SPIR-V only.
+static void InitFullscreenPipeline(FullscreenPipelineStates* states, const uint32_t* fs, size_t fs_size, GnFormat color_format)
+{
+    *states = {};
+    states->vs.size = sizeof(g_fullscreen_vs);
+    states->vs.bytecode = g_fullscreen_vs;
+    states->vs.entry_point = "main";
+    states->fs.size = fs_size;
+    states->fs.bytecode = fs;
+    states->fs.entry_point = "main";
+    states->input_assembly.topology = GnPrimitiveTopology_TriangleList;
+    states->rasterization.polygon_mode = GnPolygonMode_Fill;
+    states->rasterization.cull_mode = GnCullMode_None;
+    states->color_format = color_format;
+    states->fragment_interface.num_color_targets = 1;
+    states->fragment_interface.color_target_formats = &states->color_format;
+
+    GnGraphicsPipelineDesc& desc = states->desc;
+    desc.vs = &states->vs;
+    desc.fs = &states->fs;
+    desc.vertex_input = &states->vertex_input;
+    desc.input_assembly = &states->input_assembly;
+    desc.rasterization = &states->rasterization;
+    desc.fragment_interface = &states->fragment_interface;
+    desc.num_viewports = 1;
+}
+
+struct ReadbackTarget
+{
+    GnTexture       texture;
+    GnMemory        texture_memory;
+    GnTextureView   view;
+    GnBuffer        buffer;
+    GnMemory        buffer_memory;
+};
+
+// Creates an RGBA8 color target with a host-visible buffer its contents can be copied into.
+static GnResult CreateReadbackTarget(GnAdapter adapter, GnDevice device, uint32_t width, uint32_t height, ReadbackTarget* target)
+{
+    *target = {};
+
+    GnTextureDesc texture_desc{};
+    texture_desc.usage = GnTextureUsage_ColorTarget | GnTextureUsage_CopySrc | GnTextureUsage_CopyDst;
+    texture_desc.type = GnTextureType_2D;
+    texture_desc.format = GnFormat_RGBA8Unorm;
+    texture_desc.width = width;
+    texture_desc.height = height;
+    texture_desc.depth = 1;
+    texture_desc.mip_levels = 1;
+    texture_desc.array_layers = 1;
+    texture_desc.samples = GnSampleCount_X1;
+
+    GnResult result = GnCreateTexture(device, &texture_desc, &target->texture);
+
+    if (GN_FAILED(result))
+        return result;
+
+    GnMemoryRequirements requirements{};
+    GnGetTextureMemoryRequirements(device, target->texture, &requirements);
+
+    GnMemoryDesc memory_desc{};
+    memory_desc.size = requirements.size;
+    memory_desc.memory_type_index = GnFindSupportedMemoryType(adapter, requirements.supported_memory_type_bits,
+                                                              GnMemoryAttribute_DeviceLocal, 0, 0);
+
+    result = GnCreateMemory(device, &memory_desc, &target->texture_memory);
+
+    if (GN_FAILED(result))
+        return result;
+
+    result = GnBindTextureMemory(device, target->texture, target->texture_memory, 0);
+
+    if (GN_FAILED(result))
+        return result;
+
+    GnTextureViewDesc view_desc{};
+    view_desc.texture = target->texture;
+    view_desc.type = GnTextureViewType_2D;
+    view_desc.format = GnFormat_RGBA8Unorm;
+    view_desc.subresource_range.aspect = GnTextureAspect_Color;
+    view_desc.subresource_range.num_mip_levels = 1;
+    view_desc.subresource_range.num_array_layers = 1;
+
+    result = GnCreateTextureView(device, &view_desc, &target->view);
+
+    if (GN_FAILED(result))
+        return result;
+
+    GnBufferDesc buffer_desc{};
+    buffer_desc.size = (GnDeviceSize)width * height * 4;
+    buffer_desc.usage = GnBufferUsage_CopyDst;
+
+    return CreateHostVisibleBuffer(adapter, device, &buffer_desc, &target->buffer, &target->buffer_memory);
+}
+
+static void DestroyReadbackTarget(GnDevice device, ReadbackTarget* target)
+{
+    if (target->buffer) GnDestroyBuffer(device, target->buffer);
+    if (target->buffer_memory) GnDestroyMemory(device, target->buffer_memory);
+    if (target->view) GnDestroyTextureView(device, target->view);
+    if (target->texture) GnDestroyTexture(device, target->texture);
+    if (target->texture_memory) GnDestroyMemory(device, target->texture_memory);
+}
+
+// Copies the target, last written as a color target, into its readback buffer.
+static void CmdReadBack(GnCommandList command_list, const ReadbackTarget* target)
+{
+    GnTextureBarrier texture_barrier{};
+    texture_barrier.texture = target->texture;
+    texture_barrier.subresource_range.aspect = GnTextureAspect_Color;
+    texture_barrier.subresource_range.num_mip_levels = 1;
+    texture_barrier.subresource_range.num_array_layers = 1;
+    texture_barrier.prev_access = GnResourceAccess_ColorTargetWrite;
+    texture_barrier.next_access = GnResourceAccess_CopySrc;
+    GnCmdTextureBarrier(command_list, 1, &texture_barrier);
+
+    GnCmdCopyTextureToBuffer(command_list, target->texture, GnResourceAccess_CopySrc, target->buffer);
+
+    GnBufferBarrier buffer_barrier{};
+    buffer_barrier.buffer = target->buffer;
+    buffer_barrier.size = GN_WHOLE_SIZE;
+    buffer_barrier.prev_access = GnResourceAccess_CopyDst;
+    buffer_barrier.next_access = GnResourceAccess_HostRead;
+    GnCmdBufferBarrier(command_list, 1, &buffer_barrier);
+}
+
+// Returns the first pixel of the readback buffer, packed as 0xAABBGGRR.
+static uint32_t ReadFirstPixel(GnDevice device, const ReadbackTarget* target)
+{
+    uint8_t* mapped_data = nullptr;
+    uint32_t pixel = 0;
+
+    if (GN_FAILED(GnMapBuffer(device, target->buffer, nullptr, (void**)&mapped_data)))
+        return 0;
+
+    pixel = (uint32_t)mapped_data[0] | ((uint32_t)mapped_data[1] << 8) | ((uint32_t)mapped_data[2] << 16) | ((uint32_t)mapped_data[3] << 24);
+    GnUnmapBuffer(device, target->buffer, nullptr);
+
+    return pixel;
+}
+
+struct FullscreenPassData
+{
+    GnPipeline          pipeline;
+    GnPipelineLayout    pipeline_layout;    // Optional
+    GnDescriptorTable   descriptor_table;   // Bound to slot 0 with pipeline_layout
+    uint32_t            width;
+    uint32_t            height;
+};
+
+// GnRenderGraphExecuteFn drawing a fullscreen triangle, userdata is a FullscreenPassData.
+static void DrawFullscreenPass(void* userdata, GnCommandList command_list, GnRenderGraph render_graph)
+{
+    const FullscreenPassData* data = (const FullscreenPassData*)userdata;
+
+    GnCmdSetGraphicsPipeline(command_list, data->pipeline);
+
+    if (data->pipeline_layout != nullptr) {
+        GnCmdSetGraphicsPipelineLayout(command_list, data->pipeline_layout);
+        GnCmdSetGraphicsDescriptorTable(command_list, 0, data->descriptor_table);
+    }
+
+    GnCmdSetViewport(command_list, 0, 0.0f, 0.0f, (float)data->width, (float)data->height, 0.0f, 1.0f);
+    GnCmdSetScissor(command_list, 0, 0, 0, data->width, data->height);
+    GnCmdDraw(command_list, 3, 0);
+}
 
 TEST_CASE("Create device", "[device]")
 {
@@ -81,3 +326,2064 @@ TEST_CASE("Create queue", "[device]")
     GnDestroyDevice(device);
     GnDestroyInstance(instance);
 }
+
+TEST_CASE("Pipeline cache", "[device]")
+{
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    GnPipelineCacheDesc cache_desc{};
+    GnPipelineCache cache;
+    REQUIRE(GnCreatePipelineCache(device, &cache_desc, &cache) == GnSuccess);
+
+    size_t data_size = 0;
+    REQUIRE(GnGetPipelineCacheData(device, cache, &data_size, nullptr) == GnSuccess);
+    REQUIRE(data_size > 0);
+
+    std::vector<uint8_t> data(data_size);
+    REQUIRE(GnGetPipelineCacheData(device, cache, &data_size, data.data()) == GnSuccess);
+
+    SECTION("Too small buffer")
+    {
+        size_t small_size = data_size - 1;
+        REQUIRE(GnGetPipelineCacheData(device, cache, &small_size, data.data()) == GnError_InvalidArgs);
+    }
+
+    SECTION("Create from serialized data and merge")
+    {
+        cache_desc.initial_data_size = data_size;
+        cache_desc.initial_data = data.data();
+
+        GnPipelineCache loaded_cache;
+        REQUIRE(GnCreatePipelineCache(device, &cache_desc, &loaded_cache) == GnSuccess);
+        REQUIRE(GnMergePipelineCaches(device, cache, 1, &loaded_cache) == GnSuccess);
+        REQUIRE(GnMergePipelineCaches(device, cache, 1, &cache) == GnError_InvalidArgs);
+        GnDestroyPipelineCache(device, loaded_cache);
+    }
+
+    GnDestroyPipelineCache(device, cache);
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Foreign pipeline cache data", "[device]")
+{
+    // The test shaders are SPIR-V
+    if (g_test_backend != GnBackend_Vulkan)
+        return;
+
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    GnPipelineCacheDesc cache_desc{};
+    GnPipelineCache empty_cache, cache;
+    REQUIRE(GnCreatePipelineCache(device, &cache_desc, &empty_cache) == GnSuccess);
+    REQUIRE(GnCreatePipelineCache(device, &cache_desc, &cache) == GnSuccess);
+
+    size_t empty_data_size = 0;
+    REQUIRE(GnGetPipelineCacheData(device, empty_cache, &empty_data_size, nullptr) == GnSuccess);
+
+    FullscreenPipelineStates red_states;
+    InitFullscreenPipeline(&red_states, g_red_fs, sizeof(g_red_fs), GnFormat_RGBA8Unorm);
+    red_states.desc.cache = cache;
+
+    GnPipeline pipeline;
+    REQUIRE(GnCreateGraphicsPipeline(device, &red_states.desc, &pipeline) == GnSuccess);
+    GnDestroyPipeline(device, pipeline);
+
+    // The cache holds the compiled pipeline, so the blob carries more than an empty cache
+    size_t data_size = 0;
+    REQUIRE(GnGetPipelineCacheData(device, cache, &data_size, nullptr) == GnSuccess);
+    REQUIRE(data_size > empty_data_size);
+
+    std::vector<uint8_t> data(data_size);
+    REQUIRE(GnGetPipelineCacheData(device, cache, &data_size, data.data()) == GnSuccess);
+
+    // Corrupt the magic, then the vendor ID of the header
+    for (size_t corrupted_offset : { 0, 8 }) {
+        std::vector<uint8_t> foreign_data = data;
+        foreign_data[corrupted_offset] ^= 0xFF;
+
+        cache_desc.initial_data_size = foreign_data.size();
+        cache_desc.initial_data = foreign_data.data();
+
+        GnPipelineCache loaded_cache;
+        REQUIRE(GnCreatePipelineCache(device, &cache_desc, &loaded_cache) == GnSuccess);
+
+        // The data was dropped, the loaded cache starts out empty
+        size_t loaded_data_size = 0;
+        REQUIRE(GnGetPipelineCacheData(device, loaded_cache, &loaded_data_size, nullptr) == GnSuccess);
+        REQUIRE(loaded_data_size == empty_data_size);
+
+        // and pipelines are still created with it
+        red_states.desc.cache = loaded_cache;
+        REQUIRE(GnCreateGraphicsPipeline(device, &red_states.desc, &pipeline) == GnSuccess);
+        GnDestroyPipeline(device, pipeline);
+        GnDestroyPipelineCache(device, loaded_cache);
+    }
+
+    GnDestroyPipelineCache(device, cache);
+    GnDestroyPipelineCache(device, empty_cache);
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Malformed pipeline stream", "[device]")
+{
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    std::vector<uint32_t> stream;
+
+    GnPipelineStreamDesc stream_desc{};
+    stream_desc.tight_stream = GN_TRUE;
+
+    GnPipeline pipeline;
+
+    SECTION("Truncated header")
+    {
+        stream = { GnPipelineStreamTokenType_NumViewports };
+    }
+
+    SECTION("Unknown token")
+    {
+        stream = { 0xFFFF, 0 };
+    }
+
+    SECTION("Payload past the end")
+    {
+        stream = { GnPipelineStreamTokenType_NumViewports, 8, 1 };
+    }
+
+    SECTION("Entry point without terminator")
+    {
+        // bytecode_size, entry_point_size, 4 bytes of bytecode, "main" without NUL
+        stream = { GnPipelineStreamTokenType_VS, 16, 4, 4, 0x07230203, 0x6E69616D };
+    }
+
+    stream_desc.stream_size = stream.size() * sizeof(uint32_t);
+    stream_desc.stream_data = stream.data();
+    REQUIRE(GnCreateGraphicsPipelineFromStream(device, &stream_desc, &pipeline) == GnError_InvalidArgs);
+
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Tight pipeline stream", "[device]")
+{
+    // The test shaders are SPIR-V
+    if (g_test_backend != GnBackend_Vulkan)
+        return;
+
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    uint32_t queue_group = GetDirectQueueGroup(adapter);
+    GnQueue queue = GnGetDeviceQueue(device, queue_group, 0);
+
+    ReadbackTarget target;
+    REQUIRE(CreateReadbackTarget(adapter, device, 4, 4, &target) == GnSuccess);
+
+    GnCommandPool command_pool;
+    GnCommandList command_list;
+    REQUIRE(CreateCommandList(device, queue_group, &command_pool, &command_list) == GnSuccess);
+
+    GnPipelineLayoutDesc layout_desc{};
+    GnPipelineLayout layout;
+    REQUIRE(GnCreatePipelineLayout(device, &layout_desc, &layout) == GnSuccess);
+
+    std::vector<uint32_t> stream;
+
+    auto write_header = [&stream](GnPipelineStreamTokenType type, uint32_t payload_size) {
+        stream.push_back(type);
+        stream.push_back(payload_size);
+    };
+
+    // Appends size bytes of data, padded to a multiple of 4 bytes.
+    auto write_bytes = [&stream](const void* data, size_t size) {
+        size_t offset = stream.size();
+        stream.resize(offset + (size + 3) / 4, 0);
+        std::memcpy(stream.data() + offset, data, size);
+    };
+
+    auto write_shader = [&](GnPipelineStreamTokenType type, const uint32_t* bytecode, uint32_t bytecode_size) {
+        const char entry_point[] = "main";
+        write_header(type, 2 * sizeof(uint32_t) + bytecode_size + sizeof(entry_point));
+        stream.push_back(bytecode_size);
+        stream.push_back(sizeof(entry_point));
+        write_bytes(bytecode, bytecode_size);
+        write_bytes(entry_point, sizeof(entry_point));
+    };
+
+    write_shader(GnPipelineStreamTokenType_VS, g_fullscreen_vs, sizeof(g_fullscreen_vs));
+    write_shader(GnPipelineStreamTokenType_FS, g_red_fs, sizeof(g_red_fs));
+
+    // num_color_targets, resolve_target_mask, depth_stencil_target_format, color_target_formats[0]
+    write_header(GnPipelineStreamTokenType_FragmentInterface, 4 * sizeof(uint32_t));
+    stream.insert(stream.end(), { 1, 0, GnFormat_Unknown, GnFormat_RGBA8Unorm });
+
+    write_header(GnPipelineStreamTokenType_Layout, sizeof(uint32_t));
+    stream.push_back(0);
+
+    write_header(GnPipelineStreamTokenType_NumViewports, sizeof(uint32_t));
+    stream.push_back(1);
+
+    GnPipelineStreamDesc stream_desc{};
+    stream_desc.stream_size = stream.size() * sizeof(uint32_t);
+    stream_desc.stream_data = stream.data();
+    stream_desc.tight_stream = GN_TRUE;
+    stream_desc.num_layouts = 1;
+    stream_desc.layouts = &layout;
+
+    GnPipeline pipeline;
+    REQUIRE(GnCreateGraphicsPipelineFromStream(device, &stream_desc, &pipeline) == GnSuccess);
+
+    // The pipeline draws like one created from the equivalent desc
+    REQUIRE(GnBeginCommandList(command_list, nullptr) == GnSuccess);
+
+    GnTextureBarrier texture_barrier{};
+    texture_barrier.texture = target.texture;
+    texture_barrier.subresource_range.aspect = GnTextureAspect_Color;
+    texture_barrier.subresource_range.num_mip_levels = 1;
+    texture_barrier.subresource_range.num_array_layers = 1;
+    texture_barrier.prev_access = GnResourceAccess_Undefined;
+    texture_barrier.next_access = GnResourceAccess_ColorTargetWrite;
+    GnCmdTextureBarrier(command_list, 1, &texture_barrier);
+
+    GnRenderPassColorTargetDesc color_target{};
+    color_target.view = target.view;
+    color_target.access = GnResourceAccess_ColorTargetWrite;
+    color_target.load_op = GnRenderPassOp_Clear;
+    color_target.store_op = GnRenderPassOp_Store;
+    color_target.clear_value.float32[3] = 1.0f;
+
+    GnRenderPassBeginDesc render_pass_desc{};
+    render_pass_desc.sample_count = GnSampleCount_X1;
+    render_pass_desc.width = 4;
+    render_pass_desc.height = 4;
+    render_pass_desc.num_color_targets = 1;
+    render_pass_desc.color_targets = &color_target;
+
+    GnCmdBeginRenderPass(command_list, &render_pass_desc);
+    GnCmdSetGraphicsPipeline(command_list, pipeline);
+    GnCmdSetGraphicsPipelineLayout(command_list, layout);
+    GnCmdSetViewport(command_list, 0, 0.0f, 0.0f, 4.0f, 4.0f, 0.0f, 1.0f);
+    GnCmdSetScissor(command_list, 0, 0, 0, 4, 4);
+    GnCmdDraw(command_list, 3, 0);
+    GnCmdEndRenderPass(command_list);
+    CmdReadBack(command_list, &target);
+    REQUIRE(GnEndCommandList(command_list) == GnSuccess);
+
+    REQUIRE(GnEnqueueCommandLists(queue, 1, &command_list) == GnSuccess);
+    REQUIRE(GnFlushQueueAndWait(queue) == GnSuccess);
+    REQUIRE(ReadFirstPixel(device, &target) == 0xFF0000FF);
+
+    GnDestroyPipeline(device, pipeline);
+    GnDestroyPipelineLayout(device, layout);
+    GnDestroyCommandLists(device, command_pool, 1, &command_list);
+    GnDestroyCommandPool(device, command_pool);
+    DestroyReadbackTarget(device, &target);
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Compatible render pass reuse", "[device]")
+{
+    // The test shaders are SPIR-V
+    if (g_test_backend != GnBackend_Vulkan)
+        return;
+
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    uint32_t queue_group = GetDirectQueueGroup(adapter);
+    GnQueue queue = GnGetDeviceQueue(device, queue_group, 0);
+
+    ReadbackTarget target;
+    REQUIRE(CreateReadbackTarget(adapter, device, 4, 4, &target) == GnSuccess);
+
+    GnCommandPool command_pool;
+    GnCommandList command_list;
+    REQUIRE(CreateCommandList(device, queue_group, &command_pool, &command_list) == GnSuccess);
+
+    FullscreenPipelineStates red_states, green_states;
+    InitFullscreenPipeline(&red_states, g_red_fs, sizeof(g_red_fs), GnFormat_RGBA8Unorm);
+    InitFullscreenPipeline(&green_states, g_green_fs, sizeof(g_green_fs), GnFormat_RGBA8Unorm);
+
+    // Both pipelines have the same fragment interface and look up the same compatible render pass at the same time
+    GnPipeline red_pipeline = nullptr, green_pipeline = nullptr;
+    GnResult red_result = GnError_Unknown, green_result = GnError_Unknown;
+
+    std::thread red_thread([&]() { red_result = GnCreateGraphicsPipeline(device, &red_states.desc, &red_pipeline); });
+    green_result = GnCreateGraphicsPipeline(device, &green_states.desc, &green_pipeline);
+    red_thread.join();
+
+    REQUIRE(red_result == GnSuccess);
+    REQUIRE(green_result == GnSuccess);
+
+    GnRenderPassColorTargetDesc color_target{};
+    color_target.view = target.view;
+    color_target.access = GnResourceAccess_ColorTargetWrite;
+    color_target.load_op = GnRenderPassOp_Clear;
+    color_target.store_op = GnRenderPassOp_Store;
+    color_target.clear_value.float32[3] = 1.0f;
+
+    GnRenderPassBeginDesc render_pass_desc{};
+    render_pass_desc.sample_count = GnSampleCount_X1;
+    render_pass_desc.width = 4;
+    render_pass_desc.height = 4;
+    render_pass_desc.num_color_targets = 1;
+    render_pass_desc.color_targets = &color_target;
+
+    // Clears the target, draws with each pipeline in turn and returns the first pixel.
+    auto draw = [&](GnPipeline first_pipeline, GnPipeline second_pipeline) {
+        REQUIRE(GnResetCommandPool(device, command_pool) == GnSuccess);
+        REQUIRE(GnBeginCommandList(command_list, nullptr) == GnSuccess);
+
+        GnTextureBarrier texture_barrier{};
+        texture_barrier.texture = target.texture;
+        texture_barrier.subresource_range.aspect = GnTextureAspect_Color;
+        texture_barrier.subresource_range.num_mip_levels = 1;
+        texture_barrier.subresource_range.num_array_layers = 1;
+        texture_barrier.prev_access = GnResourceAccess_Undefined;
+        texture_barrier.next_access = GnResourceAccess_ColorTargetWrite;
+        GnCmdTextureBarrier(command_list, 1, &texture_barrier);
+
+        GnCmdBeginRenderPass(command_list, &render_pass_desc);
+        GnCmdSetViewport(command_list, 0, 0.0f, 0.0f, 4.0f, 4.0f, 0.0f, 1.0f);
+        GnCmdSetScissor(command_list, 0, 0, 0, 4, 4);
+        GnCmdSetGraphicsPipeline(command_list, first_pipeline);
+        GnCmdDraw(command_list, 3, 0);
+        GnCmdSetGraphicsPipeline(command_list, second_pipeline);
+        GnCmdDraw(command_list, 3, 0);
+        GnCmdEndRenderPass(command_list);
+        CmdReadBack(command_list, &target);
+        REQUIRE(GnEndCommandList(command_list) == GnSuccess);
+
+        REQUIRE(GnEnqueueCommandLists(queue, 1, &command_list) == GnSuccess);
+        REQUIRE(GnFlushQueueAndWait(queue) == GnSuccess);
+
+        return ReadFirstPixel(device, &target);
+    };
+
+    // The second render pass begun with the same desc reuses the cached render pass and framebuffer
+    REQUIRE(draw(red_pipeline, green_pipeline) == 0xFF00FF00);
+    REQUIRE(draw(green_pipeline, red_pipeline) == 0xFF0000FF);
+
+    // Pipelines created after the render pass was cached keep drawing into it
+    GnPipeline second_red_pipeline;
+    REQUIRE(GnCreateGraphicsPipeline(device, &red_states.desc, &second_red_pipeline) == GnSuccess);
+    REQUIRE(draw(green_pipeline, second_red_pipeline) == 0xFF0000FF);
+
+    GnDestroyPipeline(device, second_red_pipeline);
+    GnDestroyPipeline(device, green_pipeline);
+    GnDestroyPipeline(device, red_pipeline);
+    GnDestroyCommandLists(device, command_pool, 1, &command_list);
+    GnDestroyCommandPool(device, command_pool);
+    DestroyReadbackTarget(device, &target);
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Pipeline deduplication", "[device]")
+{
+    // The test shaders are SPIR-V
+    if (g_test_backend != GnBackend_Vulkan)
+        return;
+
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+    GnSetDevicePipelineDeduplication(device, GN_TRUE);
+
+    FullscreenPipelineStates red_states, green_states;
+    InitFullscreenPipeline(&red_states, g_red_fs, sizeof(g_red_fs), GnFormat_RGBA8Unorm);
+    InitFullscreenPipeline(&green_states, g_green_fs, sizeof(g_green_fs), GnFormat_RGBA8Unorm);
+
+    // Same size and layout as the red shader, only the constant differs
+    REQUIRE(sizeof(g_red_fs) == sizeof(g_green_fs));
+
+    GnPipeline red_pipeline, shared_red_pipeline, green_pipeline;
+    GnPipelineDeduplicationStats stats{};
+
+    REQUIRE(GnCreateGraphicsPipeline(device, &red_states.desc, &red_pipeline) == GnSuccess);
+    REQUIRE(GnCreateGraphicsPipeline(device, &red_states.desc, &shared_red_pipeline) == GnSuccess);
+    REQUIRE(shared_red_pipeline == red_pipeline);
+
+    REQUIRE(GnCreateGraphicsPipeline(device, &green_states.desc, &green_pipeline) == GnSuccess);
+    REQUIRE(green_pipeline != red_pipeline);
+
+    GnGetPipelineDeduplicationStats(device, &stats);
+    REQUIRE(stats.num_hits == 1);
+    REQUIRE(stats.num_misses == 2);
+    REQUIRE(stats.num_pipelines == 2);
+
+    // The red pipeline stays shared until its last reference is released
+    GnDestroyPipeline(device, shared_red_pipeline);
+    GnGetPipelineDeduplicationStats(device, &stats);
+    REQUIRE(stats.num_pipelines == 2);
+
+    GnDestroyPipeline(device, red_pipeline);
+    GnGetPipelineDeduplicationStats(device, &stats);
+    REQUIRE(stats.num_pipelines == 1);
+
+    // Released pipelines are compiled again
+    REQUIRE(GnCreateGraphicsPipeline(device, &red_states.desc, &red_pipeline) == GnSuccess);
+    GnGetPipelineDeduplicationStats(device, &stats);
+    REQUIRE(stats.num_hits == 1);
+    REQUIRE(stats.num_misses == 3);
+    REQUIRE(stats.num_pipelines == 2);
+
+    GnDestroyPipeline(device, red_pipeline);
+    GnDestroyPipeline(device, green_pipeline);
+    GnGetPipelineDeduplicationStats(device, &stats);
+    REQUIRE(stats.num_pipelines == 0);
+
+    // Pipelines are keyed by the contents of their layout, not by its handle
+    GnShaderResource uniform_buffer{};
+    uniform_buffer.binding = 0;
+    uniform_buffer.resource_type = GnResourceType_UniformBuffer;
+    uniform_buffer.shader_visibility = GnShaderStage_FragmentShader;
+
+    GnPipelineLayoutDesc layout_desc{};
+    GnPipelineLayout empty_layout, uniform_layout;
+    REQUIRE(GnCreatePipelineLayout(device, &layout_desc, &empty_layout) == GnSuccess);
+
+    red_states.desc.layout = empty_layout;
+    REQUIRE(GnCreateGraphicsPipeline(device, &red_states.desc, &red_pipeline) == GnSuccess);
+    GnDestroyPipelineLayout(device, empty_layout);
+
+    layout_desc.num_resources = 1;
+    layout_desc.resources = &uniform_buffer;
+    REQUIRE(GnCreatePipelineLayout(device, &layout_desc, &uniform_layout) == GnSuccess);
+
+    red_states.desc.layout = uniform_layout;
+    REQUIRE(GnCreateGraphicsPipeline(device, &red_states.desc, &shared_red_pipeline) == GnSuccess);
+    REQUIRE(shared_red_pipeline != red_pipeline);
+
+    GnDestroyPipeline(device, shared_red_pipeline);
+    GnDestroyPipeline(device, red_pipeline);
+    GnDestroyPipelineLayout(device, uniform_layout);
+
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Batched pipeline creation", "[device]")
+{
+    // The test shaders are SPIR-V
+    if (g_test_backend != GnBackend_Vulkan)
+        return;
+
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    FullscreenPipelineStates red_states, green_states;
+    InitFullscreenPipeline(&red_states, g_red_fs, sizeof(g_red_fs), GnFormat_RGBA8Unorm);
+    InitFullscreenPipeline(&green_states, g_green_fs, sizeof(g_green_fs), GnFormat_RGBA8Unorm);
+
+    // More pipelines than the backend compiles in a single batch
+    constexpr uint32_t num_pipelines = 19;
+    std::vector<GnGraphicsPipelineDesc> descs(num_pipelines);
+    std::vector<GnPipeline> pipelines(num_pipelines);
+    std::vector<GnResult> results(num_pipelines, GnError_Unknown);
+
+    for (uint32_t i = 0; i < num_pipelines; i++)
+        descs[i] = (i % 2 == 0) ? red_states.desc : green_states.desc;
+
+    REQUIRE(GnCreateGraphicsPipelines(device, num_pipelines, descs.data(), pipelines.data(), results.data()) == GnSuccess);
+
+    for (uint32_t i = 0; i < num_pipelines; i++) {
+        REQUIRE(results[i] == GnSuccess);
+        REQUIRE(pipelines[i] != nullptr);
+        GnDestroyPipeline(device, pipelines[i]);
+    }
+
+    // results is optional
+    REQUIRE(GnCreateGraphicsPipelines(device, num_pipelines, descs.data(), pipelines.data(), nullptr) == GnSuccess);
+
+    for (uint32_t i = 0; i < num_pipelines; i++)
+        GnDestroyPipeline(device, pipelines[i]);
+
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Shader module cache", "[device]")
+{
+    // The test shaders are SPIR-V
+    if (g_test_backend != GnBackend_Vulkan)
+        return;
+
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    FullscreenPipelineStates red_states, green_states;
+    InitFullscreenPipeline(&red_states, g_red_fs, sizeof(g_red_fs), GnFormat_RGBA8Unorm);
+    InitFullscreenPipeline(&green_states, g_green_fs, sizeof(g_green_fs), GnFormat_RGBA8Unorm);
+
+    GnPipeline red_pipeline, green_pipeline;
+    GnShaderModuleCacheStats stats{};
+
+    // Both pipelines use the same vertex shader
+    REQUIRE(GnCreateGraphicsPipeline(device, &red_states.desc, &red_pipeline) == GnSuccess);
+    REQUIRE(GnCreateGraphicsPipeline(device, &green_states.desc, &green_pipeline) == GnSuccess);
+    GnGetShaderModuleCacheStats(device, &stats);
+
+    // Devices that pass the bytecode straight to the pipeline never create modules
+    if (stats.num_misses > 0) {
+        REQUIRE(stats.num_misses == 3);
+        REQUIRE(stats.num_hits == 1);
+        REQUIRE(stats.num_modules == 3);
+
+        // The vertex shader module is still referenced by the green pipeline
+        GnDestroyPipeline(device, red_pipeline);
+        GnGetShaderModuleCacheStats(device, &stats);
+        REQUIRE(stats.num_modules == 2);
+
+        // A new pipeline reuses the modules that are still alive and recreates the released one
+        REQUIRE(GnCreateGraphicsPipeline(device, &red_states.desc, &red_pipeline) == GnSuccess);
+        GnGetShaderModuleCacheStats(device, &stats);
+        REQUIRE(stats.num_misses == 4);
+        REQUIRE(stats.num_hits == 2);
+        REQUIRE(stats.num_modules == 3);
+
+        GnDestroyPipeline(device, red_pipeline);
+        GnDestroyPipeline(device, green_pipeline);
+        GnGetShaderModuleCacheStats(device, &stats);
+        REQUIRE(stats.num_modules == 0);
+    }
+    else {
+        REQUIRE(stats.num_hits == 0);
+        REQUIRE(stats.num_modules == 0);
+        GnDestroyPipeline(device, red_pipeline);
+        GnDestroyPipeline(device, green_pipeline);
+    }
+
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Async pipeline", "[device]")
+{
+    // The test shaders are SPIR-V
+    if (g_test_backend != GnBackend_Vulkan)
+        return;
+
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    uint32_t queue_group = GetDirectQueueGroup(adapter);
+    GnQueue queue = GnGetDeviceQueue(device, queue_group, 0);
+
+    ReadbackTarget target;
+    REQUIRE(CreateReadbackTarget(adapter, device, 4, 4, &target) == GnSuccess);
+
+    GnCommandPool command_pool;
+    GnCommandList command_list;
+    REQUIRE(CreateCommandList(device, queue_group, &command_pool, &command_list) == GnSuccess);
+
+    FullscreenPipelineStates red_states, green_states;
+    InitFullscreenPipeline(&red_states, g_red_fs, sizeof(g_red_fs), GnFormat_RGBA8Unorm);
+    InitFullscreenPipeline(&green_states, g_green_fs, sizeof(g_green_fs), GnFormat_RGBA8Unorm);
+
+    constexpr uint32_t black = 0xFF000000;
+    constexpr uint32_t red = 0xFF0000FF;
+    constexpr uint32_t green = 0xFF00FF00;
+
+    // Clears the target to black, draws a fullscreen triangle with pipeline and returns the first pixel.
+    // *status_after_bind is the status of the pipeline right after it was bound.
+    auto draw = [&](GnPipeline pipeline, GnResult* status_after_bind) {
+        REQUIRE(GnResetCommandPool(device, command_pool) == GnSuccess);
+
+        GnCommandListBeginDesc begin_desc{};
+        begin_desc.flags = GnCommandListBegin_OneTimeSubmit;
+        REQUIRE(GnBeginCommandList(command_list, &begin_desc) == GnSuccess);
+
+        GnTextureBarrier texture_barrier{};
+        texture_barrier.texture = target.texture;
+        texture_barrier.subresource_range.aspect = GnTextureAspect_Color;
+        texture_barrier.subresource_range.num_mip_levels = 1;
+        texture_barrier.subresource_range.num_array_layers = 1;
+        texture_barrier.prev_access = GnResourceAccess_Undefined;
+        texture_barrier.next_access = GnResourceAccess_ColorTargetWrite;
+        GnCmdTextureBarrier(command_list, 1, &texture_barrier);
+
+        GnRenderPassColorTargetDesc color_target{};
+        color_target.view = target.view;
+        color_target.access = GnResourceAccess_ColorTargetWrite;
+        color_target.load_op = GnRenderPassOp_Clear;
+        color_target.store_op = GnRenderPassOp_Store;
+        color_target.clear_value.float32[3] = 1.0f;
+
+        GnRenderPassBeginDesc render_pass_desc{};
+        render_pass_desc.sample_count = GnSampleCount_X1;
+        render_pass_desc.width = 4;
+        render_pass_desc.height = 4;
+        render_pass_desc.num_color_targets = 1;
+        render_pass_desc.color_targets = &color_target;
+
+        GnCmdBeginRenderPass(command_list, &render_pass_desc);
+        GnCmdSetGraphicsPipeline(command_list, pipeline);
+        *status_after_bind = GnGetPipelineStatus(pipeline);
+        GnCmdSetViewport(command_list, 0, 0.0f, 0.0f, 4.0f, 4.0f, 0.0f, 1.0f);
+        GnCmdSetScissor(command_list, 0, 0, 0, 4, 4);
+        GnCmdDraw(command_list, 3, 0);
+        GnCmdEndRenderPass(command_list);
+        CmdReadBack(command_list, &target);
+        REQUIRE(GnEndCommandList(command_list) == GnSuccess);
+
+        REQUIRE(GnEnqueueCommandLists(queue, 1, &command_list) == GnSuccess);
+        REQUIRE(GnFlushQueueAndWait(queue) == GnSuccess);
+
+        return ReadFirstPixel(device, &target);
+    };
+
+    GnPipeline red_pipeline;
+    GnResult status;
+    REQUIRE(GnCreateGraphicsPipeline(device, &red_states.desc, &red_pipeline) == GnSuccess);
+    REQUIRE(draw(red_pipeline, &status) == red);
+    REQUIRE(status == GnSuccess);
+
+    GnPipeline green_pipeline, skipped_pipeline;
+    REQUIRE(GnCreateGraphicsPipelineAsync(device, &green_states.desc, red_pipeline, &green_pipeline) == GnSuccess);
+    REQUIRE(GnCreateGraphicsPipelineAsync(device, &green_states.desc, nullptr, &skipped_pipeline) == GnSuccess);
+
+    // Compilation may finish at any time, a pipeline still not ready after the bind was not ready when it was bound
+    uint32_t pixel = draw(green_pipeline, &status);
+
+    if (status == GnNotReady)
+        REQUIRE(pixel == red); // Drawn with the fallback
+    else
+        REQUIRE((pixel == red || pixel == green));
+
+    pixel = draw(skipped_pipeline, &status);
+
+    if (status == GnNotReady)
+        REQUIRE(pixel == black); // No fallback, the draw was skipped
+    else
+        REQUIRE((pixel == black || pixel == green));
+
+    while (GnGetPipelineStatus(green_pipeline) == GnNotReady || GnGetPipelineStatus(skipped_pipeline) == GnNotReady)
+        std::this_thread::yield();
+
+    REQUIRE(GnGetPipelineStatus(green_pipeline) == GnSuccess);
+    REQUIRE(GnGetPipelineStatus(skipped_pipeline) == GnSuccess);
+    REQUIRE(draw(green_pipeline, &status) == green);
+    REQUIRE(draw(skipped_pipeline, &status) == green);
+
+    GnDestroyPipeline(device, green_pipeline);
+    GnDestroyPipeline(device, skipped_pipeline);
+    GnDestroyPipeline(device, red_pipeline);
+    GnDestroyCommandLists(device, command_pool, 1, &command_list);
+    GnDestroyCommandPool(device, command_pool);
+    DestroyReadbackTarget(device, &target);
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Transient texture memory", "[device]")
+{
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    uint32_t queue_group = GetDirectQueueGroup(adapter);
+    GnQueue queue = GnGetDeviceQueue(device, queue_group, 0);
+
+    GnTextureDesc texture_desc{};
+    texture_desc.usage = GnTextureUsage_ColorTarget | GnTextureUsage_Transient;
+    texture_desc.type = GnTextureType_2D;
+    texture_desc.format = GnFormat_RGBA8Unorm;
+    texture_desc.width = 4;
+    texture_desc.height = 4;
+    texture_desc.depth = 1;
+    texture_desc.mip_levels = 1;
+    texture_desc.array_layers = 1;
+    texture_desc.samples = GnSampleCount_X1;
+
+    GnTexture texture;
+
+    // Transient contents can't be copied out of the render pass
+    GnTextureDesc invalid_desc = texture_desc;
+    invalid_desc.usage |= GnTextureUsage_CopySrc;
+    REQUIRE(GnCreateTexture(device, &invalid_desc, &texture) == GnError_InvalidArgs);
+
+    REQUIRE(GnCreateTexture(device, &texture_desc, &texture) == GnSuccess);
+
+    GnMemoryRequirements requirements{};
+    GnGetTextureMemoryRequirements(device, texture, &requirements);
+
+    GnMemoryProperties memory_properties{};
+    GnGetAdapterMemoryProperties(adapter, &memory_properties);
+
+    // A lazily allocated type is expected whenever the texture allows one, preferably one with the preferred flags
+    constexpr GnMemoryAttributeFlags preferred_flags = GnMemoryAttribute_DeviceLocal;
+    uint32_t first_lazy_type = GN_INVALID;
+    uint32_t first_preferred_lazy_type = GN_INVALID;
+
+    for (uint32_t i = 0; i < memory_properties.num_memory_types; i++) {
+        GnMemoryAttributeFlags attribute = memory_properties.memory_types[i].attribute;
+
+        if ((requirements.supported_memory_type_bits & (1 << i)) == 0 || (attribute & GnMemoryAttribute_LazilyAllocated) == 0)
+            continue;
+
+        if (first_lazy_type == GN_INVALID)
+            first_lazy_type = i;
+
+        if (first_preferred_lazy_type == GN_INVALID && (attribute & preferred_flags) == preferred_flags)
+            first_preferred_lazy_type = i;
+    }
+
+    uint32_t memory_type = GnFindSupportedMemoryType(adapter, requirements.supported_memory_type_bits, preferred_flags, GnMemoryAttribute_DeviceLocal, 0);
+    REQUIRE(memory_type != GN_INVALID);
+
+    if (first_preferred_lazy_type != GN_INVALID)
+        REQUIRE(memory_type == first_preferred_lazy_type);
+    else if (first_lazy_type != GN_INVALID)
+        REQUIRE(memory_type == first_lazy_type);
+
+    GnMemoryDesc memory_desc{};
+    memory_desc.size = requirements.size;
+    memory_desc.memory_type_index = memory_type;
+
+    GnMemory memory;
+    REQUIRE(GnCreateMemory(device, &memory_desc, &memory) == GnSuccess);
+    REQUIRE(GnBindTextureMemory(device, texture, memory, 0) == GnSuccess);
+
+    GnTextureViewDesc view_desc{};
+    view_desc.texture = texture;
+    view_desc.type = GnTextureViewType_2D;
+    view_desc.format = GnFormat_RGBA8Unorm;
+    view_desc.subresource_range.aspect = GnTextureAspect_Color;
+    view_desc.subresource_range.num_mip_levels = 1;
+    view_desc.subresource_range.num_array_layers = 1;
+
+    GnTextureView view;
+    REQUIRE(GnCreateTextureView(device, &view_desc, &view) == GnSuccess);
+
+    GnCommandPool command_pool;
+    GnCommandList command_list;
+    REQUIRE(CreateCommandList(device, queue_group, &command_pool, &command_list) == GnSuccess);
+
+    // The texture is only ever cleared and discarded inside a render pass
+    REQUIRE(GnBeginCommandList(command_list, nullptr) == GnSuccess);
+
+    GnTextureBarrier texture_barrier{};
+    texture_barrier.texture = texture;
+    texture_barrier.subresource_range.aspect = GnTextureAspect_Color;
+    texture_barrier.subresource_range.num_mip_levels = 1;
+    texture_barrier.subresource_range.num_array_layers = 1;
+    texture_barrier.prev_access = GnResourceAccess_Undefined;
+    texture_barrier.next_access = GnResourceAccess_ColorTargetWrite;
+    GnCmdTextureBarrier(command_list, 1, &texture_barrier);
+
+    GnRenderPassColorTargetDesc color_target{};
+    color_target.view = view;
+    color_target.access = GnResourceAccess_ColorTargetWrite;
+    color_target.load_op = GnRenderPassOp_Clear;
+    color_target.store_op = GnRenderPassOp_Discard;
+
+    GnRenderPassBeginDesc render_pass_desc{};
+    render_pass_desc.sample_count = GnSampleCount_X1;
+    render_pass_desc.width = 4;
+    render_pass_desc.height = 4;
+    render_pass_desc.num_color_targets = 1;
+    render_pass_desc.color_targets = &color_target;
+
+    GnCmdBeginRenderPass(command_list, &render_pass_desc);
+    GnCmdEndRenderPass(command_list);
+    REQUIRE(GnEndCommandList(command_list) == GnSuccess);
+
+    REQUIRE(GnEnqueueCommandLists(queue, 1, &command_list) == GnSuccess);
+    REQUIRE(GnFlushQueueAndWait(queue) == GnSuccess);
+
+    GnDestroyCommandLists(device, command_pool, 1, &command_list);
+    GnDestroyCommandPool(device, command_pool);
+    GnDestroyTextureView(device, view);
+    GnDestroyTexture(device, texture);
+    GnDestroyMemory(device, memory);
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Render graph", "[device]")
+{
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    GnBufferDesc buffer_desc{};
+    buffer_desc.size = 1024;
+    buffer_desc.usage = GnBufferUsage_Storage;
+
+    GnBuffer output_buffer;
+    REQUIRE(GnCreateBuffer(device, &buffer_desc, &output_buffer) == GnSuccess);
+
+    GnRenderGraph render_graph;
+    REQUIRE(GnCreateRenderGraph(device, nullptr, &render_graph) == GnSuccess);
+
+    GnRenderGraphResource output, intermediate, unused;
+    REQUIRE(GnRenderGraphImportBuffer(render_graph, output_buffer, GnResourceAccess_Undefined, GnResourceAccess_CSRead, &output) == GnSuccess);
+    REQUIRE(GnRenderGraphCreateBuffer(render_graph, &buffer_desc, &intermediate) == GnSuccess);
+    REQUIRE(GnRenderGraphCreateBuffer(render_graph, &buffer_desc, &unused) == GnSuccess);
+
+    GnRenderGraphResourceAccess producer_accesses[] = { { intermediate, GnResourceAccess_CSWrite } };
+    GnRenderGraphResourceAccess consumer_accesses[] = { { intermediate, GnResourceAccess_CSRead }, { output, GnResourceAccess_CSWrite } };
+    GnRenderGraphResourceAccess unused_accesses[] = { { unused, GnResourceAccess_CSWrite } };
+
+    GnRenderGraphPassDesc pass_desc{};
+    pass_desc.num_accesses = 1;
+    pass_desc.accesses = producer_accesses;
+    REQUIRE(GnRenderGraphAddPass(render_graph, &pass_desc) == GnSuccess);
+
+    pass_desc.num_accesses = 2;
+    pass_desc.accesses = consumer_accesses;
+    REQUIRE(GnRenderGraphAddPass(render_graph, &pass_desc) == GnSuccess);
+
+    pass_desc.num_accesses = 1;
+    pass_desc.accesses = unused_accesses;
+    REQUIRE(GnRenderGraphAddPass(render_graph, &pass_desc) == GnSuccess);
+
+    REQUIRE(GnCompileRenderGraph(device, render_graph) == GnSuccess);
+    REQUIRE(GnGetRenderGraphBuffer(render_graph, output) == output_buffer);
+    REQUIRE(GnGetRenderGraphBuffer(render_graph, intermediate) != nullptr);
+    REQUIRE(GnGetRenderGraphBuffer(render_graph, unused) == nullptr); // Only written by a culled pass
+
+    GnRenderGraphPassInfo pass_info;
+    REQUIRE(GnGetRenderGraphPassInfo(render_graph, 0, &pass_info) == GnSuccess);
+    REQUIRE(pass_info.execution_position == 0);
+    // The previous execution of the graph may still read the buffer
+    REQUIRE(pass_info.num_buffer_barriers == 1);
+    REQUIRE(pass_info.buffer_barriers[0].buffer == GnGetRenderGraphBuffer(render_graph, intermediate));
+    REQUIRE(pass_info.buffer_barriers[0].prev_access == (GnResourceAccess_Discard | GnResourceAccess_CSRead));
+    REQUIRE(pass_info.buffer_barriers[0].next_access == GnResourceAccess_CSWrite);
+
+    REQUIRE(GnGetRenderGraphPassInfo(render_graph, 1, &pass_info) == GnSuccess);
+    REQUIRE(pass_info.execution_position == 1);
+    REQUIRE(pass_info.num_buffer_barriers == 2);
+    REQUIRE(pass_info.buffer_barriers[0].buffer == GnGetRenderGraphBuffer(render_graph, intermediate));
+    REQUIRE(pass_info.buffer_barriers[0].prev_access == GnResourceAccess_CSWrite);
+    REQUIRE(pass_info.buffer_barriers[0].next_access == GnResourceAccess_CSRead);
+    REQUIRE(pass_info.buffer_barriers[1].buffer == output_buffer);
+    REQUIRE(pass_info.buffer_barriers[1].prev_access == GnResourceAccess_Undefined);
+    REQUIRE(pass_info.buffer_barriers[1].next_access == GnResourceAccess_CSWrite);
+
+    REQUIRE(GnGetRenderGraphPassInfo(render_graph, 2, &pass_info) == GnSuccess);
+    REQUIRE(pass_info.execution_position == GN_INVALID);
+
+    // first_a and first_b are alive at the same time, second only once both are dead and covers both of them
+    GnResetRenderGraph(device, render_graph);
+
+    GnBufferDesc large_buffer_desc = buffer_desc;
+    large_buffer_desc.size = 4 * buffer_desc.size;
+
+    GnRenderGraphResource first_a, first_b, second;
+    REQUIRE(GnRenderGraphImportBuffer(render_graph, output_buffer, GnResourceAccess_Undefined, GnResourceAccess_CSRead, &output) == GnSuccess);
+    REQUIRE(GnRenderGraphCreateBuffer(render_graph, &buffer_desc, &first_a) == GnSuccess);
+    REQUIRE(GnRenderGraphCreateBuffer(render_graph, &buffer_desc, &first_b) == GnSuccess);
+    REQUIRE(GnRenderGraphCreateBuffer(render_graph, &large_buffer_desc, &second) == GnSuccess);
+
+    GnRenderGraphResourceAccess first_write_accesses[] = { { first_a, GnResourceAccess_CSWrite }, { first_b, GnResourceAccess_CSWrite } };
+    GnRenderGraphResourceAccess first_read_accesses[] = { { first_a, GnResourceAccess_CSRead }, { first_b, GnResourceAccess_VSRead }, { output, GnResourceAccess_CSWrite } };
+    GnRenderGraphResourceAccess second_write_accesses[] = { { second, GnResourceAccess_CSWrite } };
+    GnRenderGraphResourceAccess second_read_accesses[] = { { second, GnResourceAccess_CSRead }, { output, GnResourceAccess_CSWrite } };
+
+    pass_desc.num_accesses = 2;
+    pass_desc.accesses = first_write_accesses;
+    REQUIRE(GnRenderGraphAddPass(render_graph, &pass_desc) == GnSuccess);
+
+    pass_desc.num_accesses = 3;
+    pass_desc.accesses = first_read_accesses;
+    REQUIRE(GnRenderGraphAddPass(render_graph, &pass_desc) == GnSuccess);
+
+    pass_desc.num_accesses = 1;
+    pass_desc.accesses = second_write_accesses;
+    REQUIRE(GnRenderGraphAddPass(render_graph, &pass_desc) == GnSuccess);
+
+    pass_desc.num_accesses = 2;
+    pass_desc.accesses = second_read_accesses;
+    REQUIRE(GnRenderGraphAddPass(render_graph, &pass_desc) == GnSuccess);
+
+    REQUIRE(GnCompileRenderGraph(device, render_graph) == GnSuccess);
+
+    // The second pass writes nothing the first ones read, it still runs after them in declaration order
+    for (uint32_t i = 0; i < 4; i++) {
+        REQUIRE(GnGetRenderGraphPassInfo(render_graph, i, &pass_info) == GnSuccess);
+        REQUIRE(pass_info.execution_position == i);
+    }
+
+    GnDeviceSize first_a_offset, first_b_offset, second_offset;
+    GnMemory first_a_memory = GnGetRenderGraphResourceMemory(render_graph, first_a, &first_a_offset);
+    GnMemory first_b_memory = GnGetRenderGraphResourceMemory(render_graph, first_b, &first_b_offset);
+    GnMemory second_memory = GnGetRenderGraphResourceMemory(render_graph, second, &second_offset);
+
+    REQUIRE(first_a_memory != nullptr);
+    REQUIRE(first_a_memory == second_memory);
+    REQUIRE(first_a_offset == second_offset);
+    REQUIRE(first_b_memory == second_memory);
+    REQUIRE(first_b_offset != first_a_offset);
+    REQUIRE(GnGetRenderGraphResourceMemory(render_graph, output, &second_offset) == nullptr);
+
+    // Both first buffers wait for second, the last occupant of their memory in the previous execution
+    REQUIRE(GnGetRenderGraphPassInfo(render_graph, 0, &pass_info) == GnSuccess);
+    REQUIRE(pass_info.num_buffer_barriers == 2);
+    REQUIRE(pass_info.buffer_barriers[0].buffer == GnGetRenderGraphBuffer(render_graph, first_a));
+    REQUIRE(pass_info.buffer_barriers[0].prev_access == (GnResourceAccess_Discard | GnResourceAccess_CSRead));
+    REQUIRE(pass_info.buffer_barriers[1].buffer == GnGetRenderGraphBuffer(render_graph, first_b));
+    REQUIRE(pass_info.buffer_barriers[1].prev_access == (GnResourceAccess_Discard | GnResourceAccess_CSRead | GnResourceAccess_VSRead));
+
+    // second has to wait for the last accesses of both buffers it replaces
+    REQUIRE(GnGetRenderGraphPassInfo(render_graph, 2, &pass_info) == GnSuccess);
+    REQUIRE(pass_info.num_buffer_barriers == 1);
+    REQUIRE(pass_info.buffer_barriers[0].buffer == GnGetRenderGraphBuffer(render_graph, second));
+    REQUIRE(pass_info.buffer_barriers[0].prev_access == (GnResourceAccess_Discard | GnResourceAccess_CSRead | GnResourceAccess_VSRead));
+    REQUIRE(pass_info.buffer_barriers[0].next_access == GnResourceAccess_CSWrite);
+
+    GnDestroyRenderGraph(device, render_graph);
+    GnDestroyBuffer(device, output_buffer);
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Render graph subpass merging", "[device]")
+{
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    GnTextureDesc texture_desc{};
+    texture_desc.usage = GnTextureUsage_ColorTarget | GnTextureUsage_InputAttachment;
+    texture_desc.type = GnTextureType_2D;
+    texture_desc.format = GnFormat_RGBA8Unorm;
+    texture_desc.width = 64;
+    texture_desc.height = 64;
+    texture_desc.depth = 1;
+    texture_desc.mip_levels = 1;
+    texture_desc.array_layers = 1;
+    texture_desc.samples = GnSampleCount_X1;
+
+    GnTexture output_texture;
+    REQUIRE(GnCreateTexture(device, &texture_desc, &output_texture) == GnSuccess);
+
+    GnRenderGraph render_graph;
+    REQUIRE(GnCreateRenderGraph(device, nullptr, &render_graph) == GnSuccess);
+
+    GnRenderGraphResource output, gbuffer;
+    REQUIRE(GnRenderGraphImportTexture(render_graph, output_texture, GnResourceAccess_Undefined, GnResourceAccess_FSRead, &output) == GnSuccess);
+    REQUIRE(GnRenderGraphCreateTexture(render_graph, &texture_desc, &gbuffer) == GnSuccess);
+
+    GnRenderGraphColorTargetDesc gbuffer_target{};
+    gbuffer_target.resource = gbuffer;
+    gbuffer_target.load_op = GnRenderPassOp_Clear;
+    gbuffer_target.store_op = GnRenderPassOp_Store;
+
+    GnRenderGraphColorTargetDesc output_target = gbuffer_target;
+    output_target.resource = output;
+
+    GnRenderGraphRenderPassDesc geometry_render_pass{};
+    geometry_render_pass.num_color_targets = 1;
+    geometry_render_pass.color_targets = &gbuffer_target;
+
+    GnRenderGraphRenderPassDesc lighting_render_pass{};
+    lighting_render_pass.num_color_targets = 1;
+    lighting_render_pass.color_targets = &output_target;
+    lighting_render_pass.num_input_targets = 1;
+    lighting_render_pass.input_targets = &gbuffer;
+
+    GnRenderGraphPassDesc pass_desc{};
+    pass_desc.render_pass = &geometry_render_pass;
+    REQUIRE(GnRenderGraphAddPass(render_graph, &pass_desc) == GnSuccess);
+
+    pass_desc.render_pass = &lighting_render_pass;
+    REQUIRE(GnRenderGraphAddPass(render_graph, &pass_desc) == GnSuccess);
+
+    GnRenderGraphPassLayout layout;
+    REQUIRE(GnCompileRenderGraph(device, render_graph) == GnSuccess);
+    REQUIRE(GnGetRenderGraphPassLayout(render_graph, 1, &layout) == GnSuccess);
+    REQUIRE(layout.num_color_targets == 2);
+    REQUIRE(layout.num_subpasses == 2);
+    REQUIRE(layout.subpass == 1);
+
+    GnSetRenderGraphSubpassMerging(render_graph, GN_FALSE);
+    REQUIRE(GnCompileRenderGraph(device, render_graph) == GnSuccess);
+    REQUIRE(GnGetRenderGraphPassLayout(render_graph, 1, &layout) == GnSuccess);
+    REQUIRE(layout.num_subpasses == 1);
+    REQUIRE(layout.subpass == 0);
+
+    GnDestroyRenderGraph(device, render_graph);
+    GnDestroyTexture(device, output_texture);
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Render graph subpass merging readback", "[device]")
+{
+    // The test shaders are SPIR-V
+    if (g_test_backend != GnBackend_Vulkan)
+        return;
+
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    uint32_t queue_group = GetDirectQueueGroup(adapter);
+    GnQueue queue = GnGetDeviceQueue(device, queue_group, 0);
+
+    ReadbackTarget target;
+    REQUIRE(CreateReadbackTarget(adapter, device, 4, 4, &target) == GnSuccess);
+
+    GnCommandPool command_pool;
+    GnCommandList command_list;
+    REQUIRE(CreateCommandList(device, queue_group, &command_pool, &command_list) == GnSuccess);
+
+    GnDescriptorTableBinding binding{};
+    binding.binding = 0;
+    binding.type = GnResourceType_InputAttachment;
+    binding.num_resources = 1;
+    binding.shader_visibility = GnShaderStage_FragmentShader;
+
+    GnDescriptorTableLayoutDesc table_layout_desc{};
+    table_layout_desc.num_bindings = 1;
+    table_layout_desc.bindings = &binding;
+
+    GnDescriptorTableLayout table_layout;
+    REQUIRE(GnCreateDescriptorTableLayout(device, &table_layout_desc, &table_layout) == GnSuccess);
+
+    GnPipelineLayoutDesc pipeline_layout_desc{};
+    pipeline_layout_desc.num_descriptor_tables = 1;
+    pipeline_layout_desc.descriptor_tables = &table_layout;
+
+    GnPipelineLayout pipeline_layout;
+    REQUIRE(GnCreatePipelineLayout(device, &pipeline_layout_desc, &pipeline_layout) == GnSuccess);
+
+    GnDescriptorPoolDesc pool_desc{};
+    pool_desc.type = GnDescriptorTableType_Resource;
+    pool_desc.mode = GnDescriptorPoolMode_Persistent;
+    pool_desc.max_descriptor_tables = 1;
+    pool_desc.pool_limits.max_input_attachments = 1;
+
+    GnDescriptorPool descriptor_pool;
+    GnDescriptorTable descriptor_table;
+    REQUIRE(GnCreateDescriptorPool(device, &pool_desc, &descriptor_pool) == GnSuccess);
+    REQUIRE(GnAllocateDescriptorTables(device, descriptor_pool, 1, &table_layout, &descriptor_table) == GnSuccess);
+
+    GnTextureDesc gbuffer_desc{};
+    gbuffer_desc.usage = GnTextureUsage_ColorTarget | GnTextureUsage_InputAttachment;
+    gbuffer_desc.type = GnTextureType_2D;
+    gbuffer_desc.format = GnFormat_RGBA8Unorm;
+    gbuffer_desc.width = 4;
+    gbuffer_desc.height = 4;
+    gbuffer_desc.depth = 1;
+    gbuffer_desc.mip_levels = 1;
+    gbuffer_desc.array_layers = 1;
+    gbuffer_desc.samples = GnSampleCount_X1;
+
+    GnRenderGraph render_graph;
+    REQUIRE(GnCreateRenderGraph(device, nullptr, &render_graph) == GnSuccess);
+
+    GnRenderGraphResource output, gbuffer;
+    REQUIRE(GnRenderGraphImportTexture(render_graph, target.texture, GnResourceAccess_Undefined, GnResourceAccess_ColorTargetWrite, &output) == GnSuccess);
+    REQUIRE(GnRenderGraphCreateTexture(render_graph, &gbuffer_desc, &gbuffer) == GnSuccess);
+
+    GnRenderGraphColorTargetDesc gbuffer_target{};
+    gbuffer_target.resource = gbuffer;
+    gbuffer_target.load_op = GnRenderPassOp_Clear;
+    gbuffer_target.store_op = GnRenderPassOp_Store;
+
+    GnRenderGraphColorTargetDesc output_target = gbuffer_target;
+    output_target.resource = output;
+
+    GnRenderGraphRenderPassDesc geometry_render_pass{};
+    geometry_render_pass.num_color_targets = 1;
+    geometry_render_pass.color_targets = &gbuffer_target;
+
+    GnRenderGraphRenderPassDesc lighting_render_pass{};
+    lighting_render_pass.num_color_targets = 1;
+    lighting_render_pass.color_targets = &output_target;
+    lighting_render_pass.num_input_targets = 1;
+    lighting_render_pass.input_targets = &gbuffer;
+
+    FullscreenPassData geometry_data{};
+    geometry_data.width = 4;
+    geometry_data.height = 4;
+
+    FullscreenPassData lighting_data = geometry_data;
+    lighting_data.pipeline_layout = pipeline_layout;
+    lighting_data.descriptor_table = descriptor_table;
+
+    GnRenderGraphPassDesc pass_desc{};
+    pass_desc.execute_fn = DrawFullscreenPass;
+    pass_desc.userdata = &geometry_data;
+    pass_desc.render_pass = &geometry_render_pass;
+    REQUIRE(GnRenderGraphAddPass(render_graph, &pass_desc) == GnSuccess);
+
+    pass_desc.userdata = &lighting_data;
+    pass_desc.render_pass = &lighting_render_pass;
+    REQUIRE(GnRenderGraphAddPass(render_graph, &pass_desc) == GnSuccess);
+
+    // The geometry pass writes red into the gbuffer, the lighting pass copies it into the output through an input
+    // attachment. Returns the first pixel of the output.
+    auto render = [&](GnBool merge_subpasses, uint32_t* num_subpasses) {
+        GnSetRenderGraphSubpassMerging(render_graph, merge_subpasses);
+        REQUIRE(GnCompileRenderGraph(device, render_graph) == GnSuccess);
+
+        GnRenderGraphPassLayout geometry_layout, lighting_layout;
+        REQUIRE(GnGetRenderGraphPassLayout(render_graph, 0, &geometry_layout) == GnSuccess);
+        REQUIRE(GnGetRenderGraphPassLayout(render_graph, 1, &lighting_layout) == GnSuccess);
+        *num_subpasses = lighting_layout.num_subpasses;
+
+        FullscreenPipelineStates geometry_states, lighting_states;
+        InitFullscreenPipeline(&geometry_states, g_red_fs, sizeof(g_red_fs), GnFormat_RGBA8Unorm);
+        InitFullscreenPipeline(&lighting_states, g_copy_input_fs, sizeof(g_copy_input_fs), GnFormat_RGBA8Unorm);
+
+        const GnRenderGraphPassLayout* layouts[] = { &geometry_layout, &lighting_layout };
+        FullscreenPipelineStates* states[] = { &geometry_states, &lighting_states };
+
+        for (uint32_t i = 0; i < 2; i++) {
+            states[i]->fragment_interface.num_color_targets = layouts[i]->num_color_targets;
+            states[i]->fragment_interface.color_target_formats = (GnFormat*)layouts[i]->color_target_formats;
+            states[i]->desc.num_subpasses = layouts[i]->num_subpasses;
+            states[i]->desc.subpasses = layouts[i]->subpasses;
+            states[i]->desc.subpass = layouts[i]->subpass;
+        }
+
+        lighting_states.desc.layout = pipeline_layout;
+
+        REQUIRE(GnCreateGraphicsPipeline(device, &geometry_states.desc, &geometry_data.pipeline) == GnSuccess);
+        REQUIRE(GnCreateGraphicsPipeline(device, &lighting_states.desc, &lighting_data.pipeline) == GnSuccess);
+
+        GnTextureViewDesc view_desc{};
+        view_desc.texture = GnGetRenderGraphTexture(render_graph, gbuffer);
+        view_desc.type = GnTextureViewType_2D;
+        view_desc.format = GnFormat_RGBA8Unorm;
+        view_desc.subresource_range.aspect = GnTextureAspect_Color;
+        view_desc.subresource_range.num_mip_levels = 1;
+        view_desc.subresource_range.num_array_layers = 1;
+
+        GnTextureView gbuffer_view;
+        REQUIRE(GnCreateTextureView(device, &view_desc, &gbuffer_view) == GnSuccess);
+
+        GnDescriptorInfo descriptor{};
+        descriptor.texture_view = gbuffer_view;
+        REQUIRE(GnWriteDescriptorTable(device, descriptor_table, &descriptor) == GnSuccess);
+
+        REQUIRE(GnResetCommandPool(device, command_pool) == GnSuccess);
+
+        GnCommandListBeginDesc begin_desc{};
+        begin_desc.flags = GnCommandListBegin_OneTimeSubmit;
+        REQUIRE(GnBeginCommandList(command_list, &begin_desc) == GnSuccess);
+        GnExecuteRenderGraph(command_list, render_graph);
+        CmdReadBack(command_list, &target);
+        REQUIRE(GnEndCommandList(command_list) == GnSuccess);
+
+        REQUIRE(GnEnqueueCommandLists(queue, 1, &command_list) == GnSuccess);
+        REQUIRE(GnFlushQueueAndWait(queue) == GnSuccess);
+
+        GnDestroyTextureView(device, gbuffer_view);
+        GnDestroyPipeline(device, geometry_data.pipeline);
+        GnDestroyPipeline(device, lighting_data.pipeline);
+
+        return ReadFirstPixel(device, &target);
+    };
+
+    constexpr uint32_t red = 0xFF0000FF;
+    uint32_t merged_num_subpasses, unmerged_num_subpasses;
+
+    uint32_t merged_pixel = render(GN_TRUE, &merged_num_subpasses);
+    uint32_t unmerged_pixel = render(GN_FALSE, &unmerged_num_subpasses);
+
+    REQUIRE(merged_num_subpasses == 2);
+    REQUIRE(unmerged_num_subpasses == 1);
+    REQUIRE(merged_pixel == red);
+    REQUIRE(merged_pixel == unmerged_pixel);
+
+    GnDestroyRenderGraph(device, render_graph);
+    GnDestroyDescriptorPool(device, descriptor_pool);
+    GnDestroyPipelineLayout(device, pipeline_layout);
+    GnDestroyDescriptorTableLayout(device, table_layout);
+    GnDestroyCommandLists(device, command_pool, 1, &command_list);
+    GnDestroyCommandPool(device, command_pool);
+    DestroyReadbackTarget(device, &target);
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Bindless indices", "[device]")
+{
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    if (!GnIsAdapterFeaturePresent(adapter, GnFeature_Bindless)) {
+        GnDestroyInstance(instance);
+        return;
+    }
+
+    GnFeature bindless_feature = GnFeature_Bindless;
+
+    GnDeviceDesc device_desc{};
+    device_desc.num_enabled_features = 1;
+    device_desc.enabled_features = &bindless_feature;
+    device_desc.max_bindless_buffers = 2;
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, &device_desc, &device) == GnSuccess);
+
+    GnBufferDesc buffer_desc{};
+    buffer_desc.size = 256;
+    buffer_desc.usage = GnBufferUsage_Storage;
+
+    GnBuffer buffers[3];
+    for (GnBuffer& buffer : buffers)
+        REQUIRE(GnCreateBuffer(device, &buffer_desc, &buffer) == GnSuccess);
+
+    uint32_t first_index = GnGetBufferBindlessIndex(buffers[0]);
+    REQUIRE(first_index != GN_INVALID);
+    REQUIRE(GnGetBufferBindlessIndex(buffers[1]) != GN_INVALID);
+    REQUIRE(GnGetBufferBindlessIndex(buffers[1]) != first_index);
+    REQUIRE(GnGetBufferBindlessIndex(buffers[2]) == GN_INVALID); // The heap is full
+
+    // Freed indices are handed out again
+    GnDestroyBuffer(device, buffers[0]);
+    REQUIRE(GnCreateBuffer(device, &buffer_desc, &buffers[0]) == GnSuccess);
+    REQUIRE(GnGetBufferBindlessIndex(buffers[0]) == first_index);
+
+    for (GnBuffer buffer : buffers)
+        GnDestroyBuffer(device, buffer);
+
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Descriptor pool", "[device]")
+{
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    GnDescriptorTableBinding binding{};
+    binding.binding = 0;
+    binding.type = GnResourceType_StorageBuffer;
+    binding.num_resources = 1;
+    binding.shader_visibility = GnShaderStage_ComputeShader;
+
+    GnDescriptorTableLayoutDesc layout_desc{};
+    layout_desc.num_bindings = 1;
+    layout_desc.bindings = &binding;
+
+    GnDescriptorTableLayout layout;
+    REQUIRE(GnCreateDescriptorTableLayout(device, &layout_desc, &layout) == GnSuccess);
+
+    GnDescriptorPoolDesc pool_desc{};
+    pool_desc.type = GnDescriptorTableType_Resource;
+    pool_desc.max_descriptor_tables = 2;
+    pool_desc.pool_limits.max_storage_buffers = 2;
+
+    GnDescriptorTableLayout layouts[] = { layout, layout };
+    GnDescriptorTable tables[2];
+
+    SECTION("Persistent")
+    {
+        pool_desc.mode = GnDescriptorPoolMode_Persistent;
+
+        GnDescriptorPool pool;
+        REQUIRE(GnCreateDescriptorPool(device, &pool_desc, &pool) == GnSuccess);
+        REQUIRE(GnAllocateDescriptorTables(device, pool, 2, layouts, tables) == GnSuccess);
+        REQUIRE(tables[0] != tables[1]);
+
+        GnFreeDescriptorTables(device, pool, 1, &tables[0]);
+        REQUIRE(GnAllocateDescriptorTables(device, pool, 1, layouts, &tables[0]) == GnSuccess);
+
+        GnDestroyDescriptorPool(device, pool);
+    }
+
+    SECTION("Linear")
+    {
+        pool_desc.mode = GnDescriptorPoolMode_Linear;
+
+        GnDescriptorPool pool;
+        REQUIRE(GnCreateDescriptorPool(device, &pool_desc, &pool) == GnSuccess);
+        REQUIRE(GnAllocateDescriptorTables(device, pool, 2, layouts, tables) == GnSuccess);
+        REQUIRE(GnAllocateDescriptorTables(device, pool, 1, layouts, tables) != GnSuccess);
+
+        REQUIRE(GnResetDescriptorPool(device, pool) == GnSuccess);
+        REQUIRE(GnAllocateDescriptorTables(device, pool, 2, layouts, tables) == GnSuccess);
+
+        GnDestroyDescriptorPool(device, pool);
+    }
+
+    GnDestroyDescriptorTableLayout(device, layout);
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Write descriptor table", "[device]")
+{
+    if (g_test_backend != GnBackend_Vulkan)
+        return;
+
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    GnBufferDesc buffer_desc{};
+    buffer_desc.size = 256;
+    buffer_desc.usage = GnBufferUsage_Storage;
+
+    GnBuffer buffer;
+    GnMemory buffer_memory;
+    REQUIRE(CreateHostVisibleBuffer(adapter, device, &buffer_desc, &buffer, &buffer_memory) == GnSuccess);
+
+    GnTextureDesc texture_desc{};
+    texture_desc.usage = GnTextureUsage_Sampled;
+    texture_desc.type = GnTextureType_2D;
+    texture_desc.format = GnFormat_RGBA8Unorm;
+    texture_desc.width = 4;
+    texture_desc.height = 4;
+    texture_desc.depth = 1;
+    texture_desc.mip_levels = 1;
+    texture_desc.array_layers = 1;
+    texture_desc.samples = GnSampleCount_X1;
+
+    GnTexture texture;
+    REQUIRE(GnCreateTexture(device, &texture_desc, &texture) == GnSuccess);
+
+    GnMemoryRequirements requirements{};
+    GnGetTextureMemoryRequirements(device, texture, &requirements);
+
+    GnMemoryDesc memory_desc{};
+    memory_desc.size = requirements.size;
+    memory_desc.memory_type_index = GnFindSupportedMemoryType(adapter, requirements.supported_memory_type_bits,
+                                                              GnMemoryAttribute_DeviceLocal, 0, 0);
+
+    GnMemory texture_memory;
+    REQUIRE(GnCreateMemory(device, &memory_desc, &texture_memory) == GnSuccess);
+    REQUIRE(GnBindTextureMemory(device, texture, texture_memory, 0) == GnSuccess);
+
+    GnTextureViewDesc view_desc{};
+    view_desc.texture = texture;
+    view_desc.type = GnTextureViewType_2D;
+    view_desc.format = GnFormat_RGBA8Unorm;
+    view_desc.subresource_range.aspect = GnTextureAspect_Color;
+    view_desc.subresource_range.num_mip_levels = 1;
+    view_desc.subresource_range.num_array_layers = 1;
+
+    GnTextureView view;
+    REQUIRE(GnCreateTextureView(device, &view_desc, &view) == GnSuccess);
+
+    SECTION("Buffers and textures")
+    {
+        GnDescriptorTableBinding bindings[2]{};
+        bindings[0].binding = 0;
+        bindings[0].type = GnResourceType_StorageBuffer;
+        bindings[0].num_resources = 2;
+        bindings[0].shader_visibility = GnShaderStage_ComputeShader;
+        bindings[1].binding = 1;
+        bindings[1].type = GnResourceType_SampledTexture;
+        bindings[1].num_resources = 1;
+        bindings[1].shader_visibility = GnShaderStage_ComputeShader;
+
+        GnDescriptorTableLayoutDesc layout_desc{};
+        layout_desc.num_bindings = 2;
+        layout_desc.bindings = bindings;
+
+        GnDescriptorTableLayout layout;
+        REQUIRE(GnCreateDescriptorTableLayout(device, &layout_desc, &layout) == GnSuccess);
+
+        GnDescriptorPoolDesc pool_desc{};
+        pool_desc.type = GnDescriptorTableType_Resource;
+        pool_desc.mode = GnDescriptorPoolMode_Persistent;
+        pool_desc.max_descriptor_tables = 1;
+        pool_desc.pool_limits.max_storage_buffers = 2;
+        pool_desc.pool_limits.max_sampled_textures = 1;
+
+        GnDescriptorPool pool;
+        REQUIRE(GnCreateDescriptorPool(device, &pool_desc, &pool) == GnSuccess);
+
+        GnDescriptorTable table;
+        REQUIRE(GnAllocateDescriptorTables(device, pool, 1, &layout, &table) == GnSuccess);
+
+        // One entry per array element, in binding declaration order
+        GnDescriptorInfo descriptors[3]{};
+        descriptors[0].buffer = { buffer, 0, 128 };
+        descriptors[1].buffer = { buffer, 128, GN_WHOLE_SIZE };
+        descriptors[2].texture_view = view;
+
+        REQUIRE(GnWriteDescriptorTable(device, table, descriptors) == GnSuccess);
+        REQUIRE(GnWriteDescriptorTable(device, table, nullptr) == GnError_InvalidArgs);
+
+        GnDestroyDescriptorPool(device, pool);
+        GnDestroyDescriptorTableLayout(device, layout);
+    }
+
+    SECTION("Samplers")
+    {
+        GnDescriptorTableBinding binding{};
+        binding.binding = 0;
+        binding.type = GnResourceType_Sampler;
+        binding.num_resources = 1;
+        binding.shader_visibility = GnShaderStage_FragmentShader;
+
+        GnDescriptorTableLayoutDesc layout_desc{};
+        layout_desc.num_bindings = 1;
+        layout_desc.bindings = &binding;
+
+        GnDescriptorTableLayout layout;
+        REQUIRE(GnCreateDescriptorTableLayout(device, &layout_desc, &layout) == GnSuccess);
+
+        GnDescriptorPoolDesc pool_desc{};
+        pool_desc.type = GnDescriptorTableType_Sampler;
+        pool_desc.mode = GnDescriptorPoolMode_Persistent;
+        pool_desc.max_descriptor_tables = 1;
+        pool_desc.pool_limits.max_samplers = 1;
+
+        GnDescriptorPool pool;
+        REQUIRE(GnCreateDescriptorPool(device, &pool_desc, &pool) == GnSuccess);
+
+        GnDescriptorTable table;
+        REQUIRE(GnAllocateDescriptorTables(device, pool, 1, &layout, &table) == GnSuccess);
+
+        // There is no sampler object to write yet
+        GnDescriptorInfo descriptor{};
+        REQUIRE(GnWriteDescriptorTable(device, table, &descriptor) == GnError_Unimplemented);
+
+        GnDestroyDescriptorPool(device, pool);
+        GnDestroyDescriptorTableLayout(device, layout);
+    }
+
+    GnDestroyTextureView(device, view);
+    GnDestroyTexture(device, texture);
+    GnDestroyMemory(device, texture_memory);
+    GnDestroyBuffer(device, buffer);
+    GnDestroyMemory(device, buffer_memory);
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Tracked buffer copies", "[device]")
+{
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    uint32_t queue_group = GetDirectQueueGroup(adapter);
+    GnQueue queue = GnGetDeviceQueue(device, queue_group, 0);
+
+    GnBufferDesc buffer_desc{};
+    buffer_desc.size = 256;
+    buffer_desc.usage = GnBufferUsage_CopySrc | GnBufferUsage_CopyDst;
+
+    GnBuffer buffers[3];
+    GnMemory memories[3];
+
+    for (uint32_t i = 0; i < 3; i++)
+        REQUIRE(CreateHostVisibleBuffer(adapter, device, &buffer_desc, &buffers[i], &memories[i]) == GnSuccess);
+
+    std::vector<uint32_t> data(64);
+    std::iota(data.begin(), data.end(), 1);
+    REQUIRE(GnWriteBuffer(device, buffers[0], 0, buffer_desc.size, data.data()) == GnSuccess);
+
+    GnCommandPool command_pool;
+    GnCommandList command_list;
+    REQUIRE(CreateCommandList(device, queue_group, &command_pool, &command_list) == GnSuccess);
+
+    GnCommandListBeginDesc begin_desc{};
+    begin_desc.flags = GnCommandListBegin_OneTimeSubmit | GnCommandListBegin_TrackResourceState;
+    REQUIRE(GnBeginCommandList(command_list, &begin_desc) == GnSuccess);
+
+    // The second copy reads what the first one wrote, the tracker has to put a CopyDst -> CopySrc barrier in between
+    GnCmdCopyBuffer(command_list, buffers[0], 0, buffers[1], 0, buffer_desc.size);
+    GnCmdCopyBuffer(command_list, buffers[1], 0, buffers[2], 0, buffer_desc.size);
+    GnCmdTransitionBuffer(command_list, buffers[2], GnResourceAccess_HostRead);
+    REQUIRE(GnEndCommandList(command_list) == GnSuccess);
+
+    REQUIRE(GnEnqueueCommandLists(queue, 1, &command_list) == GnSuccess);
+    REQUIRE(GnFlushQueueAndWait(queue) == GnSuccess);
+
+    uint32_t* mapped_data = nullptr;
+    REQUIRE(GnMapBuffer(device, buffers[2], nullptr, (void**)&mapped_data) == GnSuccess);
+    REQUIRE(std::equal(data.begin(), data.end(), mapped_data));
+    GnUnmapBuffer(device, buffers[2], nullptr);
+
+    GnDestroyCommandLists(device, command_pool, 1, &command_list);
+    GnDestroyCommandPool(device, command_pool);
+
+    for (uint32_t i = 0; i < 3; i++) {
+        GnDestroyBuffer(device, buffers[i]);
+        GnDestroyMemory(device, memories[i]);
+    }
+
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Tracked texture copies", "[device]")
+{
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    uint32_t queue_group = GetDirectQueueGroup(adapter);
+    GnQueue queue = GnGetDeviceQueue(device, queue_group, 0);
+
+    ReadbackTarget src_target, dst_target;
+    REQUIRE(CreateReadbackTarget(adapter, device, 4, 4, &src_target) == GnSuccess);
+    REQUIRE(CreateReadbackTarget(adapter, device, 4, 4, &dst_target) == GnSuccess);
+
+    GnCommandPool command_pool;
+    GnCommandList command_list;
+    REQUIRE(CreateCommandList(device, queue_group, &command_pool, &command_list) == GnSuccess);
+
+    GnCommandListBeginDesc begin_desc{};
+    begin_desc.flags = GnCommandListBegin_OneTimeSubmit | GnCommandListBegin_TrackResourceState;
+    REQUIRE(GnBeginCommandList(command_list, &begin_desc) == GnSuccess);
+
+    GnTextureSubresourceRange subresource_range{};
+    subresource_range.aspect = GnTextureAspect_Color;
+    subresource_range.num_mip_levels = 1;
+    subresource_range.num_array_layers = 1;
+    GnCmdTransitionTexture(command_list, src_target.texture, &subresource_range, GnResourceAccess_ColorTargetWrite);
+
+    GnRenderPassColorTargetDesc color_target{};
+    color_target.view = src_target.view;
+    color_target.access = GnResourceAccess_ColorTargetWrite;
+    color_target.load_op = GnRenderPassOp_Clear;
+    color_target.store_op = GnRenderPassOp_Store;
+    color_target.clear_value.float32[0] = 1.0f;
+    color_target.clear_value.float32[3] = 1.0f;
+
+    GnRenderPassBeginDesc render_pass_desc{};
+    render_pass_desc.sample_count = GnSampleCount_X1;
+    render_pass_desc.width = 4;
+    render_pass_desc.height = 4;
+    render_pass_desc.num_color_targets = 1;
+    render_pass_desc.color_targets = &color_target;
+
+    GnCmdBeginRenderPass(command_list, &render_pass_desc);
+    GnCmdEndRenderPass(command_list);
+
+    // Both textures and the readback buffer are transitioned by the tracker, no explicit barrier is recorded
+    GnCmdCopyTexture(command_list, src_target.texture, GnResourceAccess_ColorTargetWrite, GnOffset3{ 0, 0, 0 },
+                     dst_target.texture, GnResourceAccess_Undefined, GnOffset3{ 0, 0, 0 }, GnExtent3{ 4, 4, 1 });
+    GnCmdCopyTextureToBuffer(command_list, dst_target.texture, GnResourceAccess_CopyDst, dst_target.buffer);
+    GnCmdTransitionBuffer(command_list, dst_target.buffer, GnResourceAccess_HostRead);
+    REQUIRE(GnEndCommandList(command_list) == GnSuccess);
+
+    REQUIRE(GnEnqueueCommandLists(queue, 1, &command_list) == GnSuccess);
+    REQUIRE(GnFlushQueueAndWait(queue) == GnSuccess);
+    REQUIRE(ReadFirstPixel(device, &dst_target) == 0xFF0000FF);
+
+    GnDestroyCommandLists(device, command_pool, 1, &command_list);
+    GnDestroyCommandPool(device, command_pool);
+    DestroyReadbackTarget(device, &dst_target);
+    DestroyReadbackTarget(device, &src_target);
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Cross-queue submissions", "[device]")
+{
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    if (!GnIsAdapterFeaturePresent(adapter, GnFeature_TimelineFence)) {
+        GnDestroyInstance(instance);
+        return;
+    }
+
+    // Any queue other than the first direct queue will do, preferably one of another queue group
+    uint32_t direct_queue_group = GetDirectQueueGroup(adapter);
+    uint32_t other_queue_group = direct_queue_group;
+    uint32_t other_queue_index = 1;
+    uint32_t num_direct_queues = 0;
+
+    GnEnumerateAdapterQueueGroupProperties(adapter,
+                                           [&](const GnQueueGroupProperties& queue_properties) {
+                                               if (queue_properties.index == direct_queue_group)
+                                                   num_direct_queues = queue_properties.num_queues;
+                                               else if (queue_properties.num_queues > 0 && other_queue_index != 0) {
+                                                   other_queue_group = queue_properties.index;
+                                                   other_queue_index = 0;
+                                               }
+                                           });
+
+    if (other_queue_index == 1 && num_direct_queues < 2) {
+        GnDestroyInstance(instance);
+        return;
+    }
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    GnQueue direct_queue = GnGetDeviceQueue(device, direct_queue_group, 0);
+    GnQueue other_queue = GnGetDeviceQueue(device, other_queue_group, other_queue_index);
+
+    GnBufferDesc buffer_desc{};
+    buffer_desc.size = 256;
+    buffer_desc.usage = GnBufferUsage_CopySrc | GnBufferUsage_CopyDst;
+
+    GnBuffer buffers[4];
+    GnMemory memories[4];
+
+    for (uint32_t i = 0; i < 4; i++)
+        REQUIRE(CreateHostVisibleBuffer(adapter, device, &buffer_desc, &buffers[i], &memories[i]) == GnSuccess);
+
+    std::vector<uint32_t> other_data(64), direct_data(64);
+    std::iota(other_data.begin(), other_data.end(), 1);
+    std::iota(direct_data.begin(), direct_data.end(), 100);
+    REQUIRE(GnWriteBuffer(device, buffers[0], 0, buffer_desc.size, other_data.data()) == GnSuccess);
+    REQUIRE(GnWriteBuffer(device, buffers[2], 0, buffer_desc.size, direct_data.data()) == GnSuccess);
+
+    // Each queue copies its own pair of buffers, so no buffer changes queue group
+    GnCommandPool command_pools[2];
+    GnCommandList command_lists[2];
+    REQUIRE(CreateCommandList(device, other_queue_group, &command_pools[0], &command_lists[0]) == GnSuccess);
+    REQUIRE(CreateCommandList(device, direct_queue_group, &command_pools[1], &command_lists[1]) == GnSuccess);
+
+    for (uint32_t i = 0; i < 2; i++) {
+        GnCommandListBeginDesc begin_desc{};
+        REQUIRE(GnBeginCommandList(command_lists[i], &begin_desc) == GnSuccess);
+
+        GnCmdCopyBuffer(command_lists[i], buffers[i * 2], 0, buffers[i * 2 + 1], 0, buffer_desc.size);
+
+        GnBufferBarrier barrier{};
+        barrier.buffer = buffers[i * 2 + 1];
+        barrier.size = GN_WHOLE_SIZE;
+        barrier.prev_access = GnResourceAccess_CopyDst;
+        barrier.next_access = GnResourceAccess_HostRead;
+        GnCmdBufferBarrier(command_lists[i], 1, &barrier);
+
+        REQUIRE(GnEndCommandList(command_lists[i]) == GnSuccess);
+    }
+
+    const uint32_t dependencies[] = { 0 };
+    GnQueueSubmission submissions[2]{};
+    submissions[0].queue = other_queue;
+    submissions[0].num_command_lists = 1;
+    submissions[0].command_lists = &command_lists[0];
+    submissions[1].queue = direct_queue;
+    submissions[1].num_command_lists = 1;
+    submissions[1].command_lists = &command_lists[1];
+    submissions[1].num_dependencies = 1;
+    submissions[1].dependencies = dependencies;
+
+    // Waiting on another queue requires wait stages
+    REQUIRE(GnEnqueueSubmissions(2, submissions) == GnError_InvalidArgs);
+
+    // Dependencies must refer to earlier submissions
+    submissions[1].wait_stages = GnPipelineStage_Transfer;
+    submissions[0].num_dependencies = 1;
+    submissions[0].dependencies = dependencies;
+    REQUIRE(GnEnqueueSubmissions(2, submissions) == GnError_InvalidArgs);
+
+    submissions[0].num_dependencies = 0;
+    submissions[0].dependencies = nullptr;
+
+    // Rejected calls enqueue nothing, and repeated calls keep signaling increasing progress values
+    for (uint32_t i = 0; i < 2; i++) {
+        REQUIRE(GnEnqueueSubmissions(2, submissions) == GnSuccess);
+        REQUIRE(GnFlushQueueAndWait(direct_queue) == GnSuccess);
+        REQUIRE(GnFlushQueueAndWait(other_queue) == GnSuccess);
+    }
+
+    uint32_t* mapped_data = nullptr;
+    REQUIRE(GnMapBuffer(device, buffers[1], nullptr, (void**)&mapped_data) == GnSuccess);
+    REQUIRE(std::equal(other_data.begin(), other_data.end(), mapped_data));
+    GnUnmapBuffer(device, buffers[1], nullptr);
+
+    REQUIRE(GnMapBuffer(device, buffers[3], nullptr, (void**)&mapped_data) == GnSuccess);
+    REQUIRE(std::equal(direct_data.begin(), direct_data.end(), mapped_data));
+    GnUnmapBuffer(device, buffers[3], nullptr);
+
+    for (uint32_t i = 0; i < 2; i++) {
+        GnDestroyCommandLists(device, command_pools[i], 1, &command_lists[i]);
+        GnDestroyCommandPool(device, command_pools[i]);
+    }
+
+    for (uint32_t i = 0; i < 4; i++) {
+        GnDestroyBuffer(device, buffers[i]);
+        GnDestroyMemory(device, memories[i]);
+    }
+
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Timeline fence", "[device]")
+{
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    if (!GnIsAdapterFeaturePresent(adapter, GnFeature_TimelineFence)) {
+        GnDestroyInstance(instance);
+        return;
+    }
+
+    GnFeature timeline_feature = GnFeature_TimelineFence;
+
+    GnDeviceDesc device_desc{};
+    device_desc.num_enabled_features = 1;
+    device_desc.enabled_features = &timeline_feature;
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, &device_desc, &device) == GnSuccess);
+
+    GnQueue queue = GnGetDeviceQueue(device, GetDirectQueueGroup(adapter), 0);
+
+    GnFence fence, binary_fence;
+    REQUIRE(GnCreateTimelineFence(device, 5, &fence) == GnSuccess);
+    REQUIRE(GnCreateFence(device, GN_FALSE, &binary_fence) == GnSuccess);
+
+    uint64_t value = 0;
+    REQUIRE(GnGetFenceValue(fence, &value) == GnSuccess);
+    REQUIRE(value == 5);
+
+    SECTION("Invalid fences")
+    {
+        REQUIRE(GnGetFenceValue(nullptr, &value) == GnError_InvalidArgs);
+        REQUIRE(GnGetFenceValue(binary_fence, &value) == GnError_InvalidArgs);
+        REQUIRE(GnWaitFence(nullptr, 0) == GnError_InvalidArgs);
+        REQUIRE(GnWaitFenceValue(nullptr, 1, 0) == GnError_InvalidArgs);
+        REQUIRE(GnEnqueueSignalFence(queue, nullptr, 1) == GnError_InvalidArgs);
+        REQUIRE(GnEnqueueSignalFence(queue, binary_fence, 1) == GnError_InvalidArgs);
+        REQUIRE(GnEnqueueWaitFence(queue, nullptr, 1) == GnError_InvalidArgs);
+        REQUIRE(GnEnqueueWaitFenceStages(queue, nullptr, 1, GnPipelineStage_AllCommands) == GnError_InvalidArgs);
+    }
+
+    SECTION("Signal and wait")
+    {
+        // Values the fence has already reached don't block
+        REQUIRE(GnWaitFenceValue(fence, 5, 0) == GnSuccess);
+        REQUIRE(GnWaitFenceValue(fence, 6, 0) == GnTimeout);
+
+        REQUIRE(GnEnqueueSignalFence(queue, fence, 6) == GnSuccess);
+        REQUIRE(GnFlushQueue(queue, nullptr) == GnSuccess);
+        REQUIRE(GnWaitFenceValue(fence, 6, UINT64_MAX) == GnSuccess);
+        REQUIRE(GnGetFenceValue(fence, &value) == GnSuccess);
+        REQUIRE(value == 6);
+
+        // The queue waits for the value it signaled before signaling the next one
+        REQUIRE(GnEnqueueWaitFence(queue, fence, 6) == GnSuccess);
+        REQUIRE(GnEnqueueSignalFence(queue, fence, 8) == GnSuccess);
+        REQUIRE(GnFlushQueue(queue, nullptr) == GnSuccess);
+
+        // Waits for the highest value enqueued for signaling
+        REQUIRE(GnWaitFence(fence, UINT64_MAX) == GnSuccess);
+        REQUIRE(GnGetFenceValue(fence, &value) == GnSuccess);
+        REQUIRE(value == 8);
+        REQUIRE(GnWaitFenceValue(fence, 7, 0) == GnSuccess);
+    }
+
+    REQUIRE(GnDeviceWaitIdle(device) == GnSuccess);
+    GnDestroyFence(device, binary_fence);
+    GnDestroyFence(device, fence);
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Deferred submission", "[device]")
+{
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    if (!GnIsAdapterFeaturePresent(adapter, GnFeature_TimelineFence)) {
+        GnDestroyInstance(instance);
+        return;
+    }
+
+    GnFeature timeline_feature = GnFeature_TimelineFence;
+
+    GnDeviceDesc device_desc{};
+    device_desc.num_enabled_features = 1;
+    device_desc.enabled_features = &timeline_feature;
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, &device_desc, &device) == GnSuccess);
+
+    uint32_t queue_group = GetDirectQueueGroup(adapter);
+    GnQueue queue = GnGetDeviceQueue(device, queue_group, 0);
+    GnSetQueueDeferredSubmission(queue, GN_TRUE);
+
+    GnFence fence;
+    REQUIRE(GnCreateTimelineFence(device, 0, &fence) == GnSuccess);
+
+    GnBufferDesc buffer_desc{};
+    buffer_desc.size = 256;
+    buffer_desc.usage = GnBufferUsage_CopySrc | GnBufferUsage_CopyDst;
+
+    GnBuffer buffers[2];
+    GnMemory memories[2];
+
+    for (uint32_t i = 0; i < 2; i++)
+        REQUIRE(CreateHostVisibleBuffer(adapter, device, &buffer_desc, &buffers[i], &memories[i]) == GnSuccess);
+
+    std::vector<uint32_t> data(64);
+    std::iota(data.begin(), data.end(), 1);
+    REQUIRE(GnWriteBuffer(device, buffers[0], 0, buffer_desc.size, data.data()) == GnSuccess);
+
+    GnCommandPool command_pool;
+    GnCommandList command_list;
+    REQUIRE(CreateCommandList(device, queue_group, &command_pool, &command_list) == GnSuccess);
+
+    GnCommandListBeginDesc begin_desc{};
+    begin_desc.flags = GnCommandListBegin_OneTimeSubmit | GnCommandListBegin_TrackResourceState;
+    REQUIRE(GnBeginCommandList(command_list, &begin_desc) == GnSuccess);
+    GnCmdCopyBuffer(command_list, buffers[0], 0, buffers[1], 0, buffer_desc.size);
+    GnCmdTransitionBuffer(command_list, buffers[1], GnResourceAccess_HostRead);
+    REQUIRE(GnEndCommandList(command_list) == GnSuccess);
+
+    // Flushes without a fence only close packets, nothing reaches the GPU before the commit
+    REQUIRE(GnEnqueueCommandLists(queue, 1, &command_list) == GnSuccess);
+    REQUIRE(GnEnqueueSignalFence(queue, fence, 1) == GnSuccess);
+    REQUIRE(GnFlushQueue(queue, nullptr) == GnSuccess);
+    REQUIRE(GnEnqueueSignalFence(queue, fence, 2) == GnSuccess);
+    REQUIRE(GnFlushQueue(queue, nullptr) == GnSuccess);
+    REQUIRE(GnWaitFenceValue(fence, 1, 0) == GnTimeout);
+
+    REQUIRE(GnCommitQueue(queue, nullptr) == GnSuccess);
+    REQUIRE(GnWaitFenceValue(fence, 2, UINT64_MAX) == GnSuccess);
+
+    uint32_t* mapped_data = nullptr;
+    REQUIRE(GnMapBuffer(device, buffers[1], nullptr, (void**)&mapped_data) == GnSuccess);
+    REQUIRE(std::equal(data.begin(), data.end(), mapped_data));
+    GnUnmapBuffer(device, buffers[1], nullptr);
+
+    // The next commit only submits what was enqueued since the last one
+    REQUIRE(GnEnqueueSignalFence(queue, fence, 3) == GnSuccess);
+    REQUIRE(GnCommitQueue(queue, nullptr) == GnSuccess);
+    REQUIRE(GnWaitFenceValue(fence, 3, UINT64_MAX) == GnSuccess);
+
+    GnDestroyCommandLists(device, command_pool, 1, &command_list);
+    GnDestroyCommandPool(device, command_pool);
+
+    for (uint32_t i = 0; i < 2; i++) {
+        GnDestroyBuffer(device, buffers[i]);
+        GnDestroyMemory(device, memories[i]);
+    }
+
+    GnDestroyFence(device, fence);
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
+
+TEST_CASE("Deferred destruction", "[device]")
+{
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+
+    if (!GnIsAdapterFeaturePresent(adapter, GnFeature_TimelineFence)) {
+        GnDestroyInstance(instance);
+        return;
+    }
+
+    GnFeature timeline_feature = GnFeature_TimelineFence;
+
+    GnDeviceDesc device_desc{};
+    device_desc.num_enabled_features = 1;
+    device_desc.enabled_features = &timeline_feature;
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, &device_desc, &device) == GnSuccess);
+    GnSetDeviceDeferredDestruction(device, GN_TRUE, 0);
+
+    GnQueue queue = GnGetDeviceQueue(device, GetDirectQueueGroup(adapter), 0);
+
+    GnFence fence;
+    REQUIRE(GnCreateTimelineFence(device, 0, &fence) == GnSuccess);
+
+    GnBufferDesc buffer_desc{};
+    buffer_desc.size = 256;
+    buffer_desc.usage = GnBufferUsage_CopySrc;
+
+    GnBuffer buffers[2];
+    for (GnBuffer& buffer : buffers)
+        REQUIRE(GnCreateBuffer(device, &buffer_desc, &buffer) == GnSuccess);
+
+    GnDeferredDestructionStats stats{};
+
+    // Queued objects stay alive until their frame is retired and the fence has reached its value
+    GnDestroyBuffer(device, buffers[0]);
+    GnGetDeferredDestructionStats(device, &stats);
+    REQUIRE(stats.num_pending_objects == 1);
+    REQUIRE(stats.num_pending_frames == 0);
+
+    REQUIRE(GnRetireDeviceFrame(device, fence, 1) == GnSuccess);
+    GnGetDeferredDestructionStats(device, &stats);
+    REQUIRE(stats.num_pending_objects == 1);
+    REQUIRE(stats.num_pending_frames == 1);
+
+    // Queued after the retired frame, it waits for the next one
+    GnDestroyBuffer(device, buffers[1]);
+
+    REQUIRE(GnEnqueueSignalFence(queue, fence, 1) == GnSuccess);
+    REQUIRE(GnFlushQueueAndWait(queue) == GnSuccess);
+
+    REQUIRE(GnRetireDeviceFrame(device, fence, 2) == GnSuccess);
+    GnGetDeferredDestructionStats(device, &stats);
+    REQUIRE(stats.num_pending_objects == 1);
+    REQUIRE(stats.num_pending_frames == 1);
+
+    REQUIRE(GnEnqueueSignalFence(queue, fence, 2) == GnSuccess);
+    REQUIRE(GnFlushQueueAndWait(queue) == GnSuccess);
+
+    REQUIRE(GnRetireDeviceFrame(device, fence, 2) == GnSuccess);
+    GnGetDeferredDestructionStats(device, &stats);
+    REQUIRE(stats.num_pending_objects == 0);
+    REQUIRE(stats.num_pending_frames == 0);
+
+    GnDestroyFence(device, fence);
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
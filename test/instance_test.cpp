@@ -111,4 +111,39 @@ TEST_CASE("Adapter queues", "[instance]")
     GnEnumerateAdapterQueueGroupProperties(adapter, [&queue_properties](const GnQueueGroupProperties& feature) { queue_properties.push_back(feature); });
 
     GnDestroyInstance(instance);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Startup timings", "[instance]")
+{
+    GnInstanceDesc instance_desc{};
+    instance_desc.backend = g_test_backend;
+    instance_desc.enable_debugging = GN_TRUE;
+    instance_desc.enable_validation = GN_TRUE;
+    instance_desc.enable_backend_validation = GN_TRUE;
+
+    GnInstance instance;
+    REQUIRE(GnCreateInstance(&instance_desc, &instance) == GnSuccess);
+
+    GnInstanceStartupTimings timings;
+    GnGetInstanceStartupTimings(instance, &timings);
+    REQUIRE(timings.num_queried_adapters == 0);
+    REQUIRE(timings.create_devices_ns == 0);
+
+    // Only the adapter that gets used is queried
+    GnAdapter adapter = GnGetDefaultAdapter(instance);
+    GnAdapterProperties properties;
+    GnGetAdapterProperties(adapter, &properties);
+
+    GnGetInstanceStartupTimings(instance, &timings);
+    REQUIRE(timings.num_queried_adapters == 1);
+
+    GnDevice device;
+    REQUIRE(GnCreateDevice(adapter, nullptr, &device) == GnSuccess);
+
+    GnGetInstanceStartupTimings(instance, &timings);
+    REQUIRE(timings.num_queried_adapters == 1);
+    REQUIRE(timings.create_devices_ns != 0);
+
+    GnDestroyDevice(device);
+    GnDestroyInstance(instance);
+}
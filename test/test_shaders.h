@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+
+// Hand-assembled SPIR-V 1.0 shaders for tests that need pipelines. Every shader has a "main" entry point.
+
+// Vertex shader drawing a triangle that covers the viewport from 3 vertices, positions come from gl_VertexIndex.
+static const uint32_t g_fullscreen_vs[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x0000001c, 0x00000000, 0x00020011,
+    0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0007000f, 0x00000000,
+    0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00000003, 0x00040047,
+    0x00000002, 0x0000000b, 0x0000002a, 0x00040047, 0x00000003, 0x0000000b,
+    0x00000000, 0x00020013, 0x00000004, 0x00030021, 0x00000005, 0x00000004,
+    0x00040015, 0x00000006, 0x00000020, 0x00000001, 0x00030016, 0x00000007,
+    0x00000020, 0x00040017, 0x00000008, 0x00000007, 0x00000004, 0x00040020,
+    0x00000009, 0x00000001, 0x00000006, 0x00040020, 0x0000000a, 0x00000003,
+    0x00000008, 0x0004003b, 0x00000009, 0x00000002, 0x00000001, 0x0004003b,
+    0x0000000a, 0x00000003, 0x00000003, 0x0004002b, 0x00000006, 0x0000000b,
+    0x00000001, 0x0004002b, 0x00000006, 0x0000000c, 0x00000002, 0x0004002b,
+    0x00000007, 0x0000000d, 0x00000000, 0x0004002b, 0x00000007, 0x0000000e,
+    0x3f800000, 0x0004002b, 0x00000007, 0x0000000f, 0x40000000, 0x00050036,
+    0x00000004, 0x00000001, 0x00000000, 0x00000005, 0x000200f8, 0x00000010,
+    0x0004003d, 0x00000006, 0x00000011, 0x00000002, 0x000500c4, 0x00000006,
+    0x00000012, 0x00000011, 0x0000000b, 0x000500c7, 0x00000006, 0x00000013,
+    0x00000012, 0x0000000c, 0x000500c7, 0x00000006, 0x00000014, 0x00000011,
+    0x0000000c, 0x0004006f, 0x00000007, 0x00000015, 0x00000013, 0x0004006f,
+    0x00000007, 0x00000016, 0x00000014, 0x00050085, 0x00000007, 0x00000017,
+    0x00000015, 0x0000000f, 0x00050085, 0x00000007, 0x00000018, 0x00000016,
+    0x0000000f, 0x00050083, 0x00000007, 0x00000019, 0x00000017, 0x0000000e,
+    0x00050083, 0x00000007, 0x0000001a, 0x00000018, 0x0000000e, 0x00070050,
+    0x00000008, 0x0000001b, 0x00000019, 0x0000001a, 0x0000000d, 0x0000000e,
+    0x0003003e, 0x00000003, 0x0000001b, 0x000100fd, 0x00010038,
+};
+
+// Fragment shader writing opaque red to color target 0.
+static const uint32_t g_red_fs[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x0000000e, 0x00000000, 0x00020011,
+    0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0006000f, 0x00000004,
+    0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00030010, 0x00000001,
+    0x00000007, 0x00040047, 0x00000002, 0x0000001e, 0x00000000, 0x00020013,
+    0x00000003, 0x00030021, 0x00000004, 0x00000003, 0x00030016, 0x00000005,
+    0x00000020, 0x00040017, 0x00000006, 0x00000005, 0x00000004, 0x00040020,
+    0x00000007, 0x00000003, 0x00000006, 0x0004003b, 0x00000007, 0x00000002,
+    0x00000003, 0x0004002b, 0x00000005, 0x00000008, 0x3f800000, 0x0004002b,
+    0x00000005, 0x00000009, 0x00000000, 0x0004002b, 0x00000005, 0x0000000a,
+    0x00000000, 0x0004002b, 0x00000005, 0x0000000b, 0x3f800000, 0x0007002c,
+    0x00000006, 0x0000000c, 0x00000008, 0x00000009, 0x0000000a, 0x0000000b,
+    0x00050036, 0x00000003, 0x00000001, 0x00000000, 0x00000004, 0x000200f8,
+    0x0000000d, 0x0003003e, 0x00000002, 0x0000000c, 0x000100fd, 0x00010038,
+};
+
+// Fragment shader writing opaque green to color target 0.
+static const uint32_t g_green_fs[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x0000000e, 0x00000000, 0x00020011,
+    0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0006000f, 0x00000004,
+    0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00030010, 0x00000001,
+    0x00000007, 0x00040047, 0x00000002, 0x0000001e, 0x00000000, 0x00020013,
+    0x00000003, 0x00030021, 0x00000004, 0x00000003, 0x00030016, 0x00000005,
+    0x00000020, 0x00040017, 0x00000006, 0x00000005, 0x00000004, 0x00040020,
+    0x00000007, 0x00000003, 0x00000006, 0x0004003b, 0x00000007, 0x00000002,
+    0x00000003, 0x0004002b, 0x00000005, 0x00000008, 0x00000000, 0x0004002b,
+    0x00000005, 0x00000009, 0x3f800000, 0x0004002b, 0x00000005, 0x0000000a,
+    0x00000000, 0x0004002b, 0x00000005, 0x0000000b, 0x3f800000, 0x0007002c,
+    0x00000006, 0x0000000c, 0x00000008, 0x00000009, 0x0000000a, 0x0000000b,
+    0x00050036, 0x00000003, 0x00000001, 0x00000000, 0x00000004, 0x000200f8,
+    0x0000000d, 0x0003003e, 0x00000002, 0x0000000c, 0x000100fd, 0x00010038,
+};
+
+// Fragment shader copying input attachment 0 (set 0, binding 0) to color target 0.
+static const uint32_t g_copy_input_fs[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x00000012, 0x00000000, 0x00020011,
+    0x00000001, 0x00020011, 0x00000028, 0x0003000e, 0x00000000, 0x00000001,
+    0x0006000f, 0x00000004, 0x00000001, 0x6e69616d, 0x00000000, 0x00000002,
+    0x00030010, 0x00000001, 0x00000007, 0x00040047, 0x00000002, 0x0000001e,
+    0x00000000, 0x00040047, 0x00000003, 0x00000022, 0x00000000, 0x00040047,
+    0x00000003, 0x00000021, 0x00000000, 0x00040047, 0x00000003, 0x0000002b,
+    0x00000000, 0x00020013, 0x00000004, 0x00030021, 0x00000005, 0x00000004,
+    0x00030016, 0x00000006, 0x00000020, 0x00040017, 0x00000007, 0x00000006,
+    0x00000004, 0x00040015, 0x00000008, 0x00000020, 0x00000001, 0x00040017,
+    0x00000009, 0x00000008, 0x00000002, 0x00090019, 0x0000000a, 0x00000006,
+    0x00000006, 0x00000000, 0x00000000, 0x00000000, 0x00000002, 0x00000000,
+    0x00040020, 0x0000000b, 0x00000000, 0x0000000a, 0x00040020, 0x0000000c,
+    0x00000003, 0x00000007, 0x0004003b, 0x0000000b, 0x00000003, 0x00000000,
+    0x0004003b, 0x0000000c, 0x00000002, 0x00000003, 0x0004002b, 0x00000008,
+    0x0000000d, 0x00000000, 0x0005002c, 0x00000009, 0x0000000e, 0x0000000d,
+    0x0000000d, 0x00050036, 0x00000004, 0x00000001, 0x00000000, 0x00000005,
+    0x000200f8, 0x0000000f, 0x0004003d, 0x0000000a, 0x00000010, 0x00000003,
+    0x00050062, 0x00000007, 0x00000011, 0x00000010, 0x0000000e, 0x0003003e,
+    0x00000002, 0x00000011, 0x000100fd, 0x00010038,
+};